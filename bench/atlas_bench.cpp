@@ -0,0 +1,367 @@
+/*
+  Texture atlas benchmark
+
+  Generates a set of small images of different sizes and draws sprites that use them in no
+  particular order (like the objects of a scene), with a sprite batch (see gloom/sprite_batch.hpp):
+    - with every image in a texture of its own, so nearly every sprite ends a batch
+    - with the images packed into atlas pages (see gloom/texture_atlas.hpp), with MaxRects and Skyline
+  and reports the draw calls and milliseconds per frame, and how much of the pages the images cover.
+
+  Then, without OpenGL, it compares the packers on their own:
+    - packing efficiency when the images arrive one at a time (runtime) or sorted largest first (offline)
+    - a full page that keeps evicting a random image and refilling with new ones (streaming),
+      reporting how often the new images found no room and how full the page stays
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/atlas_bench.cpp ./src/texture_atlas.cpp ./src/atlas_packer.cpp ./src/sprite_batch.cpp ./src/uniform_buffer.cpp ./src/tga.cpp ./src/stream_buffer.cpp ./src/render_commands.cpp ./src/render_thread.cpp ./src/gl_state.cpp ./src/asset_io.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/glad.c -o atlas_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./atlas_bench [--images N] [--sprites N] [--frames N] [--page N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// GLoom
+#include <gloom/atlas_packer.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/sprite_batch.hpp>
+#include <gloom/stream_buffer.hpp>
+#include <gloom/texture_atlas.hpp>
+#include <gloom/uniform_buffer.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Small on purpose, we want to measure batching rather than filling pixels
+const int kFramebufferSize = 256;
+// Evict and insert rounds of the streaming test
+const int kChurnRounds = 20000;
+
+struct TestImage
+{
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+};
+
+// A small deterministic random number generator, so every run packs the same images
+struct Random
+{
+  uint32_t state = 12345;
+  int Next(int low, int high)
+  {
+    state = state * 1664525u + 1013904223u;
+    return low + (int)((state >> 8) % (uint32_t)(high - low + 1));
+  }
+};
+
+/*
+  Draws 'frames' frames of sprites, sprite i showing image imageOfSprite[i] from textures[image]
+  with texture coordinates textureRects[image]
+
+  @return the milliseconds per frame, until the GPU finished
+*/
+double DrawFrames(SpriteBatch& batch, int frames, const std::vector<int>& imageOfSprite, const std::vector<GLuint>& textures,
+		  const std::vector<glm::vec4>& textureRects)
+{
+  auto startTime = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    SpriteBatchBegin(batch);
+    for (size_t sprite = 0; sprite < imageOfSprite.size(); ++sprite)
+    {
+      int image = imageOfSprite[sprite];
+      glm::vec4 rect((float)((sprite * 7919 + frame) % kFramebufferSize), (float)((sprite * 104729) % kFramebufferSize), 4.0f, 4.0f);
+      SpriteBatchSubmit(batch, textures[image], rect, glm::vec4(1.0f), 0.0f, textureRects[image]);
+    }
+    SpriteBatchEnd(batch);
+    StreamBufferFenceFrame();
+    glFinish();
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() / frames;
+}
+
+// Image sizes of the packer comparison, enough for several pages
+const int kPackImageCount = 4096;
+
+/*
+  Packs slots for images of the given sizes, in the given order, into as many pages as they need
+
+  @return the pages used, 'efficiency' receives the fraction of their area the images cover, of the
+	  last page only up to its highest slot
+*/
+int PackAll(const std::vector<glm::ivec2>& sizes, const std::vector<int>& order, AtlasPackMethod method, int pageSize,
+	    double& efficiency, double& microsecondsPerInsert)
+{
+  std::vector<AtlasPacker> packers;
+  size_t imageArea = 0;
+  int lastPageTop = 0;
+  auto startTime = std::chrono::steady_clock::now();
+  for (int index : order)
+  {
+    AtlasRect slot;
+    int width = AtlasSlotSize(sizes[index].x, 4, 4);
+    int height = AtlasSlotSize(sizes[index].y, 4, 4);
+    size_t page = 0;
+    while (page < packers.size() && !AtlasPackerInsert(packers[page], width, height, slot))
+    {
+      ++page;
+    }
+    if (page == packers.size())
+    {
+      packers.emplace_back();
+      AtlasPackerReset(packers.back(), pageSize, pageSize, method);
+      AtlasPackerInsert(packers.back(), width, height, slot);
+      lastPageTop = 0;
+    }
+    if (page == packers.size() - 1)
+    {
+      lastPageTop = std::max(lastPageTop, slot.y + slot.height);
+    }
+    imageArea += (size_t)sizes[index].x * sizes[index].y;
+  }
+  microsecondsPerInsert = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count() / order.size();
+  efficiency = (double)imageArea / ((double)(packers.size() - 1) * pageSize * pageSize + (double)lastPageTop * pageSize);
+  return (int)packers.size();
+}
+
+/*
+  Fills a page like a streaming cache with a budget of as many images as first fit. Then, kChurnRounds
+  times, evicts a random image and inserts new ones of random size until the budget is reached again.
+
+  @return the rounds whose inserts found no room before the budget was reached, 'occupancy' receives
+	  the average fraction of the page in use after each round
+*/
+int Churn(AtlasPackMethod method, int pageSize, double& occupancy)
+{
+  Random random;
+  AtlasPacker packer;
+  AtlasPackerReset(packer, pageSize, pageSize, method);
+  std::vector<AtlasRect> placed;
+  AtlasRect slot;
+  while (AtlasPackerInsert(packer, AtlasSlotSize(random.Next(8, 64), 4, 4), AtlasSlotSize(random.Next(8, 64), 4, 4), slot))
+  {
+    placed.push_back(slot);
+  }
+  const size_t budget = placed.size();
+
+  int failures = 0;
+  occupancy = 0.0;
+  for (int round = 0; round < kChurnRounds; ++round)
+  {
+    if (!placed.empty())
+    {
+      size_t victim = (size_t)random.Next(0, (int)placed.size() - 1);
+      AtlasPackerRelease(packer, placed[victim]);
+      placed[victim] = placed.back();
+      placed.pop_back();
+    }
+    while (placed.size() < budget)
+    {
+      if (!AtlasPackerInsert(packer, AtlasSlotSize(random.Next(8, 64), 4, 4), AtlasSlotSize(random.Next(8, 64), 4, 4), slot))
+      {
+	++failures;
+	break;
+      }
+      placed.push_back(slot);
+    }
+    occupancy += AtlasPackerOccupancy(packer);
+  }
+  occupancy /= kChurnRounds;
+  return failures;
+}
+
+int main(int argc, char* args[])
+{
+  int imageCount = 256;
+  int spriteCount = 20000;
+  int frames = 20;
+  int pageSize = 1024;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--images" && i + 1 < argc)
+    {
+      imageCount = std::atoi(args[++i]);
+    }
+    else if (option == "--sprites" && i + 1 < argc)
+    {
+      spriteCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else if (option == "--page" && i + 1 < argc)
+    {
+      pageSize = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--images N] [--sprites N] [--frames N] [--page N]" << std::endl;
+      return 1;
+    }
+  }
+  if (imageCount <= 0 || spriteCount <= 0 || frames <= 0 || pageSize < 128)
+  {
+    std::cout << "--images, --sprites and --frames must be positive, --page at least 128" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  GLuint program = LoadBenchmarkProgram("./shaders/sprite_vert.glsl", "./shaders/sprite_frag.glsl", "sprite");
+  SpriteBatch batch;
+  if (program == 0 || !CreateSpriteBatch(batch, (size_t)spriteCount))
+  {
+    std::cout << "Could not create the sprite program or batch" << std::endl;
+    return 1;
+  }
+  BindUniformBlocks(program);
+  ViewUniforms view;
+  view.viewProjection[0][0] = 2.0f / kFramebufferSize;
+  view.viewProjection[1][1] = 2.0f / kFramebufferSize;
+  view.viewProjection[3] = glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+  GLuint viewBuffer = 0;
+  glGenBuffers(1, &viewBuffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, viewBuffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewUniforms), &view, GL_STATIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, kViewUniformBinding, viewBuffer);
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+  GLStateInvalidate();
+  GLStateUseProgram(program);
+
+  // Images from 8 to 64 pixels on a side, each a gradient in a color of its own
+  Random random;
+  std::vector<TestImage> images(imageCount);
+  for (TestImage& image : images)
+  {
+    image.width = random.Next(8, 64);
+    image.height = random.Next(8, 64);
+    uint8_t red = (uint8_t)random.Next(0, 255);
+    uint8_t green = (uint8_t)random.Next(0, 255);
+    for (int y = 0; y < image.height; ++y)
+    {
+      for (int x = 0; x < image.width; ++x)
+      {
+	image.pixels.insert(image.pixels.end(), { red, green, (uint8_t)(x * 255 / image.width), 255 });
+      }
+    }
+  }
+  std::vector<int> imageOfSprite(spriteCount);
+  for (int& image : imageOfSprite)
+  {
+    image = random.Next(0, imageCount - 1);
+  }
+  std::cout << imageCount << " images, " << spriteCount << " sprites per frame, " << frames << " frames" << std::endl;
+
+  // Before: a texture per image
+  std::vector<GLuint> textures(imageCount);
+  std::vector<glm::vec4> wholeTexture(imageCount, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+  glGenTextures(imageCount, textures.data());
+  for (int i = 0; i < imageCount; ++i)
+  {
+    GLStateBindTexture(GL_TEXTURE_2D, textures[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, images[i].width, images[i].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, images[i].pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+  }
+  batch.statistics = SpriteBatchStatistics();
+  double separateMilliseconds = DrawFrames(batch, frames, imageOfSprite, textures, wholeTexture);
+  std::cout << "Separate textures:  " << (double)batch.statistics.drawCalls / batch.statistics.frames << " draw calls, "
+	    << separateMilliseconds << " ms per frame" << std::endl;
+  GLStateBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures(imageCount, textures.data());
+
+  // After: the same images in an atlas
+  const AtlasPackMethod methods[2] = { AtlasPackMethod::MaxRects, AtlasPackMethod::Skyline };
+  for (AtlasPackMethod method : methods)
+  {
+    TextureAtlasSettings settings;
+    settings.pageSize = pageSize;
+    settings.maxPages = 16;
+    settings.method = method;
+    TextureAtlas atlas;
+    CreateTextureAtlas(atlas, settings);
+    std::vector<GLuint> atlasTextures(imageCount);
+    std::vector<glm::vec4> textureRects(imageCount);
+    for (int i = 0; i < imageCount; ++i)
+    {
+      if (!TextureAtlasInsert(atlas, (AtlasAssetId)i, images[i].pixels.data(), images[i].width, images[i].height))
+      {
+	std::cout << "Image " << i << " did not fit into the atlas" << std::endl;
+	return 1;
+      }
+      const AtlasEntry* entry = TextureAtlasFind(atlas, (AtlasAssetId)i);
+      atlasTextures[i] = entry->texture;
+      textureRects[i] = entry->textureRect;
+    }
+    TextureAtlasUpdateMipmaps(atlas);
+
+    batch.statistics = SpriteBatchStatistics();
+    double atlasMilliseconds = DrawFrames(batch, frames, imageOfSprite, atlasTextures, textureRects);
+    std::cout << "Atlas (" << AtlasPackMethodName(method) << "): " << (method == AtlasPackMethod::Skyline ? " " : "")
+	      << (double)batch.statistics.drawCalls / batch.statistics.frames << " draw calls, " << atlasMilliseconds
+	      << " ms per frame (" << separateMilliseconds / atlasMilliseconds << "x), " << atlas.pages.size()
+	      << " pages, the images cover " << TextureAtlasEfficiency(atlas) * 100.0 << "% of them" << std::endl;
+    DestroyTextureAtlas(atlas);
+  }
+
+  // The packers on their own, with a 4 pixel border and alignment
+  std::vector<glm::ivec2> sizes(kPackImageCount);
+  std::vector<int> arrival(kPackImageCount);
+  for (int i = 0; i < kPackImageCount; ++i)
+  {
+    sizes[i] = glm::ivec2(random.Next(8, 64), random.Next(8, 64));
+    arrival[i] = i;
+  }
+  std::vector<int> sorted = arrival;
+  std::sort(sorted.begin(), sorted.end(), [&](int a, int b) {
+    int longA = std::max(sizes[a].x, sizes[a].y);
+    int longB = std::max(sizes[b].x, sizes[b].y);
+    return longA != longB ? longA > longB : sizes[a].x * sizes[a].y > sizes[b].x * sizes[b].y;
+  });
+  std::cout << kPackImageCount << " images on pages of " << pageSize << "x" << pageSize << ":" << std::endl;
+  for (AtlasPackMethod method : methods)
+  {
+    double arrivalEfficiency = 0.0;
+    double sortedEfficiency = 0.0;
+    double arrivalMicroseconds = 0.0;
+    double sortedMicroseconds = 0.0;
+    int arrivalPages = PackAll(sizes, arrival, method, pageSize, arrivalEfficiency, arrivalMicroseconds);
+    int sortedPages = PackAll(sizes, sorted, method, pageSize, sortedEfficiency, sortedMicroseconds);
+    double occupancy = 0.0;
+    int failures = Churn(method, pageSize, occupancy);
+    std::cout << "  " << AtlasPackMethodName(method) << ": as they arrive " << arrivalEfficiency * 100.0 << "% on " << arrivalPages
+	      << " pages (" << arrivalMicroseconds << " us per insert), largest first " << sortedEfficiency * 100.0 << "% on "
+	      << sortedPages << " pages" << std::endl;
+    std::cout << "  " << AtlasPackMethodName(method) << " streaming: " << failures << " of " << kChurnRounds
+	      << " rounds found no room, " << occupancy * 100.0 << "% of the page in use on average" << std::endl;
+  }
+
+  DestroySpriteBatch(batch);
+  glDeleteBuffers(1, &viewBuffer);
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return 0;
+}
@@ -0,0 +1,154 @@
+#ifndef GLOOM_BENCH_COMMON_HPP
+#define GLOOM_BENCH_COMMON_HPP
+
+/*
+  Helpers shared by the benchmarks that render, e.g. bench/instancing_bench.cpp
+
+  Header only, so a benchmark still compiles with a single g++ line. Everything here needs a
+  current OpenGL context, e.g. one from CreateHeadlessContext (see gloom/headless.hpp).
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// GLoom
+#include <gloom/asset_io.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+/*
+  Compiles a vertex and a fragment shader and links them into a program
+
+  @param sources The vertex and the fragment shader source
+  @param lengths Lengths of both sources, nullptr if they are null terminated
+  @param name What the program is for, for the error message
+  @return the program, 0 on failure
+*/
+inline GLuint CreateBenchmarkProgram(const char* const sources[2], const GLint* lengths, const char* name)
+{
+  const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+
+  GLuint program = glCreateProgram();
+  for (int i = 0; i < 2; ++i)
+  {
+    GLuint shader = glCreateShader(types[i]);
+    glShaderSource(shader, 1, &sources[i], lengths != nullptr ? &lengths[i] : nullptr);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+  }
+  glLinkProgram(program);
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE)
+  {
+    std::cout << "Could not link the " << name << " program" << std::endl;
+    glDeleteProgram(program);
+    return 0;
+  }
+  return program;
+}
+
+/*
+  Loads a vertex and a fragment shader (e.g. from ./shaders) and links them into a program.
+  Both files are loaded before any OpenGL object is created, so nothing leaks if one is missing.
+
+  @param name What the program is for, for the error message
+  @return the program, 0 on failure
+*/
+inline GLuint LoadBenchmarkProgram(const char* vertexFilename, const char* fragmentFilename, const char* name)
+{
+  const char* filenames[2] = { vertexFilename, fragmentFilename };
+  AssetFile files[2];
+  const char* sources[2] = {};
+  GLint lengths[2] = {};
+  for (int i = 0; i < 2; ++i)
+  {
+    files[i] = LoadAsset(filenames[i]);
+    if (!files[i].IsOpen())
+    {
+      std::cout << "Could not load " << filenames[i] << " (run from the repository root)" << std::endl;
+      return 0;
+    }
+    sources[i] = files[i].View().data();
+    lengths[i] = (GLint)files[i].View().size();
+  }
+  return CreateBenchmarkProgram(sources, lengths, name);
+}
+
+/*
+  shaders/vert.glsl reads its transforms from uniform blocks (see gloom/uniform_buffer.hpp), and
+  shaders/frag.glsl multiplies with the texture on unit 0. Binds blocks holding identity matrices
+  and a white color, and a white texture, which leave our quads as they are.
+*/
+inline void BindDefaultShaderInputs(GLuint program)
+{
+  const GLfloat identity[16] = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+  // ViewBlock: viewProjection, view, cameraPositionTime
+  GLfloat view[36] = {};
+  std::memcpy(view, identity, sizeof(identity));
+  std::memcpy(view + 16, identity, sizeof(identity));
+  // DrawBlock: model, color
+  GLfloat draw[20] = { 0, 0, 0, 0,  0, 0, 0, 0,  0, 0, 0, 0,  0, 0, 0, 0,  1, 1, 1, 1 };
+  std::memcpy(draw, identity, sizeof(identity));
+
+  const char* blockNames[2] = { "ViewBlock", "DrawBlock" };
+  const GLfloat* blockData[2] = { view, draw };
+  const GLsizeiptr blockSizes[2] = { sizeof(view), sizeof(draw) };
+  for (GLuint binding = 0; binding < 2; ++binding)
+  {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, blockSizes[binding], blockData[binding], GL_STATIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+    glUniformBlockBinding(program, glGetUniformBlockIndex(program, blockNames[binding]), binding);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  const GLubyte white[4] = { 255, 255, 255, 255 };
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+}
+
+/*
+  Renders 'frames' frames, calling drawFrame(frame) after clearing, and returns the average
+  milliseconds per frame.
+
+  @param finishEveryFrame true to render frame 0 once to warm up (shader variants, buffer uploads, ...)
+                          and call glFinish after every frame, so the GPU time of each frame counts.
+                          false to wait only once at the end, like a real application where fences
+                          (or the driver) keep the CPU from running too far ahead.
+*/
+template <typename DrawFrame>
+double TimeFrames(int frames, bool finishEveryFrame, DrawFrame drawFrame)
+{
+  if (finishEveryFrame)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawFrame(0);
+  }
+  glFinish();
+
+  auto startTime = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawFrame(frame);
+    if (finishEveryFrame)
+    {
+      glFinish();
+    }
+  }
+  glFinish();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() / frames;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+  Frustum culling benchmark
+
+  Scatters objects of random size around a perspective camera and culls them against its
+  frustum (see gloom/culling.hpp), once one object at a time and once with the SIMD path.
+  Every other object is round, a ball with its own bounding sphere inside its box, and reports
+  how many objects only the sphere culled.
+  Reports nanoseconds per object for both and checks that they keep exactly the same objects.
+
+  Compilation on Linux (from the repository root), add -mavx (or -march=native) for the 8 wide AVX path
+  g++ -std=c++17 -O2 ./bench/culling_bench.cpp ./src/culling.cpp -o culling_bench -I ./include/ -I ./thirdparty/glm-master/
+
+  Usage
+  ./culling_bench [--objects N] [--frames N]
+*/
+
+// Third Party Libraries
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// GLoom
+#include <gloom/culling.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+  Culls every frame with a camera turning a little further each time, and returns
+  the median nanoseconds per object
+*/
+template <typename CullFunction>
+double MeasureCulling(const CullingSet& set, int frames, std::vector<uint32_t>& visible, CullFunction cull)
+{
+  glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+  std::vector<double> nanoseconds;
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    float angle = 6.2831853f * frame / frames;
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(std::sin(angle), 0.0f, std::cos(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+    FrustumPlanes frustum = ExtractFrustumPlanes(projection * view);
+
+    auto startTime = std::chrono::steady_clock::now();
+    cull(set, frustum, visible);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - startTime;
+    nanoseconds.push_back(elapsed.count() / set.Size());
+  }
+  std::sort(nanoseconds.begin(), nanoseconds.end());
+  return nanoseconds[nanoseconds.size() / 2];
+}
+
+int main(int argc, char* args[])
+{
+  int objectCount = 1000000;
+  int frames = 64;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--objects" && i + 1 < argc)
+    {
+      objectCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--objects N] [--frames N]" << std::endl;
+      return 1;
+    }
+  }
+  if (objectCount <= 0 || frames <= 0)
+  {
+    std::cout << "--objects and --frames must be positive" << std::endl;
+    return 1;
+  }
+
+  // Boxes from tiny to large, anywhere in a cube of 1000 units around the camera
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+  std::uniform_real_distribution<float> size(0.1f, 10.0f);
+  CullingSet set;
+  // The same boxes, with the sphere through their corners, to count what the balls' spheres cull
+  CullingSet boxes;
+  for (int i = 0; i < objectCount; ++i)
+  {
+    glm::vec3 center(position(random), position(random), position(random));
+    glm::vec3 halfExtents(size(random), size(random), size(random));
+    float radius = 0.0f;
+    if (i % 2 == 1)
+    {
+      radius = halfExtents.x;
+      halfExtents = glm::vec3(radius);
+    }
+    CullingSetAdd(set, center, halfExtents, radius);
+    CullingSetAdd(boxes, center, halfExtents);
+  }
+
+  std::vector<uint32_t> scalarVisible;
+  std::vector<uint32_t> simdVisible;
+  double scalar = MeasureCulling(set, frames, scalarVisible, CullObjectsScalar);
+  double simd = MeasureCulling(set, frames, simdVisible, CullObjects);
+  std::vector<uint32_t> boxVisible;
+  MeasureCulling(boxes, frames, boxVisible, CullObjects);
+
+  std::cout << objectCount << " objects, " << simdVisible.size() << " visible in the last frame" << std::endl;
+  std::cout << "Scalar: " << scalar << " ns per object" << std::endl;
+  std::cout << CullingInstructionSet() << ": " << simd << " ns per object (" << scalar / simd << "x)" << std::endl;
+  std::cout << boxVisible.size() - simdVisible.size() << " balls culled by their sphere, not their box" << std::endl;
+
+  // The same camera ends both runs, so both must have kept the same objects
+  if (scalarVisible != simdVisible)
+  {
+    std::cout << "The SIMD path culled different objects than the scalar path" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,178 @@
+/*
+  Instancing benchmark
+
+  Draws the same number of quads two ways and reports how many objects per second each manages:
+    - one glDrawElements per object, passing its transform and color as constant attributes
+    - one glDrawElementsInstanced for all objects, with the per instance data in a vertex buffer
+
+  Runs headless (see gloom/headless.hpp), with the shaders from ./shaders, into a small
+  framebuffer so the result is dominated by the cost of submitting draws rather than by filling pixels.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/instancing_bench.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/gl_state.cpp ./src/instancing.cpp ./src/asset_io.cpp ./src/glad.c -o instancing_bench -I ./include/ -lEGL -ldl -pthread
+
+  Usage
+  ./instancing_bench [--objects N] [--frames N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// GLoom
+#include <gloom/headless.hpp>
+#include <gloom/instancing.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Small on purpose, see above
+const int kFramebufferSize = 64;
+
+/*
+  Creates the quad from main.cpp (positions, colors and indices)
+
+  @return the vertex array
+*/
+GLuint CreateQuadVertexArray(GLuint vertexBuffer, GLuint indexBuffer)
+{
+  GLuint vertexArray = 0;
+  glGenVertexArrays(1, &vertexArray);
+  glBindVertexArray(vertexArray);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 6, (void*)0);
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 6, (GLvoid*)(sizeof(GLfloat) * 3));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+  glBindVertexArray(0);
+  return vertexArray;
+}
+
+int main(int argc, char* args[])
+{
+  int objectCount = 10000;
+  int frames = 20;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--objects" && i + 1 < argc)
+    {
+      objectCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--objects N] [--frames N]" << std::endl;
+      return 1;
+    }
+  }
+  if (objectCount <= 0 || frames <= 0)
+  {
+    std::cout << "--objects and --frames must be positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  GLuint program = LoadBenchmarkProgram("./shaders/vert.glsl", "./shaders/frag.glsl", "benchmark");
+  if (program == 0)
+  {
+    return 1;
+  }
+  BindDefaultShaderInputs(program);
+
+  // Same quad as VertexSpecification in main.cpp
+  const GLfloat vertexData[] = {
+    -0.5f, -0.5f, 0.0f,  1.0f, 0.0f, 0.0f,
+     0.5f, -0.5f, 0.0f,  0.0f, 1.0f, 0.0f,
+    -0.5f,  0.5f, 0.0f,  0.0f, 0.0f, 1.0f,
+     0.5f,  0.5f, 0.0f,  0.0f, 1.0f, 0.0f,
+  };
+  const GLuint indexData[] = { 2, 0, 1, 3, 2, 1 };
+
+  GLuint buffers[2] = {};
+  glGenBuffers(2, buffers);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indexData), indexData, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  // Without the instance buffer, the instance attributes take their constant values
+  GLuint perObjectVertexArray = CreateQuadVertexArray(buffers[0], buffers[1]);
+  GLuint instancedVertexArray = CreateQuadVertexArray(buffers[0], buffers[1]);
+
+  // Small quads scattered over the framebuffer
+  std::vector<InstanceData> instances(objectCount);
+  for (int i = 0; i < objectCount; ++i)
+  {
+    InstanceData& instance = instances[i];
+    instance.translation[0] = -0.9f + 1.8f * ((i * 7919) % 1000) / 1000.0f;
+    instance.translation[1] = -0.9f + 1.8f * ((i * 104729) % 1000) / 1000.0f;
+    instance.translation[2] = 0.0f;
+    instance.scale = 0.05f;
+    instance.color[0] = (GLubyte)(i * 37);
+    instance.color[1] = (GLubyte)(i * 59);
+    instance.color[2] = (GLubyte)(i * 83);
+    instance.color[3] = 255;
+  }
+
+  InstanceBuffer instanceBuffer;
+  CreateInstanceBuffer(instanceBuffer, instancedVertexArray, objectCount);
+  UpdateInstanceBuffer(instanceBuffer, instances.data(), objectCount);
+
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+  glUseProgram(program);
+
+  double perObjectMilliseconds = TimeFrames(frames, true, [&](int)
+  {
+    glBindVertexArray(perObjectVertexArray);
+    for (const InstanceData& instance : instances)
+    {
+      SetConstantInstanceAttributes(instance);
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+  });
+
+  double instancedMilliseconds = TimeFrames(frames, true, [&](int)
+  {
+    glBindVertexArray(instancedVertexArray);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, instanceBuffer.count);
+  });
+
+  std::cout << objectCount << " objects, " << frames << " frames" << std::endl;
+  std::cout << "One draw call per object: " << perObjectMilliseconds << " ms per frame, "
+	    << objectCount / (perObjectMilliseconds / 1000.0) << " objects per second" << std::endl;
+  std::cout << "Instanced:                " << instancedMilliseconds << " ms per frame, "
+	    << objectCount / (instancedMilliseconds / 1000.0) << " objects per second" << std::endl;
+  std::cout << "Speedup: " << perObjectMilliseconds / instancedMilliseconds << "x" << std::endl;
+
+  DestroyInstanceBuffer(instanceBuffer);
+  glDeleteVertexArrays(1, &perObjectVertexArray);
+  glDeleteVertexArrays(1, &instancedVertexArray);
+  glDeleteBuffers(2, buffers);
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return 0;
+}
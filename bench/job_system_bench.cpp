@@ -0,0 +1,167 @@
+/*
+  Job system benchmark
+
+  Measures what a job costs (see gloom/job_system.hpp) and how well work scales over threads:
+  - Spawn: the main thread queues and runs empty jobs on its own, the pure bookkeeping cost per job
+  - Steal: empty jobs queued by the main thread while every worker tries to steal them
+  - Scaling: ParallelFor over a fixed amount of arithmetic, from 1 thread up to one per core
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/job_system_bench.cpp ./src/job_system.cpp -o job_system_bench -I ./include/ -pthread
+
+  Usage
+  ./job_system_bench [--threads N] [--items N]
+*/
+
+// GLoom
+#include <gloom/job_system.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Empty jobs per measurement, queued in groups that fit in a deque
+const size_t kEmptyJobs = 1 << 20;
+const size_t kJobGroupSize = 1024;
+// Repetitions of each scaling measurement, the fastest counts
+const int kScalingRepetitions = 5;
+
+static void EmptyJob(const Job&)
+{
+}
+
+/*
+  Queues and waits for kEmptyJobs empty jobs
+  @return nanoseconds per job
+*/
+double MeasureEmptyJobs()
+{
+  std::vector<Job> jobs(kJobGroupSize);
+  for (Job& job : jobs)
+  {
+    job.function = EmptyJob;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+  for (size_t group = 0; group < kEmptyJobs / kJobGroupSize; ++group)
+  {
+    JobCounter counter;
+    JobRun(jobs.data(), jobs.size(), counter);
+    JobWait(counter);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - startTime;
+  return elapsed.count() / kEmptyJobs;
+}
+
+/*
+  Some arithmetic per item, enough that memory bandwidth does not limit the scaling
+  @return the fastest of kScalingRepetitions runs in milliseconds
+*/
+double MeasureParallelFor(std::vector<float>& items)
+{
+  double best = 0.0;
+  for (int repetition = 0; repetition < kScalingRepetitions; ++repetition)
+  {
+    auto startTime = std::chrono::steady_clock::now();
+    ParallelFor(items.size(), 256, [&items](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+      {
+	float x = items[i];
+	for (int step = 0; step < 8; ++step)
+	{
+	  x = std::sin(x) * 0.5f + std::cos(x * 0.25f);
+	}
+	items[i] = x;
+      }
+    });
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    if (repetition == 0 || milliseconds < best)
+    {
+      best = milliseconds;
+    }
+  }
+  return best;
+}
+
+int main(int argc, char* args[])
+{
+  int maxThreads = (int)std::thread::hardware_concurrency();
+  size_t itemCount = 1 << 20;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--threads" && i + 1 < argc)
+    {
+      maxThreads = std::atoi(args[++i]);
+    }
+    else if (option == "--items" && i + 1 < argc)
+    {
+      itemCount = (size_t)std::atoll(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--threads N] [--items N]" << std::endl;
+      return 1;
+    }
+  }
+  if (maxThreads <= 0 || itemCount == 0)
+  {
+    std::cout << "--threads and --items must be positive" << std::endl;
+    return 1;
+  }
+
+  // Spawn: no workers, so every job is pushed and popped by the main thread itself
+  JobSystemStart(0);
+  std::cout << "Spawn (1 thread): " << MeasureEmptyJobs() << " ns per job" << std::endl;
+  JobSystemStop();
+
+  // Steal: the workers compete with the main thread for every job
+  if (maxThreads > 1)
+  {
+    JobSystemStart(maxThreads - 1);
+    double nanoseconds = MeasureEmptyJobs();
+    JobSystemStatistics statistics = GetJobSystemStatistics();
+    JobSystemStop();
+    std::cout << "Steal (" << maxThreads << " threads): " << nanoseconds << " ns per job, "
+	      << 100.0 * statistics.steals / statistics.jobs << "% of the jobs stolen" << std::endl;
+  }
+
+  // Scaling
+  std::cout << "ParallelFor over " << itemCount << " items:" << std::endl;
+  std::vector<float> items(itemCount);
+  // 1, 2, 4, ... threads, and always the maximum
+  std::vector<int> threadCounts;
+  for (int threads = 1; threads < maxThreads; threads *= 2)
+  {
+    threadCounts.push_back(threads);
+  }
+  threadCounts.push_back(maxThreads);
+
+  double singleThreaded = 0.0;
+  for (int threads : threadCounts)
+  {
+    for (size_t i = 0; i < itemCount; ++i)
+    {
+      items[i] = (float)i / itemCount;
+    }
+
+    JobSystemStart(threads - 1);
+    double milliseconds = MeasureParallelFor(items);
+    JobSystemStatistics statistics = GetJobSystemStatistics();
+    JobSystemStop();
+
+    if (threads == 1)
+    {
+      singleThreaded = milliseconds;
+    }
+    std::cout << "  " << threads << " threads: " << milliseconds << " ms, speedup " << singleThreaded / milliseconds
+	      << "x, efficiency " << 100.0 * singleThreaded / milliseconds / threads << "%, "
+	      << statistics.steals << " steals" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*
+  Mesh loading benchmark
+
+  Writes a grid mesh of the requested size as a Wavefront OBJ file and as a binary mesh file,
+  then measures how long it takes to get each onto the GPU:
+    - OBJ: read the text, parse it, then upload the parsed vertices and indices
+    - binary: LoadMesh, which maps the file and uploads the streams directly
+  Both files are loaded a few times first, so we compare warm page caches rather than disks.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/mesh_load_bench.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/mesh.cpp ./src/mesh_obj.cpp ./src/asset_io.cpp ./src/glad.c -o mesh_load_bench -I ./include/ -lEGL -ldl -pthread
+
+  Usage
+  ./mesh_load_bench [--grid N] [--repeats N] [--directory D]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// GLoom
+#include <gloom/asset_io.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/mesh.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+  Writes a grid of (gridSize + 1)^2 colored vertices and 2 * gridSize^2 triangles as OBJ
+
+  @return true if the file was written
+*/
+bool WriteGridObj(const std::string& filename, int gridSize)
+{
+  std::ofstream file(filename, std::ios::trunc);
+  if (!file.is_open())
+  {
+    return false;
+  }
+
+  char line[128];
+  for (int y = 0; y <= gridSize; ++y)
+  {
+    for (int x = 0; x <= gridSize; ++x)
+    {
+      float u = (float)x / gridSize;
+      float v = (float)y / gridSize;
+      int length = std::snprintf(line, sizeof(line), "v %.6f %.6f 0.0 %.4f %.4f 0.5\n", u * 2.0f - 1.0f, v * 2.0f - 1.0f, u, v);
+      file.write(line, length);
+    }
+  }
+  for (int y = 0; y < gridSize; ++y)
+  {
+    for (int x = 0; x < gridSize; ++x)
+    {
+      // OBJ indices start at 1
+      int corner = y * (gridSize + 1) + x + 1;
+      int length = std::snprintf(line, sizeof(line), "f %d %d %d %d\n", corner, corner + 1,
+				 corner + gridSize + 2, corner + gridSize + 1);
+      file.write(line, length);
+    }
+  }
+  return file.good();
+}
+
+/*
+  What a program without a binary format has to do: parse the text, then upload
+
+  @return true if the mesh was loaded
+*/
+bool LoadObjMesh(const std::string& filename, Mesh& mesh)
+{
+  AssetFile file = LoadAsset(filename);
+  MeshData data;
+  if (!file.IsOpen() || !ParseObjMesh(file.View(), data))
+  {
+    return false;
+  }
+
+  glGenVertexArrays(1, &mesh.vertexArray);
+  glBindVertexArray(mesh.vertexArray);
+  glGenBuffers(1, &mesh.vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, data.vertices.size(), data.vertices.data(), GL_STATIC_DRAW);
+  glGenBuffers(1, &mesh.indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(uint32_t), data.indices.data(), GL_STATIC_DRAW);
+  for (const MeshAttribute& attribute : data.attributes)
+  {
+    glEnableVertexAttribArray(attribute.location);
+    glVertexAttribPointer(attribute.location, (GLint)attribute.components, (GLenum)attribute.type,
+			  attribute.normalized ? GL_TRUE : GL_FALSE, (GLsizei)data.vertexStride,
+			  (GLvoid*)(uintptr_t)attribute.offset);
+  }
+  glBindVertexArray(0);
+  mesh.vertexCount = (GLsizei)data.VertexCount();
+  mesh.indexCount = (GLsizei)data.indices.size();
+  mesh.indexType = GL_UNSIGNED_INT;
+  return true;
+}
+
+/*
+  Loads a mesh 'repeats' times (after warming up) and returns the median milliseconds per load.
+  glFinish is included, so the upload has really happened.
+*/
+template <typename Load>
+double TimeLoads(int repeats, Load load)
+{
+  std::vector<double> milliseconds;
+  for (int i = -2; i < repeats; ++i)
+  {
+    Mesh mesh;
+    auto startTime = std::chrono::steady_clock::now();
+    if (!load(mesh))
+    {
+      return -1.0;
+    }
+    glFinish();
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    DestroyMesh(mesh);
+    // The first two loads only warm up the page cache and the driver
+    if (i >= 0)
+    {
+      milliseconds.push_back(elapsed);
+    }
+  }
+  std::sort(milliseconds.begin(), milliseconds.end());
+  return milliseconds[milliseconds.size() / 2];
+}
+
+// Size of a file in MiB, for the report
+double FileMegabytes(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  return file.is_open() ? (double)file.tellg() / (1024.0 * 1024.0) : 0.0;
+}
+
+int main(int argc, char* args[])
+{
+  int gridSize = 500;
+  int repeats = 10;
+  std::string directory = "/tmp";
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--grid" && i + 1 < argc)
+    {
+      gridSize = std::atoi(args[++i]);
+    }
+    else if (option == "--repeats" && i + 1 < argc)
+    {
+      repeats = std::atoi(args[++i]);
+    }
+    else if (option == "--directory" && i + 1 < argc)
+    {
+      directory = args[++i];
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--grid N] [--repeats N] [--directory D]" << std::endl;
+      return 1;
+    }
+  }
+  if (gridSize <= 0 || repeats <= 0)
+  {
+    std::cout << "--grid and --repeats must be positive" << std::endl;
+    return 1;
+  }
+
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+
+  // Produce both files the way the converter would
+  std::string objFilename = directory + "/gloom_bench_grid.obj";
+  std::string meshFilename = directory + "/gloom_bench_grid.mesh";
+  AssetFile objFile;
+  MeshData data;
+  if (!WriteGridObj(objFilename, gridSize) || !(objFile = LoadAsset(objFilename)).IsOpen() ||
+      !ParseObjMesh(objFile.View(), data) || !WriteMeshFile(meshFilename, data))
+  {
+    std::cout << "Could not write the benchmark meshes to " << directory << std::endl;
+    return 1;
+  }
+  objFile = AssetFile();
+
+  std::cout << data.VertexCount() << " vertices, " << data.indices.size() / 3 << " triangles" << std::endl;
+  std::cout << "OBJ " << FileMegabytes(objFilename) << " MiB, binary " << FileMegabytes(meshFilename) << " MiB" << std::endl;
+
+  double objMilliseconds = TimeLoads(repeats, [&](Mesh& mesh) { return LoadObjMesh(objFilename, mesh); });
+  double binaryMilliseconds = TimeLoads(repeats, [&](Mesh& mesh) { return LoadMesh(meshFilename, mesh); });
+
+  std::cout << "OBJ (parse + upload):     " << objMilliseconds << " ms" << std::endl;
+  std::cout << "Binary (mmap + upload):   " << binaryMilliseconds << " ms" << std::endl;
+  std::cout << "Speedup: " << objMilliseconds / binaryMilliseconds << "x" << std::endl;
+  AssetIOPrintStatistics();
+
+  std::remove(objFilename.c_str());
+  std::remove(meshFilename.c_str());
+  DestroyHeadlessContext();
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*
+  Mesh optimization benchmark
+
+  Builds a sphere whose triangles are in random order (the worst case, and not far from what
+  some exporters produce), then optimizes it step by step (see gloom/mesh_optimizer.hpp).
+  After every step it reports the ACMR/ATVR of a simulated vertex cache and the GPU time
+  of drawing the mesh with the depth test on, measured with GL_TIME_ELAPSED timer queries.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/mesh_optimize_bench.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/mesh_optimizer.cpp ./src/glad.c -o mesh_optimize_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./mesh_optimize_bench [--segments N] [--draws N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// GLoom
+#include <gloom/headless.hpp>
+#include <gloom/mesh_optimizer.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+const int kFramebufferSize = 512;
+// Each measurement is the median of this many timer queries
+const int kMeasurements = 9;
+
+const char* kVertexShaderSource = R"(#version 410 core
+layout(location=0) in vec3 position;
+out vec3 v_normal;
+void main()
+{
+  v_normal = normalize(position);
+  gl_Position = vec4(position.xy, position.z * 0.5, 1.0);
+}
+)";
+
+// Deliberately expensive per pixel, so that overdraw shows up in the timings
+const char* kFragmentShaderSource = R"(#version 410 core
+in vec3 v_normal;
+out vec4 color;
+void main()
+{
+  vec3 n = normalize(v_normal);
+  float light = 0.0;
+  for (int i = 0; i < 32; ++i)
+  {
+    light += pow(max(dot(n, normalize(vec3(sin(i), cos(i), 1.0))), 0.0), 8.0);
+  }
+  color = vec4(vec3(light / 32.0), 1.0);
+}
+)";
+
+/*
+  A UV sphere of radius 0.9 with float positions, its triangles shuffled
+*/
+MeshData CreateShuffledSphere(int segments)
+{
+  MeshData mesh;
+  mesh.attributes.push_back({ 0, 3, GL_FLOAT, 0, 0 });
+  mesh.vertexStride = 3 * sizeof(float);
+
+  int rings = segments / 2;
+  for (int ring = 0; ring <= rings; ++ring)
+  {
+    float theta = 3.14159265f * ring / rings;
+    for (int segment = 0; segment <= segments; ++segment)
+    {
+      float phi = 2.0f * 3.14159265f * segment / segments;
+      float position[3] = { 0.9f * std::sin(theta) * std::cos(phi), 0.9f * std::cos(theta),
+			    0.9f * std::sin(theta) * std::sin(phi) };
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(position);
+      mesh.vertices.insert(mesh.vertices.end(), bytes, bytes + sizeof(position));
+    }
+  }
+
+  std::vector<std::array<uint32_t, 3>> triangles;
+  for (int ring = 0; ring < rings; ++ring)
+  {
+    for (int segment = 0; segment < segments; ++segment)
+    {
+      uint32_t corner = ring * (segments + 1) + segment;
+      uint32_t below = corner + segments + 1;
+      triangles.push_back({ corner, below, corner + 1 });
+      triangles.push_back({ corner + 1, below, below + 1 });
+    }
+  }
+  std::mt19937 random(42);
+  std::shuffle(triangles.begin(), triangles.end(), random);
+  for (const std::array<uint32_t, 3>& triangle : triangles)
+  {
+    mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+  }
+  return mesh;
+}
+
+/*
+  Uploads the mesh, draws it 'draws' times per query and returns the median GPU milliseconds per draw
+*/
+double MeasureGPUTime(const MeshData& mesh, int draws)
+{
+  GLuint vertexArray = 0;
+  GLuint buffers[2] = {};
+  glGenVertexArrays(1, &vertexArray);
+  glBindVertexArray(vertexArray);
+  glGenBuffers(2, buffers);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size(), mesh.vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, mesh.vertexStride, (GLvoid*)0);
+
+  GLuint query = 0;
+  glGenQueries(1, &query);
+  std::vector<double> milliseconds;
+  for (int measurement = -1; measurement < kMeasurements; ++measurement)
+  {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    for (int draw = 0; draw < draws; ++draw)
+    {
+      // Clearing depth in between makes every draw pay for its own overdraw
+      glClear(GL_DEPTH_BUFFER_BIT);
+      glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    // The first round only warms up
+    if (measurement >= 0)
+    {
+      milliseconds.push_back(nanoseconds / 1e6 / draws);
+    }
+  }
+
+  glDeleteQueries(1, &query);
+  glBindVertexArray(0);
+  glDeleteVertexArrays(1, &vertexArray);
+  glDeleteBuffers(2, buffers);
+
+  std::sort(milliseconds.begin(), milliseconds.end());
+  return milliseconds[milliseconds.size() / 2];
+}
+
+void Report(const char* label, const MeshData& mesh, int draws)
+{
+  VertexCacheStatistics statistics = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+  std::cout << label << ": ACMR " << statistics.acmr << ", ATVR " << statistics.atvr << ", GPU "
+	    << MeasureGPUTime(mesh, draws) << " ms per draw" << std::endl;
+}
+
+int main(int argc, char* args[])
+{
+  int segments = 256;
+  int draws = 4;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--segments" && i + 1 < argc)
+    {
+      segments = std::atoi(args[++i]);
+    }
+    else if (option == "--draws" && i + 1 < argc)
+    {
+      draws = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--segments N] [--draws N]" << std::endl;
+      return 1;
+    }
+  }
+  if (segments < 4 || draws <= 0)
+  {
+    std::cout << "--segments must be at least 4 and --draws positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  const char* sources[2] = { kVertexShaderSource, kFragmentShaderSource };
+  GLuint program = CreateBenchmarkProgram(sources, nullptr, "benchmark");
+  if (program == 0)
+  {
+    return 1;
+  }
+  glUseProgram(program);
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+  glEnable(GL_DEPTH_TEST);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+
+  MeshData mesh = CreateShuffledSphere(segments);
+  std::cout << mesh.VertexCount() << " vertices, " << mesh.indices.size() / 3 << " triangles" << std::endl;
+
+  Report("Original (shuffled)", mesh, draws);
+  OptimizeVertexCache(mesh.indices, mesh.VertexCount());
+  Report("+ vertex cache     ", mesh, draws);
+  OptimizeOverdraw(mesh);
+  Report("+ overdraw         ", mesh, draws);
+  OptimizeVertexFetch(mesh);
+  Report("+ vertex fetch     ", mesh, draws);
+
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return 0;
+}
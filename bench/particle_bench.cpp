@@ -0,0 +1,252 @@
+/*
+  Particle simulation benchmark
+
+  Runs a fountain of --particles particles (see gloom/particle_system.hpp) until it is full and
+  as many particles die as are spawned every update, then times --frames updates of it:
+    - a plain loop over an array of particle structs, erasing the dead ones with std::remove_if,
+      as a baseline
+    - the particle system on one thread (structure of arrays, SIMD integration)
+    - the particle system on the job system with 1, 2, ... --threads threads
+  and reports particles per millisecond, per core, and the speedup over one thread. Every run
+  has to end with exactly the same particles, whatever the number of threads.
+  No OpenGL is needed, the instances are written into the system's staging memory only.
+
+  Compilation on Linux (from the repository root), add -mavx (or -march=native) for the 8 wide AVX path
+  g++ -std=c++17 -O2 ./bench/particle_bench.cpp ./src/particle_system.cpp ./src/job_system.cpp ./src/stream_buffer.cpp ./src/render_commands.cpp ./src/render_thread.cpp ./src/gl_state.cpp ./src/gldebug.cpp ./src/glad.c -o particle_bench -I ./include/ -I ./thirdparty/glm-master/ -ldl -pthread
+
+  Usage
+  ./particle_bench [--particles N] [--frames N] [--threads N]
+*/
+
+// Third Party Libraries
+#include <glm/glm.hpp>
+
+// GLoom
+#include <gloom/job_system.hpp>
+#include <gloom/particle_system.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const float kTimeStep = 1.0f / 60.0f;
+// Updates before the timing starts, enough for the first particles to die (lifetimes are 1 to 2 seconds)
+const int kWarmUpFrames = 150;
+
+ParticleEmitter MakeFountain(size_t particles)
+{
+  ParticleEmitter fountain;
+  fountain.position = glm::vec3(0.0f, -0.9f, 0.0f);
+  fountain.velocity = glm::vec3(0.0f, 1.6f, 0.0f);
+  fountain.spread = glm::vec3(0.4f, 0.3f, 0.2f);
+  fountain.lifetime = 1.0f;
+  fountain.lifetimeSpread = 1.0f;
+  // As many particles as fit, on average
+  fountain.rate = particles / (fountain.lifetime + fountain.lifetimeSpread * 0.5f);
+  return fountain;
+}
+
+struct Result
+{
+  double milliseconds = 0.0;
+  size_t simulated = 0;
+  size_t alive = 0;
+  // Sum of all positions, to compare runs
+  double checksum = 0.0;
+};
+
+/*
+  The baseline: one struct per particle, updated one at a time
+*/
+struct Particle
+{
+  glm::vec3 position;
+  glm::vec3 velocity;
+  glm::vec4 color;
+  float life;
+  float inverseLifetime;
+  float size;
+};
+
+Result RunBaseline(size_t maxParticles, int frames)
+{
+  ParticleEmitter fountain = MakeFountain(maxParticles);
+  std::vector<Particle> particles;
+  std::vector<InstanceData> instances(maxParticles);
+  particles.reserve(maxParticles);
+  uint32_t random = 12345;
+  auto randomSigned = [&random]() {
+    random = random * 1664525u + 1013904223u;
+    return (float)(random >> 8) / (float)(1 << 23) - 1.0f;
+  };
+  glm::vec3 gravity(0.0f, -1.5f, 0.0f);
+
+  Result result;
+  for (int frame = -kWarmUpFrames; frame < frames; ++frame)
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t simulated = particles.size();
+    for (Particle& particle : particles)
+    {
+      particle.velocity += gravity * kTimeStep;
+      particle.position += particle.velocity * kTimeStep;
+      particle.life -= kTimeStep;
+    }
+    auto dead = [](const Particle& particle) { return particle.life <= 0.0f; };
+    particles.erase(std::remove_if(particles.begin(), particles.end(), dead), particles.end());
+
+    fountain.accumulator += fountain.rate * kTimeStep;
+    size_t spawn = std::min((size_t)fountain.accumulator, maxParticles - particles.size());
+    fountain.accumulator -= (float)(size_t)fountain.accumulator;
+    for (size_t i = 0; i < spawn; ++i)
+    {
+      Particle particle;
+      float lifetime = fountain.lifetime + fountain.lifetimeSpread * (randomSigned() * 0.5f + 0.5f);
+      particle.position = fountain.position;
+      glm::vec3 direction(randomSigned(), randomSigned(), randomSigned());
+      particle.velocity = fountain.velocity + fountain.spread * direction;
+      glm::vec4 variation(randomSigned(), randomSigned(), randomSigned(), 0.0f);
+      particle.color = glm::clamp(fountain.color + fountain.colorSpread * variation, 0.0f, 1.0f);
+      particle.life = lifetime;
+      particle.inverseLifetime = 1.0f / lifetime;
+      particle.size = fountain.size;
+      particles.push_back(particle);
+    }
+
+    for (size_t i = 0; i < particles.size(); ++i)
+    {
+      const Particle& particle = particles[i];
+      InstanceData& instance = instances[i];
+      instance.translation[0] = particle.position.x;
+      instance.translation[1] = particle.position.y;
+      instance.translation[2] = particle.position.z;
+      instance.scale = particle.size * particle.life * particle.inverseLifetime;
+      for (int channel = 0; channel < 4; ++channel)
+      {
+        instance.color[channel] = (GLubyte)(particle.color[channel] * 255.0f + 0.5f);
+      }
+    }
+
+    if (frame >= 0)
+    {
+      auto end = std::chrono::steady_clock::now();
+      result.milliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+      result.simulated += simulated;
+    }
+  }
+  result.alive = particles.size();
+  return result;
+}
+
+/*
+  The particle system, with workerCount job system workers besides this thread (none for one thread)
+*/
+Result RunParticleSystem(size_t maxParticles, int frames, int workerCount)
+{
+  if (workerCount > 0)
+  {
+    JobSystemStart(workerCount);
+  }
+  ParticleSystem system;
+  CreateParticleSystem(system, maxParticles, false);
+  system.gravity = glm::vec3(0.0f, -1.5f, 0.0f);
+  ParticleSystemAddEmitter(system, MakeFountain(maxParticles));
+
+  for (int frame = 0; frame < kWarmUpFrames; ++frame)
+  {
+    ParticleSystemUpdate(system, kTimeStep);
+  }
+  system.statistics = ParticleStatistics();
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    ParticleSystemUpdate(system, kTimeStep);
+  }
+
+  Result result;
+  result.milliseconds = system.statistics.simulateMilliseconds;
+  result.simulated = system.statistics.simulated;
+  result.alive = system.count;
+  const std::vector<InstanceData>& instances = system.staging[system.region];
+  for (size_t i = 0; i < system.count; ++i)
+  {
+    result.checksum += (double)instances[i].translation[0] + instances[i].translation[1] + instances[i].translation[2];
+  }
+  DestroyParticleSystem(system);
+  if (workerCount > 0)
+  {
+    JobSystemStop();
+  }
+  return result;
+}
+
+void Print(const std::string& name, const Result& result, int threads)
+{
+  double perMillisecond = result.simulated / result.milliseconds;
+  std::cout << name << ": " << result.milliseconds / (double)result.simulated * 1e6 << " ns per particle, "
+	    << perMillisecond << " particles per ms (" << perMillisecond / threads << " per core), " << result.alive
+	    << " alive" << std::endl;
+}
+
+int main(int argc, char* args[])
+{
+  int particleCount = 1000000;
+  int frames = 100;
+  int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--particles" && i + 1 < argc)
+    {
+      particleCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else if (option == "--threads" && i + 1 < argc)
+    {
+      threads = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--particles N] [--frames N] [--threads N]" << std::endl;
+      return 1;
+    }
+  }
+  if (particleCount <= 0 || frames <= 0 || threads <= 0)
+  {
+    std::cout << "--particles, --frames and --threads must be positive" << std::endl;
+    return 1;
+  }
+
+  // The particle system's capacity is a whole number of chunks, the baseline gets the same
+  size_t maxParticles = ((size_t)particleCount + kParticleChunkSize - 1) / kParticleChunkSize * kParticleChunkSize;
+  std::cout << maxParticles << " particles, " << frames << " updates, " << ParticleInstructionSet() << ", "
+	    << std::thread::hardware_concurrency() << " cores" << std::endl;
+  Print("Array of structs (1 thread)", RunBaseline(maxParticles, frames), 1);
+
+  Result single;
+  for (int threadCount = 1; threadCount <= threads; ++threadCount)
+  {
+    Result result = RunParticleSystem(maxParticles, frames, threadCount - 1);
+    Print("Particle system (" + std::to_string(threadCount) + (threadCount == 1 ? " thread)" : " threads)"), result,
+	  threadCount);
+    if (threadCount == 1)
+    {
+      single = result;
+      continue;
+    }
+    std::cout << "  " << single.milliseconds / result.milliseconds << "x the speed of 1 thread" << std::endl;
+    if (result.alive != single.alive || result.checksum != single.checksum)
+    {
+      std::cout << "  Mismatch: " << result.alive << " particles alive instead of " << single.alive << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
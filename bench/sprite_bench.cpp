@@ -0,0 +1,244 @@
+/*
+  Sprite batch benchmark
+
+  Moves and draws a large number of small rotated sprites every frame with a sprite batch
+  (see gloom/sprite_batch.hpp) and reports, per frame, the CPU time to record the sprites
+  (SpriteBatchSubmit), to upload them and issue the draws (SpriteBatchEnd), and the time until
+  the GPU finished, with the sprites per second that adds up to.
+  For comparison it then draws the first --naive sprites of the last frame with one draw call
+  each, the way our single quad is drawn, and checks that both draw the same image.
+  A software rasterizer spends most of the frame setting up the tiny triangles, --size 0 makes
+  them degenerate (dropped before rasterization) to see the cost of the batching itself.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/sprite_bench.cpp ./src/sprite_batch.cpp ./src/uniform_buffer.cpp ./src/stream_buffer.cpp ./src/render_commands.cpp ./src/render_thread.cpp ./src/gl_state.cpp ./src/asset_io.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/glad.c -o sprite_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./sprite_bench [--sprites N] [--frames N] [--textures N] [--naive N] [--size PIXELS]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// GLoom
+#include <gloom/gl_state.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/sprite_batch.hpp>
+#include <gloom/stream_buffer.hpp>
+#include <gloom/uniform_buffer.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Small on purpose, we want to measure batching rather than filling pixels
+const int kFramebufferSize = 256;
+
+// Milliseconds since 'start'
+double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The framebuffer's pixels, to compare what both ways drew
+std::vector<unsigned char> ReadFramebuffer()
+{
+  std::vector<unsigned char> pixels(kFramebufferSize * kFramebufferSize * 4);
+  glReadPixels(0, 0, kFramebufferSize, kFramebufferSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  return pixels;
+}
+
+int main(int argc, char* args[])
+{
+  int spriteCount = 1000000;
+  int frames = 20;
+  int textureCount = 1;
+  int naiveCount = 10000;
+  // Every sprite covers a pixel or two
+  float spriteSize = 1.5f;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--sprites" && i + 1 < argc)
+    {
+      spriteCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else if (option == "--textures" && i + 1 < argc)
+    {
+      textureCount = std::atoi(args[++i]);
+    }
+    else if (option == "--naive" && i + 1 < argc)
+    {
+      naiveCount = std::atoi(args[++i]);
+    }
+    else if (option == "--size" && i + 1 < argc)
+    {
+      spriteSize = (float)std::atof(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--sprites N] [--frames N] [--textures N] [--naive N] [--size PIXELS]" << std::endl;
+      return 1;
+    }
+  }
+  if (spriteCount <= 0 || frames <= 0 || textureCount <= 0 || naiveCount < 0)
+  {
+    std::cout << "--sprites, --frames and --textures must be positive" << std::endl;
+    return 1;
+  }
+  naiveCount = std::min(naiveCount, spriteCount);
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  GLuint program = LoadBenchmarkProgram("./shaders/sprite_vert.glsl", "./shaders/sprite_frag.glsl", "sprite");
+  SpriteBatch batch;
+  if (program == 0 || !CreateSpriteBatch(batch, (size_t)spriteCount))
+  {
+    std::cout << "Could not create the sprite program or batch" << std::endl;
+    return 1;
+  }
+  BindUniformBlocks(program);
+
+  // Positions in pixels, through an orthographic ViewBlock
+  ViewUniforms view;
+  view.viewProjection[0][0] = 2.0f / kFramebufferSize;
+  view.viewProjection[1][1] = 2.0f / kFramebufferSize;
+  view.viewProjection[3] = glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+  GLuint viewBuffer = 0;
+  glGenBuffers(1, &viewBuffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, viewBuffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewUniforms), &view, GL_STATIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, kViewUniformBinding, viewBuffer);
+
+  // 2x2 textures in different shades, sprites use them in runs so every texture is one batch
+  std::vector<GLuint> textures(textureCount);
+  glGenTextures(textureCount, textures.data());
+  for (int i = 0; i < textureCount; ++i)
+  {
+    GLubyte shade = (GLubyte)(255 - (i * 97) % 128);
+    const GLubyte pixels[16] = { shade, 255, 255, 255, 255, shade, 255, 255, 255, 255, shade, 255, shade, shade, 255, 255 };
+    glBindTexture(GL_TEXTURE_2D, textures[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // Every sprite drifts in its own direction and turns, wrapping around the edges
+  std::vector<glm::vec4> sprites(spriteCount);
+  for (int i = 0; i < spriteCount; ++i)
+  {
+    sprites[i] = glm::vec4(((i * 7919) % 10007) * kFramebufferSize / 10007.0f, ((i * 104729) % 10009) * kFramebufferSize / 10009.0f,
+			   ((i * 31) % 17 - 8) * 0.05f, ((i * 17) % 13 - 6) * 0.05f);
+  }
+  auto recordFrame = [&](int frame)
+  {
+    SpriteBatchBegin(batch);
+    size_t spritesPerTexture = (spriteCount + textureCount - 1) / textureCount;
+    for (int i = 0; i < spriteCount; ++i)
+    {
+      glm::vec4& sprite = sprites[i];
+      sprite.x = sprite.x + sprite.z < 0.0f ? sprite.x + sprite.z + kFramebufferSize : std::fmod(sprite.x + sprite.z, (float)kFramebufferSize);
+      sprite.y = sprite.y + sprite.w < 0.0f ? sprite.y + sprite.w + kFramebufferSize : std::fmod(sprite.y + sprite.w, (float)kFramebufferSize);
+      glm::vec4 color(((i * 37) % 256) / 255.0f, ((i * 59) % 256) / 255.0f, ((i * 83) % 256) / 255.0f, 1.0f);
+      SpriteBatchSubmit(batch, textures[i / spritesPerTexture], glm::vec4(sprite.x, sprite.y, spriteSize, spriteSize), color,
+			frame * 0.05f + i, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), SpriteBlend::Opaque);
+    }
+  };
+
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+  GLStateInvalidate();
+  GLStateUseProgram(program);
+  std::cout << spriteCount << " sprites per frame in " << textureCount << " textures, " << frames << " frames" << std::endl;
+
+  double recordMilliseconds = 0.0;
+  double submitMilliseconds = 0.0;
+  double gpuMilliseconds = 0.0;
+  double frameMaxMilliseconds = 0.0;
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    auto frameStart = std::chrono::steady_clock::now();
+    recordFrame(frame);
+    double recorded = MillisecondsSince(frameStart);
+    SpriteBatchEnd(batch);
+    double submitted = MillisecondsSince(frameStart);
+    StreamBufferFenceFrame();
+    glFinish();
+    double finished = MillisecondsSince(frameStart);
+
+    recordMilliseconds += recorded;
+    submitMilliseconds += submitted - recorded;
+    gpuMilliseconds += finished - submitted;
+    frameMaxMilliseconds = std::max(frameMaxMilliseconds, finished);
+  }
+  double frameMilliseconds = (recordMilliseconds + submitMilliseconds + gpuMilliseconds) / frames;
+  std::cout << "Sprite batch: " << frameMilliseconds << " ms per frame (max " << frameMaxMilliseconds << " ms): record "
+	    << recordMilliseconds / frames << " ms, upload and draw calls " << submitMilliseconds / frames << " ms, GPU "
+	    << gpuMilliseconds / frames << " ms, " << spriteCount / frameMilliseconds / 1000.0 << " million sprites per second"
+	    << std::endl;
+  SpriteBatchPrintStatistics(batch);
+
+  // The naive way: the first sprites of one frame again, each with a draw call of its own
+  bool identical = true;
+  if (naiveCount > 0)
+  {
+    int savedCount = spriteCount;
+    spriteCount = naiveCount;
+    recordFrame(frames);
+    spriteCount = savedCount;
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    SpriteBatchEnd(batch);
+    std::vector<unsigned char> batchedImage = ReadFramebuffer();
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    GLint regionVertex = (GLint)(batch.region * batch.stream.regionSize / sizeof(SpriteVertex));
+    auto naiveStart = std::chrono::steady_clock::now();
+    for (const SpriteDraw& draw : batch.draws)
+    {
+      GLStateBindTexture(GL_TEXTURE_2D, draw.texture);
+      for (uint32_t sprite = draw.firstSprite; sprite < draw.firstSprite + draw.spriteCount; ++sprite)
+      {
+	glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, regionVertex + (GLint)sprite * 4);
+      }
+    }
+    glFinish();
+    double naiveMilliseconds = MillisecondsSince(naiveStart);
+    identical = ReadFramebuffer() == batchedImage;
+
+    std::cout << "One draw call per sprite: " << naiveMilliseconds << " ms for " << naiveCount << " sprites, "
+	      << naiveMilliseconds * spriteCount / naiveCount << " ms for " << spriteCount << " ("
+	      << naiveMilliseconds * spriteCount / naiveCount / frameMilliseconds << "x the batch)" << std::endl;
+    std::cout << (identical ? "Both drew the same image" : "ERROR: the images differ") << std::endl;
+  }
+
+  DestroySpriteBatch(batch);
+  glDeleteTextures(textureCount, textures.data());
+  glDeleteBuffers(1, &viewBuffer);
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/*
+  Streaming benchmark
+
+  Every frame, writes a new set of vertices (small quads at new positions) and draws them,
+  uploading them three different ways:
+    - glBufferData every frame, which orphans the buffer and makes the driver allocate
+    - a stream buffer mapped with GL_MAP_UNSYNCHRONIZED_BIT, region by region
+    - a persistently mapped stream buffer (ARB_buffer_storage), if available
+  and reports the milliseconds per frame, and the fence waits of the stream buffers.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/stream_bench.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/gl_state.cpp ./src/stream_buffer.cpp ./src/instancing.cpp ./src/asset_io.cpp ./src/glad.c -o stream_bench -I ./include/ -lEGL -ldl -pthread
+
+  Usage
+  ./stream_bench [--quads N] [--frames N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// GLoom
+#include <gloom/gl_state.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/instancing.hpp>
+#include <gloom/stream_buffer.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Small on purpose, we want to measure uploads rather than filling pixels
+const int kFramebufferSize = 64;
+// Two triangles of 3 vertices, each vertex a position and a color (6 floats)
+const int kFloatsPerQuad = 6 * 6;
+
+/*
+  Writes this frame's quads, moving them a little every frame like dynamic geometry would
+*/
+void WriteQuads(GLfloat* vertices, int quadCount, int frame)
+{
+  const GLfloat corners[6][2] = { {-1, -1}, {1, -1}, {-1, 1}, {-1, 1}, {1, -1}, {1, 1} };
+  for (int quad = 0; quad < quadCount; ++quad)
+  {
+    GLfloat x = -0.9f + 1.8f * ((quad * 7919 + frame * 13) % 1000) / 1000.0f;
+    GLfloat y = -0.9f + 1.8f * ((quad * 104729 + frame * 7) % 1000) / 1000.0f;
+    for (int corner = 0; corner < 6; ++corner)
+    {
+      GLfloat* vertex = vertices + quad * kFloatsPerQuad + corner * 6;
+      vertex[0] = x + corners[corner][0] * 0.02f;
+      vertex[1] = y + corners[corner][1] * 0.02f;
+      vertex[2] = 0.0f;
+      vertex[3] = (quad % 3) == 0 ? 1.0f : 0.0f;
+      vertex[4] = (quad % 3) == 1 ? 1.0f : 0.0f;
+      vertex[5] = (quad % 3) == 2 ? 1.0f : 0.0f;
+    }
+  }
+}
+
+/*
+  Points the vertex array at the vertices starting at 'offset' in 'buffer'
+*/
+void SetVertexLayout(GLuint buffer, GLintptr offset)
+{
+  GLStateBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 6, (GLvoid*)offset);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 6, (GLvoid*)(offset + sizeof(GLfloat) * 3));
+}
+
+/*
+  Streams through a stream buffer and prints its statistics
+
+  @return milliseconds per frame, or a negative value if the buffer could not be created
+*/
+double TimeStreamBuffer(const std::string& name, bool persistent, int quadCount, int frames)
+{
+  size_t frameBytes = quadCount * kFloatsPerQuad * sizeof(GLfloat);
+  StreamBuffer stream;
+  if (!CreateStreamBuffer(stream, frameBytes, persistent) || stream.persistent != persistent)
+  {
+    return -1.0;
+  }
+
+  double milliseconds = TimeFrames(frames, false, [&](int frame)
+  {
+    StreamBufferBeginFrame(stream);
+    StreamAllocation allocation = StreamBufferMap(stream, frameBytes, sizeof(GLfloat));
+    WriteQuads(static_cast<GLfloat*>(allocation.data), quadCount, frame);
+    StreamBufferUnmap(stream);
+    SetVertexLayout(stream.buffer, allocation.offset);
+    glDrawArrays(GL_TRIANGLES, 0, quadCount * 6);
+    StreamBufferEndFrame(stream);
+  });
+
+  StreamBufferPrintStatistics(stream, name);
+  DestroyStreamBuffer(stream);
+  return milliseconds;
+}
+
+int main(int argc, char* args[])
+{
+  int quadCount = 20000;
+  int frames = 200;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--quads" && i + 1 < argc)
+    {
+      quadCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--quads N] [--frames N]" << std::endl;
+      return 1;
+    }
+  }
+  if (quadCount <= 0 || frames <= 0)
+  {
+    std::cout << "--quads and --frames must be positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  GLuint program = LoadBenchmarkProgram("./shaders/vert.glsl", "./shaders/frag.glsl", "benchmark");
+  if (program == 0)
+  {
+    return 1;
+  }
+  BindDefaultShaderInputs(program);
+
+  GLuint vertexArray = 0;
+  glGenVertexArrays(1, &vertexArray);
+  glBindVertexArray(vertexArray);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  GLStateInvalidate();
+
+  // No instance buffer, every quad is drawn as is
+  InstanceData identity = { {0.0f, 0.0f, 0.0f}, 1.0f, {255, 255, 255, 255} };
+  SetConstantInstanceAttributes(identity);
+
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+  glUseProgram(program);
+
+  size_t frameBytes = quadCount * kFloatsPerQuad * sizeof(GLfloat);
+  std::cout << quadCount << " quads (" << frameBytes / 1024 << " KiB) per frame, " << frames << " frames" << std::endl;
+
+  // The naive path, a new allocation every frame
+  GLuint orphanedBuffer = 0;
+  glGenBuffers(1, &orphanedBuffer);
+  std::vector<GLfloat> vertices(quadCount * kFloatsPerQuad);
+  double orphanMilliseconds = TimeFrames(frames, false, [&](int frame)
+  {
+    WriteQuads(vertices.data(), quadCount, frame);
+    GLStateBindBuffer(GL_ARRAY_BUFFER, orphanedBuffer);
+    glBufferData(GL_ARRAY_BUFFER, frameBytes, vertices.data(), GL_STREAM_DRAW);
+    SetVertexLayout(orphanedBuffer, 0);
+    glDrawArrays(GL_TRIANGLES, 0, quadCount * 6);
+  });
+  GLStateBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDeleteBuffers(1, &orphanedBuffer);
+
+  double unsynchronizedMilliseconds = TimeStreamBuffer("unsynchronized", false, quadCount, frames);
+  double persistentMilliseconds = TimeStreamBuffer("persistent", true, quadCount, frames);
+
+  std::cout << "glBufferData every frame:     " << orphanMilliseconds << " ms per frame" << std::endl;
+  std::cout << "Map unsynchronized (ring):    " << unsynchronizedMilliseconds << " ms per frame" << std::endl;
+  if (persistentMilliseconds >= 0.0)
+  {
+    std::cout << "Persistent coherent (ring):   " << persistentMilliseconds << " ms per frame" << std::endl;
+  }
+  else
+  {
+    std::cout << "Persistent coherent (ring):   ARB_buffer_storage is not available" << std::endl;
+  }
+
+  glDeleteVertexArrays(1, &vertexArray);
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+  Text rendering benchmark
+
+  Draws text with the text renderer (see gloom/text_renderer.hpp) into a 640x480 framebuffer:
+    - an overlay like the one of ./prog --overlay, a panel with about a dozen lines of frame times
+    - a screen full of text, --glyphs characters per frame
+  and reports, per frame, the CPU time to format and lay out the text, the draw calls, and the
+  GPU time of the draw (GL_TIME_ELAPSED timer queries, with the GPU idle before each frame).
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/text_bench.cpp ./src/text_renderer.cpp ./src/texture_atlas.cpp ./src/atlas_packer.cpp ./src/sprite_batch.cpp ./src/uniform_buffer.cpp ./src/tga.cpp ./src/stream_buffer.cpp ./src/render_commands.cpp ./src/render_thread.cpp ./src/gl_state.cpp ./src/asset_io.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/glad.c -o text_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./text_bench [--glyphs N] [--frames N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// GLoom
+#include <gloom/gl_state.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/stream_buffer.hpp>
+#include <gloom/text_renderer.hpp>
+#include <gloom/uniform_buffer.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+const int kFramebufferWidth = 640;
+const int kFramebufferHeight = 480;
+
+/*
+  Draws 'frames' frames of text, laid out by 'layout' between TextRendererBegin and TextRendererEnd,
+  and prints the averages per frame
+*/
+void Measure(const char* name, TextRenderer& text, int frames, const std::function<void(int)>& layout)
+{
+  GLuint query = 0;
+  glGenQueries(1, &query);
+  text.statistics = TextRendererStatistics();
+  text.batch.statistics = SpriteBatchStatistics();
+  double gpuMilliseconds = 0.0;
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glFinish();
+    TextRendererBegin(text);
+    layout(frame);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    TextRendererEnd(text);
+    glEndQuery(GL_TIME_ELAPSED);
+    StreamBufferFenceFrame();
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    gpuMilliseconds += nanoseconds / 1e6;
+  }
+  glDeleteQueries(1, &query);
+
+  const TextRendererStatistics& statistics = text.statistics;
+  double glyphs = (double)statistics.glyphs / frames;
+  double cpuMilliseconds = statistics.cpuMilliseconds / frames;
+  std::cout << name << ": " << glyphs << " glyphs in " << (double)text.batch.statistics.drawCalls / frames
+	    << " draw calls, CPU " << cpuMilliseconds << " ms (max " << statistics.maxCpuMilliseconds << " ms, "
+	    << glyphs / cpuMilliseconds / 1000.0 << " million glyphs per second), GPU " << gpuMilliseconds / frames << " ms"
+	    << std::endl;
+}
+
+int main(int argc, char* args[])
+{
+  int glyphCount = 10000;
+  int frames = 100;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--glyphs" && i + 1 < argc)
+    {
+      glyphCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--glyphs N] [--frames N]" << std::endl;
+      return 1;
+    }
+  }
+  if (glyphCount <= 0 || frames <= 0)
+  {
+    std::cout << "--glyphs and --frames must be positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferWidth, kFramebufferHeight))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  GLuint program = LoadBenchmarkProgram("./shaders/sprite_vert.glsl", "./shaders/sprite_frag.glsl", "sprite");
+  TextRenderer text;
+  if (program == 0 || !CreateTextRenderer(text, (size_t)glyphCount + 1, 1))
+  {
+    std::cout << "Could not create the sprite program or text renderer" << std::endl;
+    return 1;
+  }
+  BindUniformBlocks(program);
+
+  // Positions in pixels, through an orthographic ViewBlock
+  ViewUniforms view;
+  view.viewProjection[0][0] = 2.0f / kFramebufferWidth;
+  view.viewProjection[1][1] = 2.0f / kFramebufferHeight;
+  view.viewProjection[3] = glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+  GLuint viewBuffer = 0;
+  glGenBuffers(1, &viewBuffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, viewBuffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewUniforms), &view, GL_STATIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, kViewUniformBinding, viewBuffer);
+  glViewport(0, 0, kFramebufferWidth, kFramebufferHeight);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+  GLStateInvalidate();
+  GLStateUseProgram(program);
+
+  // The overlay, at twice the size like in ./prog, with numbers that change every frame
+  text.scale = 2;
+  Measure("Overlay", text, frames, [&](int frame) {
+    char buffer[1024];
+    int length = std::snprintf(buffer, sizeof(buffer), "Frame %d  %.0f FPS\n          CPU ms   GPU ms\n", frame, 1000.0 / (1.0 + frame % 7));
+    const char* phases[6] = { "Frame", "Input", "Update", "PreDraw", "Draw", "Swap" };
+    for (int phase = 0; phase < 6; ++phase)
+    {
+      length += std::snprintf(buffer + length, sizeof(buffer) - length, "%-7s %8.3f %8.3f\n", phases[phase], 0.1 * (frame % 13 + phase),
+			      0.05 * (frame % 11 + phase));
+    }
+    length += std::snprintf(buffer + length, sizeof(buffer) - length, "Objects 1 of 1 visible\nOverlay %.3f ms CPU",
+			    text.statistics.lastCpuMilliseconds);
+    std::string_view string(buffer, std::min(length, (int)sizeof(buffer) - 1));
+    glm::vec2 size = TextRendererMeasure(text, string);
+    TextRendererRect(text, glm::vec4(0.0f, kFramebufferHeight - size.y - 16.0f, size.x + 16.0f, size.y + 16.0f),
+		     glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+    TextRendererPrint(text, glm::vec2(8.0f, kFramebufferHeight - 8.0f), string, glm::vec4(1.0f, 1.0f, 0.6f, 1.0f));
+  });
+
+  // A screen full of small text, every line printed on its own like a log would be
+  text.scale = 1;
+  std::string line;
+  for (int i = 0; i < 100; ++i)
+  {
+    line += (char)('!' + (i * 7) % 94);
+  }
+  Measure("Full screen", text, frames, [&](int frame) {
+    int lines = (glyphCount + (int)line.size() - 1) / (int)line.size();
+    for (int i = 0; i < lines; ++i)
+    {
+      int count = std::min((int)line.size(), glyphCount - i * (int)line.size());
+      float y = (float)(kFramebufferHeight - (i * kLineAdvance + frame) % kFramebufferHeight);
+      TextRendererPrint(text, glm::vec2(20.0f, y), std::string_view(line).substr(0, count), glm::vec4(0.8f, 1.0f, 0.8f, 1.0f));
+    }
+  });
+
+  DestroyTextRenderer(text);
+  glDeleteBuffers(1, &viewBuffer);
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return 0;
+}
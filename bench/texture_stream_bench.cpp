@@ -0,0 +1,240 @@
+/*
+  Texture streaming benchmark
+
+  Writes a set of TGA files, then loads them two ways:
+    - on the spot, the way a renderer without streaming would: read, decode, glTexImage2D
+      and glGenerateMipmap, all on the thread that renders, one texture per frame
+    - through the texture streamer (see gloom/texture_streaming.hpp), with a frame every few
+      milliseconds that uses one texture after the other, like a camera moving through a level
+  and reports the longest time a frame spent loading textures for both. The streamer also
+  reports its upload latencies, and evictions if the textures do not fit into --memory.
+  The first texture's full resolution level is read back from both and compared.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/texture_stream_bench.cpp ./src/texture_streaming.cpp ./src/tga.cpp ./src/stream_buffer.cpp ./src/render_commands.cpp ./src/render_thread.cpp ./src/gl_state.cpp ./src/asset_io.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/glad.c -o texture_stream_bench -I ./include/ -lEGL -ldl -pthread
+
+  Usage
+  ./texture_stream_bench [--textures N] [--size N] [--budget KiB] [--memory MiB]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// GLoom
+#include <gloom/asset_io.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/texture_streaming.hpp>
+#include <gloom/tga.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The simulated frame rate of the streaming run
+const double kFrameMilliseconds = 4.0;
+
+/*
+  Writes a run length encoded 32 bit TGA: a gradient, with a checker pattern that differs per texture
+
+  @return false if the file could not be written
+*/
+bool WriteTestTGA(const std::string& filename, int size, int seed)
+{
+  std::vector<uint8_t> file = { 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+				(uint8_t)(size & 0xFF), (uint8_t)(size >> 8), (uint8_t)(size & 0xFF), (uint8_t)(size >> 8), 32, 8 };
+  int square = 8 << (seed % 4);
+  for (int y = 0; y < size; ++y)
+  {
+    // One raw packet of up to 128 pixels at a time, the gradient leaves few runs to find
+    for (int x = 0; x < size; x += 128)
+    {
+      int count = std::min(128, size - x);
+      file.push_back((uint8_t)(count - 1));
+      for (int i = x; i < x + count; ++i)
+      {
+	bool dark = ((i / square) + (y / square)) % 2 == 0;
+	file.push_back(dark ? 0 : (uint8_t)(i * 255 / size));
+	file.push_back((uint8_t)(y * 255 / size));
+	file.push_back((uint8_t)(seed * 37));
+	file.push_back(255);
+      }
+    }
+  }
+  std::ofstream stream(filename, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+  return stream.good();
+}
+
+/*
+  Loads a texture the simple way, on the calling thread
+
+  @return the texture object, 0 if the file could not be decoded
+*/
+GLuint LoadTextureNow(const std::string& filename)
+{
+  AssetFile file = LoadAsset(filename);
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+  if (!file.IsOpen() || !DecodeTGA(file.View(), pixels, width, height))
+  {
+    return 0;
+  }
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  return texture;
+}
+
+// Reads back a level of a texture
+std::vector<uint8_t> ReadLevel(GLuint texture, int level, int size)
+{
+  std::vector<uint8_t> pixels((size_t)std::max(1, size >> level) * std::max(1, size >> level) * 4);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return pixels;
+}
+
+int main(int argc, char* args[])
+{
+  int textureCount = 16;
+  int size = 1024;
+  TextureStreamerSettings settings;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--textures" && i + 1 < argc)
+    {
+      textureCount = std::atoi(args[++i]);
+    }
+    else if (option == "--size" && i + 1 < argc)
+    {
+      size = std::atoi(args[++i]);
+    }
+    else if (option == "--budget" && i + 1 < argc)
+    {
+      settings.uploadBudgetBytes = (size_t)std::atoi(args[++i]) * 1024;
+    }
+    else if (option == "--memory" && i + 1 < argc)
+    {
+      settings.memoryBudgetBytes = (size_t)std::atoi(args[++i]) * 1024 * 1024;
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--textures N] [--size N] [--budget KiB] [--memory MiB]" << std::endl;
+      return 1;
+    }
+  }
+  if (textureCount <= 0 || size <= 0 || size > 16384 || settings.uploadBudgetBytes == 0)
+  {
+    std::cout << "--textures, --size (up to 16384) and --budget must be positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, 64, 64))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  std::filesystem::path directory = std::filesystem::temp_directory_path() / "gloom_texture_stream_bench";
+  std::filesystem::create_directories(directory);
+  std::vector<std::string> filenames;
+  for (int i = 0; i < textureCount; ++i)
+  {
+    filenames.push_back((directory / ("texture" + std::to_string(i) + ".tga")).string());
+    if (!WriteTestTGA(filenames.back(), size, i))
+    {
+      std::cout << "Could not write " << filenames.back() << std::endl;
+      return 1;
+    }
+  }
+  std::cout << textureCount << " textures of " << size << "x" << size << " (" << size * size * 4 / 1024
+	    << " KiB each without mips)" << std::endl;
+
+  // On the spot: every texture is a frame that stalls for as long as loading it takes
+  std::vector<GLuint> immediateTextures;
+  double immediateMilliseconds = 0.0;
+  double immediateMaxMilliseconds = 0.0;
+  for (const std::string& filename : filenames)
+  {
+    auto startTime = std::chrono::steady_clock::now();
+    immediateTextures.push_back(LoadTextureNow(filename));
+    glFinish();
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    immediateMilliseconds += milliseconds;
+    immediateMaxMilliseconds = std::max(immediateMaxMilliseconds, milliseconds);
+  }
+
+  // Streamed: request everything, then use one texture after the other
+  if (!TextureStreamerStart(settings))
+  {
+    std::cout << "Could not start the texture streamer" << std::endl;
+    return 1;
+  }
+  std::vector<TextureHandle> handles;
+  for (const std::string& filename : filenames)
+  {
+    handles.push_back(TextureRequest(filename));
+  }
+
+  auto streamStartTime = std::chrono::steady_clock::now();
+  auto nextFrameTime = streamStartTime;
+  double frameMaxMilliseconds = 0.0;
+  double frameMilliseconds = 0.0;
+  int frames = 0;
+  int current = 0;
+  bool failed = false;
+  while (current < textureCount && !failed)
+  {
+    auto frameStartTime = std::chrono::steady_clock::now();
+    TextureStreamerBeginFrame();
+    TextureUse(handles[current]);
+    glFinish();
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStartTime).count();
+    frameMilliseconds += milliseconds;
+    frameMaxMilliseconds = std::max(frameMaxMilliseconds, milliseconds);
+    ++frames;
+
+    failed = TextureFailed(handles[current]);
+    current += TextureIsResident(handles[current]) ? 1 : 0;
+
+    nextFrameTime += std::chrono::microseconds((int)(kFrameMilliseconds * 1000.0));
+    std::this_thread::sleep_until(nextFrameTime);
+  }
+  double streamMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - streamStartTime).count();
+
+  // The last texture is still resident (it was used in the last frame), compare it with its immediate twin
+  GLuint streamedTexture = TextureUse(handles[textureCount - 1]);
+  bool identical = !failed && streamedTexture != 0 &&
+		   ReadLevel(streamedTexture, 0, size) == ReadLevel(immediateTextures.back(), 0, size);
+
+  std::cout << "On the spot:  " << immediateMilliseconds / textureCount << " ms per texture, the longest frame took "
+	    << immediateMaxMilliseconds << " ms" << std::endl;
+  std::cout << "Streamed:     " << frames << " frames of " << kFrameMilliseconds << " ms in " << streamMilliseconds
+	    << " ms, the longest frame spent " << frameMaxMilliseconds << " ms on textures ("
+	    << frameMilliseconds / frames << " ms on average)" << std::endl;
+  TextureStreamerPrintStatistics();
+  std::cout << (identical ? "The streamed texture matches" : "ERROR: the streamed texture differs") << std::endl;
+
+  TextureStreamerStop();
+  glDeleteTextures((GLsizei)immediateTextures.size(), immediateTextures.data());
+  std::filesystem::remove_all(directory);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return identical ? 0 : 1;
+}
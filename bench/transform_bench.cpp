@@ -0,0 +1,224 @@
+/*
+  Transform hierarchy benchmark
+
+  Builds a forest of nodes (see gloom/transform.hpp) and measures TransformUpdate in nodes per
+  millisecond for a full update (every node dirty), for a few random nodes moving (their subtrees
+  follow) and for a single root moving. Every result is compared against world matrices computed
+  the plain way, node by node with GLM's operator*.
+  After every update the changed range is uploaded with UploadWorldMatrices (into a buffer of a
+  headless context, see gloom/headless.hpp), and the whole buffer is read back and compared against
+  the hierarchy's matrices.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/transform_bench.cpp ./src/transform.cpp ./src/gl_state.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/glad.c -o transform_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./transform_bench [--nodes N] [--moving N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// GLoom
+#include <gloom/gl_state.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/transform.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Updates per measurement
+const int kRepetitions = 10;
+// Nodes are attached to one of the last kParentWindow nodes, or become roots with this probability
+const uint32_t kParentWindow = 1000;
+const float kRootProbability = 0.001f;
+
+/*
+  Recomputes every world matrix with GLM's default operator* and checks the hierarchy's results
+*/
+bool Verify(const TransformHierarchy& hierarchy)
+{
+  std::vector<glm::mat4> worlds(hierarchy.Size());
+  for (size_t node = 0; node < hierarchy.Size(); ++node)
+  {
+    glm::mat4 local = glm::translate(glm::mat4(1.0f), hierarchy.translations[node]) * glm::mat4_cast(hierarchy.rotations[node]) *
+		      glm::scale(glm::mat4(1.0f), hierarchy.scales[node]);
+    uint32_t parent = hierarchy.parents[node];
+    worlds[node] = parent == kTransformNoParent ? local : worlds[parent] * local;
+
+    for (int column = 0; column < 4; ++column)
+    {
+      glm::vec4 difference = glm::abs(worlds[node][column] - hierarchy.worlds[node][column]);
+      float tolerance = 1e-3f * (1.0f + glm::length(worlds[node][column]));
+      if (difference.x > tolerance || difference.y > tolerance || difference.z > tolerance || difference.w > tolerance)
+      {
+        std::cout << "Node " << node << " has the wrong world matrix" << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+  Reads the whole buffer back and compares it with the hierarchy's world matrices, which the
+  uploads so far must have copied exactly
+*/
+bool VerifyUpload(const TransformHierarchy& hierarchy, const TransformBuffer& transformBuffer)
+{
+  std::vector<glm::mat4> uploaded(hierarchy.Size());
+  GLStateBindBuffer(GL_COPY_WRITE_BUFFER, transformBuffer.buffer);
+  glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0, uploaded.size() * sizeof(glm::mat4), uploaded.data());
+  if (std::memcmp(uploaded.data(), hierarchy.worlds.data(), uploaded.size() * sizeof(glm::mat4)) != 0)
+  {
+    std::cout << "The transform buffer does not match the world matrices" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+struct Measurement
+{
+  // Per update
+  double milliseconds = 0.0;
+  size_t updated = 0;
+  double uploadMilliseconds = 0.0;
+  size_t uploadedMatrices = 0;
+};
+
+/*
+  Marks nodes dirty with 'mark' before every update, and uploads the changes after it
+*/
+template <typename MarkFunction>
+Measurement MeasureUpdate(TransformHierarchy& hierarchy, TransformBuffer& transformBuffer, MarkFunction mark)
+{
+  Measurement measurement;
+  for (int repetition = 0; repetition < kRepetitions; ++repetition)
+  {
+    mark();
+    auto startTime = std::chrono::steady_clock::now();
+    measurement.updated += TransformUpdate(hierarchy);
+    auto updatedTime = std::chrono::steady_clock::now();
+    measurement.uploadedMatrices += hierarchy.uploadEnd - hierarchy.uploadBegin;
+    UploadWorldMatrices(hierarchy, transformBuffer);
+    // Only the copy into the driver counts, not the GPU's work
+    auto uploadedTime = std::chrono::steady_clock::now();
+    measurement.milliseconds += std::chrono::duration<double, std::milli>(updatedTime - startTime).count();
+    measurement.uploadMilliseconds += std::chrono::duration<double, std::milli>(uploadedTime - updatedTime).count();
+  }
+  measurement.milliseconds /= kRepetitions;
+  measurement.updated /= kRepetitions;
+  measurement.uploadMilliseconds /= kRepetitions;
+  measurement.uploadedMatrices /= kRepetitions;
+  return measurement;
+}
+
+void Report(const char* label, const Measurement& measurement)
+{
+  if (measurement.updated == 0)
+  {
+    std::cout << label << ": nothing to update in " << measurement.milliseconds << " ms" << std::endl;
+    return;
+  }
+  std::cout << label << ": " << measurement.updated << " nodes in " << measurement.milliseconds << " ms, "
+	    << measurement.updated / measurement.milliseconds << " nodes per ms, uploaded "
+	    << measurement.uploadedMatrices * sizeof(glm::mat4) / 1024.0 << " KiB in " << measurement.uploadMilliseconds
+	    << " ms" << std::endl;
+}
+
+int main(int argc, char* args[])
+{
+  uint32_t nodeCount = 1000000;
+  int moving = 100;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--nodes" && i + 1 < argc)
+    {
+      nodeCount = (uint32_t)std::atoi(args[++i]);
+    }
+    else if (option == "--moving" && i + 1 < argc)
+    {
+      moving = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--nodes N] [--moving N]" << std::endl;
+      return 1;
+    }
+  }
+  if (nodeCount == 0 || moving < 0)
+  {
+    std::cout << "--nodes must be positive" << std::endl;
+    return 1;
+  }
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> probability(0.0f, 1.0f);
+  TransformHierarchy hierarchy;
+  for (uint32_t node = 0; node < nodeCount; ++node)
+  {
+    uint32_t parent = kTransformNoParent;
+    if (node > 0 && probability(random) > kRootProbability)
+    {
+      uint32_t window = std::min(node, kParentWindow);
+      parent = node - 1 - random() % window;
+    }
+    glm::quat rotation = glm::angleAxis(unit(random) * 3.14159265f, glm::normalize(glm::vec3(unit(random), unit(random), 1.0f)));
+    TransformAdd(hierarchy, parent, glm::vec3(unit(random), unit(random), unit(random)), rotation,
+		 glm::vec3(1.0f + 0.01f * unit(random)));
+  }
+  std::cout << nodeCount << " nodes" << std::endl;
+
+  // Only for the transform buffer, nothing is drawn
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  TransformBuffer transformBuffer;
+
+  Measurement measurement = MeasureUpdate(hierarchy, transformBuffer, [&] {
+    for (uint32_t node = 0; node < nodeCount; ++node)
+    {
+      TransformSetTranslation(hierarchy, node, hierarchy.translations[node]);
+    }
+  });
+  Report("All nodes dirty   ", measurement);
+  bool correct = Verify(hierarchy) && VerifyUpload(hierarchy, transformBuffer);
+
+  measurement = MeasureUpdate(hierarchy, transformBuffer, [&] {
+    for (int i = 0; i < moving; ++i)
+    {
+      uint32_t node = random() % nodeCount;
+      TransformSetTranslation(hierarchy, node, hierarchy.translations[node] + glm::vec3(0.01f, 0.0f, 0.0f));
+    }
+  });
+  Report("Random nodes moved", measurement);
+  correct = correct && Verify(hierarchy) && VerifyUpload(hierarchy, transformBuffer);
+
+  measurement = MeasureUpdate(hierarchy, transformBuffer, [&] {
+    TransformSetRotation(hierarchy, 0, glm::angleAxis(0.01f, glm::vec3(0.0f, 1.0f, 0.0f)) * hierarchy.rotations[0]);
+  });
+  Report("First root rotated", measurement);
+  correct = correct && Verify(hierarchy) && VerifyUpload(hierarchy, transformBuffer);
+
+  measurement = MeasureUpdate(hierarchy, transformBuffer, [] {});
+  Report("Nothing dirty     ", measurement);
+
+  DestroyTransformBuffer(transformBuffer);
+  DestroyHeadlessContext();
+  return correct ? 0 : 1;
+}
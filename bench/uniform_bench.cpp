@@ -0,0 +1,285 @@
+/*
+  Uniform buffer benchmark
+
+  Draws the same small quads two ways and reports the CPU time per draw:
+    - setting the object's transform and color with glUniformMatrix4fv and glUniform4fv before each draw
+    - pushing them into a uniform ring (see gloom/uniform_buffer.hpp), uploading the frame with one
+      map, and selecting each draw's range with glBindBufferRange
+  Only the time spent issuing calls is measured, the GPU work is waited for outside of it.
+  The last frame of both is read back and compared, they have to draw the same pixels.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/uniform_bench.cpp ./src/uniform_buffer.cpp ./src/stream_buffer.cpp ./src/render_commands.cpp ./src/render_thread.cpp ./src/gl_state.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/glad.c -o uniform_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./uniform_bench [--objects N] [--frames N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// GLoom
+#include <gloom/gl_state.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/uniform_buffer.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Small on purpose, we want to measure submitting draws rather than filling pixels
+const int kFramebufferSize = 64;
+
+// Both programs compute the same thing, one from default block uniforms, one from uniform blocks
+const char* kUniformVertexSource = R"(#version 410 core
+layout(location=0) in vec3 position;
+uniform mat4 viewProjection;
+uniform mat4 model;
+uniform vec4 color;
+out vec4 v_color;
+void main()
+{
+  v_color = color;
+  gl_Position = viewProjection * model * vec4(position, 1.0f);
+}
+)";
+
+const char* kBlockVertexSource = R"(#version 410 core
+layout(location=0) in vec3 position;
+layout(std140) uniform ViewBlock
+{
+  mat4 viewProjection;
+  mat4 view;
+  vec4 cameraPositionTime;
+};
+layout(std140) uniform DrawBlock
+{
+  mat4 model;
+  vec4 color;
+};
+out vec4 v_color;
+void main()
+{
+  v_color = color;
+  gl_Position = viewProjection * model * vec4(position, 1.0f);
+}
+)";
+
+const char* kFragmentSource = R"(#version 410 core
+in vec4 v_color;
+out vec4 color;
+void main()
+{
+  color = v_color;
+}
+)";
+
+/*
+  @return the linked program, 0 on failure
+*/
+GLuint CreateProgram(const char* vertexSource)
+{
+  const char* sources[2] = { vertexSource, kFragmentSource };
+  const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+
+  GLuint program = glCreateProgram();
+  for (int i = 0; i < 2; ++i)
+  {
+    GLuint shader = glCreateShader(types[i]);
+    glShaderSource(shader, 1, &sources[i], nullptr);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+  }
+  glLinkProgram(program);
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE)
+  {
+    std::cout << "Could not link a benchmark program" << std::endl;
+    glDeleteProgram(program);
+    return 0;
+  }
+  BindUniformBlocks(program);
+  return program;
+}
+
+/*
+  Calls issueFrame 'frames' times, timing only the calls themselves
+
+  @return the CPU nanoseconds per draw
+*/
+template <typename IssueFrame>
+double TimeDraws(int frames, int objectCount, IssueFrame issueFrame)
+{
+  double nanoseconds = 0.0;
+  for (int frame = 0; frame < frames; ++frame)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    auto startTime = std::chrono::steady_clock::now();
+    issueFrame(frame);
+    nanoseconds += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    // Keeps the driver's queue from filling up and stalling inside the measured part
+    glFinish();
+  }
+  return nanoseconds / ((double)frames * objectCount);
+}
+
+// Sum of the framebuffer's bytes, to compare what both ways drew
+unsigned long long FramebufferChecksum()
+{
+  std::vector<unsigned char> pixels(kFramebufferSize * kFramebufferSize * 4);
+  glReadPixels(0, 0, kFramebufferSize, kFramebufferSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  unsigned long long checksum = 0;
+  for (size_t i = 0; i < pixels.size(); ++i)
+  {
+    checksum = checksum * 31 + pixels[i];
+  }
+  return checksum;
+}
+
+int main(int argc, char* args[])
+{
+  int objectCount = 10000;
+  int frames = 100;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--objects" && i + 1 < argc)
+    {
+      objectCount = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--objects N] [--frames N]" << std::endl;
+      return 1;
+    }
+  }
+  if (objectCount <= 0 || frames <= 0)
+  {
+    std::cout << "--objects and --frames must be positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  GLuint uniformProgram = CreateProgram(kUniformVertexSource);
+  GLuint blockProgram = CreateProgram(kBlockVertexSource);
+  if (uniformProgram == 0 || blockProgram == 0)
+  {
+    return 1;
+  }
+  GLint viewProjectionLocation = glGetUniformLocation(uniformProgram, "viewProjection");
+  GLint modelLocation = glGetUniformLocation(uniformProgram, "model");
+  GLint colorLocation = glGetUniformLocation(uniformProgram, "color");
+
+  // A quad around the origin, scaled and moved by each object's model matrix
+  const GLfloat vertexData[] = { -1.0f, -1.0f, 0.0f,  1.0f, -1.0f, 0.0f,  -1.0f, 1.0f, 0.0f,  1.0f, 1.0f, 0.0f };
+  const GLuint indexData[] = { 2, 0, 1, 3, 2, 1 };
+  GLuint vertexArray = 0;
+  GLuint buffers[2] = {};
+  glGenVertexArrays(1, &vertexArray);
+  glBindVertexArray(vertexArray);
+  glGenBuffers(2, buffers);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indexData), indexData, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, (GLvoid*)0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  GLStateInvalidate();
+
+  // Small quads scattered over the framebuffer, each with its own color
+  std::vector<DrawUniforms> objects(objectCount);
+  for (int i = 0; i < objectCount; ++i)
+  {
+    glm::vec3 translation(-0.9f + 1.8f * ((i * 7919) % 1000) / 1000.0f, -0.9f + 1.8f * ((i * 104729) % 1000) / 1000.0f, 0.0f);
+    objects[i].model = glm::scale(glm::translate(glm::mat4(1.0f), translation), glm::vec3(0.02f));
+    objects[i].color = glm::vec4(((i * 37) % 256) / 255.0f, ((i * 59) % 256) / 255.0f, ((i * 83) % 256) / 255.0f, 1.0f);
+  }
+  ViewUniforms view;
+  view.viewProjection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+  glClearColor(.03f, .05f, 0.27f, 1.f);
+  std::cout << objectCount << " objects (one draw each) per frame, " << frames << " frames" << std::endl;
+
+  // The usual way, the program's own uniforms are set again before every draw
+  glUseProgram(uniformProgram);
+  double uniformNanoseconds = TimeDraws(frames, objectCount, [&](int)
+  {
+    glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(view.viewProjection));
+    for (const DrawUniforms& object : objects)
+    {
+      glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(object.model));
+      glUniform4fv(colorLocation, 1, glm::value_ptr(object.color));
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+  });
+  unsigned long long uniformChecksum = FramebufferChecksum();
+
+  // Through the uniform ring, a region per frame in flight with room for every object
+  UniformRing ring;
+  if (!CreateUniformRing(ring, (objectCount + 1) * (sizeof(DrawUniforms) + 256)))
+  {
+    std::cout << "Could not create the uniform ring" << std::endl;
+    return 1;
+  }
+  std::vector<GLintptr> offsets(objectCount);
+  GLStateUseProgram(blockProgram);
+  double blockNanoseconds = TimeDraws(frames, objectCount, [&](int)
+  {
+    UniformRingBeginFrame(ring);
+    GLintptr viewOffset = UniformRingPush(ring, view);
+    for (int i = 0; i < objectCount; ++i)
+    {
+      offsets[i] = UniformRingPush(ring, objects[i]);
+    }
+    UniformRingFlush(ring);
+
+    GLStateBindBufferRange(GL_UNIFORM_BUFFER, kViewUniformBinding, ring.stream.buffer, viewOffset, sizeof(ViewUniforms));
+    for (int i = 0; i < objectCount; ++i)
+    {
+      GLStateBindBufferRange(GL_UNIFORM_BUFFER, kDrawUniformBinding, ring.stream.buffer, offsets[i], sizeof(DrawUniforms));
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    UniformRingEndFrame(ring);
+  });
+  unsigned long long blockChecksum = FramebufferChecksum();
+
+  std::cout << "glUniform* per draw:          " << uniformNanoseconds << " ns CPU per draw" << std::endl;
+  std::cout << "Uniform ring + range binding: " << blockNanoseconds << " ns CPU per draw ("
+	    << uniformNanoseconds / blockNanoseconds << "x)" << std::endl;
+  UniformRingPrintStatistics(ring);
+
+  bool identical = uniformChecksum == blockChecksum;
+  std::cout << (identical ? "Both drew the same image" : "ERROR: the images differ") << std::endl;
+
+  DestroyUniformRing(ring);
+  glDeleteBuffers(2, buffers);
+  glDeleteVertexArrays(1, &vertexArray);
+  glDeleteProgram(uniformProgram);
+  glDeleteProgram(blockProgram);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return identical ? 0 : 1;
+}
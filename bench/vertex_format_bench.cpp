@@ -0,0 +1,239 @@
+/*
+  Vertex format benchmark
+
+  Builds a grid mesh with positions, colors and normals, stores it in every vertex format
+  (see gloom/vertex_format.hpp) and reports for each:
+    - bytes per vertex and the size of the vertex buffer
+    - how long packing the vertices takes on the CPU
+    - how many vertices per second the GPU fetches and transforms, drawing the mesh repeatedly
+      into a tiny framebuffer so that vertex fetch rather than pixel work dominates
+    - the largest position error the format introduces
+
+  The shader reads all three attributes, so none of them can be optimized away.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./bench/vertex_format_bench.cpp ./src/headless.cpp ./src/gldebug.cpp ./src/vertex_format.cpp ./src/glad.c -o vertex_format_bench -I ./include/ -I ./thirdparty/glm-master/ -lEGL -ldl -pthread
+
+  Usage
+  ./vertex_format_bench [--grid N] [--frames N]
+*/
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// GLoom
+#include <gloom/headless.hpp>
+#include <gloom/vertex_format.hpp>
+
+// Benchmark helpers
+#include "bench_common.hpp"
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+const int kFramebufferSize = 64;
+// Draws of the whole mesh per frame
+const int kDrawsPerFrame = 4;
+
+const char* kVertexShaderSource = R"(#version 410 core
+layout(location=0) in vec3 position;
+layout(location=1) in vec3 vertexColors;
+layout(location=4) in vec3 normal;
+out vec3 v_vertexColors;
+void main()
+{
+  v_vertexColors = vertexColors * (0.5 + 0.5 * normal.z);
+  gl_Position = vec4(position, 1.0);
+}
+)";
+
+const char* kFragmentShaderSource = R"(#version 410 core
+in vec3 v_vertexColors;
+out vec4 color;
+void main()
+{
+  color = vec4(v_vertexColors, 1.0);
+}
+)";
+
+/*
+  A wavy grid of (gridSize + 1)^2 vertices covering clip space, with float positions,
+  colors and normals
+*/
+MeshData CreateGridMesh(int gridSize)
+{
+  MeshData mesh;
+  mesh.attributes.push_back({ kVertexPositionLocation, 3, GL_FLOAT, 0, 0 });
+  mesh.attributes.push_back({ kVertexColorLocation, 3, GL_FLOAT, 0, 12 });
+  mesh.attributes.push_back({ kVertexNormalLocation, 3, GL_FLOAT, 0, 24 });
+  mesh.vertexStride = 36;
+
+  int side = gridSize + 1;
+  mesh.vertices.resize((size_t)side * side * mesh.vertexStride);
+  for (int y = 0; y < side; ++y)
+  {
+    for (int x = 0; x < side; ++x)
+    {
+      float u = (float)x / gridSize;
+      float v = (float)y / gridSize;
+      float height = 0.1f * std::sin(u * 20.0f) * std::cos(v * 20.0f);
+      glm::vec3 normal = glm::normalize(glm::vec3(-2.0f * std::cos(u * 20.0f) * std::cos(v * 20.0f),
+						  2.0f * std::sin(u * 20.0f) * std::sin(v * 20.0f), 1.0f));
+      float values[9] = { u * 2.0f - 1.0f, v * 2.0f - 1.0f, height, u, v, 0.5f, normal.x, normal.y, normal.z };
+      std::memcpy(mesh.vertices.data() + ((size_t)y * side + x) * mesh.vertexStride, values, sizeof(values));
+    }
+  }
+  for (int y = 0; y < gridSize; ++y)
+  {
+    for (int x = 0; x < gridSize; ++x)
+    {
+      uint32_t corner = y * side + x;
+      uint32_t quad[6] = { corner, corner + 1, corner + side, corner + side, corner + 1, corner + side + 1 };
+      mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+    }
+  }
+  return mesh;
+}
+
+/*
+  Largest distance between the original positions and the positions as the GPU will read them
+*/
+float MaximumPositionError(const MeshData& original, const MeshData& converted)
+{
+  float maximum = 0.0f;
+  for (uint32_t vertex = 0; vertex < original.VertexCount(); ++vertex)
+  {
+    glm::vec3 expected;
+    std::memcpy(&expected[0], original.vertices.data() + (size_t)vertex * original.vertexStride, sizeof(expected));
+    const uint8_t* stored = converted.vertices.data() + (size_t)vertex * converted.vertexStride;
+
+    glm::vec3 decoded;
+    if (converted.attributes[0].type == GL_HALF_FLOAT)
+    {
+      glm::uint64 packed;
+      std::memcpy(&packed, stored, sizeof(packed));
+      decoded = glm::vec3(glm::unpackHalf4x16(packed));
+    }
+    else
+    {
+      std::memcpy(&decoded[0], stored, sizeof(decoded));
+    }
+    maximum = std::max(maximum, glm::length(decoded - expected));
+  }
+  return maximum;
+}
+
+int main(int argc, char* args[])
+{
+  int gridSize = 700;
+  int frames = 20;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--grid" && i + 1 < argc)
+    {
+      gridSize = std::atoi(args[++i]);
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      frames = std::atoi(args[++i]);
+    }
+    else
+    {
+      std::cout << "Usage: " << args[0] << " [--grid N] [--frames N]" << std::endl;
+      return 1;
+    }
+  }
+  if (gridSize <= 0 || frames <= 0)
+  {
+    std::cout << "--grid and --frames must be positive" << std::endl;
+    return 1;
+  }
+
+  HeadlessFramebuffer framebuffer;
+  if (!CreateHeadlessContext(4, 1) || !gladLoadGLLoader(GetHeadlessProcAddress) ||
+      !CreateHeadlessFramebuffer(framebuffer, kFramebufferSize, kFramebufferSize))
+  {
+    std::cout << "Could not create a headless OpenGL 4.1 context" << std::endl;
+    return 1;
+  }
+  std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  const char* sources[2] = { kVertexShaderSource, kFragmentShaderSource };
+  GLuint program = CreateBenchmarkProgram(sources, nullptr, "benchmark");
+  if (program == 0)
+  {
+    return 1;
+  }
+  glUseProgram(program);
+  glViewport(0, 0, kFramebufferSize, kFramebufferSize);
+
+  MeshData source = CreateGridMesh(gridSize);
+  std::cout << source.VertexCount() << " vertices, " << source.indices.size() / 3 << " triangles, "
+	    << kDrawsPerFrame << " draws per frame, " << frames << " frames" << std::endl;
+
+  for (VertexFormat format : { VertexFormat::Float, VertexFormat::Compact })
+  {
+    auto packStart = std::chrono::steady_clock::now();
+    MeshData mesh;
+    ConvertVertexFormat(source, format, mesh);
+    double packMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packStart).count();
+
+    // Upload, the same way LoadMesh does
+    GLuint vertexArray = 0;
+    GLuint buffers[2] = {};
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size(), mesh.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+    for (const MeshAttribute& attribute : mesh.attributes)
+    {
+      glEnableVertexAttribArray(attribute.location);
+      glVertexAttribPointer(attribute.location, (GLint)attribute.components, (GLenum)attribute.type,
+			    attribute.normalized ? GL_TRUE : GL_FALSE, (GLsizei)mesh.vertexStride,
+			    (GLvoid*)(uintptr_t)attribute.offset);
+    }
+
+    // One frame to warm up
+    glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+    glFinish();
+
+    auto drawStart = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+      glClear(GL_COLOR_BUFFER_BIT);
+      for (int draw = 0; draw < kDrawsPerFrame; ++draw)
+      {
+        glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+      }
+      glFinish();
+    }
+    double drawSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - drawStart).count();
+    double vertices = (double)mesh.indices.size() * kDrawsPerFrame * frames;
+
+    std::cout << VertexFormatName(format) << ": " << mesh.vertexStride << " bytes per vertex, "
+	      << mesh.vertices.size() / (1024.0 * 1024.0) << " MiB, packed in " << packMilliseconds << " ms, "
+	      << drawSeconds * 1000.0 / frames << " ms per frame, " << vertices / drawSeconds / 1e6
+	      << " M vertices/s, largest position error " << MaximumPositionError(source, mesh) << std::endl;
+
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &vertexArray);
+    glDeleteBuffers(2, buffers);
+  }
+
+  glDeleteProgram(program);
+  DestroyHeadlessFramebuffer(framebuffer);
+  DestroyHeadlessContext();
+  return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef GLOOM_ASSET_IO_HPP
+#define GLOOM_ASSET_IO_HPP
+
+/*
+  Asset file loading
+
+  Files are read without any per-line work or copying:
+  - Large files are memory mapped (mmap), so the operating system pages them in on demand
+    and we never copy them at all.
+  - Small files (where mapping costs more than it saves) are read with a single read call
+    into a buffer borrowed from a pool, so loading many files does not allocate every time.
+
+  Either way the contents are exposed as a std::string_view, which can be handed straight to
+  e.g. glShaderSource together with its length.
+
+  e.g.
+    AssetFile vertexShader = LoadAsset("./shaders/vert.glsl");
+    if (vertexShader.IsOpen())
+    {
+      std::string_view source = vertexShader.View();
+    }
+*/
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Files of at least this size are memory mapped, smaller ones are read into a pooled buffer
+const size_t kAssetMapThreshold = 64 * 1024;
+
+/*
+  The contents of a loaded file. Owns the mapping or the pooled buffer and gives it back
+  when destroyed, so the view is only valid as long as the AssetFile is alive.
+*/
+struct AssetFile
+{
+  AssetFile() = default;
+  ~AssetFile();
+
+  AssetFile(AssetFile&& other) noexcept;
+  AssetFile& operator=(AssetFile&& other) noexcept;
+  AssetFile(const AssetFile&) = delete;
+  AssetFile& operator=(const AssetFile&) = delete;
+
+  bool IsOpen() const { return mOpen; }
+  bool IsMapped() const { return mMapping != nullptr; }
+  std::string_view View() const { return std::string_view(mData, mSize); }
+
+private:
+  friend AssetFile LoadAsset(const std::string& filename);
+  void Release();
+
+  const char* mData = nullptr;
+  size_t mSize = 0;
+  bool mOpen = false;
+  // Set if the file is memory mapped
+  void* mMapping = nullptr;
+  // Used if the file was read into a buffer from the pool
+  std::vector<char> mBuffer;
+};
+
+/*
+  Loads a whole file
+
+  @param filename Path to the file
+  @return the file contents, check IsOpen() to see if loading worked
+*/
+AssetFile LoadAsset(const std::string& filename);
+
+// Totals over every LoadAsset call so far
+struct AssetIOStatistics
+{
+  size_t files = 0;
+  size_t mappedFiles = 0;
+  size_t bytes = 0;
+  double seconds = 0.0;
+  // Number of times the buffer pool had to allocate (or grow) a buffer
+  size_t allocations = 0;
+};
+
+AssetIOStatistics GetAssetIOStatistics();
+
+/*
+  Prints the number of files, bytes, throughput in bytes/s and allocations
+*/
+void AssetIOPrintStatistics();
+
+#endif
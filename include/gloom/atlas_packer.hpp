@@ -0,0 +1,173 @@
+#ifndef GLOOM_ATLAS_PACKER_HPP
+#define GLOOM_ATLAS_PACKER_HPP
+
+/*
+  Atlas packing
+
+  Every texture change ends a sprite batch (see sprite_batch.hpp). Putting many small images
+  into one large texture, an atlas, lets sprites with different images share a batch. Where
+  each image goes is a rectangle bin packing problem, solved here with one of two heuristics:
+
+    MaxRects  Keeps a list of the largest free rectangles (they may overlap) and puts each image
+              into the one it fits most snugly (best short side fit). Packs tightly, and freed
+              rectangles are simply free again, so images can be evicted and replaced at runtime.
+              Insertion costs grow with the number of free rectangles.
+    Skyline   Only remembers the height of the packed area along the x axis and puts each image
+              as low as it goes (bottom left). Fast and nearly as tight for similar sizes, but
+              the space of an evicted image is only reused once the whole page is empty.
+
+  This file knows nothing about OpenGL, the same code packs offline (tools/atlas_pack.cpp) and
+  at runtime (texture_atlas.hpp). It also blits images into a page with their edge pixels
+  extended into a border, and reads and writes the manifest that describes a baked atlas.
+
+  e.g.
+    AtlasPacker packer;
+    AtlasPackerReset(packer, 2048, 2048, AtlasPackMethod::MaxRects);
+    AtlasRect rect;
+    if (AtlasPackerInsert(packer, 40, 24, rect))
+    {
+      ... rect.x, rect.y ...
+    }
+    AtlasPackerRelease(packer, rect);
+*/
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class AtlasPackMethod
+{
+  MaxRects,
+  Skyline
+};
+
+struct AtlasRect
+{
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// A horizontal stretch of the skyline: everything below y is (or was) used
+struct SkylineSegment
+{
+  int x = 0;
+  int y = 0;
+  int width = 0;
+};
+
+struct AtlasPacker
+{
+  AtlasPackMethod method = AtlasPackMethod::MaxRects;
+  int width = 0;
+  int height = 0;
+  // MaxRects: free rectangles, none of them inside another
+  std::vector<AtlasRect> freeRects;
+  // Skyline: segments from left to right, covering the whole width
+  std::vector<SkylineSegment> skyline;
+  // Area and number of the rectangles placed and not released
+  size_t usedArea = 0;
+  size_t rectCount = 0;
+};
+
+/*
+  Empties a packer and sets its size and method
+*/
+void AtlasPackerReset(AtlasPacker& packer, int width, int height, AtlasPackMethod method);
+
+/*
+  Finds room for a rectangle
+
+  @param rect Receives the position, and width and height
+  @return false if it does not fit anywhere
+*/
+bool AtlasPackerInsert(AtlasPacker& packer, int width, int height, AtlasRect& rect);
+
+/*
+  Gives the room of a rectangle returned by AtlasPackerInsert back. MaxRects can reuse it right away,
+  Skyline only once every rectangle was released.
+*/
+void AtlasPackerRelease(AtlasPacker& packer, const AtlasRect& rect);
+
+/*
+  @return the fraction of the area covered by placed rectangles
+*/
+double AtlasPackerOccupancy(const AtlasPacker& packer);
+
+/*
+  @return "maxrects" or "skyline"
+*/
+const char* AtlasPackMethodName(AtlasPackMethod method);
+
+/*
+  Parses a method name as printed by AtlasPackMethodName
+
+  @return true if the name is known
+*/
+bool ParseAtlasPackMethod(const std::string& name, AtlasPackMethod& method);
+
+/*
+  @return how much room an image takes in an atlas: its size plus the border on both sides,
+  rounded up to a multiple of 'alignment'
+*/
+int AtlasSlotSize(int size, int border, int alignment);
+
+/*
+  Copies an RGBA8 image into an RGBA8 page with its outermost pixels repeated 'border' times
+  on every side, so filtering (and mip levels) near its edges never pick up a neighbor's pixels.
+  The slot's remaining pixels, from the alignment, repeat the edge too.
+
+  @param page The page's pixels, pageWidth pixels per row
+  @param slot The image's slot in the page (see AtlasSlotSize), the image starts border pixels in
+*/
+void AtlasBlit(uint8_t* page, int pageWidth, const AtlasRect& slot, int border, const uint8_t* pixels, int width, int height);
+
+// Identifies an image in an atlas
+typedef uint32_t AtlasAssetId;
+
+/*
+  @return the id of an image with this name (a 32 bit FNV-1a hash)
+*/
+AtlasAssetId AtlasAssetIdFromName(std::string_view name);
+
+/*
+  What a baked atlas is made of: the page images, and where each image is
+*/
+struct AtlasManifestEntry
+{
+  std::string name;
+  int page = 0;
+  // The image itself (without its border), in pixels
+  AtlasRect rect;
+};
+
+struct AtlasManifest
+{
+  int pageSize = 0;
+  int border = 0;
+  int mipLevels = 0;
+  // TGA files, relative to the manifest
+  std::vector<std::string> pageFilenames;
+  std::vector<AtlasManifestEntry> entries;
+};
+
+/*
+  Writes a manifest as text, one line per page and image. Names and page filenames are
+  quoted, so they may hold spaces.
+
+  @return false if the file could not be written
+*/
+bool WriteAtlasManifest(const std::string& filename, const AtlasManifest& manifest);
+
+/*
+  Reads a manifest written by WriteAtlasManifest
+
+  @return false if the file is missing or malformed
+*/
+bool ReadAtlasManifest(const std::string& filename, AtlasManifest& manifest);
+
+#endif
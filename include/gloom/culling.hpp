@@ -0,0 +1,121 @@
+#ifndef GLOOM_CULLING_HPP
+#define GLOOM_CULLING_HPP
+
+/*
+  Frustum culling
+
+  Before anything is handed to the draw bucket we throw away the objects the camera can not
+  see. Every object has a bounding sphere and an axis aligned bounding box (AABB) around the
+  same center. An object is culled if either lies completely outside one of the six planes of
+  the view frustum; the sphere is the better fit for round objects, the box for long or flat ones.
+  Without a radius of its own the sphere is the one through the corners of the box, which never
+  culls anything the box does not, so pass a tighter one where there is one (e.g. the distance
+  from the center to the farthest vertex of a round mesh).
+
+  The bounds are kept as a structure of arrays (all x coordinates together, all radii together, ...)
+  so the tests run on 4 objects at a time with SSE, through GLM's SIMD layer, or on 8 at a time
+  with AVX when compiled with -mavx (or -march=native). Anything else uses the scalar loop.
+
+  e.g.
+    uint32_t object = CullingSetAdd(gSceneBounds, center, halfExtents);
+    ...
+    FrustumPlanes frustum = ExtractFrustumPlanes(projection * view);
+    CullObjects(gSceneBounds, frustum, gVisibleObjects);
+    for (uint32_t object : gVisibleObjects) { ... push its draw packet ... }
+*/
+
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+  The six planes of a view frustum (left, right, bottom, top, near, far). Each plane is
+  (normal, distance) with the normal pointing inwards and normalized, so for a point p
+  dot(normal, p) + distance is the signed distance to the plane, negative outside.
+*/
+struct FrustumPlanes
+{
+  glm::vec4 planes[6];
+};
+
+/*
+  Extracts the frustum planes from a view-projection matrix (Gribb and Hartmann),
+  for OpenGL clip space (-w <= z <= w)
+
+  @param viewProjection Maps world space to clip space, the identity for our clip space quads
+*/
+FrustumPlanes ExtractFrustumPlanes(const glm::mat4& viewProjection);
+
+/*
+  The bounds of every object, as a structure of arrays indexed by object
+*/
+struct CullingSet
+{
+  std::vector<float> centerX, centerY, centerZ;
+  std::vector<float> radius;
+  // Half the size of the box along each axis
+  std::vector<float> extentX, extentY, extentZ;
+
+  size_t Size() const { return radius.size(); }
+};
+
+/*
+  Adds an object
+
+  @param set The set to add to
+  @param center Center of the box (and of the sphere)
+  @param halfExtents Half the size of the box along each axis
+  @param radius Radius of a bounding sphere around the center, 0 (or anything larger than the box's
+                corners) for the sphere through the corners of the box
+  @return the index of the object, what CullObjects reports
+*/
+uint32_t CullingSetAdd(CullingSet& set, const glm::vec3& center, const glm::vec3& halfExtents, float radius = 0.0f);
+
+/*
+  Moves or resizes an object added before
+*/
+void CullingSetUpdate(CullingSet& set, uint32_t object, const glm::vec3& center, const glm::vec3& halfExtents,
+		      float radius = 0.0f);
+
+void CullingSetClear(CullingSet& set);
+
+/*
+  Finds the objects that may be visible, with the widest SIMD instructions available
+
+  @param set Bounds of all objects
+  @param frustum Planes of the view frustum
+  @param visible Receives the indices of the objects that were not culled, in increasing order
+  @return the number of visible objects
+*/
+size_t CullObjects(const CullingSet& set, const FrustumPlanes& frustum, std::vector<uint32_t>& visible);
+
+/*
+  Same as CullObjects, one object at a time. For comparison and for platforms without SIMD.
+*/
+size_t CullObjectsScalar(const CullingSet& set, const FrustumPlanes& frustum, std::vector<uint32_t>& visible);
+
+/*
+  @return "AVX (8 objects)", "SSE (4 objects)" or "scalar", whatever CullObjects uses
+*/
+const char* CullingInstructionSet();
+
+// Totals over every CullObjects call
+struct CullingStatistics
+{
+  size_t calls = 0;
+  size_t tested = 0;
+  size_t culled = 0;
+  double nanoseconds = 0.0;
+};
+
+CullingStatistics GetCullingStatistics();
+
+/*
+  Prints the objects culled per frame and the nanoseconds spent per object
+*/
+void CullingPrintStatistics();
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef GLOOM_DRAW_BUCKET_HPP
+#define GLOOM_DRAW_BUCKET_HPP
+
+/*
+  Draw buckets
+
+  Callers push draw packets in any order, each with a 64-bit sort key. Before submitting,
+  the bucket radix sorts the packets by key, so draws that share a program, vertex array
+  and texture end up next to each other, and we only change state when the next draw
+  actually needs something different.
+
+  The key is laid out from most to least significant:
+    bits 63..56  layer     (e.g. world, transparent, overlay), drawn in increasing order
+    bits 55..44  program   (ordering by program first, since switching programs costs the most)
+    bits 43..24  material  (textures and other per material state)
+    bits 23..0   depth     (front to back for opaque layers, to help early depth rejection)
+
+  e.g.
+    DrawBucketClear(gDrawBucket);
+    DrawPacket packet;
+    packet.key = MakeDrawSortKey(0, program, material, depth);
+    ...
+    DrawBucketPush(gDrawBucket, packet);
+    DrawBucketSort(gDrawBucket);
+    DrawBucketSubmit(gDrawBucket);
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+  Everything needed to issue one indexed draw call
+*/
+struct DrawPacket
+{
+  uint64_t key = 0;
+  GLuint program = 0;
+  GLuint vertexArray = 0;
+  // Texture bound to texture unit 0 (GL_TEXTURE_2D), 0 for none
+  GLuint texture = 0;
+  GLenum mode = GL_TRIANGLES;
+  GLsizei count = 0;
+  GLenum indexType = GL_UNSIGNED_INT;
+  // Byte offset into the element array buffer
+  GLintptr indexOffset = 0;
+  // Drawn with glDrawElementsInstanced if not 1, see instancing.hpp
+  GLsizei instanceCount = 1;
+  // Per draw uniforms (DrawBlock), bound to kDrawUniformBinding if uniformSize is not 0, see uniform_buffer.hpp
+  GLuint uniformBuffer = 0;
+  GLintptr uniformOffset = 0;
+  GLsizeiptr uniformSize = 0;
+};
+
+// Number of bits of each field in the sort key
+const int kDrawSortLayerBits = 8;
+const int kDrawSortProgramBits = 12;
+const int kDrawSortMaterialBits = 20;
+const int kDrawSortDepthBits = 24;
+
+/*
+  Builds a sort key. Values wider than their field are truncated.
+
+  @param layer Drawn in increasing order
+  @param program Small id of the program (e.g. the OpenGL program name)
+  @param material Small id of the material (e.g. the texture name)
+  @param depth Quantized view depth, smaller is drawn first
+*/
+inline uint64_t MakeDrawSortKey(uint32_t layer, uint32_t program, uint32_t material, uint32_t depth)
+{
+  const uint64_t layerMask = (1ull << kDrawSortLayerBits) - 1;
+  const uint64_t programMask = (1ull << kDrawSortProgramBits) - 1;
+  const uint64_t materialMask = (1ull << kDrawSortMaterialBits) - 1;
+  const uint64_t depthMask = (1ull << kDrawSortDepthBits) - 1;
+  return ((layer & layerMask) << (kDrawSortProgramBits + kDrawSortMaterialBits + kDrawSortDepthBits)) |
+	 ((program & programMask) << (kDrawSortMaterialBits + kDrawSortDepthBits)) |
+	 ((material & materialMask) << kDrawSortDepthBits) |
+	 (depth & depthMask);
+}
+
+// What the last DrawBucketSubmit did
+struct DrawBucketStatistics
+{
+  size_t draws = 0;
+  size_t instances = 0;
+  size_t programChanges = 0;
+  size_t vertexArrayChanges = 0;
+  size_t textureChanges = 0;
+  size_t uniformChanges = 0;
+};
+
+/*
+  The packets of one frame. Keep it around between frames so its memory is reused.
+*/
+struct DrawBucket
+{
+  std::vector<DrawPacket> packets;
+  // Sorted order of 'packets', filled by DrawBucketSort
+  std::vector<uint32_t> order;
+  // Scratch space for the radix sort
+  std::vector<uint64_t> keys;
+  std::vector<uint64_t> keysScratch;
+  std::vector<uint32_t> orderScratch;
+  DrawBucketStatistics statistics;
+};
+
+/*
+  Removes all packets (keeps the memory)
+*/
+void DrawBucketClear(DrawBucket& bucket);
+
+/*
+  Adds a draw. Its key must already be set.
+*/
+void DrawBucketPush(DrawBucket& bucket, const DrawPacket& packet);
+
+/*
+  Sorts the packets by key (LSD radix sort, 8 bits per pass, stable).
+  Passes where every key has the same byte are skipped.
+*/
+void DrawBucketSort(DrawBucket& bucket);
+
+/*
+  Records the sorted draws as render commands, changing program, vertex array, texture and
+  uniform range only when they differ from the previous draw
+*/
+void DrawBucketSubmit(DrawBucket& bucket);
+
+/*
+  Prints the statistics of the last DrawBucketSubmit to std::cout
+*/
+void DrawBucketPrintStatistics(const DrawBucket& bucket);
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef GLOOM_FRAME_PACING_HPP
+#define GLOOM_FRAME_PACING_HPP
+
+/*
+  Frame pacing
+
+  Without any pacing the main loop renders as many frames as it can: it keeps a core busy, and
+  the CPU runs frames ahead of the display, so what is on screen reacts to input that was read
+  several frames earlier. Frame pacing decides when the next frame starts:
+
+    Unlimited      As fast as possible (what headless benchmarks want)
+    VSync          Swap interval 1, the swap waits for the display's refresh
+    AdaptiveVSync  Swap interval -1, waits like VSync, but a late frame is shown right away
+                   (tearing instead of a whole frame of stutter)
+    Limiter        A fixed rate without help from the display: sleeps until shortly before the
+                   next frame is due, then spins the rest, since sleeps can wake up late
+    LowLatency     VSync (where available), but caps how many frames the GPU may have queued:
+                   a fence (glFenceSync) after every frame, and before the next one starts we wait
+                   until the GPU is done with all but maxQueuedFrames of them. So the input of the
+                   next frame is read as late as possible instead of frames piling up in the driver.
+                   With a render thread, the thread reading input also waits until all but
+                   maxQueuedFrames of its frames were presented, instead of running ahead by
+                   kRenderThreadMaxFramesInFlight.
+
+  Every mode measures the input-to-present latency: from reading the input of a frame to its
+  swap returning, and to the GPU having finished the frame (seen through the fences).
+
+  Threads: FramePacingBeginFrame is called by the thread that reads input, right before it
+  does. FramePacingFramePresented is called after the swap, on the thread that owns the
+  context. With a render thread these are different threads.
+
+  e.g.
+    FramePacingInitialize(settings, callbacks);
+    while (!gQuit)
+    {
+      FramePacingBeginFrame();
+      Input();
+      ...
+      SDL_GL_SwapWindow(window);
+      FramePacingFramePresented();
+    }
+    FramePacingShutdown();
+*/
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <functional>
+#include <string>
+
+enum class FramePacingMode
+{
+  Unlimited,
+  VSync,
+  AdaptiveVSync,
+  Limiter,
+  LowLatency
+};
+
+// Frames whose input time we remember, more than can ever be in flight
+const int kFramePacingHistory = 8;
+
+struct FramePacingSettings
+{
+  FramePacingMode mode = FramePacingMode::Unlimited;
+  // Frames per second of the Limiter, and of VSync when there is no display to sync to
+  double targetFramesPerSecond = 60.0;
+  // LowLatency: frames the GPU may still be working on when the next one starts (0 to 3)
+  int maxQueuedFrames = 1;
+};
+
+struct FramePacingCallbacks
+{
+  // Sets the swap interval (e.g. SDL_GL_SetSwapInterval), returns false if it is not supported.
+  // Without it, VSync and AdaptiveVSync fall back to the Limiter.
+  std::function<bool(int interval)> setSwapInterval;
+};
+
+/*
+  Sets the swap interval for the mode. Call on the thread that owns the context.
+
+  @return the mode that is in effect, which differs from settings.mode after a fallback
+*/
+FramePacingMode FramePacingInitialize(const FramePacingSettings& settings, const FramePacingCallbacks& callbacks);
+
+/*
+  Deletes the fences. Call on the thread that owns the context.
+*/
+void FramePacingShutdown();
+
+/*
+  Waits until the next frame is due (Limiter) or until enough earlier frames were presented (LowLatency),
+  and remembers when its input is read
+*/
+void FramePacingBeginFrame();
+
+/*
+  Measures the latency of the frame that was just presented, and in LowLatency mode waits
+  until the GPU caught up to maxQueuedFrames
+*/
+void FramePacingFramePresented();
+
+/*
+  Converts names given on the command line: unlimited, vsync, adaptive, limiter, low-latency
+
+  @return false if the name is unknown
+*/
+bool FramePacingParseMode(const std::string& name, FramePacingMode& mode);
+
+const char* FramePacingModeName(FramePacingMode mode);
+
+struct FramePacingStatistics
+{
+  size_t frames = 0;
+  // Input to the swap returning
+  double presentLatencyMilliseconds = 0.0;
+  double presentLatencyMaxMilliseconds = 0.0;
+  // Input to the GPU finishing the frame, for the frames whose fence we saw signaled
+  size_t completedFrames = 0;
+  double completionLatencyMilliseconds = 0.0;
+  double completionLatencyMaxMilliseconds = 0.0;
+  // Limiter
+  double sleepMilliseconds = 0.0;
+  double spinMilliseconds = 0.0;
+  // LowLatency
+  size_t fenceWaits = 0;
+  double fenceWaitMilliseconds = 0.0;
+  // LowLatency with a render thread: the thread reading input waiting for frames to be presented
+  size_t presentWaits = 0;
+  double presentWaitMilliseconds = 0.0;
+};
+
+FramePacingStatistics FramePacingGetStatistics();
+
+/*
+  Prints the mode, the average and worst latencies and the time spent waiting to std::cout
+*/
+void FramePacingPrintStatistics();
+
+#endif
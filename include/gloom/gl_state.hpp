@@ -0,0 +1,77 @@
+#ifndef GLOOM_GL_STATE_HPP
+#define GLOOM_GL_STATE_HPP
+
+/*
+  OpenGL state cache
+
+  Every OpenGL call costs CPU time in the driver, even when it sets state to the value it
+  already has. These wrappers keep a shadow copy of the state we set and skip the driver call
+  when nothing would change. They also count how many calls were issued and how many were
+  skipped ('elided') in each frame.
+
+  The cache only knows about changes made through these functions. After changing state
+  directly with gl* calls (e.g. while setting up a VAO), call GLStateInvalidate so the next
+  call through the cache is always issued.
+
+  e.g.
+    GLStateDisable(GL_DEPTH_TEST);
+    GLStateUseProgram(gGraphicsPipelineShaderProgram);
+    GLStateBindVertexArray(gVertexArrayObject);
+*/
+
+#include <glad/glad.h>
+
+/*
+  Forgets all cached state, so the next call of every kind reaches the driver
+*/
+void GLStateInvalidate();
+
+// Wrappers for the matching gl* functions
+void GLStateEnable(GLenum capability);
+void GLStateDisable(GLenum capability);
+void GLStateViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void GLStateClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void GLStateUseProgram(GLuint program);
+void GLStateBindVertexArray(GLuint vertexArray);
+void GLStateBindBuffer(GLenum target, GLuint buffer);
+// Also binds the buffer to 'target' itself, like glBindBufferRange does
+void GLStateBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void GLStateBindFramebuffer(GLenum target, GLuint framebuffer);
+void GLStateBlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+void GLStateActiveTexture(GLenum textureUnit);
+void GLStateBindTexture(GLenum target, GLuint texture);
+
+/*
+  The binding the cache believes is current. Used by code that has to restore a binding.
+  @return the bound object, or 0 if nothing (or something unknown) is bound
+*/
+GLuint GLStateBoundBuffer(GLenum target);
+
+// Calls that reached the driver and calls that were skipped
+struct GLStateStatistics
+{
+  unsigned long long issued = 0;
+  unsigned long long elided = 0;
+};
+
+/*
+  Starts a new frame for the per frame counters
+*/
+void GLStateBeginFrame();
+
+/*
+  @return the counters of the last completed frame
+*/
+GLStateStatistics GLStateLastFrameStatistics();
+
+/*
+  @return the counters summed over all frames
+*/
+GLStateStatistics GLStateTotalStatistics();
+
+/*
+  Prints the totals and the average per frame
+*/
+void GLStatePrintStatistics();
+
+#endif
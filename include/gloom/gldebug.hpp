@@ -0,0 +1,67 @@
+#ifndef GLOOM_GLDEBUG_HPP
+#define GLOOM_GLDEBUG_HPP
+
+/*
+  OpenGL error reporting
+
+  Polling glGetError after every call forces the driver to synchronize, which is far too
+  expensive to leave on. Instead we let the driver tell us about problems:
+  with GL_KHR_debug (or GL_ARB_debug_output) the driver calls our callback whenever it
+  has something to report. The callback can run on any driver thread, so it only pushes
+  the message into a lock-free ring buffer. Once per frame GLDebugFlush drains the ring on
+  the render thread, drops repeats of messages we have already printed, and prints the rest.
+
+  Only when no debug callback is available do we fall back to glGetError, and even then
+  only every kGLDebugSampleInterval-th GLCheck actually calls it.
+
+  All of this is compiled out of release builds (-DNDEBUG), unless GLOOM_GL_DEBUG is
+  defined explicitly. GLCheck(x) then becomes plain x.
+*/
+
+#include <glad/glad.h>
+
+#if !defined(GLOOM_GL_DEBUG) && !defined(NDEBUG)
+#define GLOOM_GL_DEBUG 1
+#endif
+
+#if GLOOM_GL_DEBUG
+
+// In the glGetError fallback, only every Nth GLCheck polls for errors
+const int kGLDebugSampleInterval = 64;
+
+/*
+  Installs the debug callback if the context supports one, otherwise enables the
+  sampled glGetError fallback. Requires a current OpenGL context.
+*/
+void GLDebugInitialize();
+
+/*
+  Prints the messages that arrived since the last call. Call once per frame.
+*/
+void GLDebugFlush();
+
+/*
+  Flushes any remaining messages, removes the callback and prints how often each
+  message that was reported more than once was repeated.
+*/
+void GLDebugShutdown();
+
+/*
+  Called by GLCheck after every wrapped call. Does nothing while the debug callback is
+  active, otherwise polls glGetError every kGLDebugSampleInterval calls.
+*/
+void GLDebugCheckCall(const char* function, const char* file, int line);
+
+#define GLCheck(x) do { x; GLDebugCheckCall(#x, __FILE__, __LINE__); } while (0)
+
+#else
+
+inline void GLDebugInitialize() {}
+inline void GLDebugFlush() {}
+inline void GLDebugShutdown() {}
+
+#define GLCheck(x) do { x; } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef GLOOM_HEADLESS_HPP
+#define GLOOM_HEADLESS_HPP
+
+/*
+  Headless (offscreen) rendering support
+
+  On machines without a display (CI runners, render farm boxes) we cannot create an
+  SDL window. Instead we ask EGL for a 'surfaceless' OpenGL context, which needs no
+  window at all, and render into a framebuffer object (FBO) that we create ourselves.
+  With Mesa installed this works even without a GPU, in which case the software
+  rasterizer (llvmpipe) does all of the work.
+*/
+
+#include <glad/glad.h>
+
+/*
+  The offscreen render target that stands in for the window's default framebuffer.
+  It has a color attachment and a depth attachment of the requested size.
+*/
+struct HeadlessFramebuffer
+{
+  GLuint framebuffer = 0;
+  GLuint colorRenderbuffer = 0;
+  GLuint depthRenderbuffer = 0;
+  int width = 0;
+  int height = 0;
+};
+
+/*
+  Creates an EGL display and a surfaceless OpenGL core profile context of (at least)
+  the requested version, and makes it current on the calling thread.
+
+  @param majorVersion OpenGL major version e.g. 4
+  @param minorVersion OpenGL minor version e.g. 1
+  @return true if the context was created and made current
+*/
+bool CreateHeadlessContext(int majorVersion, int minorVersion);
+
+/*
+  Looks up an OpenGL function through EGL. Pass this to gladLoadGLLoader the same way
+  SDL_GL_GetProcAddress is passed in windowed mode.
+*/
+void* GetHeadlessProcAddress(const char* name);
+
+/*
+  Makes the headless context current on the calling thread, or releases it from the calling
+  thread (current = false). A context can only be current on one thread at a time.
+*/
+bool MakeHeadlessContextCurrent(bool current);
+
+/*
+  Releases the context and terminates the EGL display
+*/
+void DestroyHeadlessContext();
+
+/*
+  Creates the FBO we render into while headless. The FBO is left bound to GL_FRAMEBUFFER.
+
+  @return true if the framebuffer is complete
+*/
+bool CreateHeadlessFramebuffer(HeadlessFramebuffer& target, int width, int height);
+void DestroyHeadlessFramebuffer(HeadlessFramebuffer& target);
+
+#endif
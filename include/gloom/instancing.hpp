@@ -0,0 +1,83 @@
+#ifndef GLOOM_INSTANCING_HPP
+#define GLOOM_INSTANCING_HPP
+
+/*
+  Hardware instancing
+
+  Drawing many copies of the same mesh with one glDrawElements each costs a draw call
+  (and usually a uniform update) per copy, and the driver overhead of those calls quickly
+  limits us to a few ten thousand objects per frame.
+
+  Instead, everything that differs between the copies (here a translation, a scale and a
+  color) lives in a separate vertex buffer, the instance buffer. glVertexAttribDivisor(index, 1)
+  tells OpenGL to advance those attributes once per instance rather than once per vertex,
+  and a single glDrawElementsInstanced draws all copies.
+
+  The attribute locations match the instance inputs of shaders/vert.glsl.
+
+  e.g.
+    InstanceBuffer instances;
+    CreateInstanceBuffer(instances, gVertexArrayObject, 1000);
+    UpdateInstanceBuffer(instances, data.data(), data.size());
+    ...
+    glBindVertexArray(gVertexArrayObject);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, instances.count);
+*/
+
+#include <glad/glad.h>
+
+// Locations of the per instance attributes in shaders/vert.glsl
+const GLuint kInstanceTranslationScaleLocation = 2;
+const GLuint kInstanceColorLocation = 3;
+
+/*
+  The per instance attributes, 20 bytes each
+*/
+struct InstanceData
+{
+  // Added to every vertex position after scaling
+  GLfloat translation[3];
+  // Uniform scale of the mesh
+  GLfloat scale;
+  // Multiplied with the vertex colors, normalized (255 is 1.0)
+  GLubyte color[4];
+};
+
+struct InstanceBuffer
+{
+  GLuint buffer = 0;
+  // How many instances fit into the buffer
+  GLsizei capacity = 0;
+  // How many instances the last update stored
+  GLsizei count = 0;
+};
+
+/*
+  Creates the instance buffer and adds its attributes (with a divisor of 1) to a vertex array
+
+  @param instances The buffer to create
+  @param vertexArray The vertex array of the mesh that will be instanced
+  @param capacity Maximum number of instances
+*/
+void CreateInstanceBuffer(InstanceBuffer& instances, GLuint vertexArray, GLsizei capacity);
+
+/*
+  Replaces the contents of the instance buffer. The previous storage is orphaned first,
+  so we do not wait for draws that still read the old instances.
+
+  @param instances The buffer to update
+  @param data The instances to copy
+  @param count Number of instances, clamped to the capacity
+*/
+void UpdateInstanceBuffer(InstanceBuffer& instances, const InstanceData* data, GLsizei count);
+
+/*
+  Sets the per instance attributes used by draws that do not enable the instance buffer
+  (vertex arrays without one, or after DisableInstanceAttributes). This is how the
+  one draw call per object path passes each object's transform and color.
+*/
+void SetConstantInstanceAttributes(const InstanceData& instance);
+
+void DestroyInstanceBuffer(InstanceBuffer& instances);
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef GLOOM_JOB_SYSTEM_HPP
+#define GLOOM_JOB_SYSTEM_HPP
+
+/*
+  Job system
+
+  Splits the CPU work of a frame (simulation, culling, transform updates, command recording, ...)
+  into small jobs and runs them on a fixed set of worker threads, started once at startup.
+
+  Every thread (the main thread and each worker) owns a work-stealing deque
+  (see work_stealing_deque.hpp). A thread pushes the jobs it creates onto its own deque and
+  works through them newest first; a thread that has run out of jobs steals the oldest job of
+  another thread. So there is no central queue all threads fight over, and work spreads out
+  by itself. Workers that find nothing to do for a while go to sleep until new jobs arrive.
+
+  Jobs report to a JobCounter when they are done. JobWait on a counter returns once all jobs
+  counted by it have finished, and runs other jobs in the meantime instead of blocking;
+  that is also how one group of jobs is made to depend on another.
+
+  A Job is not copied: it has to stay alive until its counter says it finished.
+  Without JobSystemStart (or with 0 workers) every job simply runs on the spot.
+
+  e.g.
+    JobSystemStart(7);
+    ...
+    ParallelFor(objectCount, 1024, [&](size_t begin, size_t end) { ... objects begin to end ... });
+    ...
+    JobSystemStop();
+*/
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Jobs each thread can have waiting in its deque, more are run on the spot
+const size_t kJobDequeCapacity = 4096;
+
+/*
+  Counts the jobs of a group that have not finished yet
+*/
+struct JobCounter
+{
+  std::atomic<int> pending{0};
+};
+
+struct Job
+{
+  // The work: called with the job itself, so it can find its data and range
+  void (*function)(const Job& job) = nullptr;
+  void* data = nullptr;
+  // A range of items, for jobs that take a slice of a larger task
+  size_t begin = 0;
+  size_t end = 0;
+  // Decremented once the job finished, may be nullptr
+  JobCounter* counter = nullptr;
+};
+
+/*
+  Starts the worker threads. The calling thread becomes the job system's main thread:
+  only it and the workers may run or wait for jobs.
+
+  @param workerCount Threads to start besides the calling one, negative for one per remaining core
+*/
+void JobSystemStart(int workerCount = -1);
+
+/*
+  Stops and joins the workers. No jobs may be pending.
+*/
+void JobSystemStop();
+
+/*
+  @return the threads running jobs, workers and main thread (1 if the job system is not running)
+*/
+int JobSystemThreadCount();
+
+/*
+  Queues a job on the calling thread's deque, where it waits for this thread or a thief to run it.
+  Runs it right away if the job system is not running or the deque is full.
+
+  @param job Must stay alive until it has run (wait for its counter)
+*/
+void JobRun(Job& job);
+
+/*
+  Queues a group of jobs, all counted by the same counter
+*/
+void JobRun(Job* jobs, size_t count, JobCounter& counter);
+
+/*
+  Runs jobs (own ones first, then stolen ones) until every job counted by 'counter' has finished
+*/
+void JobWait(JobCounter& counter);
+
+/*
+  Calls function(begin, end) for slices of [0, count) of at least grainSize items,
+  in parallel, and returns when all slices are done.
+
+  @param count Number of items
+  @param grainSize Fewest items worth a job of their own, the smaller the better the
+                   load balancing but the higher the overhead
+  @param function Called as function(size_t begin, size_t end), from any of the threads
+*/
+template <typename Function>
+void ParallelFor(size_t count, size_t grainSize, const Function& function)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  // A few slices per thread, so threads that finish early can steal from the others
+  size_t threads = (size_t)JobSystemThreadCount();
+  size_t sliceSize = (count + threads * 4 - 1) / (threads * 4);
+  if (sliceSize < grainSize)
+  {
+    sliceSize = grainSize;
+  }
+  size_t sliceCount = (count + sliceSize - 1) / sliceSize;
+  if (threads == 1 || sliceCount == 1)
+  {
+    function((size_t)0, count);
+    return;
+  }
+
+  std::vector<Job> jobs(sliceCount);
+  for (size_t slice = 0; slice < sliceCount; ++slice)
+  {
+    jobs[slice].function = [](const Job& job) { (*static_cast<const Function*>(job.data))(job.begin, job.end); };
+    jobs[slice].data = const_cast<Function*>(&function);
+    jobs[slice].begin = slice * sliceSize;
+    jobs[slice].end = slice + 1 == sliceCount ? count : (slice + 1) * sliceSize;
+  }
+
+  JobCounter counter;
+  JobRun(jobs.data(), sliceCount, counter);
+  JobWait(counter);
+}
+
+struct JobSystemStatistics
+{
+  // Jobs run, and how many of them were stolen from another thread's deque
+  unsigned long long jobs = 0;
+  unsigned long long steals = 0;
+  // Jobs that did not fit in a full deque and ran on the spot
+  unsigned long long overflows = 0;
+  // Times a worker went to sleep for lack of work
+  unsigned long long sleeps = 0;
+};
+
+/*
+  @return the totals over all threads since JobSystemStart
+*/
+JobSystemStatistics GetJobSystemStatistics();
+
+/*
+  Prints how many jobs ran on each thread and how many were stolen
+*/
+void JobSystemPrintStatistics();
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef GLOOM_MESH_HPP
+#define GLOOM_MESH_HPP
+
+/*
+  Binary meshes
+
+  Meshes are stored in a small binary container that mirrors how OpenGL wants the data,
+  so loading one is: map the file, check the header, and hand the vertex and index streams
+  straight to glBufferData. Nothing is parsed and nothing is copied on the CPU.
+
+  File layout (little endian, every stream starts at a multiple of kMeshStreamAlignment):
+    MeshFileHeader   magic "GLMS", version, counts, where the streams are and the vertex layout
+    vertex stream    vertexCount interleaved vertices of vertexStride bytes, exactly as
+                     described by the attributes (what glVertexAttribPointer gets)
+    index stream     indexCount indices of indexSize (2 or 4) bytes
+
+  Text formats such as Wavefront OBJ are converted offline with tools/mesh_convert.cpp.
+
+  e.g.
+    Mesh mesh;
+    if (LoadMesh("./meshes/quad.mesh", mesh))
+    {
+      glBindVertexArray(mesh.vertexArray);
+      glDrawElements(GL_TRIANGLES, mesh.indexCount, mesh.indexType, 0);
+    }
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const char kMeshMagic[4] = { 'G', 'L', 'M', 'S' };
+// Increase whenever the layout of the file changes, older files are then rejected
+const uint32_t kMeshVersion = 1;
+const int kMeshMaxAttributes = 8;
+const size_t kMeshStreamAlignment = 16;
+
+/*
+  One vertex attribute, the arguments of glVertexAttribPointer
+*/
+struct MeshAttribute
+{
+  // Matches layout(location=...) in the vertex shader
+  uint32_t location;
+  // 1 to 4
+  uint32_t components;
+  // GL_FLOAT, GL_HALF_FLOAT, GL_UNSIGNED_BYTE, ...
+  uint32_t type;
+  // Non zero if integer data is normalized to [0, 1] or [-1, 1]
+  uint32_t normalized;
+  // Byte offset within a vertex
+  uint32_t offset;
+};
+
+struct alignas(16) MeshFileHeader
+{
+  char magic[4];
+  uint32_t version;
+  // sizeof(MeshFileHeader) when the file was written
+  uint32_t headerSize;
+  uint32_t vertexCount;
+  uint32_t vertexStride;
+  uint32_t indexCount;
+  // 2 (GL_UNSIGNED_SHORT) or 4 (GL_UNSIGNED_INT)
+  uint32_t indexSize;
+  uint32_t attributeCount;
+  // Byte offsets of the streams from the start of the file
+  uint64_t vertexOffset;
+  uint64_t indexOffset;
+  MeshAttribute attributes[kMeshMaxAttributes];
+};
+static_assert(sizeof(MeshFileHeader) % kMeshStreamAlignment == 0, "streams must stay aligned");
+
+/*
+  A mesh on the CPU, as produced by converters and tools
+*/
+struct MeshData
+{
+  std::vector<MeshAttribute> attributes;
+  uint32_t vertexStride = 0;
+  // vertexCount * vertexStride bytes, interleaved
+  std::vector<uint8_t> vertices;
+  std::vector<uint32_t> indices;
+
+  uint32_t VertexCount() const { return vertexStride == 0 ? 0 : (uint32_t)(vertices.size() / vertexStride); }
+};
+
+/*
+  A mesh on the GPU
+*/
+struct Mesh
+{
+  // Vertex Array Object (VAO)
+  // Vertex array objects encapsulate all of the items needed to render an object.
+  // Here that is the vertex buffer with its attribute layout and the index buffer.
+  GLuint vertexArray = 0;
+  // Vertex Buffer Object (VBO)
+  // Stores the vertices (e.g. positions, colors) of the mesh on the GPU
+  GLuint vertexBuffer = 0;
+  // Index Buffer Object (IBO)
+  // Stores the indices we draw from when we do indexed drawing
+  GLuint indexBuffer = 0;
+  GLsizei vertexCount = 0;
+  GLsizei indexCount = 0;
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  GLenum indexType = GL_UNSIGNED_INT;
+};
+
+/*
+  Writes a mesh file. Indices are stored as 16 bit values if every vertex can be reached with them.
+
+  @param filename Path of the file to write
+  @param mesh The mesh, with at most kMeshMaxAttributes attributes
+  @return true if the file was written
+*/
+bool WriteMeshFile(const std::string& filename, const MeshData& mesh);
+
+/*
+  Loads a mesh file and uploads it into a new vertex array, vertex buffer and index buffer.
+  Like the rest of our setup code it calls OpenGL directly, bypassing the GL state cache,
+  and leaves no vertex array bound.
+
+  @param filename Path of the mesh file
+  @param mesh Receives the OpenGL objects
+  @return true if the file was valid and uploaded
+*/
+bool LoadMesh(const std::string& filename, Mesh& mesh);
+
+void DestroyMesh(Mesh& mesh);
+
+/*
+  Parses a Wavefront OBJ file into our vertex layout: position (location 0, 3 floats) and color
+  (location 1, 3 floats). Colors come from the common "v x y z r g b" extension and default to
+  white. Faces are triangulated as fans. Texture coordinates and normals are ignored.
+  Defined in mesh_obj.cpp.
+
+  @param text Contents of the OBJ file
+  @param mesh Receives the vertices and indices
+  @return true if the text was valid
+*/
+bool ParseObjMesh(std::string_view text, MeshData& mesh);
+
+#endif
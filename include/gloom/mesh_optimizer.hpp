@@ -0,0 +1,92 @@
+#ifndef GLOOM_MESH_OPTIMIZER_HPP
+#define GLOOM_MESH_OPTIMIZER_HPP
+
+/*
+  Mesh optimization
+
+  The order of a mesh's triangles and vertices does not change what is drawn, but it changes
+  how much work the GPU does to draw it. We reorder offline, before the mesh is written
+  (see tools/mesh_convert.cpp), in three passes:
+
+  1. Vertex cache: the GPU keeps the last few transformed vertices in a small cache, a triangle
+     whose vertices are still there skips the vertex shader for them. OptimizeVertexCache
+     reorders triangles with Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", so
+     neighbouring triangles are drawn together.
+  2. Overdraw: pixels hidden behind ones drawn earlier are rejected by the depth test before
+     shading. OptimizeOverdraw cuts the cache optimized order into clusters where the cache was
+     cold anyway, and sorts the clusters so ones facing outwards are drawn first (as in Sander,
+     Nehab and Barczak's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+  3. Vertex fetch: OptimizeVertexFetch stores the vertices in the order the triangles first use
+     them, so the GPU reads the vertex buffer front to back instead of jumping around.
+
+  Progress is measured with the usual numbers for a FIFO cache of kVertexCacheAnalyzeSize:
+    ACMR  average cache miss ratio, transformed vertices per triangle (0.5 is ideal for a grid, 3 the worst)
+    ATVR  average transformed vertex ratio, transformed vertices per vertex (1.0 is ideal)
+
+  e.g.
+    VertexCacheStatistics before = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+    OptimizeMesh(mesh);
+    VertexCacheStatistics after = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+*/
+
+#include <gloom/mesh.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstdint>
+#include <vector>
+
+// Cache size Forsyth's scoring assumes
+const int kVertexCacheOptimizeSize = 32;
+// Cache size of the FIFO cache we simulate to report ACMR/ATVR, typical of real hardware
+const int kVertexCacheAnalyzeSize = 16;
+
+struct VertexCacheStatistics
+{
+  // Vertices the simulated cache had to transform
+  uint32_t misses = 0;
+  float acmr = 0.0f;
+  float atvr = 0.0f;
+};
+
+/*
+  Simulates a FIFO post-transform cache
+
+  @param indices Triangle list
+  @param vertexCount Number of vertices the indices refer to
+  @param cacheSize Entries in the simulated cache
+*/
+VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount,
+					 int cacheSize = kVertexCacheAnalyzeSize);
+
+/*
+  Reorders the triangles of a triangle list for the post-transform vertex cache (Forsyth)
+
+  @param indices Triangle list, reordered in place
+  @param vertexCount Number of vertices the indices refer to
+*/
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+/*
+  Reorders clusters of triangles so outward facing ones are drawn first. Run after
+  OptimizeVertexCache, the clusters keep their order inside so the cache efficiency stays.
+
+  @param mesh A mesh whose position (location 0) is stored as floats
+  @return false if the mesh has no float positions
+*/
+bool OptimizeOverdraw(MeshData& mesh);
+
+/*
+  Reorders the vertices in the order the triangles first use them, and drops unused ones
+
+  @param mesh The mesh, its vertices and indices are rewritten
+*/
+void OptimizeVertexFetch(MeshData& mesh);
+
+/*
+  All of the above, in the right order
+
+  @return false if the overdraw pass was skipped (no float positions)
+*/
+bool OptimizeMesh(MeshData& mesh);
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef GLOOM_PARTICLE_SYSTEM_HPP
+#define GLOOM_PARTICLE_SYSTEM_HPP
+
+/*
+  Particle systems
+
+  Emitters spawn particles at a steady rate, and every frame each particle falls under gravity,
+  ages, and is drawn as an instance of a small quad until its life runs out.
+
+  Simulation: particles are kept as a structure of arrays (all x positions together, all ages
+  together, ...) like the bounds in culling.hpp. Every array is made of glm::aligned_vec4, four
+  particles' values in one 16 byte aligned group, so integration loads and stores whole groups
+  with SSE (through GLM's SIMD layer), or two groups at a time with AVX when compiled with -mavx
+  (or -march=native). GLM only has aligned types when GLM_FORCE_INTRINSICS is defined before it
+  is first included, so the arrays (ParticleArrays) are only defined in particle_system.cpp.
+
+  Culling and spawning: particles are split into chunks of kParticleChunkSize, which the job
+  system (see job_system.hpp) integrates in parallel, counting the particles that live on. The
+  sum of the counts of the chunks before it tells every chunk where its particles go, so the
+  chunks then copy them, in order (a stable compaction), into a second set of arrays, again in
+  parallel. The two sets swap roles every update. New particles are appended at the end, so a
+  particle's index only ever decreases and the draw order never changes from one frame to the next.
+
+  Drawing: the compaction writes every particle it copies as an InstanceData (see instancing.hpp)
+  into the frame's staging memory, which is copied into a stream buffer (see stream_buffer.hpp) on the
+  thread that owns the context, like the sprite batch does. Each region of the stream buffer has
+  a vertex array of its own, with the instance attributes pointing at that region, so the
+  particles are one glDrawElementsInstanced of a quad with shaders/vert.glsl.
+
+  e.g.
+    CreateParticleSystem(gParticles, 100000);
+    ParticleEmitter fountain;
+    fountain.rate = 5000.0f;
+    ParticleSystemAddEmitter(gParticles, fountain);
+    ...
+    ParticleSystemUpdate(gParticles, deltaTime);
+    ParticleSystemUpload(gParticles);
+    ... draw ParticleSystemDrawPacket(gParticles) ...
+    ParticleSystemEndFrame(gParticles);
+*/
+
+#include <gloom/draw_bucket.hpp>
+#include <gloom/instancing.hpp>
+#include <gloom/stream_buffer.hpp>
+
+// Third Party Libraries
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Particles per job of the simulation, a multiple of 8 so every chunk starts a whole AVX group
+const size_t kParticleChunkSize = 4096;
+
+struct ParticleEmitter
+{
+  glm::vec3 position = glm::vec3(0.0f);
+  // Mean velocity of new particles, plus up to spread in either direction along each axis
+  glm::vec3 velocity = glm::vec3(0.0f, 1.0f, 0.0f);
+  glm::vec3 spread = glm::vec3(0.2f, 0.2f, 0.0f);
+  // Particles per second
+  float rate = 1000.0f;
+  // Seconds a particle lives, plus up to lifetimeSpread
+  float lifetime = 1.0f;
+  float lifetimeSpread = 0.5f;
+  // Size when spawned, particles shrink to nothing over their lifetime
+  float size = 0.02f;
+  // Color of new particles, each channel varied by up to colorSpread
+  glm::vec4 color = glm::vec4(1.0f, 0.6f, 0.2f, 1.0f);
+  float colorSpread = 0.2f;
+  // Fraction of a particle owed from previous frames
+  float accumulator = 0.0f;
+};
+
+struct ParticleStatistics
+{
+  size_t updates = 0;
+  size_t spawned = 0;
+  size_t died = 0;
+  // Particles that were not spawned because the system was full
+  size_t dropped = 0;
+  // Particles simulated over all updates, and the time it took
+  size_t simulated = 0;
+  double simulateMilliseconds = 0.0;
+};
+
+struct ParticleSystem;
+// The particles' structure of arrays, see particle_system.cpp
+struct ParticleArrays;
+
+// What ParticleSystemUpload asks the context's thread to copy
+struct ParticleUpload
+{
+  ParticleSystem* system = nullptr;
+  int region = 0;
+  size_t count = 0;
+};
+
+struct ParticleSystem
+{
+  size_t maxParticles = 0;
+  // Particles alive, the first 'count' of every array
+  size_t count = 0;
+  glm::vec3 gravity = glm::vec3(0.0f, -1.0f, 0.0f);
+  std::vector<ParticleEmitter> emitters;
+
+  // Two sets of arrays, created by CreateParticleSystem and deleted by DestroyParticleSystem
+  ParticleArrays* particles = nullptr;
+  // Particles alive in every chunk after integrating it, then where they go in the compacted arrays
+  std::vector<size_t> chunkOffsets;
+
+  // The frames' instances while they are written, copied into the stream buffer region with the same index
+  StreamBuffer stream;
+  std::vector<InstanceData> staging[kStreamBufferRegions];
+  ParticleUpload uploads[kStreamBufferRegions];
+  // A quad (positions and white vertex colors) and its indices, shared by all regions
+  GLuint quadBuffer = 0;
+  GLuint indexBuffer = 0;
+  // One per region, with the instance attributes at the start of the region
+  GLuint vertexArrays[kStreamBufferRegions] = {};
+  // Region of the frame being simulated
+  int region = kStreamBufferRegions - 1;
+  // State of the random number generator for new particles
+  uint32_t random = 12345;
+  ParticleStatistics statistics;
+};
+
+/*
+  Allocates the particle arrays, and the stream buffer, quad and vertex arrays on the thread that
+  owns the context. Leaves the vertex array and buffer bindings changed, and the GL state cache invalidated.
+
+  @param maxParticles Particles alive at the same time, rounded up to a whole chunk
+  @param createBuffers false for a simulation without OpenGL (e.g. a benchmark), the instances are
+                       still written but ParticleSystemUpload and ParticleSystemEndFrame may not be called
+  @return true if the buffers were created
+*/
+bool CreateParticleSystem(ParticleSystem& system, size_t maxParticles, bool createBuffers = true);
+
+/*
+  @return the index of the new emitter in system.emitters
+*/
+size_t ParticleSystemAddEmitter(ParticleSystem& system, const ParticleEmitter& emitter);
+
+/*
+  Moves every particle on by deltaTime, removes the ones whose life ran out, spawns new ones and
+  writes the instances of the frame. Spreads the work over the job system's threads.
+
+  @param deltaTime Seconds since the last update
+*/
+void ParticleSystemUpdate(ParticleSystem& system, float deltaTime);
+
+/*
+  Records the copy of the last update's instances into the stream buffer. Call once per frame, before the draw,
+  also when no particle is alive or the draw is skipped, the stream buffer's regions follow the updates.
+*/
+void ParticleSystemUpload(ParticleSystem& system);
+
+/*
+  @return a draw of the particles (vertex array, indices and instance count) for the draw bucket,
+          the caller fills in the key, program, texture and uniforms
+*/
+DrawPacket ParticleSystemDrawPacket(const ParticleSystem& system);
+
+/*
+  Records the fence of the frame's region. Call once per frame after the draw was recorded, or would have been.
+*/
+void ParticleSystemEndFrame(ParticleSystem& system);
+
+void DestroyParticleSystem(ParticleSystem& system);
+
+/*
+  @return "AVX (8 particles)", "SSE (4 particles)" or "scalar", whatever the integration uses
+*/
+const char* ParticleInstructionSet();
+
+/*
+  Prints particles alive, spawned and culled per update, and the simulation time per particle
+*/
+void ParticleSystemPrintStatistics(const ParticleSystem& system);
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef GLOOM_PROFILER_HPP
+#define GLOOM_PROFILER_HPP
+
+/*
+  Frame profiler
+
+  Measures how long each phase of a frame takes on the CPU and on the GPU, so we can tell
+  whether we are CPU-bound, GPU-bound or stalled waiting on the swap.
+
+  CPU time is measured with std::chrono around each phase.
+  GPU time is measured with GL_TIMESTAMP queries (glQueryCounter). The GPU runs a few frames
+  behind the CPU, so every frame gets its own set of queries and we only read them back
+  kProfilerFramesInFlight frames later, after checking GL_QUERY_RESULT_AVAILABLE.
+  That way reading the results never makes the CPU wait for the GPU.
+
+  e.g.
+    ProfilerBeginFrame();
+    {
+      ProfileScope scope(FramePhase::Draw);
+      Draw();
+    }
+    ProfilerEndFrame();
+*/
+
+#include <string>
+
+// The phases of a frame in MainLoop that we time
+enum class FramePhase
+{
+  Input,
+  Update,
+  PreDraw,
+  Draw,
+  Swap,
+  Count
+};
+
+// How many frames of queries we keep in flight before reading them back
+const int kProfilerFramesInFlight = 3;
+
+/*
+  Creates the timer queries. Requires a current OpenGL context.
+*/
+void ProfilerInitialize();
+
+/*
+  Deletes the timer queries. Requires a current OpenGL context.
+*/
+void ProfilerShutdown();
+
+/*
+  Marks the beginning and the end of a frame.
+  ProfilerBeginFrame also collects the GPU results of older frames that are ready.
+*/
+void ProfilerBeginFrame();
+void ProfilerEndFrame();
+
+/*
+  Marks the beginning and the end of a phase within the current frame.
+  Prefer ProfileScope, which can not forget the end.
+*/
+void ProfilerBeginPhase(FramePhase phase);
+void ProfilerEndPhase(FramePhase phase);
+
+/*
+  Times everything from its construction until the end of the enclosing scope
+*/
+struct ProfileScope
+{
+  explicit ProfileScope(FramePhase phase) : mPhase(phase) { ProfilerBeginPhase(phase); }
+  ~ProfileScope() { ProfilerEndPhase(mPhase); }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  FramePhase mPhase;
+};
+
+// Times of a single frame in milliseconds, for showing them while the program runs
+struct ProfilerFrameTimes
+{
+  // Index of the frame, -1 if no frame has GPU times yet
+  long long frame = -1;
+  double cpuFrame = 0.0;
+  double gpuFrame = 0.0;
+  double cpuPhase[static_cast<int>(FramePhase::Count)] = {};
+  double gpuPhase[static_cast<int>(FramePhase::Count)] = {};
+  // Phases can be skipped (e.g. there is no input to handle when headless)
+  bool timed[static_cast<int>(FramePhase::Count)] = {};
+};
+
+/*
+  Gets the newest frame whose GPU times have been read back, usually kProfilerFramesInFlight
+  frames old. Can be called from any thread, e.g. the main thread while the render thread
+  owns the profiler.
+
+  @return false if there is no such frame yet
+*/
+bool ProfilerLatestFrame(ProfilerFrameTimes& times);
+
+/*
+  @return the name of a phase, as in the summary and the trace
+*/
+const char* ProfilerPhaseName(FramePhase phase);
+
+/*
+  Prints p50/p99/max of the frame time and of every phase (CPU and GPU) to std::cout
+*/
+void ProfilerPrintSummary();
+
+/*
+  Writes the same statistics as ProfilerPrintSummary as a JSON document
+
+  @param filename Path of the file to write
+  @return true if the file was written
+*/
+bool ProfilerWriteJSON(const std::string& filename);
+
+/*
+  Writes the recent frames in the Chrome trace event format.
+  Open the file in chrome://tracing or https://ui.perfetto.dev
+  CPU phases show up on one track and GPU phases on another.
+
+  @param filename Path of the file to write
+  @return true if the file was written
+*/
+bool ProfilerWriteChromeTrace(const std::string& filename);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef GLOOM_PROGRAM_CACHE_HPP
+#define GLOOM_PROGRAM_CACHE_HPP
+
+/*
+  On-disk cache of linked shader programs
+
+  Compiling and linking shaders is the most expensive part of starting up. Since OpenGL 4.1
+  we can ask the driver for the linked program as an opaque binary blob (glGetProgramBinary)
+  and hand it back on the next launch (glProgramBinary), skipping the compiler entirely.
+
+  The blob is only valid for the exact same driver, so the cache key is a hash of the
+  shader sources together with GL_RENDERER and GL_VERSION. Drivers may still reject a
+  binary (e.g. after an update that kept the version string), in which case
+  ProgramCacheLoad reports a miss and the caller compiles from source as usual.
+
+  e.g.
+    uint64_t key = ProgramCacheKey({ vertexSource, fragmentSource });
+    GLuint program = ProgramCacheLoad(key);
+    if (program == 0)
+    {
+      program = ... compile and link with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set ...
+      ProgramCacheStore(key, program, compileMilliseconds);
+    }
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+/*
+  Enables the cache. Requires a current OpenGL context, since the driver identity is part of the key.
+  If the driver supports no binary formats the cache stays disabled and every load is a miss.
+
+  @param directory Where the binaries are stored, created if it does not exist
+*/
+void ProgramCacheInitialize(const std::string& directory);
+
+/*
+  @return true if the driver can give us program binaries
+*/
+bool ProgramCacheEnabled();
+
+/*
+  Computes the cache key for a program made of the given shader sources
+
+  @param sources The sources of every stage, in a fixed order (e.g. vertex, fragment)
+  @return 64-bit hash of the sources and the driver identity
+*/
+uint64_t ProgramCacheKey(std::initializer_list<std::string_view> sources);
+
+/*
+  Creates a program from a cached binary
+
+  @param key Value returned by ProgramCacheKey
+  @return id of a linked program object, or 0 if there is no usable binary
+*/
+GLuint ProgramCacheLoad(uint64_t key);
+
+/*
+  Writes the binary of a linked program to the cache.
+  The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set to GL_TRUE.
+
+  @param key Value returned by ProgramCacheKey
+  @param program A successfully linked program object
+  @param compileMilliseconds How long compiling and linking took, used to report the time saved on later hits
+*/
+void ProgramCacheStore(uint64_t key, GLuint program, double compileMilliseconds);
+
+/*
+  Prints hits, misses, rejected binaries and the estimated compile time saved
+*/
+void ProgramCachePrintStatistics();
+
+#endif
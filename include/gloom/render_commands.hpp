@@ -0,0 +1,102 @@
+#ifndef GLOOM_RENDER_COMMANDS_HPP
+#define GLOOM_RENDER_COMMANDS_HPP
+
+/*
+  Render commands
+
+  Instead of calling OpenGL directly, per frame rendering code records small command
+  packets through the Render* functions below. When the render thread is running
+  (see render_thread.hpp) the packets are queued for it, which lets the simulation of the
+  next frame overlap with rendering this one. Otherwise they are executed right away.
+
+  Commands go through the GL state cache when they are executed, so redundant state
+  changes are still skipped.
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <cstdint>
+
+enum class RenderCommandType : uint8_t
+{
+  Enable,
+  Disable,
+  Viewport,
+  ClearColor,
+  Clear,
+  BlendFunc,
+  UseProgram,
+  BindVertexArray,
+  BindBuffer,
+  BindBufferRange,
+  BindTexture,
+  DrawElements,
+  DrawElementsInstanced,
+  DrawElementsBaseVertex,
+  // Calls a function on the thread that owns the context
+  Call,
+  // Marks the end of a frame, the render thread presents it
+  EndFrame
+};
+
+/*
+  A single recorded OpenGL call. Which fields are used depends on the type.
+*/
+struct RenderCommand
+{
+  RenderCommandType type = RenderCommandType::EndFrame;
+  // Capability, buffer or texture target, primitive mode, clear mask or blend source factor
+  GLenum enumValue = 0;
+  // Program, vertex array, buffer or texture
+  GLuint name = 0;
+  // Viewport rectangle, texture unit, binding index of a buffer range,
+  // or index count, index type and instance count (or base vertex) of a draw,
+  // or the blend destination factor
+  GLint integers[4] = {};
+  // Byte offset and size of a buffer range, or byte offset into the index buffer of a draw.
+  // Pointer sized, buffers may be larger than 2 GiB.
+  GLintptr offset = 0;
+  GLsizeiptr size = 0;
+  // Clear color
+  GLfloat floats[4] = {};
+  // Function and argument of a Call
+  void (*function)(void* data) = nullptr;
+  void* data = nullptr;
+};
+
+/*
+  Performs the OpenGL call a command stands for. Must run on the thread that owns the context.
+*/
+void ExecuteRenderCommand(const RenderCommand& command);
+
+/*
+  Hands a command to the render thread, or executes it right away if there is none.
+  Defined in render_thread.cpp.
+*/
+void RenderSubmit(const RenderCommand& command);
+
+// Recording helpers, one per command type
+void RenderEnable(GLenum capability);
+void RenderDisable(GLenum capability);
+void RenderViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void RenderClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void RenderClear(GLbitfield mask);
+void RenderBlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+void RenderUseProgram(GLuint program);
+void RenderBindVertexArray(GLuint vertexArray);
+void RenderBindBuffer(GLenum target, GLuint buffer);
+void RenderBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void RenderBindTexture(GLuint unit, GLenum target, GLuint texture);
+void RenderDrawElements(GLenum mode, GLsizei count, GLenum type, GLintptr offset);
+void RenderDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instanceCount);
+void RenderDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLint baseVertex);
+
+/*
+  Calls function(data) where the commands are executed, for work that needs the OpenGL context
+  but is more than a single call (e.g. uploading the data recorded for a frame).
+  'data' has to stay valid until the command was executed.
+*/
+void RenderCall(void (*function)(void* data), void* data);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef GLOOM_RENDER_THREAD_HPP
+#define GLOOM_RENDER_THREAD_HPP
+
+/*
+  Render thread
+
+  Normally input, simulation and every OpenGL call run one after another on the main thread,
+  so their costs add up. With the render thread, the OpenGL context belongs to a dedicated
+  thread that executes the command packets recorded by the main (simulation) thread.
+  The packets travel through a single-producer/single-consumer lock-free ring
+  (see spsc_ring.hpp), so while the render thread draws frame N, the main thread is
+  already simulating frame N+1.
+
+  The main thread may run at most kRenderThreadMaxFramesInFlight frames ahead of the
+  render thread, which bounds the added latency.
+
+  e.g.
+    // Release the context on the main thread first
+    RenderThreadStart(callbacks);
+    while (!gQuit)
+    {
+      Input();
+      Update();
+      RenderClear(...);        // recorded, not executed
+      RenderDrawElements(...);
+      RenderThreadEndFrame();
+    }
+    RenderThreadStop();
+*/
+
+#include <gloom/render_commands.hpp>
+
+// C++ Standard Template Library (STL)
+#include <functional>
+
+// How many frames the simulation may be ahead of the render thread
+const int kRenderThreadMaxFramesInFlight = 2;
+
+// Hooks the application provides, all of them are called on the render thread
+struct RenderThreadCallbacks
+{
+  // Makes the OpenGL context current on the render thread (called once at start)
+  std::function<void()> acquireContext;
+  // Releases the context again before the render thread exits
+  std::function<void()> releaseContext;
+  // Called before the first command of every frame
+  std::function<void()> beginFrame;
+  // Called when the frame's EndFrame command arrives, e.g. to swap buffers
+  std::function<void()> endFrame;
+};
+
+/*
+  Starts the render thread. The OpenGL context must not be current on any other thread.
+*/
+void RenderThreadStart(const RenderThreadCallbacks& callbacks);
+
+/*
+  Finishes recording the current frame. Blocks if the render thread is
+  kRenderThreadMaxFramesInFlight frames behind.
+*/
+void RenderThreadEndFrame();
+
+/*
+  Waits until every recorded frame has been rendered, then stops and joins the render thread.
+  Afterwards the context can be made current on the calling thread again.
+*/
+void RenderThreadStop();
+
+/*
+  @return true between RenderThreadStart and RenderThreadStop
+*/
+bool RenderThreadRunning();
+
+/*
+  Prints how often and how long the main thread had to wait for the render thread
+*/
+void RenderThreadPrintStatistics();
+
+#endif
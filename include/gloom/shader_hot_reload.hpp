@@ -0,0 +1,68 @@
+#ifndef GLOOM_SHADER_HOT_RELOAD_HPP
+#define GLOOM_SHADER_HOT_RELOAD_HPP
+
+/*
+  Shader hot reloading
+
+  A watcher thread uses inotify to notice when a shader file in the watched directory is
+  saved. It loads the new sources right there, off the render thread, and skips files whose
+  contents did not actually change (editors often write a file several times per save).
+
+  The render thread calls ShaderHotReloadUpdate between frames. It hands new sources to the
+  shader manager, which compiles them in the background, and only once the new program has
+  linked does it replace the program the application uses. If compiling fails, the errors
+  are printed and the previous program stays in use. A replaced program is only deleted a few
+  frames later, once the frames the render thread recorded with it have been executed.
+
+  e.g.
+    ShaderHotReloadWatch("graphics pipeline", "./shaders/vert.glsl", "./shaders/frag.glsl",
+                         handle, &gGraphicsPipelineShaderProgram);
+    ShaderHotReloadStart("./shaders");
+    while (!gQuit)
+    {
+      ShaderHotReloadUpdate();
+      ... draw a frame ...
+    }
+    ShaderHotReloadStop();
+*/
+
+#include <gloom/shader_manager.hpp>
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <string>
+
+/*
+  Registers a program to reload when one of its files changes. Call before ShaderHotReloadStart.
+
+  @param name Used in messages
+  @param vertexFilename Path of the vertex shader, must be inside the watched directory
+  @param fragmentFilename Path of the fragment shader, must be inside the watched directory
+  @param handle The shader manager handle of the program currently in use
+  @param program Where the application keeps the program id, replaced when a reload succeeds.
+                 It is atomic because other threads may read it while recording commands.
+*/
+void ShaderHotReloadWatch(const std::string& name, const std::string& vertexFilename,
+			  const std::string& fragmentFilename, ShaderProgramHandle handle,
+			  std::atomic<GLuint>* program);
+
+/*
+  Starts the watcher thread
+
+  @param directory Directory containing the watched shader files
+  @return true if the directory is being watched
+*/
+bool ShaderHotReloadStart(const std::string& directory);
+
+/*
+  Picks up reloaded sources and swaps in programs that finished compiling.
+  Call on the render thread between frames. Never waits for the compiler.
+*/
+void ShaderHotReloadUpdate();
+
+/*
+  Stops and joins the watcher thread
+*/
+void ShaderHotReloadStop();
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef GLOOM_SHADER_MANAGER_HPP
+#define GLOOM_SHADER_MANAGER_HPP
+
+/*
+  Shader manager
+
+  Asking for GL_COMPILE_STATUS or GL_LINK_STATUS right after glCompileShader/glLinkProgram
+  makes us wait for the compiler, one shader at a time. The shader manager instead submits
+  every compile and link up front, and only asks for the status once the program is
+  actually needed. In the meantime the driver can work on all of them at once.
+
+  With GL_KHR_parallel_shader_compile (or GL_ARB_parallel_shader_compile) we also tell
+  the driver to use as many compiler threads as it likes, and can ask whether a program
+  is done (GL_COMPLETION_STATUS_KHR) without blocking.
+
+  Programs come from the on-disk program cache when possible (see program_cache.hpp).
+
+  e.g.
+    ShaderProgramHandle a = ShaderManagerSubmit("a", vertexA, fragmentA);
+    ShaderProgramHandle b = ShaderManagerSubmit("b", vertexB, fragmentB);
+    ... other work while the driver compiles ...
+    GLuint programA = ShaderManagerGetProgram(a);
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <string>
+#include <string_view>
+
+// Identifies a submitted program, -1 is never a valid handle
+typedef int ShaderProgramHandle;
+const ShaderProgramHandle kInvalidShaderProgram = -1;
+
+/*
+  Enables parallel compilation if the driver supports it. Requires a current OpenGL context.
+*/
+void ShaderManagerInitialize();
+
+/*
+  Starts compiling and linking a program made of a vertex and a fragment shader.
+  Does not wait for the compiler. The sources are only needed for the duration of the call.
+
+  @param name Used in error messages
+  @param vertexSource Vertex shader source code
+  @param fragmentSource Fragment shader source code
+  @return handle used to get the program later
+*/
+ShaderProgramHandle ShaderManagerSubmit(const std::string& name, std::string_view vertexSource,
+					std::string_view fragmentSource);
+
+/*
+  Asks whether a program has finished compiling and linking, without blocking.
+  Without parallel compile support the driver can not tell us, so this always returns true.
+*/
+bool ShaderManagerIsReady(ShaderProgramHandle handle);
+
+/*
+  Returns the linked program, waiting for the compiler if it is not done yet.
+  The first call checks the compile and link status, prints any errors and stores the
+  program in the program cache.
+
+  @return id of the program object, or 0 if compiling or linking failed
+*/
+GLuint ShaderManagerGetProgram(ShaderProgramHandle handle);
+
+/*
+  Deletes a program that is no longer needed (e.g. after it was replaced by a hot reload).
+  The handle must not be used afterwards.
+*/
+void ShaderManagerRelease(ShaderProgramHandle handle);
+
+/*
+  Deletes every program the manager created
+*/
+void ShaderManagerShutdown();
+
+/*
+  Prints how many programs were submitted, how many came from the cache, and how long
+  we waited on the compiler in ShaderManagerGetProgram
+*/
+void ShaderManagerPrintStatistics();
+
+#endif
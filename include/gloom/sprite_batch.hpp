@@ -0,0 +1,175 @@
+#ifndef GLOOM_SPRITE_BATCH_HPP
+#define GLOOM_SPRITE_BATCH_HPP
+
+/*
+  Sprite batching
+
+  A 2D scene is thousands of small textured quads that move every frame. Drawing each one
+  like our single quad (its own buffers and one glDrawElements) spends all the time in the
+  driver. A sprite batch instead writes the four corners of every sprite into one vertex
+  stream on the CPU, and draws as many sprites as possible with each draw call:
+
+  - Vertices are recorded into CPU memory and copied once per frame into a stream buffer
+    (see stream_buffer.hpp), on the thread that owns the context, like the uniform ring does.
+    The stream buffer waits for the frame fence rather than fencing the sprites on its own, so
+    call StreamBufferFenceFrame once per frame after the last draw (main.cpp does in PresentFrame).
+  - A new batch (draw call) only starts when the texture or the blend mode changes, so submit
+    sprites sorted by texture where the drawing order allows it.
+  - The index buffer never changes: every quad uses the pattern of our quad mesh,
+    2, 0, 1, 3, 2, 1, shifted by 4 vertices per sprite. It covers kSpriteBatchMaxQuadsPerDraw
+    quads with 16 bit indices, longer batches are split into several draws whose base vertex
+    (glDrawElementsBaseVertex) moves on to the next quads.
+
+  Corners are numbered like the quad mesh's vertices:
+    2 --- 3
+    |     |
+    0 --- 1
+  rect.xy is corner 0, and the sprite rotates (counterclockwise, in radians) around its center.
+  Positions are transformed by the viewProjection of the ViewBlock (see uniform_buffer.hpp),
+  so with an orthographic projection they can be pixels. The program is the caller's, our
+  shaders are shaders/sprite_vert.glsl and shaders/sprite_frag.glsl.
+
+  e.g.
+    SpriteBatchBegin(gSprites);
+    SpriteBatchSubmit(gSprites, playerTexture, glm::vec4(x, y, 32.0f, 32.0f), glm::vec4(1.0f), angle);
+    ...
+    RenderUseProgram(gSpriteProgram);
+    SpriteBatchEnd(gSprites);
+    ...
+    StreamBufferFenceFrame();   // on the context's thread, after the frame's last draw
+*/
+
+#include <gloom/stream_buffer.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Attribute locations of shaders/sprite_vert.glsl (position and color as in vertex_format.hpp)
+const GLuint kSpritePositionLocation = 0;
+const GLuint kSpriteColorLocation = 1;
+const GLuint kSpriteTextureCoordinatesLocation = 2;
+
+// Quads one draw call can address with 16 bit indices (65536 vertices)
+const uint32_t kSpriteBatchMaxQuadsPerDraw = 16384;
+
+enum class SpriteBlend : uint8_t
+{
+  // No blending, the sprite's alpha is ignored
+  Opaque,
+  // Classic transparency, source * alpha + destination * (1 - alpha)
+  Alpha,
+  // source * alpha + destination, for glows and particles
+  Additive
+};
+
+// 16 bytes: texture coordinates are 16 bit and colors 8 bit normalized integers
+struct SpriteVertex
+{
+  glm::vec2 position;
+  uint32_t textureCoordinates;
+  uint32_t color;
+};
+static_assert(sizeof(SpriteVertex) == 16, "SpriteVertex should be 16 bytes");
+
+// A run of consecutive sprites that share a texture and a blend mode
+struct SpriteDraw
+{
+  GLuint texture = 0;
+  SpriteBlend blend = SpriteBlend::Alpha;
+  uint32_t firstSprite = 0;
+  uint32_t spriteCount = 0;
+};
+
+struct SpriteBatchStatistics
+{
+  size_t frames = 0;
+  size_t sprites = 0;
+  // Batches, and the draw calls they were split into
+  size_t batches = 0;
+  size_t drawCalls = 0;
+  // Why batches ended
+  size_t textureBreaks = 0;
+  size_t blendBreaks = 0;
+  // Sprites that did not fit into the frame and were dropped
+  size_t overflows = 0;
+};
+
+struct SpriteBatch;
+
+// What SpriteBatchEnd asks the context's thread to upload
+struct SpriteUpload
+{
+  SpriteBatch* batch = nullptr;
+  int region = 0;
+  size_t spriteCount = 0;
+};
+
+struct SpriteBatch
+{
+  // The vertices of all sprites, one region per frame in flight
+  StreamBuffer stream;
+  // Reads SpriteVertex from the stream buffer, with the quad index buffer bound
+  GLuint vertexArray = 0;
+  GLuint indexBuffer = 0;
+  // Sprites a frame can hold
+  size_t maxSprites = 0;
+  // The frames' vertices while they are recorded, copied into the stream buffer region with the same index
+  std::vector<SpriteVertex> staging[kStreamBufferRegions];
+  SpriteUpload uploads[kStreamBufferRegions];
+  // The batches of the frame being recorded
+  std::vector<SpriteDraw> draws;
+  // Region of the frame being recorded and how many sprites it has
+  int region = kStreamBufferRegions - 1;
+  size_t spriteCount = 0;
+  SpriteBatchStatistics statistics;
+};
+
+/*
+  Creates the stream buffer, the quad index buffer and the vertex array, on the thread that owns the context.
+  Leaves the vertex array and buffer bindings changed, and the GL state cache invalidated.
+
+  @param batch The sprite batch to create
+  @param maxSprites Sprites per frame, 16 bytes per corner are reserved for each of them per frame in flight
+  @return true if the buffers were created
+*/
+bool CreateSpriteBatch(SpriteBatch& batch, size_t maxSprites);
+
+/*
+  Starts recording the next frame's sprites
+*/
+void SpriteBatchBegin(SpriteBatch& batch);
+
+/*
+  Adds a sprite to the frame
+
+  @param texture Texture the sprite samples (unit 0)
+  @param rect x, y of corner 0, width and height
+  @param color Multiplied with the texture
+  @param rotation Counterclockwise around the center of rect, in radians
+  @param textureRect Part of the texture to show: u, v of corner 0, width and height in texture coordinates
+  @param blend How the sprite is blended with what is behind it
+  @return false if the frame is full (see maxSprites), the sprite is dropped
+*/
+bool SpriteBatchSubmit(SpriteBatch& batch, GLuint texture, const glm::vec4& rect, const glm::vec4& color,
+		       float rotation = 0.0f, const glm::vec4& textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+		       SpriteBlend blend = SpriteBlend::Alpha);
+
+/*
+  Records the upload of the frame's sprites and one draw per batch. The program that draws them
+  (and its ViewBlock) has to be bound already. Leaves GL_BLEND as the last batch needed it.
+*/
+void SpriteBatchEnd(SpriteBatch& batch);
+
+void DestroySpriteBatch(SpriteBatch& batch);
+
+/*
+  Prints sprites, batches and draw calls per frame, and why batches were broken
+*/
+void SpriteBatchPrintStatistics(const SpriteBatch& batch);
+
+#endif
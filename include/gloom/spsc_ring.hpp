@@ -0,0 +1,99 @@
+#ifndef GLOOM_SPSC_RING_HPP
+#define GLOOM_SPSC_RING_HPP
+
+/*
+  Single-producer/single-consumer lock-free ring buffer
+
+  One thread pushes, one other thread pops, and neither ever takes a lock.
+  The producer only writes 'mTail' and the consumer only writes 'mHead', so each index has
+  exactly one writer. The two indices live on separate cache lines, otherwise every push
+  would invalidate the consumer's cache line and vice versa ('false sharing').
+  Each side also keeps a private copy of the other side's index and only reloads it when
+  the ring looks full (or empty), which keeps the shared cache lines quiet.
+
+  e.g.
+    SpscRing<RenderCommand, 4096> ring;
+    // Producer thread
+    while (!ring.TryPush(command)) { ... wait ... }
+    // Consumer thread
+    RenderCommand command;
+    while (ring.TryPop(command)) { ... }
+*/
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t Capacity>
+class SpscRing
+{
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+  /*
+    Called by the producer only
+    @return false if the ring is full
+  */
+  bool TryPush(const T& value)
+  {
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mCachedHead == Capacity)
+    {
+      mCachedHead = mHead.load(std::memory_order_acquire);
+      if (tail - mCachedHead == Capacity)
+      {
+        return false;
+      }
+    }
+
+    mItems[tail & (Capacity - 1)] = value;
+    // Release: the item must be visible before the consumer sees the new tail
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*
+    Called by the consumer only
+    @return false if the ring is empty
+  */
+  bool TryPop(T& value)
+  {
+    size_t head = mHead.load(std::memory_order_relaxed);
+    if (head == mCachedTail)
+    {
+      mCachedTail = mTail.load(std::memory_order_acquire);
+      if (head == mCachedTail)
+      {
+        return false;
+      }
+    }
+
+    value = mItems[head & (Capacity - 1)];
+    // Release: we are done reading the slot before the producer may overwrite it
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*
+    Approximate when called while the other thread is active
+  */
+  bool Empty() const
+  {
+    return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+  }
+
+private:
+  static const size_t kCacheLineSize = 64;
+
+  // Consumer side
+  alignas(kCacheLineSize) std::atomic<size_t> mHead{0};
+  size_t mCachedTail = 0;
+
+  // Producer side
+  alignas(kCacheLineSize) std::atomic<size_t> mTail{0};
+  size_t mCachedHead = 0;
+
+  alignas(kCacheLineSize) T mItems[Capacity];
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef GLOOM_STREAM_BUFFER_HPP
+#define GLOOM_STREAM_BUFFER_HPP
+
+/*
+  Streaming buffers
+
+  Geometry that changes every frame has to be uploaded every frame. Calling glBufferData
+  each time orphans the buffer: the driver allocates new storage (and frees the old one
+  once the GPU is done with it), which shows up as stalls and allocation spikes.
+
+  A stream buffer allocates its storage once and splits it into kStreamBufferRegions regions,
+  one per frame in flight, used as a ring. Each frame we write into the next region only, so
+  we never touch memory the GPU may still read, and can map it with GL_MAP_UNSYNCHRONIZED_BIT
+  (no implicit synchronization by the driver). At the end of a frame a fence marks when the GPU
+  is done with the region, and before we reuse the region three frames later we check that fence.
+  Normally it has long signaled, if not we wait for it and count the wait.
+
+  Every glFenceSync costs something, on some drivers (e.g. Mesa's llvmpipe) it flushes and runs
+  everything recorded so far. A stream buffer with frameFence set creates no fence of its own, it
+  waits for the frame fence instead: one fence per frame, inserted by StreamBufferFenceFrame after
+  the frame's last draw and shared by all such buffers. A region that no frame fence covers yet
+  (e.g. written twice in one frame) falls back to a fence of its own, and waits for it.
+
+  With ARB_buffer_storage (core in OpenGL 4.4) the storage is immutable and mapped once,
+  persistently and coherently, so streaming is a plain memcpy with no map or unmap calls at all.
+
+  All functions must run on the thread that owns the OpenGL context.
+
+  e.g.
+    StreamBuffer vertices;
+    CreateStreamBuffer(vertices, 4 * 1024 * 1024);
+    ...
+    StreamBufferBeginFrame(vertices);
+    StreamAllocation allocation = StreamBufferMap(vertices, byteCount, sizeof(GLfloat));
+    memcpy(allocation.data, ...);
+    StreamBufferUnmap(vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+    glVertexAttribPointer(..., (GLvoid*)allocation.offset);
+    ... draw ...
+    StreamBufferEndFrame(vertices);
+    ... the frame's other draws ...
+    StreamBufferFenceFrame();
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <string>
+
+// Frames the GPU may lag behind before we have to wait on a region
+const int kStreamBufferRegions = 3;
+
+struct StreamBufferStatistics
+{
+  size_t bytesStreamed = 0;
+  size_t allocations = 0;
+  // Allocations that did not fit into what was left of the frame's region
+  size_t overflows = 0;
+  // Times a region was still in use by the GPU when we wanted to write to it again
+  size_t fenceWaits = 0;
+  double fenceWaitMilliseconds = 0.0;
+};
+
+struct StreamBuffer
+{
+  GLuint buffer = 0;
+  // Size of one region, the buffer is kStreamBufferRegions times as large
+  size_t regionSize = 0;
+  // Mapped with ARB_buffer_storage for the lifetime of the buffer
+  bool persistent = false;
+  void* persistentMapping = nullptr;
+  // Region of the current frame and how much of it is used
+  int region = 0;
+  size_t regionUsed = 0;
+  bool mapped = false;
+  // Signaled once the GPU finished the commands of the last frame that used each region
+  GLsync fences[kStreamBufferRegions] = {};
+  // Wait for the frame fence (see StreamBufferFenceFrame) instead of fencing every region
+  bool frameFence = false;
+  // With frameFence, the frame that last used each region, 0 if none did
+  unsigned long long regionFrames[kStreamBufferRegions] = {};
+  StreamBufferStatistics statistics;
+};
+
+/*
+  Where to write streamed data, and where it ends up in the buffer
+*/
+struct StreamAllocation
+{
+  // nullptr if the allocation did not fit
+  void* data = nullptr;
+  // Byte offset in the buffer, pass it to glVertexAttribPointer, glDrawElements, glBindBufferRange, ...
+  GLintptr offset = 0;
+};
+
+/*
+  Creates the buffer. Leaves the GL_COPY_WRITE_BUFFER binding changed (through the GL state cache).
+
+  @param stream The stream buffer to create
+  @param regionSize Bytes that can be streamed per frame
+  @param allowPersistent Use ARB_buffer_storage if available (false forces the map/unmap path)
+  @return true if the buffer was created
+*/
+bool CreateStreamBuffer(StreamBuffer& stream, size_t regionSize, bool allowPersistent = true);
+
+/*
+  Moves on to the next region, waiting for the GPU if it still uses it
+*/
+void StreamBufferBeginFrame(StreamBuffer& stream);
+
+/*
+  Reserves 'size' bytes in the current region and returns a pointer to write them to.
+  Call StreamBufferUnmap when done writing, before drawing.
+
+  @param size Bytes to reserve
+  @param alignment The offset is a multiple of this (e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+  @return the allocation, with data == nullptr if the region is full
+*/
+StreamAllocation StreamBufferMap(StreamBuffer& stream, size_t size, size_t alignment = 4);
+
+/*
+  Finishes writing the last allocation (nothing to do for persistent buffers)
+*/
+void StreamBufferUnmap(StreamBuffer& stream);
+
+/*
+  Fences the current region. Call after the draws that read this frame's data were issued.
+  With frameFence it only notes the frame, StreamBufferFenceFrame fences it.
+*/
+void StreamBufferEndFrame(StreamBuffer& stream);
+
+/*
+  Inserts the frame fence, which covers every stream buffer with frameFence set that ended its
+  frame since the last call. Call once per frame, after the frame's last draw.
+*/
+void StreamBufferFenceFrame();
+
+void DestroyStreamBuffer(StreamBuffer& stream);
+
+/*
+  Prints the counters of a stream buffer to std::cout
+
+  @param name Used in the output
+*/
+void StreamBufferPrintStatistics(const StreamBuffer& stream, const std::string& name);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef GLOOM_TEXT_RENDERER_HPP
+#define GLOOM_TEXT_RENDERER_HPP
+
+/*
+  Text rendering
+
+  Draws text on top of the frame, e.g. live statistics from the profiler. The font is a small
+  bitmap font built into the program (5x8 pixels per character, printable ASCII), rasterized
+  once into a glyph atlas page (see texture_atlas.hpp). Every character is a quad showing its
+  glyph's part of the page, written into a sprite batch (see sprite_batch.hpp), so all the text
+  of a frame goes through one streaming vertex buffer and, sharing one texture, is drawn by a
+  single draw call (up to kSpriteBatchMaxQuadsPerDraw characters). The batch adds no fence of its
+  own, it waits for the frame fence (see StreamBufferFenceFrame). With ~150 characters, like the
+  overlay of main.cpp, a frame costs about 0.07 ms of CPU on llvmpipe.
+
+  Glyphs are sampled with GL_NEAREST and scaled by whole pixels, so text stays sharp. Positions
+  are pixels with the origin in the bottom left corner, like the sprites in main.cpp. Solid
+  rectangles (e.g. a panel behind the text) use a white glyph of the same page, so they do not
+  break the batch either.
+
+  e.g.
+    TextRendererBegin(gText);
+    TextRendererRect(gText, glm::vec4(0.0f, 400.0f, 200.0f, 80.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+    TextRendererPrint(gText, glm::vec2(4.0f, 476.0f), "Hello\nWorld", glm::vec4(1.0f));
+    RenderUseProgram(gSpriteProgram);
+    TextRendererEnd(gText);
+*/
+
+#include <gloom/sprite_batch.hpp>
+#include <gloom/texture_atlas.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+// Size of a glyph in font pixels: 7 rows above the baseline and one for descenders
+const int kGlyphWidth = 5;
+const int kGlyphHeight = 8;
+// Distance from one character to the next, and from one line to the next
+const int kGlyphAdvance = 6;
+const int kLineAdvance = 10;
+// The font's characters, ' ' to '~', and one more: the solid glyph used by TextRendererRect
+const int kFirstGlyph = 32;
+const int kGlyphCount = 96;
+
+struct TextRendererStatistics
+{
+  size_t frames = 0;
+  size_t glyphs = 0;
+  // Time spent laying out and submitting text, from TextRendererBegin to the end of TextRendererEnd
+  double cpuMilliseconds = 0.0;
+  double maxCpuMilliseconds = 0.0;
+  // Time of the last frame, for showing the overlay's own cost
+  double lastCpuMilliseconds = 0.0;
+};
+
+struct TextRenderer
+{
+  // The glyph atlas, its only page is the texture every character samples
+  TextureAtlas glyphs;
+  GLuint texture = 0;
+  // Where every glyph is in the page, in texture coordinates
+  glm::vec4 glyphRects[kGlyphCount];
+  // Screen pixels per font pixel
+  int scale = 2;
+  SpriteBatch batch;
+  std::chrono::steady_clock::time_point frameBegin;
+  TextRendererStatistics statistics;
+};
+
+/*
+  Rasterizes the font into the glyph atlas and creates the sprite batch, on the thread that owns
+  the context. Leaves texture, vertex array and buffer bindings changed, and the GL state cache
+  invalidated.
+
+  @param maxGlyphs Characters (and rectangles) per frame
+  @param scale Screen pixels per font pixel
+  @return true if the atlas and the batch were created
+*/
+bool CreateTextRenderer(TextRenderer& text, size_t maxGlyphs, int scale = 2);
+
+/*
+  Starts recording the next frame's text
+*/
+void TextRendererBegin(TextRenderer& text);
+
+/*
+  Lays out a string. '\n' starts a new line, characters the font does not have are drawn as '?'.
+
+  @param position Top left corner of the first character, in pixels
+  @return the position where the next character would go
+*/
+glm::vec2 TextRendererPrint(TextRenderer& text, glm::vec2 position, std::string_view string, const glm::vec4& color);
+
+/*
+  Adds a solid rectangle, drawn in order with the text (so submit panels before their text)
+
+  @param rect x, y of the bottom left corner, width and height, in pixels
+*/
+void TextRendererRect(TextRenderer& text, const glm::vec4& rect, const glm::vec4& color);
+
+/*
+  @return width and height of a string in pixels, as TextRendererPrint would lay it out
+*/
+glm::vec2 TextRendererMeasure(const TextRenderer& text, std::string_view string);
+
+/*
+  Records the upload of the frame's text and its draw. The sprite program (and a ViewBlock in
+  pixels) has to be bound already. Leaves GL_BLEND enabled.
+*/
+void TextRendererEnd(TextRenderer& text);
+
+void DestroyTextRenderer(TextRenderer& text);
+
+/*
+  Prints the characters per frame and how long laying them out took to std::cout
+*/
+void TextRendererPrintStatistics(const TextRenderer& text);
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef GLOOM_TEXTURE_ATLAS_HPP
+#define GLOOM_TEXTURE_ATLAS_HPP
+
+/*
+  Texture atlases
+
+  Many small images packed into a few large textures (pages), so sprites that use different
+  images can still be drawn in one batch (see sprite_batch.hpp). Where an image lands is decided
+  by an atlas packer (see atlas_packer.hpp), and a lookup table maps the image's asset id to its
+  page and texture coordinates.
+
+  Images can be inserted and evicted at any time, e.g. as content streams in and out. When no
+  page has room, a new one is created, up to maxPages.
+
+  Mipmaps: each image sits in a slot that extends its edge pixels into a border, and slots start
+  and end on multiples of 2^mipLevels pixels. So down to level mipLevels every texel belongs to a
+  single image, and filtering never blends in a neighbor. Levels below that are not created.
+
+  All functions must run on the thread that owns the OpenGL context.
+
+  e.g.
+    TextureAtlas atlas;
+    CreateTextureAtlas(atlas, TextureAtlasSettings());
+    TextureAtlasInsert(atlas, AtlasAssetIdFromName("coin"), pixels, 16, 16);
+    TextureAtlasUpdateMipmaps(atlas);
+    ...
+    const AtlasEntry* coin = TextureAtlasFind(atlas, AtlasAssetIdFromName("coin"));
+    SpriteBatchSubmit(sprites, coin->texture, rect, color, 0.0f, coin->textureRect);
+*/
+
+#include <gloom/atlas_packer.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TextureAtlasSettings
+{
+  // Width and height of every page in pixels
+  int pageSize = 2048;
+  int maxPages = 4;
+  // Pixels of repeated edge around every image. Raised to 2^mipLevels if smaller, so even the
+  // smallest level has a texel of border.
+  int border = 2;
+  // Mip levels below the full resolution
+  int mipLevels = 2;
+  AtlasPackMethod method = AtlasPackMethod::MaxRects;
+};
+
+// Where an image is
+struct AtlasEntry
+{
+  int page = 0;
+  // The page's texture object
+  GLuint texture = 0;
+  // The image's slot, with border and alignment
+  AtlasRect slot;
+  // The image itself: u and v of its lower left corner, width and height, in texture coordinates
+  glm::vec4 textureRect = glm::vec4(0.0f);
+  int width = 0;
+  int height = 0;
+};
+
+struct TextureAtlasPage
+{
+  GLuint texture = 0;
+  AtlasPacker packer;
+  // Images were inserted since the mipmaps were last generated
+  bool mipmapsDirty = false;
+};
+
+struct TextureAtlasStatistics
+{
+  size_t inserts = 0;
+  size_t evictions = 0;
+  // Inserts that found no room, not even on a new page
+  size_t failedInserts = 0;
+  // Pixels of the images currently in the atlas, without their borders
+  size_t imageArea = 0;
+};
+
+struct TextureAtlas
+{
+  TextureAtlasSettings settings;
+  std::vector<TextureAtlasPage> pages;
+  // Asset id to where the image is
+  std::unordered_map<AtlasAssetId, AtlasEntry> entries;
+  // An image with its border, before it is uploaded
+  std::vector<uint8_t> slotPixels;
+  TextureAtlasStatistics statistics;
+};
+
+/*
+  Sets up an empty atlas, its first page is created with the first image
+*/
+void CreateTextureAtlas(TextureAtlas& atlas, const TextureAtlasSettings& settings);
+
+/*
+  Packs an image into a page and uploads it. Inserting an id that is already there does nothing.
+  Leaves the texture binding of unit 0 changed (through the GL state cache).
+
+  @param pixels RGBA8, rows from bottom to top
+  @return false if the image does not fit (larger than a page, or every page is full)
+*/
+bool TextureAtlasInsert(TextureAtlas& atlas, AtlasAssetId id, const uint8_t* pixels, int width, int height);
+
+/*
+  Frees an image's room in its page, for images inserted later
+
+  @return false if the id is not in the atlas
+*/
+bool TextureAtlasEvict(TextureAtlas& atlas, AtlasAssetId id);
+
+/*
+  @return where the image is, nullptr if it is not in the atlas
+*/
+const AtlasEntry* TextureAtlasFind(const TextureAtlas& atlas, AtlasAssetId id);
+
+/*
+  Regenerates the mipmaps of pages that changed. Call after inserting, before drawing with the atlas.
+*/
+void TextureAtlasUpdateMipmaps(TextureAtlas& atlas);
+
+/*
+  Loads an atlas baked by tools/atlas_pack.cpp: its manifest and page images (TGA)
+
+  @return false if the manifest or a page could not be loaded
+*/
+bool LoadTextureAtlas(TextureAtlas& atlas, const std::string& manifestFilename);
+
+void DestroyTextureAtlas(TextureAtlas& atlas);
+
+/*
+  @return the fraction of the pages' area covered by images, without borders and alignment
+*/
+double TextureAtlasEfficiency(const TextureAtlas& atlas);
+
+/*
+  Prints the pages, images and how well they are packed to std::cout
+*/
+void TextureAtlasPrintStatistics(const TextureAtlas& atlas);
+
+#endif
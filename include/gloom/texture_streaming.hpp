@@ -0,0 +1,144 @@
+#ifndef GLOOM_TEXTURE_STREAMING_HPP
+#define GLOOM_TEXTURE_STREAMING_HPP
+
+/*
+  Texture streaming
+
+  Loading a texture the simple way (read the file, decode it, build the mip chain and
+  glTexImage2D every level) stalls whichever thread does it for as long as that takes, and
+  on the render thread that means dropped frames. The texture streamer splits the work up:
+
+  1. Decode threads load the file (see asset_io.hpp), decode it to RGBA8 and compute the
+     mip chain on the CPU, into staging memory taken from a pool.
+  2. Once per frame, on the thread that owns the context, decoded textures get a texture object
+     and their levels are copied into a pixel buffer object (a stream buffer bound to
+     GL_PIXEL_UNPACK_BUFFER, see stream_buffer.hpp) and uploaded from there with
+     glTexSubImage2D. The driver copies from the PBO on its own time, and the stream buffer's
+     fences make sure we never overwrite data it has not copied yet.
+  3. Uploads start with the smallest mip and work towards the full resolution, at most
+     uploadBudgetBytes per frame (large levels are split into bands of rows). A texture can
+     be drawn as soon as its smallest level is there, GL_TEXTURE_BASE_LEVEL hides the levels
+     that are still missing and is lowered as they arrive.
+  4. When the textures take more than memoryBudgetBytes of video memory, the ones used least
+     recently are evicted. If one of them is used again it is streamed in again.
+
+  Files are TGA images (uncompressed or RLE, 24 or 32 bit, see tga.hpp), which need no image library.
+
+  Threads: TextureRequest, TextureUse and TextureStreamerBeginFrame are called by the thread
+  recording the frame. The uploads are recorded as a render command (see render_commands.hpp),
+  so they run on the thread that owns the context, the render thread if there is one.
+
+  e.g.
+    TextureStreamerStart(settings);
+    TextureHandle brick = TextureRequest("./textures/brick.tga");
+    ... every frame ...
+    TextureStreamerBeginFrame();
+    GLuint texture = TextureUse(brick);
+    packet.texture = texture != 0 ? texture : gWhiteTexture;
+    ...
+    TextureStreamerStop();
+*/
+
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Identifies a requested texture, -1 is never a valid handle
+typedef int TextureHandle;
+const TextureHandle kInvalidTexture = -1;
+
+// Textures the streamer can keep track of
+const int kMaxStreamedTextures = 4096;
+
+struct TextureStreamerSettings
+{
+  // Threads decoding files and building mip chains
+  int decodeThreads = 2;
+  // Bytes of texture data uploaded per frame at most (a single row of a level is always uploaded)
+  size_t uploadBudgetBytes = 1024 * 1024;
+  // Video memory the textures may take before the least recently used ones are evicted
+  size_t memoryBudgetBytes = 256 * 1024 * 1024;
+};
+
+/*
+  Creates the pixel buffer object and starts the decode threads.
+  Call on the thread that owns the context, before any other texture streaming function.
+
+  @return true if the pixel buffer object was created
+*/
+bool TextureStreamerStart(const TextureStreamerSettings& settings);
+
+/*
+  Joins the decode threads and deletes every texture. Call on the thread that owns the context.
+*/
+void TextureStreamerStop();
+
+/*
+  Starts loading a texture in the background. Requesting the same file twice returns the same handle.
+
+  @param filename Path to a TGA file
+  @return the handle to use the texture with, kInvalidTexture if there is no room for another texture
+*/
+TextureHandle TextureRequest(const std::string& filename);
+
+/*
+  Marks a texture as used in this frame, so it is not evicted, and streams it in again if it was.
+
+  @return the texture object, with at least its smallest mip level uploaded, or 0 if none is uploaded yet
+*/
+GLuint TextureUse(TextureHandle handle);
+
+/*
+  @return true once every level of the texture is uploaded
+*/
+bool TextureIsResident(TextureHandle handle);
+
+/*
+  @return true if decoding the texture failed (e.g. the file is missing or not a TGA we can read)
+*/
+bool TextureFailed(TextureHandle handle);
+
+/*
+  Starts a new frame: records this frame's uploads and evictions, which run on the thread that
+  owns the context when it gets to them. Call once per frame, before the frame's TextureUse calls.
+*/
+void TextureStreamerBeginFrame();
+
+struct TextureStreamerStatistics
+{
+  size_t requests = 0;
+  size_t decoded = 0;
+  size_t failed = 0;
+  double decodeMilliseconds = 0.0;
+  size_t bytesUploaded = 0;
+  size_t uploadFrames = 0;
+  // Frames that used the whole upload budget
+  size_t budgetLimitedFrames = 0;
+  size_t evictions = 0;
+  size_t residentTextures = 0;
+  size_t residentBytes = 0;
+  // Times the staging pool had to allocate (or grow) memory
+  size_t stagingAllocations = 0;
+  // From the request to the first (smallest) level being usable, and to the last level
+  size_t firstLevelCount = 0;
+  double firstLevelMilliseconds = 0.0;
+  double firstLevelMaxMilliseconds = 0.0;
+  size_t fullyResidentCount = 0;
+  double fullyResidentMilliseconds = 0.0;
+  double fullyResidentMaxMilliseconds = 0.0;
+};
+
+/*
+  @return the counters so far. Call on the thread that owns the context (or after TextureStreamerStop).
+*/
+TextureStreamerStatistics TextureStreamerGetStatistics();
+
+/*
+  Prints the upload latencies, bytes per frame and evictions to std::cout
+*/
+void TextureStreamerPrintStatistics();
+
+#endif
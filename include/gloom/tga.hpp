@@ -0,0 +1,40 @@
+#ifndef GLOOM_TGA_HPP
+#define GLOOM_TGA_HPP
+
+/*
+  TGA decoding
+
+  Textures are TGA images (uncompressed or RLE, 24 or 32 bit), which need no image library.
+  The decoder only turns the bytes of a file into pixels and uses no OpenGL, so offline tools
+  (e.g. tools/atlas_pack.cpp) can link it without a context or the renderer.
+
+  e.g.
+    AssetFile file = LoadAsset("./textures/checker.tga");
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    if (file.IsOpen() && DecodeTGA(file.View(), pixels, width, height))
+    {
+      ...
+    }
+*/
+
+// C++ Standard Template Library (STL)
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Largest width or height we decode, what every OpenGL 4 implementation supports for a texture
+const int kMaxTGASize = 16384;
+
+/*
+  Decodes a TGA file to RGBA8, rows from bottom to top like OpenGL expects them
+
+  @param file The file's contents
+  @param pixels Receives width * height * 4 bytes
+  @return false if the file is not an uncompressed or RLE true color TGA with 24 or 32 bits per pixel,
+          is larger than kMaxTGASize or is too short for the size in its header
+*/
+bool DecodeTGA(std::string_view file, std::vector<uint8_t>& pixels, int& width, int& height);
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef GLOOM_TRANSFORM_HPP
+#define GLOOM_TRANSFORM_HPP
+
+/*
+  Transform hierarchy
+
+  Every object in the scene has a local transform (translation, rotation and scale, "TRS")
+  relative to its parent, and a world matrix that places it in the world:
+    world = parent's world * translate(t) * rotate(r) * scale(s)
+
+  The nodes are stored as a structure of arrays, and every node comes after its parent.
+  So one pass from front to back always sees a parent's new world matrix before its children need it,
+  without any recursion or pointer chasing through the tree.
+
+  Changing a node only marks it dirty. TransformUpdate then recomputes the world matrices of the
+  dirty nodes and everything below them, and nothing else. Every node knows the highest index in
+  its subtree, so the pass only walks from each dirty node to the end of its subtree and jumps over
+  the clean nodes in between. Within that span a node is recomputed if it or its parent changed
+  during this pass. Matrices are multiplied with GLM's SIMD mat4 multiply (SSE).
+
+  The world matrices of all nodes can live in one buffer object, UploadWorldMatrices copies the range
+  that changed since the last upload with a single glBufferSubData. That is for shaders that look up
+  matrices by node, main.cpp passes each object's world matrix in its DrawBlock instead (see Draw).
+  bench/transform_bench.cpp uploads after every update and reads the buffer back to check it.
+
+  e.g.
+    uint32_t body = TransformAdd(gTransforms, kTransformNoParent, position);
+    uint32_t wheel = TransformAdd(gTransforms, body, glm::vec3(1.0f, -0.5f, 0.0f));
+    ...
+    TransformSetRotation(gTransforms, wheel, spin);
+    TransformUpdate(gTransforms);
+    UploadWorldMatrices(gTransforms, gTransformBuffer);
+*/
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Parent of nodes at the top of the hierarchy
+const uint32_t kTransformNoParent = 0xFFFFFFFF;
+
+struct TransformHierarchy
+{
+  // Local transforms, indexed by node. A node's parent always has a lower index.
+  std::vector<uint32_t> parents;
+  std::vector<glm::vec3> translations;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+  // Highest index in the node's subtree, the node itself if it has no children
+  std::vector<uint32_t> lastDescendants;
+  // Set when a local transform changed since the last update
+  std::vector<uint8_t> dirty;
+  // Results of the last update
+  std::vector<glm::mat4> worlds;
+
+  // Nodes marked dirty since the last update, each once, in any order
+  std::vector<uint32_t> dirtyNodes;
+  // Range of world matrices changed since the last upload
+  uint32_t uploadBegin = 0;
+  uint32_t uploadEnd = 0;
+
+  size_t Size() const { return parents.size(); }
+};
+
+/*
+  Adds a node behind all existing ones, which keeps parents in front of their children
+
+  @param hierarchy The hierarchy to add to
+  @param parent An existing node, or kTransformNoParent
+  @param translation, rotation, scale The local transform
+  @return the new node
+*/
+uint32_t TransformAdd(TransformHierarchy& hierarchy, uint32_t parent, const glm::vec3& translation = glm::vec3(0.0f),
+		      const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+
+/*
+  Change a node's local transform, its world matrix (and its children's) follow on the next update
+*/
+void TransformSetTranslation(TransformHierarchy& hierarchy, uint32_t node, const glm::vec3& translation);
+void TransformSetRotation(TransformHierarchy& hierarchy, uint32_t node, const glm::quat& rotation);
+void TransformSetScale(TransformHierarchy& hierarchy, uint32_t node, const glm::vec3& scale);
+
+void TransformClear(TransformHierarchy& hierarchy);
+
+/*
+  Recomputes the world matrices of dirty nodes and their descendants
+
+  @return the number of world matrices recomputed
+*/
+size_t TransformUpdate(TransformHierarchy& hierarchy);
+
+/*
+  Holds the world matrices of every node on the GPU, 64 bytes (a column major mat4) per node
+*/
+struct TransformBuffer
+{
+  GLuint buffer = 0;
+  // In matrices
+  size_t capacity = 0;
+};
+
+/*
+  Copies the world matrices changed since the last upload into the buffer, creating or growing it
+  as needed. Must run on the thread that owns the OpenGL context.
+*/
+void UploadWorldMatrices(TransformHierarchy& hierarchy, TransformBuffer& transformBuffer);
+
+void DestroyTransformBuffer(TransformBuffer& transformBuffer);
+
+// Totals over every TransformUpdate call
+struct TransformStatistics
+{
+  size_t updates = 0;
+  size_t nodesUpdated = 0;
+  double nanoseconds = 0.0;
+};
+
+TransformStatistics GetTransformStatistics();
+
+/*
+  Prints the nodes updated per frame and how many per millisecond
+*/
+void TransformPrintStatistics();
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef GLOOM_UNIFORM_BUFFER_HPP
+#define GLOOM_UNIFORM_BUFFER_HPP
+
+/*
+  Uniform buffers
+
+  Setting a shader's uniforms with glUniform* costs one driver call per value per draw, and the
+  values belong to the program, so they have to be set again for every program that uses them.
+  Instead, our shaders read their constants from uniform blocks backed by buffer objects:
+
+    layout(std140) uniform ViewBlock { ... };   // Shared by every draw of a view (camera), bound once
+    layout(std140) uniform DrawBlock { ... };   // One per draw, a different range of the buffer each time
+
+  The C++ structs below have exactly the std140 layout of those blocks, so they are copied
+  into the buffer as they are. Every block has a fixed binding point, the shader manager
+  assigns them when a program is linked (BindUniformBlocks).
+
+  The data of a frame goes into a uniform ring: while recording, UniformRingPush copies each
+  struct into CPU memory at the next offset aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, and
+  returns where it will be in the buffer. UniformRingFlush then copies the whole frame into one
+  region of a stream buffer (see stream_buffer.hpp) with a single map, on the thread that owns
+  the context (which is the render thread, if it runs). Draws select their data with
+  glBindBufferRange, through the GL state cache.
+
+  e.g.
+    UniformRingBeginFrame(gUniformRing);
+    GLintptr view = UniformRingPush(gUniformRing, viewUniforms);
+    GLintptr draw = UniformRingPush(gUniformRing, drawUniforms);
+    UniformRingFlush(gUniformRing);
+    RenderBindBufferRange(GL_UNIFORM_BUFFER, kViewUniformBinding, gUniformRing.stream.buffer, view, sizeof(ViewUniforms));
+    RenderBindBufferRange(GL_UNIFORM_BUFFER, kDrawUniformBinding, gUniformRing.stream.buffer, draw, sizeof(DrawUniforms));
+    ... draw ...
+    UniformRingEndFrame(gUniformRing);
+*/
+
+#include <gloom/stream_buffer.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Binding points of the uniform blocks, and their names in the shaders
+const GLuint kViewUniformBinding = 0;
+const GLuint kDrawUniformBinding = 1;
+const char* const kViewUniformBlockName = "ViewBlock";
+const char* const kDrawUniformBlockName = "DrawBlock";
+
+/*
+  std140 places a float on 4 bytes, a vec2 on 8, a vec3 or vec4 on 16, a mat4 as four vec4
+  columns, and rounds a struct up to 16 bytes. GLM's vec4 and mat4 have exactly that layout
+  when the struct itself is 16 byte aligned, a vec3 has to be followed by a float (or padding).
+  The static_asserts below check that the offsets agree with the block declarations in the shaders.
+*/
+#define GLOOM_STD140_OFFSET(Type, member, offset) \
+  static_assert(offsetof(Type, member) == (offset), #Type "::" #member " is not at its std140 offset")
+
+// layout(std140) uniform ViewBlock
+struct alignas(16) ViewUniforms
+{
+  glm::mat4 viewProjection = glm::mat4(1.0f);
+  glm::mat4 view = glm::mat4(1.0f);
+  // xyz is the camera position, w the time in seconds
+  glm::vec4 cameraPositionTime = glm::vec4(0.0f);
+};
+GLOOM_STD140_OFFSET(ViewUniforms, viewProjection, 0);
+GLOOM_STD140_OFFSET(ViewUniforms, view, 64);
+GLOOM_STD140_OFFSET(ViewUniforms, cameraPositionTime, 128);
+static_assert(sizeof(ViewUniforms) == 144, "ViewUniforms does not match ViewBlock");
+
+// layout(std140) uniform DrawBlock
+struct alignas(16) DrawUniforms
+{
+  glm::mat4 model = glm::mat4(1.0f);
+  // Multiplied with the vertex colors
+  glm::vec4 color = glm::vec4(1.0f);
+};
+GLOOM_STD140_OFFSET(DrawUniforms, model, 0);
+GLOOM_STD140_OFFSET(DrawUniforms, color, 64);
+static_assert(sizeof(DrawUniforms) == 80, "DrawUniforms does not match DrawBlock");
+
+/*
+  Assigns our binding points to the uniform blocks a program declares. Blocks the program
+  does not use are skipped. Called by the shader manager for every program it links or loads.
+*/
+void BindUniformBlocks(GLuint program);
+
+struct UniformRingStatistics
+{
+  size_t allocations = 0;
+  size_t bytes = 0;
+  // Allocations that did not fit into the frame
+  size_t overflows = 0;
+  size_t frames = 0;
+};
+
+struct UniformRing;
+
+// What UniformRingFlush asks the context's thread to upload
+struct UniformUpload
+{
+  UniformRing* ring = nullptr;
+  int region = 0;
+  size_t size = 0;
+};
+
+struct UniformRing
+{
+  // The buffer the shaders read, one region per frame in flight
+  StreamBuffer stream;
+  // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, every allocation starts at a multiple of it
+  size_t alignment = 256;
+  // The frames' data while it is recorded, copied into the stream buffer region with the same index
+  std::vector<uint8_t> staging[kStreamBufferRegions];
+  UniformUpload uploads[kStreamBufferRegions];
+  // Region of the frame being recorded and how much of it is used
+  int region = kStreamBufferRegions - 1;
+  size_t used = 0;
+  UniformRingStatistics statistics;
+};
+
+/*
+  Creates the uniform ring, on the thread that owns the context
+
+  @param ring The ring to create
+  @param bytesPerFrame Uniform data a frame can hold, including the alignment padding
+  @return true if the buffer was created
+*/
+bool CreateUniformRing(UniformRing& ring, size_t bytesPerFrame);
+
+/*
+  Starts recording the next frame's uniform data
+*/
+void UniformRingBeginFrame(UniformRing& ring);
+
+/*
+  Copies uniform data into the frame
+
+  @return the byte offset of the data in ring.stream.buffer, for glBindBufferRange, or -1 if the frame is full
+*/
+GLintptr UniformRingAllocate(UniformRing& ring, const void* data, size_t size);
+
+template <typename T>
+GLintptr UniformRingPush(UniformRing& ring, const T& uniforms)
+{
+  return UniformRingAllocate(ring, &uniforms, sizeof(T));
+}
+
+/*
+  Records the upload of everything pushed this frame. Call once per frame, after the last push
+  and before the draws that read the data.
+*/
+void UniformRingFlush(UniformRing& ring);
+
+/*
+  Records the fence that tells when the GPU is done with this frame's region. Call once per frame, after its draws.
+*/
+void UniformRingEndFrame(UniformRing& ring);
+
+void DestroyUniformRing(UniformRing& ring);
+
+/*
+  Prints how many bytes and allocations a frame used on average
+*/
+void UniformRingPrintStatistics(const UniformRing& ring);
+
+#endif
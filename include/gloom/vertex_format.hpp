@@ -0,0 +1,69 @@
+#ifndef GLOOM_VERTEX_FORMAT_HPP
+#define GLOOM_VERTEX_FORMAT_HPP
+
+/*
+  Vertex formats
+
+  Every byte of a vertex has to be fetched by the GPU, once per vertex per draw. Storing
+  everything as 32 bit floats is simple but wasteful: colors only need 8 bits per channel,
+  unit normals fit into 10 bits per component and positions of ordinary models are fine
+  as 16 bit half floats. Packing them cuts our vertices from 24 to 12 bytes (and normals
+  from 12 bytes to 4), so twice as many vertices fit into the same memory bandwidth.
+
+  The packing is done with GLM's gtc/packing functions, and the attributes are described so that
+  the vertex shader still receives plain floats:
+    position  packHalf4x16       GL_HALF_FLOAT, 4 components              8 bytes (w is 1)
+    color     packUnorm4x8       GL_UNSIGNED_BYTE, normalized             4 bytes
+    normal    packSnorm3x10_1x2  GL_INT_2_10_10_10_REV, normalized        4 bytes
+
+  The layout is stored in the mesh file (see mesh.hpp), so loading works the same for all formats.
+
+  e.g.
+    MeshData compact;
+    ConvertVertexFormat(mesh, VertexFormat::Compact, compact);
+    WriteMeshFile("./meshes/quad.mesh", compact);
+*/
+
+#include <gloom/mesh.hpp>
+
+// C++ Standard Template Library (STL)
+#include <string>
+
+// Attribute locations with a known meaning, as used by shaders/vert.glsl
+const uint32_t kVertexPositionLocation = 0;
+const uint32_t kVertexColorLocation = 1;
+// Not read by our shaders yet
+const uint32_t kVertexNormalLocation = 4;
+
+enum class VertexFormat
+{
+  // Every attribute as 32 bit floats
+  Float,
+  // Half float positions, 8 bit colors and 10-10-10-2 normals
+  Compact
+};
+
+/*
+  @return "float" or "compact"
+*/
+const char* VertexFormatName(VertexFormat format);
+
+/*
+  Parses a format name as printed by VertexFormatName
+
+  @return true if the name is known
+*/
+bool ParseVertexFormat(const std::string& name, VertexFormat& format);
+
+/*
+  Re-encodes the vertices of a mesh. Position, color and normal attributes are stored in the
+  given format, anything else is copied as 32 bit floats. Indices are copied unchanged.
+
+  @param source A mesh whose attributes are all GL_FLOAT
+  @param format The format to convert to
+  @param destination Receives the converted mesh
+  @return false if the source has attributes that are not floats
+*/
+bool ConvertVertexFormat(const MeshData& source, VertexFormat format, MeshData& destination);
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef GLOOM_WORK_STEALING_DEQUE_HPP
+#define GLOOM_WORK_STEALING_DEQUE_HPP
+
+/*
+  Chase-Lev work-stealing deque
+
+  Every worker thread of the job system owns one. The owner pushes and pops at the bottom,
+  like a stack, so it keeps working on the jobs it created last (their data is still in its cache).
+  Any other thread may steal from the top, taking the oldest job, which tends to be the biggest
+  piece of remaining work. Push and Pop never take a lock, and only race with thieves when a
+  single item is left; thieves race each other with a compare-and-swap on 'mTop'.
+
+  The deque has a fixed capacity and holds pointers: the items themselves (jobs) are owned by
+  whoever created them and have to stay alive until they have run.
+
+  Based on "Dynamic Circular Work-Stealing Deque" (Chase and Lev) and the C11 version
+  in "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen and Zappa Nardelli).
+
+  e.g.
+    WorkStealingDeque<Job, 4096> deque;
+    // Owner thread
+    deque.Push(&job);
+    Job* job = deque.Pop();
+    // Any other thread
+    Job* job = deque.Steal();
+*/
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T, size_t Capacity>
+class WorkStealingDeque
+{
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+  /*
+    Called by the owner only
+    @return false if the deque is full
+  */
+  bool Push(T* item)
+  {
+    int64_t bottom = mBottom.load(std::memory_order_relaxed);
+    int64_t top = mTop.load(std::memory_order_acquire);
+    if (bottom - top >= (int64_t)Capacity)
+    {
+      return false;
+    }
+
+    mItems[bottom & (Capacity - 1)].store(item, std::memory_order_relaxed);
+    // Release: the item must be visible before a thief sees the new bottom
+    mBottom.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*
+    Called by the owner only, takes the item pushed last
+    @return nullptr if the deque is empty (or a thief took the last item)
+  */
+  T* Pop()
+  {
+    int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    // The new bottom has to be visible to thieves before we read top, otherwise a thief
+    // and we could both take the same item. This is the one full fence in the deque.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = mTop.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+      // Empty, restore bottom
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T* item = mItems[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+      // The last item, thieves may be after it too. Whoever moves top first gets it.
+      if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      {
+        item = nullptr;
+      }
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /*
+    Called by any thread but the owner, takes the item pushed first
+    @return nullptr if the deque is empty or another thread got there first
+  */
+  T* Steal()
+  {
+    int64_t top = mTop.load(std::memory_order_acquire);
+    // Pairs with the fence in Pop
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = mBottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+    {
+      return nullptr;
+    }
+
+    T* item = mItems[top & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+      return nullptr;
+    }
+    return item;
+  }
+
+  /*
+    Approximate when called while other threads are active
+  */
+  bool Empty() const
+  {
+    return mBottom.load(std::memory_order_acquire) <= mTop.load(std::memory_order_acquire);
+  }
+
+private:
+  static const size_t kCacheLineSize = 64;
+
+  // Thieves take from the top
+  alignas(kCacheLineSize) std::atomic<int64_t> mTop{0};
+  // The owner pushes and pops at the bottom
+  alignas(kCacheLineSize) std::atomic<int64_t> mBottom{0};
+
+  alignas(kCacheLineSize) std::atomic<T*> mItems[Capacity];
+};
+
+#endif
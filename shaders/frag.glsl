@@ -1,10 +1,15 @@
  #version 410 core
 
  in vec3 v_vertexColors;
+ in vec2 v_textureCoordinates;
+
+ // Texture unit 0, a white texture unless one is streamed in (see gloom/texture_streaming.hpp)
+ uniform sampler2D albedoTexture;
 
  out vec4 color;
 
  void main()
 { 
-  color = vec4(v_vertexColors.r, v_vertexColors.g, v_vertexColors.b, 1.0f);
+  vec3 albedo = texture(albedoTexture, v_textureCoordinates).rgb;
+  color = vec4(v_vertexColors.r * albedo.r, v_vertexColors.g * albedo.g, v_vertexColors.b * albedo.b, 1.0f);
 }
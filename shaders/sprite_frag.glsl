@@ -0,0 +1,14 @@
+#version 410 core
+
+in vec4 v_color;
+in vec2 v_textureCoordinates;
+
+// Texture unit 0, bound per batch by the sprite batch
+uniform sampler2D spriteTexture;
+
+out vec4 color;
+
+void main()
+{
+  color = texture(spriteTexture, v_textureCoordinates) * v_color;
+}
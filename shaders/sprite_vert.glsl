@@ -0,0 +1,25 @@
+#version 410 core
+
+// A corner of a sprite, see gloom/sprite_batch.hpp (SpriteVertex)
+layout(location=0) in vec2 position;
+layout(location=1) in vec4 vertexColor;
+layout(location=2) in vec2 textureCoordinates;
+
+// Shared by every draw of a view, see gloom/uniform_buffer.hpp (ViewUniforms)
+layout(std140) uniform ViewBlock
+{
+  mat4 viewProjection;
+  mat4 view;
+  // xyz is the camera position, w the time in seconds
+  vec4 cameraPositionTime;
+};
+
+out vec4 v_color;
+out vec2 v_textureCoordinates;
+
+void main()
+{
+  v_color = vertexColor;
+  v_textureCoordinates = textureCoordinates;
+  gl_Position = viewProjection * vec4(position, 0.0f, 1.0f);
+}
@@ -3,10 +3,37 @@
 layout(location=0) in vec3 position;
 layout(location=1) in vec3 vertexColors;
 
+// Per instance attributes (glVertexAttribDivisor 1), see gloom/instancing.hpp
+// xyz is the translation, w a uniform scale
+layout(location=2) in vec4 instanceTranslationScale;
+// Multiplied with the vertex colors
+layout(location=3) in vec4 instanceColor;
+
+// Shared by every draw of a view, see gloom/uniform_buffer.hpp (ViewUniforms)
+layout(std140) uniform ViewBlock
+{
+  mat4 viewProjection;
+  mat4 view;
+  // xyz is the camera position, w the time in seconds
+  vec4 cameraPositionTime;
+};
+
+// Set for every draw (DrawUniforms)
+layout(std140) uniform DrawBlock
+{
+  mat4 model;
+  // Multiplied with the vertex colors
+  vec4 color;
+};
+
 out vec3 v_vertexColors;
+// The quad spans -0.5 to 0.5, its texture 0 to 1
+out vec2 v_textureCoordinates;
 
 void main()
 {
-  v_vertexColors = vertexColors;
-  gl_Position = vec4(position.x, position.y, position.z, 1.0f);
+  v_vertexColors = vertexColors * instanceColor.rgb * color.rgb;
+  v_textureCoordinates = position.xy + 0.5f;
+  vec3 worldPosition = position * instanceTranslationScale.w + instanceTranslationScale.xyz;
+  gl_Position = viewProjection * model * vec4(worldPosition, 1.0f);
 }
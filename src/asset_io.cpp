@@ -0,0 +1,174 @@
+#include <gloom/asset_io.hpp>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <iostream>
+#include <mutex>
+
+// Buffers that are not in use by any AssetFile
+// Assets may be loaded from worker threads, so the pool and the statistics are guarded by a mutex
+static std::mutex sPoolMutex;
+static std::vector<std::vector<char>> sBufferPool;
+static AssetIOStatistics sStatistics;
+
+// Takes the first pooled buffer that is large enough, or allocates one
+static std::vector<char> AcquireBuffer(size_t size)
+{
+  std::lock_guard<std::mutex> lock(sPoolMutex);
+  for (size_t i = 0; i < sBufferPool.size(); ++i)
+  {
+    if (sBufferPool[i].capacity() >= size)
+    {
+      std::vector<char> buffer = std::move(sBufferPool[i]);
+      sBufferPool[i] = std::move(sBufferPool.back());
+      sBufferPool.pop_back();
+      buffer.resize(size);
+      return buffer;
+    }
+  }
+
+  ++sStatistics.allocations;
+  return std::vector<char>(size);
+}
+
+static void ReleaseBuffer(std::vector<char>&& buffer)
+{
+  if (buffer.capacity() == 0)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(sPoolMutex);
+  sBufferPool.push_back(std::move(buffer));
+}
+
+AssetFile::~AssetFile()
+{
+  Release();
+}
+
+AssetFile::AssetFile(AssetFile&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+AssetFile& AssetFile::operator=(AssetFile&& other) noexcept
+{
+  if (this != &other)
+  {
+    Release();
+    mData = other.mData;
+    mSize = other.mSize;
+    mOpen = other.mOpen;
+    mMapping = other.mMapping;
+    mBuffer = std::move(other.mBuffer);
+    other.mData = nullptr;
+    other.mSize = 0;
+    other.mOpen = false;
+    other.mMapping = nullptr;
+  }
+  return *this;
+}
+
+void AssetFile::Release()
+{
+  if (mMapping != nullptr)
+  {
+    munmap(mMapping, mSize);
+    mMapping = nullptr;
+  }
+  ReleaseBuffer(std::move(mBuffer));
+  mBuffer = std::vector<char>();
+  mData = nullptr;
+  mSize = 0;
+  mOpen = false;
+}
+
+AssetFile LoadAsset(const std::string& filename)
+{
+  auto startTime = std::chrono::steady_clock::now();
+  AssetFile asset;
+
+  int fileDescriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor < 0)
+  {
+    std::cout << "Could not open " << filename << std::endl;
+    return asset;
+  }
+
+  struct stat fileStatus;
+  if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+  {
+    std::cout << "Could not read " << filename << std::endl;
+    close(fileDescriptor);
+    return asset;
+  }
+  size_t size = (size_t)fileStatus.st_size;
+
+  if (size >= kAssetMapThreshold)
+  {
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping != MAP_FAILED)
+    {
+      // We read the file front to back, let the kernel know so it can read ahead
+      madvise(mapping, size, MADV_SEQUENTIAL);
+      asset.mMapping = mapping;
+      asset.mData = (const char*)mapping;
+      asset.mSize = size;
+      asset.mOpen = true;
+    }
+  }
+
+  // Small file (or mapping failed): a single read into a pooled buffer
+  if (!asset.mOpen)
+  {
+    asset.mBuffer = AcquireBuffer(size);
+    size_t offset = 0;
+    while (offset < size)
+    {
+      ssize_t count = read(fileDescriptor, asset.mBuffer.data() + offset, size - offset);
+      if (count <= 0)
+      {
+        break;
+      }
+      offset += (size_t)count;
+    }
+    asset.mData = asset.mBuffer.data();
+    asset.mSize = offset;
+    asset.mOpen = offset == size;
+    if (!asset.mOpen)
+    {
+      std::cout << "Could not read " << filename << std::endl;
+    }
+  }
+  close(fileDescriptor);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  std::lock_guard<std::mutex> lock(sPoolMutex);
+  ++sStatistics.files;
+  sStatistics.mappedFiles += asset.IsMapped() ? 1 : 0;
+  sStatistics.bytes += asset.mSize;
+  sStatistics.seconds += elapsed.count();
+  return asset;
+}
+
+AssetIOStatistics GetAssetIOStatistics()
+{
+  std::lock_guard<std::mutex> lock(sPoolMutex);
+  return sStatistics;
+}
+
+void AssetIOPrintStatistics()
+{
+  AssetIOStatistics statistics = GetAssetIOStatistics();
+  double bytesPerSecond = statistics.seconds > 0.0 ? statistics.bytes / statistics.seconds : 0.0;
+  std::cout << "Asset I/O: " << statistics.files << " files (" << statistics.mappedFiles << " mapped), "
+	    << statistics.bytes << " bytes in " << statistics.seconds * 1000.0 << " ms ("
+	    << bytesPerSecond / (1024.0 * 1024.0) << " MiB/s), "
+	    << statistics.allocations << " buffer allocations" << std::endl;
+}
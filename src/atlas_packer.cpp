@@ -0,0 +1,419 @@
+#include <gloom/atlas_packer.hpp>
+#include <gloom/asset_io.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// First line of a manifest, followed by its version
+static const char* kManifestMagic = "gloom-atlas";
+static const int kManifestVersion = 1;
+
+static bool Intersects(const AtlasRect& a, const AtlasRect& b)
+{
+  return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static bool Contains(const AtlasRect& outer, const AtlasRect& inner)
+{
+  return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+	 inner.y + inner.height <= outer.y + outer.height;
+}
+
+void AtlasPackerReset(AtlasPacker& packer, int width, int height, AtlasPackMethod method)
+{
+  packer = AtlasPacker();
+  packer.method = method;
+  packer.width = width;
+  packer.height = height;
+  AtlasRect everything;
+  everything.width = width;
+  everything.height = height;
+  packer.freeRects.push_back(everything);
+  SkylineSegment ground;
+  ground.width = width;
+  packer.skyline.push_back(ground);
+}
+
+// Removes free rectangles that lie inside another one, they add nothing but work
+static void PruneFreeRects(std::vector<AtlasRect>& freeRects)
+{
+  for (size_t i = 0; i < freeRects.size(); ++i)
+  {
+    for (size_t j = i + 1; j < freeRects.size(); ++j)
+    {
+      if (Contains(freeRects[j], freeRects[i]))
+      {
+	freeRects.erase(freeRects.begin() + i);
+	--i;
+	break;
+      }
+      if (Contains(freeRects[i], freeRects[j]))
+      {
+	freeRects.erase(freeRects.begin() + j);
+	--j;
+      }
+    }
+  }
+}
+
+static bool MaxRectsInsert(AtlasPacker& packer, int width, int height, AtlasRect& rect)
+{
+  // Best short side fit: the free rectangle that leaves the least room along its tighter side
+  int bestShortSide = INT_MAX;
+  int bestLongSide = INT_MAX;
+  for (const AtlasRect& free : packer.freeRects)
+  {
+    if (width > free.width || height > free.height)
+    {
+      continue;
+    }
+    int leftoverX = free.width - width;
+    int leftoverY = free.height - height;
+    int shortSide = std::min(leftoverX, leftoverY);
+    int longSide = std::max(leftoverX, leftoverY);
+    if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+    {
+      bestShortSide = shortSide;
+      bestLongSide = longSide;
+      rect.x = free.x;
+      rect.y = free.y;
+    }
+  }
+  if (bestShortSide == INT_MAX)
+  {
+    return false;
+  }
+  rect.width = width;
+  rect.height = height;
+
+  // Every free rectangle the new one overlaps is replaced by the (up to four) parts of it
+  // left, right, below and above the new one. They overlap each other, which is fine.
+  size_t count = packer.freeRects.size();
+  for (size_t i = 0; i < count; ++i)
+  {
+    AtlasRect free = packer.freeRects[i];
+    if (!Intersects(free, rect))
+    {
+      continue;
+    }
+    if (rect.x > free.x)
+    {
+      packer.freeRects.push_back({ free.x, free.y, rect.x - free.x, free.height });
+    }
+    if (rect.x + rect.width < free.x + free.width)
+    {
+      packer.freeRects.push_back({ rect.x + rect.width, free.y, free.x + free.width - rect.x - rect.width, free.height });
+    }
+    if (rect.y > free.y)
+    {
+      packer.freeRects.push_back({ free.x, free.y, free.width, rect.y - free.y });
+    }
+    if (rect.y + rect.height < free.y + free.height)
+    {
+      packer.freeRects.push_back({ free.x, rect.y + rect.height, free.width, free.y + free.height - rect.y - rect.height });
+    }
+    packer.freeRects[i] = packer.freeRects[count - 1];
+    packer.freeRects[count - 1] = packer.freeRects.back();
+    packer.freeRects.pop_back();
+    --count;
+    --i;
+  }
+  PruneFreeRects(packer.freeRects);
+  return true;
+}
+
+static void MaxRectsRelease(AtlasPacker& packer, const AtlasRect& rect)
+{
+  // Grow the released rectangle by merging it with free neighbors that share a whole edge,
+  // so the space can take images larger than the one that left
+  AtlasRect merged = rect;
+  bool grown = true;
+  while (grown)
+  {
+    grown = false;
+    for (const AtlasRect& free : packer.freeRects)
+    {
+      if (free.y == merged.y && free.height == merged.height &&
+	  (free.x + free.width == merged.x || merged.x + merged.width == free.x))
+      {
+	merged.width += free.width;
+	merged.x = std::min(merged.x, free.x);
+	grown = true;
+      }
+      else if (free.x == merged.x && free.width == merged.width &&
+	       (free.y + free.height == merged.y || merged.y + merged.height == free.y))
+      {
+	merged.height += free.height;
+	merged.y = std::min(merged.y, free.y);
+	grown = true;
+      }
+      if (grown)
+      {
+	break;
+      }
+    }
+  }
+  packer.freeRects.push_back(merged);
+  PruneFreeRects(packer.freeRects);
+}
+
+/*
+  How high a rectangle starting at segment 'index' would sit on the skyline
+
+  @return the y it would be placed at, or -1 if it does not fit
+*/
+static int SkylineFit(const AtlasPacker& packer, size_t index, int width, int height)
+{
+  int x = packer.skyline[index].x;
+  if (x + width > packer.width)
+  {
+    return -1;
+  }
+  int y = 0;
+  int remaining = width;
+  for (size_t i = index; remaining > 0; ++i)
+  {
+    y = std::max(y, packer.skyline[i].y);
+    if (y + height > packer.height)
+    {
+      return -1;
+    }
+    remaining -= packer.skyline[i].width;
+  }
+  return y;
+}
+
+static bool SkylineInsert(AtlasPacker& packer, int width, int height, AtlasRect& rect)
+{
+  // Bottom left: the lowest top edge wins, then the leftmost
+  int bestTop = INT_MAX;
+  size_t bestIndex = 0;
+  for (size_t i = 0; i < packer.skyline.size(); ++i)
+  {
+    int y = SkylineFit(packer, i, width, height);
+    if (y >= 0 && y + height < bestTop)
+    {
+      bestTop = y + height;
+      bestIndex = i;
+      rect.x = packer.skyline[i].x;
+      rect.y = y;
+    }
+  }
+  if (bestTop == INT_MAX)
+  {
+    return false;
+  }
+  rect.width = width;
+  rect.height = height;
+
+  // The new segment replaces what it covers of the segments from bestIndex on
+  SkylineSegment top;
+  top.x = rect.x;
+  top.y = bestTop;
+  top.width = width;
+  packer.skyline.insert(packer.skyline.begin() + bestIndex, top);
+  for (size_t i = bestIndex + 1; i < packer.skyline.size();)
+  {
+    SkylineSegment& segment = packer.skyline[i];
+    int covered = top.x + top.width - segment.x;
+    if (covered <= 0)
+    {
+      break;
+    }
+    if (covered < segment.width)
+    {
+      segment.x += covered;
+      segment.width -= covered;
+      break;
+    }
+    packer.skyline.erase(packer.skyline.begin() + i);
+  }
+
+  // Neighbors at the same height become one segment
+  for (size_t i = 0; i + 1 < packer.skyline.size();)
+  {
+    if (packer.skyline[i].y == packer.skyline[i + 1].y)
+    {
+      packer.skyline[i].width += packer.skyline[i + 1].width;
+      packer.skyline.erase(packer.skyline.begin() + i + 1);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+  return true;
+}
+
+bool AtlasPackerInsert(AtlasPacker& packer, int width, int height, AtlasRect& rect)
+{
+  if (width <= 0 || height <= 0)
+  {
+    return false;
+  }
+  bool placed = packer.method == AtlasPackMethod::MaxRects ? MaxRectsInsert(packer, width, height, rect)
+							    : SkylineInsert(packer, width, height, rect);
+  if (placed)
+  {
+    packer.usedArea += (size_t)width * height;
+    ++packer.rectCount;
+  }
+  return placed;
+}
+
+void AtlasPackerRelease(AtlasPacker& packer, const AtlasRect& rect)
+{
+  packer.usedArea -= std::min(packer.usedArea, (size_t)rect.width * rect.height);
+  packer.rectCount -= std::min<size_t>(packer.rectCount, 1);
+  if (packer.rectCount == 0)
+  {
+    // Empty again, every method starts over with the whole page
+    AtlasPackerReset(packer, packer.width, packer.height, packer.method);
+    return;
+  }
+  if (packer.method == AtlasPackMethod::MaxRects)
+  {
+    MaxRectsRelease(packer, rect);
+  }
+}
+
+double AtlasPackerOccupancy(const AtlasPacker& packer)
+{
+  if (packer.width <= 0 || packer.height <= 0)
+  {
+    return 0.0;
+  }
+  return (double)packer.usedArea / ((double)packer.width * packer.height);
+}
+
+const char* AtlasPackMethodName(AtlasPackMethod method)
+{
+  return method == AtlasPackMethod::MaxRects ? "maxrects" : "skyline";
+}
+
+bool ParseAtlasPackMethod(const std::string& name, AtlasPackMethod& method)
+{
+  if (name == "maxrects")
+  {
+    method = AtlasPackMethod::MaxRects;
+    return true;
+  }
+  if (name == "skyline")
+  {
+    method = AtlasPackMethod::Skyline;
+    return true;
+  }
+  return false;
+}
+
+int AtlasSlotSize(int size, int border, int alignment)
+{
+  int padded = size + 2 * border;
+  return (padded + alignment - 1) / alignment * alignment;
+}
+
+void AtlasBlit(uint8_t* page, int pageWidth, const AtlasRect& slot, int border, const uint8_t* pixels, int width, int height)
+{
+  for (int y = 0; y < slot.height; ++y)
+  {
+    // Rows and columns outside of the image repeat its nearest edge
+    int sourceY = std::min(std::max(y - border, 0), height - 1);
+    const uint8_t* sourceRow = pixels + (size_t)sourceY * width * 4;
+    uint8_t* row = page + ((size_t)(slot.y + y) * pageWidth + slot.x) * 4;
+
+    for (int x = 0; x < border && x < slot.width; ++x)
+    {
+      std::memcpy(row + x * 4, sourceRow, 4);
+    }
+    int inside = std::min(width, slot.width - border);
+    std::memcpy(row + border * 4, sourceRow, (size_t)inside * 4);
+    for (int x = border + inside; x < slot.width; ++x)
+    {
+      std::memcpy(row + x * 4, sourceRow + (size_t)(width - 1) * 4, 4);
+    }
+  }
+}
+
+AtlasAssetId AtlasAssetIdFromName(std::string_view name)
+{
+  uint32_t hash = 2166136261u;
+  for (char c : name)
+  {
+    hash = (hash ^ (uint8_t)c) * 16777619u;
+  }
+  return hash;
+}
+
+bool WriteAtlasManifest(const std::string& filename, const AtlasManifest& manifest)
+{
+  std::ofstream file(filename);
+  file << kManifestMagic << " " << kManifestVersion << "\n";
+  file << "size " << manifest.pageSize << " border " << manifest.border << " mips " << manifest.mipLevels << "\n";
+  for (const std::string& page : manifest.pageFilenames)
+  {
+    file << "page " << std::quoted(page) << "\n";
+  }
+  for (const AtlasManifestEntry& entry : manifest.entries)
+  {
+    file << "image " << entry.page << " " << entry.rect.x << " " << entry.rect.y << " " << entry.rect.width << " "
+	 << entry.rect.height << " " << std::quoted(entry.name) << "\n";
+  }
+  return file.good();
+}
+
+bool ReadAtlasManifest(const std::string& filename, AtlasManifest& manifest)
+{
+  manifest = AtlasManifest();
+  AssetFile file = LoadAsset(filename);
+  if (!file.IsOpen())
+  {
+    return false;
+  }
+  std::istringstream stream{ std::string(file.View()) };
+
+  std::string magic;
+  int version = 0;
+  std::string size, border, mips;
+  stream >> magic >> version >> size >> manifest.pageSize >> border >> manifest.border >> mips >> manifest.mipLevels;
+  if (!stream || magic != kManifestMagic || version != kManifestVersion || size != "size" || border != "border" || mips != "mips")
+  {
+    return false;
+  }
+
+  std::string keyword;
+  while (stream >> keyword)
+  {
+    if (keyword == "page")
+    {
+      // A failed read (e.g. a trailing page without a name) may also hit the end of the file,
+      // which the eof check below would take for a complete manifest
+      std::string page;
+      if (!(stream >> std::quoted(page)) || page.empty())
+      {
+	return false;
+      }
+      manifest.pageFilenames.push_back(page);
+    }
+    else if (keyword == "image")
+    {
+      AtlasManifestEntry entry;
+      stream >> entry.page >> entry.rect.x >> entry.rect.y >> entry.rect.width >> entry.rect.height >>
+	std::quoted(entry.name);
+      if (!stream || entry.page < 0 || entry.page >= (int)manifest.pageFilenames.size())
+      {
+	return false;
+      }
+      manifest.entries.push_back(entry);
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return stream.eof();
+}
@@ -0,0 +1,274 @@
+// Enables GLM's SIMD layer (glm_vec4 and the glm_vec4_* functions) in this file.
+// Our GLM types use the default, unaligned precision, which GLM always implements without
+// intrinsics, so this does not change how glm::vec4 or glm::mat4 behave here.
+#define GLM_FORCE_INTRINSICS
+
+#include <gloom/culling.hpp>
+
+// Third Party Libraries
+#include <glm/simd/common.h>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+#include <immintrin.h>
+#endif
+
+static CullingStatistics sStatistics;
+
+FrustumPlanes ExtractFrustumPlanes(const glm::mat4& viewProjection)
+{
+  // Row i of the matrix (GLM stores columns, so m[column][row])
+  const glm::mat4& m = viewProjection;
+  glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+  glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+  glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+  glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+  // A point is inside if -w <= x <= w, i.e. w + x >= 0 and w - x >= 0, and the same for y and z
+  FrustumPlanes frustum;
+  frustum.planes[0] = row3 + row0; // left
+  frustum.planes[1] = row3 - row0; // right
+  frustum.planes[2] = row3 + row1; // bottom
+  frustum.planes[3] = row3 - row1; // top
+  frustum.planes[4] = row3 + row2; // near
+  frustum.planes[5] = row3 - row2; // far
+
+  // Normalize, so the plane equation gives real distances we can compare radii with
+  for (glm::vec4& plane : frustum.planes)
+  {
+    float length = glm::length(glm::vec3(plane));
+    if (length > 0.0f)
+    {
+      plane /= length;
+    }
+  }
+  return frustum;
+}
+
+uint32_t CullingSetAdd(CullingSet& set, const glm::vec3& center, const glm::vec3& halfExtents, float radius)
+{
+  uint32_t object = (uint32_t)set.Size();
+  set.centerX.push_back(0.0f);
+  set.centerY.push_back(0.0f);
+  set.centerZ.push_back(0.0f);
+  set.radius.push_back(0.0f);
+  set.extentX.push_back(0.0f);
+  set.extentY.push_back(0.0f);
+  set.extentZ.push_back(0.0f);
+  CullingSetUpdate(set, object, center, halfExtents, radius);
+  return object;
+}
+
+void CullingSetUpdate(CullingSet& set, uint32_t object, const glm::vec3& center, const glm::vec3& halfExtents,
+		      float radius)
+{
+  set.centerX[object] = center.x;
+  set.centerY[object] = center.y;
+  set.centerZ[object] = center.z;
+  // The sphere through the corners of the box encloses the box, so a larger one is never needed.
+  // It reaches at least as far towards any plane as the box does, only a smaller sphere culls more.
+  float cornerRadius = glm::length(halfExtents);
+  set.radius[object] = radius > 0.0f ? std::fmin(radius, cornerRadius) : cornerRadius;
+  set.extentX[object] = std::fabs(halfExtents.x);
+  set.extentY[object] = std::fabs(halfExtents.y);
+  set.extentZ[object] = std::fabs(halfExtents.z);
+}
+
+void CullingSetClear(CullingSet& set)
+{
+  set.centerX.clear();
+  set.centerY.clear();
+  set.centerZ.clear();
+  set.radius.clear();
+  set.extentX.clear();
+  set.extentY.clear();
+  set.extentZ.clear();
+}
+
+// Tests one object, used by the scalar path and for what is left over after the SIMD loops
+static bool IsVisible(const CullingSet& set, const FrustumPlanes& frustum, size_t object)
+{
+  for (const glm::vec4& plane : frustum.planes)
+  {
+    float distance = plane.x * set.centerX[object] + plane.y * set.centerY[object] + plane.z * set.centerZ[object] + plane.w;
+    // How far the box reaches towards the plane
+    float boxRadius = std::fabs(plane.x) * set.extentX[object] + std::fabs(plane.y) * set.extentY[object] +
+		      std::fabs(plane.z) * set.extentZ[object];
+    // Whichever of the two bounds is tighter
+    if (distance < -std::fmin(set.radius[object], boxRadius))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tests the objects in [begin, end) one at a time
+static void CullRangeScalar(const CullingSet& set, const FrustumPlanes& frustum, size_t begin, size_t end,
+			    std::vector<uint32_t>& visible)
+{
+  for (size_t object = begin; object < end; ++object)
+  {
+    if (IsVisible(set, frustum, object))
+    {
+      visible.push_back((uint32_t)object);
+    }
+  }
+}
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+
+// 8 objects per iteration, GLM has no 8 wide type so this uses AVX intrinsics directly
+static size_t CullRangeSIMD(const CullingSet& set, const FrustumPlanes& frustum, std::vector<uint32_t>& visible)
+{
+  const __m256 signMask = _mm256_set1_ps(-0.0f);
+  size_t count = set.Size() / 8 * 8;
+  for (size_t object = 0; object < count; object += 8)
+  {
+    __m256 centerX = _mm256_loadu_ps(&set.centerX[object]);
+    __m256 centerY = _mm256_loadu_ps(&set.centerY[object]);
+    __m256 centerZ = _mm256_loadu_ps(&set.centerZ[object]);
+    __m256 radius = _mm256_loadu_ps(&set.radius[object]);
+    __m256 extentX = _mm256_loadu_ps(&set.extentX[object]);
+    __m256 extentY = _mm256_loadu_ps(&set.extentY[object]);
+    __m256 extentZ = _mm256_loadu_ps(&set.extentZ[object]);
+
+    int inside = 0xFF;
+    for (const glm::vec4& plane : frustum.planes)
+    {
+      __m256 distance = _mm256_add_ps(
+	_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), centerX), _mm256_mul_ps(_mm256_set1_ps(plane.y), centerY)),
+	_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), centerZ), _mm256_set1_ps(plane.w)));
+      __m256 boxRadius = _mm256_add_ps(
+	_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.x)), extentX),
+		      _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.y)), extentY)),
+	_mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.z)), extentZ));
+      // distance >= -min(radius, boxRadius)
+      __m256 limit = _mm256_xor_ps(_mm256_min_ps(radius, boxRadius), signMask);
+      inside &= _mm256_movemask_ps(_mm256_cmp_ps(distance, limit, _CMP_GE_OQ));
+      if (inside == 0)
+      {
+        break;
+      }
+    }
+
+    while (inside != 0)
+    {
+      int lane = __builtin_ctz(inside);
+      visible.push_back((uint32_t)(object + lane));
+      inside &= inside - 1;
+    }
+  }
+  return count;
+}
+
+const char* CullingInstructionSet()
+{
+  return "AVX (8 objects)";
+}
+
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+// 4 objects per iteration with GLM's SIMD layer
+static size_t CullRangeSIMD(const CullingSet& set, const FrustumPlanes& frustum, std::vector<uint32_t>& visible)
+{
+  size_t count = set.Size() / 4 * 4;
+  for (size_t object = 0; object < count; object += 4)
+  {
+    glm_vec4 centerX = _mm_loadu_ps(&set.centerX[object]);
+    glm_vec4 centerY = _mm_loadu_ps(&set.centerY[object]);
+    glm_vec4 centerZ = _mm_loadu_ps(&set.centerZ[object]);
+    glm_vec4 radius = _mm_loadu_ps(&set.radius[object]);
+    glm_vec4 extentX = _mm_loadu_ps(&set.extentX[object]);
+    glm_vec4 extentY = _mm_loadu_ps(&set.extentY[object]);
+    glm_vec4 extentZ = _mm_loadu_ps(&set.extentZ[object]);
+
+    int inside = 0xF;
+    for (const glm::vec4& plane : frustum.planes)
+    {
+      glm_vec4 distance = glm_vec4_fma(_mm_set1_ps(plane.x), centerX,
+				       glm_vec4_fma(_mm_set1_ps(plane.y), centerY,
+						    glm_vec4_fma(_mm_set1_ps(plane.z), centerZ, _mm_set1_ps(plane.w))));
+      glm_vec4 boxRadius = glm_vec4_fma(glm_vec4_abs(_mm_set1_ps(plane.x)), extentX,
+					glm_vec4_fma(glm_vec4_abs(_mm_set1_ps(plane.y)), extentY,
+						     glm_vec4_mul(glm_vec4_abs(_mm_set1_ps(plane.z)), extentZ)));
+      // distance >= -min(radius, boxRadius)
+      glm_vec4 limit = glm_vec4_sub(_mm_setzero_ps(), _mm_min_ps(radius, boxRadius));
+      inside &= _mm_movemask_ps(_mm_cmpge_ps(distance, limit));
+      if (inside == 0)
+      {
+        break;
+      }
+    }
+
+    while (inside != 0)
+    {
+      int lane = __builtin_ctz(inside);
+      visible.push_back((uint32_t)(object + lane));
+      inside &= inside - 1;
+    }
+  }
+  return count;
+}
+
+const char* CullingInstructionSet()
+{
+  return "SSE (4 objects)";
+}
+
+#else
+
+static size_t CullRangeSIMD(const CullingSet&, const FrustumPlanes&, std::vector<uint32_t>&)
+{
+  return 0;
+}
+
+const char* CullingInstructionSet()
+{
+  return "scalar";
+}
+
+#endif
+
+size_t CullObjects(const CullingSet& set, const FrustumPlanes& frustum, std::vector<uint32_t>& visible)
+{
+  auto startTime = std::chrono::steady_clock::now();
+
+  visible.clear();
+  // The SIMD loop handles whole groups, the rest is tested one at a time
+  size_t done = CullRangeSIMD(set, frustum, visible);
+  CullRangeScalar(set, frustum, done, set.Size(), visible);
+
+  ++sStatistics.calls;
+  sStatistics.tested += set.Size();
+  sStatistics.culled += set.Size() - visible.size();
+  sStatistics.nanoseconds += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+  return visible.size();
+}
+
+size_t CullObjectsScalar(const CullingSet& set, const FrustumPlanes& frustum, std::vector<uint32_t>& visible)
+{
+  visible.clear();
+  CullRangeScalar(set, frustum, 0, set.Size(), visible);
+  return visible.size();
+}
+
+CullingStatistics GetCullingStatistics()
+{
+  return sStatistics;
+}
+
+void CullingPrintStatistics()
+{
+  if (sStatistics.calls == 0 || sStatistics.tested == 0)
+  {
+    return;
+  }
+  std::cout << "Culling (" << CullingInstructionSet() << "): " << (double)sStatistics.tested / sStatistics.calls
+	    << " objects tested and " << (double)sStatistics.culled / sStatistics.calls << " culled per frame, "
+	    << sStatistics.nanoseconds / sStatistics.tested << " ns per object" << std::endl;
+}
@@ -0,0 +1,149 @@
+#include <gloom/draw_bucket.hpp>
+#include <gloom/render_commands.hpp>
+#include <gloom/uniform_buffer.hpp>
+
+// C++ Standard Template Library (STL)
+#include <iostream>
+#include <utility>
+
+void DrawBucketClear(DrawBucket& bucket)
+{
+  bucket.packets.clear();
+  bucket.order.clear();
+}
+
+void DrawBucketPush(DrawBucket& bucket, const DrawPacket& packet)
+{
+  bucket.packets.push_back(packet);
+}
+
+void DrawBucketSort(DrawBucket& bucket)
+{
+  const size_t count = bucket.packets.size();
+  bucket.order.resize(count);
+  bucket.orderScratch.resize(count);
+  bucket.keys.resize(count);
+  bucket.keysScratch.resize(count);
+
+  // We sort (key, index) pairs rather than whole packets, which are much larger
+  // Meanwhile we count how often each byte value occurs, for all 8 bytes in one go
+  size_t histograms[8][256] = {};
+  for (size_t i = 0; i < count; ++i)
+  {
+    uint64_t key = bucket.packets[i].key;
+    bucket.keys[i] = key;
+    bucket.order[i] = (uint32_t)i;
+    for (int pass = 0; pass < 8; ++pass)
+    {
+      ++histograms[pass][(key >> (pass * 8)) & 0xFF];
+    }
+  }
+
+  uint64_t* keys = bucket.keys.data();
+  uint64_t* keysScratch = bucket.keysScratch.data();
+  uint32_t* order = bucket.order.data();
+  uint32_t* orderScratch = bucket.orderScratch.data();
+
+  // Least significant byte first. Each pass is stable, so after the last one
+  // the pairs are ordered by the whole key.
+  for (int pass = 0; pass < 8; ++pass)
+  {
+    size_t* histogram = histograms[pass];
+    int shift = pass * 8;
+
+    // If every key has the same byte here, this pass would not move anything
+    if (count == 0 || histogram[(keys[0] >> shift) & 0xFF] == count)
+    {
+      continue;
+    }
+
+    // Turn counts into the position where each byte value starts
+    size_t offset = 0;
+    for (int value = 0; value < 256; ++value)
+    {
+      size_t valueCount = histogram[value];
+      histogram[value] = offset;
+      offset += valueCount;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      size_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+      keysScratch[destination] = keys[i];
+      orderScratch[destination] = order[i];
+    }
+
+    std::swap(keys, keysScratch);
+    std::swap(order, orderScratch);
+  }
+
+  // An odd number of passes leaves the result in the scratch arrays
+  if (order != bucket.order.data())
+  {
+    bucket.order.swap(bucket.orderScratch);
+    bucket.keys.swap(bucket.keysScratch);
+  }
+}
+
+void DrawBucketSubmit(DrawBucket& bucket)
+{
+  DrawBucketStatistics statistics;
+
+  // Sorting is optional, unsorted buckets are drawn in the order packets were pushed
+  bool sorted = bucket.order.size() == bucket.packets.size();
+
+  const DrawPacket* previous = nullptr;
+  for (size_t i = 0; i < bucket.packets.size(); ++i)
+  {
+    const DrawPacket& packet = bucket.packets[sorted ? bucket.order[i] : i];
+
+    if (previous == nullptr || packet.program != previous->program)
+    {
+      RenderUseProgram(packet.program);
+      ++statistics.programChanges;
+    }
+    if (previous == nullptr || packet.vertexArray != previous->vertexArray)
+    {
+      RenderBindVertexArray(packet.vertexArray);
+      ++statistics.vertexArrayChanges;
+    }
+    if (previous == nullptr || packet.texture != previous->texture)
+    {
+      RenderBindTexture(0, GL_TEXTURE_2D, packet.texture);
+      ++statistics.textureChanges;
+    }
+    if (packet.uniformSize > 0 &&
+	(previous == nullptr || packet.uniformBuffer != previous->uniformBuffer ||
+	 packet.uniformOffset != previous->uniformOffset || packet.uniformSize != previous->uniformSize))
+    {
+      RenderBindBufferRange(GL_UNIFORM_BUFFER, kDrawUniformBinding, packet.uniformBuffer, packet.uniformOffset,
+			    packet.uniformSize);
+      ++statistics.uniformChanges;
+    }
+
+    if (packet.instanceCount == 1)
+    {
+      RenderDrawElements(packet.mode, packet.count, packet.indexType, packet.indexOffset);
+    }
+    else
+    {
+      RenderDrawElementsInstanced(packet.mode, packet.count, packet.indexType, packet.indexOffset,
+				  packet.instanceCount);
+    }
+    ++statistics.draws;
+    statistics.instances += packet.instanceCount;
+    previous = &packet;
+  }
+
+  bucket.statistics = statistics;
+}
+
+void DrawBucketPrintStatistics(const DrawBucket& bucket)
+{
+  const DrawBucketStatistics& statistics = bucket.statistics;
+  std::cout << "Draw bucket (last frame): " << statistics.draws << " draws ("
+	    << statistics.instances << " instances), "
+	    << statistics.programChanges << " program, " << statistics.vertexArrayChanges
+	    << " vertex array, " << statistics.textureChanges << " texture and "
+	    << statistics.uniformChanges << " uniform range changes" << std::endl;
+}
@@ -0,0 +1,353 @@
+#include <gloom/frame_pacing.hpp>
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// The Limiter sleeps until this long before the frame is due, and spins the rest.
+// Sleeps usually wake up within a few hundred microseconds, but that is not guaranteed.
+static const std::chrono::microseconds kLimiterSpinTime(1000);
+// Longest LowLatency wait for a fence, in nanoseconds, in case the GPU hangs
+static const GLuint64 kFenceTimeout = 1000000000ull;
+// Fences of frames we have not seen finished, beyond this they are dropped unmeasured
+static const size_t kMaxPendingFrames = 16;
+
+struct PendingFrame
+{
+  GLsync fence = nullptr;
+  std::chrono::steady_clock::time_point inputTime;
+};
+
+static FramePacingSettings sSettings;
+static FramePacingMode sMode = FramePacingMode::Unlimited;
+
+// Thread reading input: when the Limiter lets the next frame start, and how many frames began
+static std::chrono::steady_clock::time_point sNextFrameTime;
+static bool sLimiterStarted = false;
+static unsigned long long sFramesBegun = 0;
+
+// When each frame's input was read, indexed by frame number, handed to the context's thread
+static std::atomic<std::chrono::steady_clock::rep> sInputTimes[kFramePacingHistory];
+
+// Context's thread: frames presented so far, and those the GPU may still be working on
+static unsigned long long sFramesPresented = 0;
+static std::deque<PendingFrame> sPendingFrames;
+
+// LowLatency: frames presented with the GPU caught up, published by the context's thread so a
+// thread reading input ahead of it (a render thread's main thread) can wait for them
+static std::atomic<unsigned long long> sFramesCaughtUp{ 0 };
+static std::mutex sCaughtUpMutex;
+static std::condition_variable sCaughtUp;
+
+static std::mutex sStatisticsMutex;
+static FramePacingStatistics sStatistics;
+
+static double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+FramePacingMode FramePacingInitialize(const FramePacingSettings& settings, const FramePacingCallbacks& callbacks)
+{
+  sSettings = settings;
+  sSettings.targetFramesPerSecond = std::max(1.0, settings.targetFramesPerSecond);
+  sSettings.maxQueuedFrames = std::min(3, std::max(0, settings.maxQueuedFrames));
+  sMode = settings.mode;
+  sLimiterStarted = false;
+  sFramesBegun = 0;
+  sFramesPresented = 0;
+  sFramesCaughtUp.store(0);
+  sStatistics = FramePacingStatistics();
+
+  auto setSwapInterval = [&](int interval) { return callbacks.setSwapInterval && callbacks.setSwapInterval(interval); };
+  bool synchronized = true;
+  switch (sMode)
+  {
+    case FramePacingMode::AdaptiveVSync:
+      if (setSwapInterval(-1))
+      {
+	break;
+      }
+      std::cout << "Adaptive vsync is not supported, using vsync" << std::endl;
+      sMode = FramePacingMode::VSync;
+      synchronized = setSwapInterval(1);
+      break;
+    case FramePacingMode::VSync:
+      synchronized = setSwapInterval(1);
+      break;
+    case FramePacingMode::LowLatency:
+      // Without vsync the queue is still capped, only there is nothing to tear
+      setSwapInterval(1);
+      break;
+    case FramePacingMode::Unlimited:
+    case FramePacingMode::Limiter:
+      setSwapInterval(0);
+      break;
+  }
+  if (!synchronized)
+  {
+    std::cout << "Vsync is not available, limiting to " << sSettings.targetFramesPerSecond << " FPS instead" << std::endl;
+    sMode = FramePacingMode::Limiter;
+  }
+  return sMode;
+}
+
+void FramePacingShutdown()
+{
+  for (PendingFrame& frame : sPendingFrames)
+  {
+    glDeleteSync(frame.fence);
+  }
+  sPendingFrames.clear();
+}
+
+/*
+  Waits for the Limiter's next frame time: a sleep for most of the wait, then a spin on the clock
+*/
+static void WaitForNextFrame()
+{
+  auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / sSettings.targetFramesPerSecond));
+  auto now = std::chrono::steady_clock::now();
+  if (!sLimiterStarted)
+  {
+    sLimiterStarted = true;
+    sNextFrameTime = now + period;
+    return;
+  }
+
+  double sleepMilliseconds = 0.0;
+  double spinMilliseconds = 0.0;
+  if (now < sNextFrameTime)
+  {
+    if (sNextFrameTime - now > kLimiterSpinTime)
+    {
+      std::this_thread::sleep_for(sNextFrameTime - kLimiterSpinTime - now);
+      auto woken = std::chrono::steady_clock::now();
+      sleepMilliseconds = Milliseconds(woken - now);
+      now = woken;
+    }
+    auto spinStart = now;
+    while (now < sNextFrameTime)
+    {
+      now = std::chrono::steady_clock::now();
+    }
+    spinMilliseconds = Milliseconds(now - spinStart);
+  }
+
+  // Frames are due at fixed times, so one that started late does not push back the ones after it.
+  // After falling behind by more than a whole frame we start over rather than rush to catch up.
+  sNextFrameTime += period;
+  if (now - sNextFrameTime > period)
+  {
+    sNextFrameTime = now + period;
+  }
+
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  sStatistics.sleepMilliseconds += sleepMilliseconds;
+  sStatistics.spinMilliseconds += spinMilliseconds;
+}
+
+/*
+  LowLatency: waits until the context's thread presented all but maxQueuedFrames of the frames begun
+  so far. On the context's own thread that is always the case already. With a render thread this keeps
+  the input thread from reading input kRenderThreadMaxFramesInFlight frames ahead of the GPU.
+*/
+static void WaitForPresentedFrames()
+{
+  unsigned long long needed = sFramesBegun > (unsigned long long)sSettings.maxQueuedFrames
+				? sFramesBegun - sSettings.maxQueuedFrames : 0;
+  if (sFramesCaughtUp.load(std::memory_order_acquire) >= needed)
+  {
+    return;
+  }
+
+  auto waitStart = std::chrono::steady_clock::now();
+  {
+    std::unique_lock<std::mutex> lock(sCaughtUpMutex);
+    // Bounded like the fence waits, in case the render thread stopped presenting
+    sCaughtUp.wait_for(lock, std::chrono::nanoseconds(kFenceTimeout),
+		       [needed]() { return sFramesCaughtUp.load(std::memory_order_acquire) >= needed; });
+  }
+  auto waitEnd = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  ++sStatistics.presentWaits;
+  sStatistics.presentWaitMilliseconds += Milliseconds(waitEnd - waitStart);
+}
+
+void FramePacingBeginFrame()
+{
+  if (sMode == FramePacingMode::Limiter)
+  {
+    WaitForNextFrame();
+  }
+  else if (sMode == FramePacingMode::LowLatency)
+  {
+    WaitForPresentedFrames();
+  }
+  auto now = std::chrono::steady_clock::now();
+  sInputTimes[sFramesBegun % kFramePacingHistory].store(now.time_since_epoch().count(), std::memory_order_release);
+  ++sFramesBegun;
+}
+
+// Counts a frame the GPU finished at 'now'
+static void FrameCompleted(const PendingFrame& frame, std::chrono::steady_clock::time_point now)
+{
+  double latency = Milliseconds(now - frame.inputTime);
+  ++sStatistics.completedFrames;
+  sStatistics.completionLatencyMilliseconds += latency;
+  sStatistics.completionLatencyMaxMilliseconds = std::max(sStatistics.completionLatencyMaxMilliseconds, latency);
+}
+
+void FramePacingFramePresented()
+{
+  auto now = std::chrono::steady_clock::now();
+  // The frame numbers on both threads go up in lockstep, and the thread reading input is at most
+  // a few frames ahead (see kRenderThreadMaxFramesInFlight), so its slot was not overwritten yet
+  std::chrono::steady_clock::duration inputSinceEpoch(
+    sInputTimes[sFramesPresented % kFramePacingHistory].load(std::memory_order_acquire));
+  ++sFramesPresented;
+  PendingFrame presented;
+  presented.inputTime = std::chrono::steady_clock::time_point(inputSinceEpoch);
+  presented.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  sPendingFrames.push_back(presented);
+
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  double latency = Milliseconds(now - presented.inputTime);
+  ++sStatistics.frames;
+  sStatistics.presentLatencyMilliseconds += latency;
+  sStatistics.presentLatencyMaxMilliseconds = std::max(sStatistics.presentLatencyMaxMilliseconds, latency);
+
+  // LowLatency: wait for the oldest frames until at most maxQueuedFrames are left on the GPU
+  while (sMode == FramePacingMode::LowLatency && sPendingFrames.size() > (size_t)sSettings.maxQueuedFrames)
+  {
+    PendingFrame& oldest = sPendingFrames.front();
+    auto waitStart = std::chrono::steady_clock::now();
+    GLenum status = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+    auto waitEnd = std::chrono::steady_clock::now();
+    ++sStatistics.fenceWaits;
+    sStatistics.fenceWaitMilliseconds += Milliseconds(waitEnd - waitStart);
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+    {
+      FrameCompleted(oldest, waitEnd);
+    }
+    glDeleteSync(oldest.fence);
+    sPendingFrames.pop_front();
+  }
+
+  // Every other frame the GPU finished by now. In modes without waits we only notice once per
+  // frame, so their completion latency can be up to a frame too long.
+  while (!sPendingFrames.empty())
+  {
+    PendingFrame& oldest = sPendingFrames.front();
+    GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+      break;
+    }
+    FrameCompleted(oldest, std::chrono::steady_clock::now());
+    glDeleteSync(oldest.fence);
+    sPendingFrames.pop_front();
+  }
+  while (sPendingFrames.size() > kMaxPendingFrames)
+  {
+    glDeleteSync(sPendingFrames.front().fence);
+    sPendingFrames.pop_front();
+  }
+
+  if (sMode == FramePacingMode::LowLatency)
+  {
+    {
+      std::lock_guard<std::mutex> caughtUpLock(sCaughtUpMutex);
+      sFramesCaughtUp.store(sFramesPresented, std::memory_order_release);
+    }
+    sCaughtUp.notify_one();
+  }
+}
+
+bool FramePacingParseMode(const std::string& name, FramePacingMode& mode)
+{
+  const FramePacingMode modes[] = { FramePacingMode::Unlimited, FramePacingMode::VSync, FramePacingMode::AdaptiveVSync,
+				    FramePacingMode::Limiter, FramePacingMode::LowLatency };
+  for (FramePacingMode candidate : modes)
+  {
+    if (name == FramePacingModeName(candidate))
+    {
+      mode = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* FramePacingModeName(FramePacingMode mode)
+{
+  switch (mode)
+  {
+    case FramePacingMode::Unlimited:
+      return "unlimited";
+    case FramePacingMode::VSync:
+      return "vsync";
+    case FramePacingMode::AdaptiveVSync:
+      return "adaptive";
+    case FramePacingMode::Limiter:
+      return "limiter";
+    case FramePacingMode::LowLatency:
+      return "low-latency";
+  }
+  return "unknown";
+}
+
+FramePacingStatistics FramePacingGetStatistics()
+{
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  return sStatistics;
+}
+
+void FramePacingPrintStatistics()
+{
+  FramePacingStatistics statistics = FramePacingGetStatistics();
+  if (statistics.frames == 0)
+  {
+    return;
+  }
+  std::cout << "Frame pacing (" << FramePacingModeName(sMode);
+  if (sMode == FramePacingMode::Limiter)
+  {
+    std::cout << " at " << sSettings.targetFramesPerSecond << " FPS";
+  }
+  else if (sMode == FramePacingMode::LowLatency)
+  {
+    std::cout << ", at most " << sSettings.maxQueuedFrames << " queued";
+  }
+  std::cout << "): input to present " << statistics.presentLatencyMilliseconds / statistics.frames << " ms (max "
+	    << statistics.presentLatencyMaxMilliseconds << " ms)";
+  if (statistics.completedFrames > 0)
+  {
+    std::cout << ", input to GPU done " << statistics.completionLatencyMilliseconds / statistics.completedFrames
+	      << " ms (max " << statistics.completionLatencyMaxMilliseconds << " ms)";
+  }
+  std::cout << std::endl;
+  if (sMode == FramePacingMode::Limiter)
+  {
+    std::cout << "  Per frame: slept " << statistics.sleepMilliseconds / statistics.frames << " ms, spun "
+	      << statistics.spinMilliseconds / statistics.frames << " ms" << std::endl;
+  }
+  if (sMode == FramePacingMode::LowLatency)
+  {
+    std::cout << "  Waited for the GPU " << statistics.fenceWaits << " times, "
+	      << statistics.fenceWaitMilliseconds / statistics.frames << " ms per frame, and for frames to be presented "
+	      << statistics.presentWaits << " times, " << statistics.presentWaitMilliseconds / statistics.frames
+	      << " ms per frame" << std::endl;
+  }
+}
@@ -0,0 +1,349 @@
+#include <gloom/gl_state.hpp>
+
+// C++ Standard Template Library (STL)
+#include <iostream>
+
+// A cached value and whether we actually know it
+// (after GLStateInvalidate we do not, and the next call must be issued)
+template <typename T>
+struct Cached
+{
+  T value = T();
+  bool known = false;
+
+  // Returns true if 'newValue' has to be sent to the driver
+  bool Set(const T& newValue)
+  {
+    if (known && value == newValue)
+    {
+      return false;
+    }
+    value = newValue;
+    known = true;
+    return true;
+  }
+};
+
+struct Rectangle
+{
+  GLint x, y;
+  GLsizei width, height;
+  bool operator==(const Rectangle& other) const
+  {
+    return x == other.x && y == other.y && width == other.width && height == other.height;
+  }
+};
+
+struct Color
+{
+  GLfloat red, green, blue, alpha;
+  bool operator==(const Color& other) const
+  {
+    return red == other.red && green == other.green && blue == other.blue && alpha == other.alpha;
+  }
+};
+
+struct BufferRange
+{
+  GLuint buffer;
+  GLintptr offset;
+  GLsizeiptr size;
+  bool operator==(const BufferRange& other) const
+  {
+    return buffer == other.buffer && offset == other.offset && size == other.size;
+  }
+};
+
+struct BlendFactors
+{
+  GLenum source, destination;
+  bool operator==(const BlendFactors& other) const
+  {
+    return source == other.source && destination == other.destination;
+  }
+};
+
+// Capabilities we track, anything else goes straight to the driver
+static const GLenum kCapabilities[] = {
+  GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_MULTISAMPLE
+};
+static const int kCapabilityCount = sizeof(kCapabilities) / sizeof(kCapabilities[0]);
+
+// Buffer targets we track
+static const GLenum kBufferTargets[] = {
+  GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER,
+  GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_PACK_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER
+};
+static const int kBufferTargetCount = sizeof(kBufferTargets) / sizeof(kBufferTargets[0]);
+
+// Indexed GL_UNIFORM_BUFFER binding points we track (OpenGL guarantees at least 36)
+static const GLuint kUniformBindingCount = 16;
+
+// Texture targets we track, for each of the first kTextureUnitCount units
+static const GLenum kTextureTargets[] = {
+  GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP
+};
+static const int kTextureTargetCount = sizeof(kTextureTargets) / sizeof(kTextureTargets[0]);
+static const int kTextureUnitCount = 16;
+
+// The shadow copy of the OpenGL state
+struct GLStateCache
+{
+  Cached<bool> capabilities[kCapabilityCount];
+  Cached<Rectangle> viewport;
+  Cached<Color> clearColor;
+  Cached<BlendFactors> blendFunc;
+  Cached<GLuint> program;
+  Cached<GLuint> vertexArray;
+  Cached<GLuint> buffers[kBufferTargetCount];
+  Cached<BufferRange> uniformBuffers[kUniformBindingCount];
+  Cached<GLuint> drawFramebuffer;
+  Cached<GLuint> readFramebuffer;
+  Cached<GLenum> activeTexture;
+  Cached<GLuint> textures[kTextureUnitCount][kTextureTargetCount];
+};
+
+static GLStateCache sState;
+static GLStateStatistics sCurrentFrame;
+static GLStateStatistics sLastFrame;
+static GLStateStatistics sTotal;
+static unsigned long long sFrameCount = 0;
+
+// Counts the call and tells the caller whether to issue it
+static bool Count(bool changed)
+{
+  if (changed)
+  {
+    ++sCurrentFrame.issued;
+  }
+  else
+  {
+    ++sCurrentFrame.elided;
+  }
+  return changed;
+}
+
+template <typename T, size_t N>
+static int IndexOf(const T (&values)[N], T value)
+{
+  for (size_t i = 0; i < N; ++i)
+  {
+    if (values[i] == value)
+    {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+void GLStateInvalidate()
+{
+  sState = GLStateCache();
+}
+
+static void SetCapability(GLenum capability, bool enabled)
+{
+  int index = IndexOf(kCapabilities, capability);
+  if (index < 0)
+  {
+    // Not tracked, always issue
+    Count(true);
+  }
+  else if (!Count(sState.capabilities[index].Set(enabled)))
+  {
+    return;
+  }
+
+  if (enabled)
+  {
+    glEnable(capability);
+  }
+  else
+  {
+    glDisable(capability);
+  }
+}
+
+void GLStateEnable(GLenum capability)
+{
+  SetCapability(capability, true);
+}
+
+void GLStateDisable(GLenum capability)
+{
+  SetCapability(capability, false);
+}
+
+void GLStateViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  if (Count(sState.viewport.Set({ x, y, width, height })))
+  {
+    glViewport(x, y, width, height);
+  }
+}
+
+void GLStateClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  if (Count(sState.clearColor.Set({ red, green, blue, alpha })))
+  {
+    glClearColor(red, green, blue, alpha);
+  }
+}
+
+void GLStateBlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+  if (Count(sState.blendFunc.Set({ sourceFactor, destinationFactor })))
+  {
+    glBlendFunc(sourceFactor, destinationFactor);
+  }
+}
+
+void GLStateUseProgram(GLuint program)
+{
+  if (Count(sState.program.Set(program)))
+  {
+    glUseProgram(program);
+  }
+}
+
+void GLStateBindVertexArray(GLuint vertexArray)
+{
+  if (Count(sState.vertexArray.Set(vertexArray)))
+  {
+    glBindVertexArray(vertexArray);
+    // The element array buffer binding is part of the VAO, so it just changed as well
+    sState.buffers[IndexOf(kBufferTargets, (GLenum)GL_ELEMENT_ARRAY_BUFFER)].known = false;
+  }
+}
+
+void GLStateBindBuffer(GLenum target, GLuint buffer)
+{
+  int index = IndexOf(kBufferTargets, target);
+  if (index >= 0 && !Count(sState.buffers[index].Set(buffer)))
+  {
+    return;
+  }
+  if (index < 0)
+  {
+    Count(true);
+  }
+  glBindBuffer(target, buffer);
+}
+
+void GLStateBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+  bool tracked = target == GL_UNIFORM_BUFFER && index < kUniformBindingCount;
+  if (tracked && !Count(sState.uniformBuffers[index].Set({ buffer, offset, size })))
+  {
+    return;
+  }
+  if (!tracked)
+  {
+    Count(true);
+  }
+  glBindBufferRange(target, index, buffer, offset, size);
+
+  int generic = IndexOf(kBufferTargets, target);
+  if (generic >= 0)
+  {
+    sState.buffers[generic].Set(buffer);
+  }
+}
+
+GLuint GLStateBoundBuffer(GLenum target)
+{
+  int index = IndexOf(kBufferTargets, target);
+  if (index < 0 || !sState.buffers[index].known)
+  {
+    return 0;
+  }
+  return sState.buffers[index].value;
+}
+
+void GLStateBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+  bool changed = false;
+  if (target == GL_FRAMEBUFFER)
+  {
+    // Binding GL_FRAMEBUFFER sets both the draw and the read framebuffer
+    bool drawChanged = sState.drawFramebuffer.Set(framebuffer);
+    bool readChanged = sState.readFramebuffer.Set(framebuffer);
+    changed = drawChanged || readChanged;
+  }
+  else if (target == GL_DRAW_FRAMEBUFFER)
+  {
+    changed = sState.drawFramebuffer.Set(framebuffer);
+  }
+  else
+  {
+    changed = sState.readFramebuffer.Set(framebuffer);
+  }
+
+  if (Count(changed))
+  {
+    glBindFramebuffer(target, framebuffer);
+  }
+}
+
+void GLStateActiveTexture(GLenum textureUnit)
+{
+  if (Count(sState.activeTexture.Set(textureUnit)))
+  {
+    glActiveTexture(textureUnit);
+  }
+}
+
+void GLStateBindTexture(GLenum target, GLuint texture)
+{
+  // glActiveTexture defaults to GL_TEXTURE0, but we can only rely on that if we set it ourselves
+  int unit = sState.activeTexture.known ? (int)(sState.activeTexture.value - GL_TEXTURE0) : -1;
+  int index = IndexOf(kTextureTargets, target);
+  if (unit >= 0 && unit < kTextureUnitCount && index >= 0)
+  {
+    if (!Count(sState.textures[unit][index].Set(texture)))
+    {
+      return;
+    }
+  }
+  else
+  {
+    Count(true);
+  }
+  glBindTexture(target, texture);
+}
+
+void GLStateBeginFrame()
+{
+  if (sCurrentFrame.issued + sCurrentFrame.elided > 0)
+  {
+    sLastFrame = sCurrentFrame;
+    sTotal.issued += sCurrentFrame.issued;
+    sTotal.elided += sCurrentFrame.elided;
+    ++sFrameCount;
+  }
+  sCurrentFrame = GLStateStatistics();
+}
+
+GLStateStatistics GLStateLastFrameStatistics()
+{
+  return sLastFrame;
+}
+
+GLStateStatistics GLStateTotalStatistics()
+{
+  return sTotal;
+}
+
+void GLStatePrintStatistics()
+{
+  // Include the frame that is still in progress
+  GLStateBeginFrame();
+
+  if (sFrameCount == 0)
+  {
+    return;
+  }
+  std::cout << "GL state cache: " << sTotal.issued << " calls issued, " << sTotal.elided << " elided ("
+	    << (double)sTotal.issued / sFrameCount << " issued and "
+	    << (double)sTotal.elided / sFrameCount << " elided per frame)" << std::endl;
+}
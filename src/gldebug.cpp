@@ -0,0 +1,302 @@
+#include <gloom/gldebug.hpp>
+
+#if GLOOM_GL_DEBUG
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// Size of the ring buffer between the driver and the render thread (must be a power of two)
+static const size_t kRingCapacity = 256;
+// Longer messages get truncated so that every slot has a fixed size
+static const size_t kMaxMessageLength = 512;
+
+struct DebugMessage
+{
+  GLenum source = 0;
+  GLenum type = 0;
+  GLenum severity = 0;
+  GLuint id = 0;
+  char text[kMaxMessageLength] = {};
+};
+
+// Every slot carries a sequence number that tells producers and the consumer
+// whose turn it is, so no locks are needed (a bounded multi-producer queue).
+// Slot i starts out with sequence i, meaning 'free for the producer at position i'.
+// After writing, the producer sets it to position + 1, meaning 'ready for the consumer'.
+// After reading, the consumer sets it to position + capacity, freeing it for the next lap.
+struct RingSlot
+{
+  std::atomic<size_t> sequence{0};
+  DebugMessage message;
+};
+
+static RingSlot sRing[kRingCapacity];
+static std::atomic<size_t> sEnqueuePosition{0};
+// Only the render thread dequeues, so this does not need to be atomic
+static size_t sDequeuePosition = 0;
+// Messages that arrived while the ring was full
+static std::atomic<unsigned long long> sDroppedMessages{0};
+
+static bool sCallbackActive = false;
+static unsigned int sCheckCounter = 0;
+
+// How often we have seen each distinct message, and its text for the summary
+struct SeenMessage
+{
+  unsigned long long count = 0;
+  std::string text;
+};
+static std::unordered_map<uint64_t, SeenMessage> sSeenMessages;
+
+static bool PushMessage(const DebugMessage& message)
+{
+  size_t position = sEnqueuePosition.load(std::memory_order_relaxed);
+  RingSlot* slot = nullptr;
+  for (;;)
+  {
+    slot = &sRing[position & (kRingCapacity - 1)];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+    if (difference == 0)
+    {
+      // The slot is free, try to claim it
+      if (sEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (difference < 0)
+    {
+      // The consumer has not caught up, the ring is full
+      sDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else
+    {
+      // Another producer claimed this slot first
+      position = sEnqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->message = message;
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+static bool PopMessage(DebugMessage& message)
+{
+  RingSlot& slot = sRing[sDequeuePosition & (kRingCapacity - 1)];
+  size_t sequence = slot.sequence.load(std::memory_order_acquire);
+  if ((intptr_t)sequence - (intptr_t)(sDequeuePosition + 1) < 0)
+  {
+    // Nothing written to this slot yet
+    return false;
+  }
+
+  message = slot.message;
+  slot.sequence.store(sDequeuePosition + kRingCapacity, std::memory_order_release);
+  ++sDequeuePosition;
+  return true;
+}
+
+/*
+  Called by the driver, possibly from one of its own threads.
+  Must be cheap and must not call OpenGL, so all we do is copy the message into the ring.
+*/
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+					  GLsizei length, const GLchar* text, const void* userParam)
+{
+  (void)userParam;
+
+  DebugMessage message;
+  message.source = source;
+  message.type = type;
+  message.severity = severity;
+  message.id = id;
+  size_t textLength = length >= 0 ? (size_t)length : std::strlen(text);
+  if (textLength >= kMaxMessageLength)
+  {
+    textLength = kMaxMessageLength - 1;
+  }
+  std::memcpy(message.text, text, textLength);
+  message.text[textLength] = '\0';
+
+  PushMessage(message);
+}
+
+static const char* SourceName(GLenum source)
+{
+  switch (source)
+  {
+    case GL_DEBUG_SOURCE_API: return "API";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "Window System";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY: return "Third Party";
+    case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+    default: return "Other";
+  }
+}
+
+static const char* TypeName(GLenum type)
+{
+  switch (type)
+  {
+    case GL_DEBUG_TYPE_ERROR: return "Error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated Behavior";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined Behavior";
+    case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+    case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+    case GL_DEBUG_TYPE_MARKER: return "Marker";
+    default: return "Other";
+  }
+}
+
+static const char* SeverityName(GLenum severity)
+{
+  switch (severity)
+  {
+    case GL_DEBUG_SEVERITY_HIGH: return "High";
+    case GL_DEBUG_SEVERITY_MEDIUM: return "Medium";
+    case GL_DEBUG_SEVERITY_LOW: return "Low";
+    default: return "Notification";
+  }
+}
+
+// Messages are the same if everything including the text matches
+// (some drivers use id 0 for many different messages)
+static uint64_t MessageKey(const DebugMessage& message)
+{
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](uint64_t value) {
+    hash ^= value;
+    hash *= 1099511628211ull;
+  };
+  mix(message.source);
+  mix(message.type);
+  mix(message.severity);
+  mix(message.id);
+  for (const char* c = message.text; *c != '\0'; ++c)
+  {
+    mix((unsigned char)*c);
+  }
+  return hash;
+}
+
+void GLDebugInitialize()
+{
+  for (size_t i = 0; i < kRingCapacity; ++i)
+  {
+    sRing[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  sEnqueuePosition.store(0, std::memory_order_relaxed);
+  sDequeuePosition = 0;
+
+  if (GLAD_GL_KHR_debug && glad_glDebugMessageCallback != nullptr)
+  {
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(DebugMessageCallback, nullptr);
+    // Notifications are informational only (e.g. 'buffer will use video memory'),
+    // so we ask the driver not to generate them at all
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    sCallbackActive = true;
+    std::cout << "OpenGL debug output: GL_KHR_debug" << std::endl;
+  }
+  else if (GLAD_GL_ARB_debug_output && glad_glDebugMessageCallbackARB != nullptr)
+  {
+    // ARB_debug_output has no notification severity, and is always on once a callback is set
+    glDebugMessageCallbackARB(DebugMessageCallback, nullptr);
+    sCallbackActive = true;
+    std::cout << "OpenGL debug output: GL_ARB_debug_output" << std::endl;
+  }
+  else
+  {
+    sCallbackActive = false;
+    std::cout << "OpenGL debug output: sampling glGetError every "
+	      << kGLDebugSampleInterval << " checks" << std::endl;
+  }
+}
+
+void GLDebugFlush()
+{
+  DebugMessage message;
+  while (PopMessage(message))
+  {
+    SeenMessage& seen = sSeenMessages[MessageKey(message)];
+    ++seen.count;
+    if (seen.count > 1)
+    {
+      // Already printed, it will show up in the summary
+      continue;
+    }
+    seen.text = message.text;
+
+    std::cout << "OpenGL " << SeverityName(message.severity)
+	      << " [" << SourceName(message.source) << ", " << TypeName(message.type)
+	      << ", id " << message.id << "]: " << message.text << std::endl;
+  }
+}
+
+void GLDebugShutdown()
+{
+  GLDebugFlush();
+
+  if (sCallbackActive)
+  {
+    if (GLAD_GL_KHR_debug)
+    {
+      glDebugMessageCallback(nullptr, nullptr);
+      glDisable(GL_DEBUG_OUTPUT);
+    }
+    else
+    {
+      glDebugMessageCallbackARB(nullptr, nullptr);
+    }
+    sCallbackActive = false;
+  }
+
+  for (const auto& entry : sSeenMessages)
+  {
+    if (entry.second.count > 1)
+    {
+      std::cout << "OpenGL message repeated " << entry.second.count << " times: " << entry.second.text << std::endl;
+    }
+  }
+  unsigned long long dropped = sDroppedMessages.load(std::memory_order_relaxed);
+  if (dropped > 0)
+  {
+    std::cout << "OpenGL debug output: " << dropped << " messages dropped (ring buffer full)" << std::endl;
+  }
+  sSeenMessages.clear();
+}
+
+void GLDebugCheckCall(const char* function, const char* file, int line)
+{
+  // The driver already reports errors to our callback
+  if (sCallbackActive)
+  {
+    return;
+  }
+
+  if (++sCheckCounter % kGLDebugSampleInterval != 0)
+  {
+    return;
+  }
+
+  // Note: since we do not check after every call, the error may come from an earlier call
+  while (GLenum error = glGetError())
+  {
+    std::cout << "OpenGL Error:" << error
+	      << "\tLine: " << line
+	      << "\tFile: " << file
+	      << "\tfunction: " << function
+	      << " (or a call before it)" << std::endl;
+  }
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include <gloom/headless.hpp>
+#include <gloom/gldebug.hpp>
+
+// Third Party Libraries
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+// C++ Standard Template Library (STL)
+#include <iostream>
+#include <string>
+
+// EGL objects for the headless context
+// These are only valid between CreateHeadlessContext and DestroyHeadlessContext
+static EGLDisplay sDisplay = EGL_NO_DISPLAY;
+static EGLContext sContext = EGL_NO_CONTEXT;
+
+/*
+  Finds an EGL display that does not need a window system.
+  We prefer Mesa's 'surfaceless' platform, which works without X11 or Wayland running.
+  If the platform extension is missing we fall back to the default display.
+*/
+static EGLDisplay GetHeadlessDisplay()
+{
+  const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+  if (clientExtensions != nullptr && eglGetPlatformDisplayEXT != nullptr)
+  {
+    std::string extensions = clientExtensions;
+    if (extensions.find("EGL_MESA_platform_surfaceless") != std::string::npos)
+    {
+      EGLDisplay display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      if (display != EGL_NO_DISPLAY)
+      {
+        return display;
+      }
+    }
+  }
+
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool CreateHeadlessContext(int majorVersion, int minorVersion)
+{
+  sDisplay = GetHeadlessDisplay();
+  if (sDisplay == EGL_NO_DISPLAY)
+  {
+    std::cout << "EGL display could not be opened" << std::endl;
+    return false;
+  }
+
+  EGLint eglMajor = 0;
+  EGLint eglMinor = 0;
+  if (!eglInitialize(sDisplay, &eglMajor, &eglMinor))
+  {
+    std::cout << "EGL could not be initialized (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+    sDisplay = EGL_NO_DISPLAY;
+    return false;
+  }
+
+  // Rendering without any surface at all requires EGL_KHR_surfaceless_context
+  const char* displayExtensions = eglQueryString(sDisplay, EGL_EXTENSIONS);
+  if (displayExtensions == nullptr ||
+      std::string(displayExtensions).find("EGL_KHR_surfaceless_context") == std::string::npos)
+  {
+    std::cout << "EGL_KHR_surfaceless_context is not supported" << std::endl;
+    DestroyHeadlessContext();
+    return false;
+  }
+
+  // EGL defaults to OpenGL ES, so we have to ask for desktop OpenGL explicitly
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    std::cout << "EGL does not support desktop OpenGL" << std::endl;
+    DestroyHeadlessContext();
+    return false;
+  }
+
+  // Same request as the SDL path: OpenGL core profile of the given version or greater.
+  // With EGL_KHR_no_config_context we do not need a config, since we never create a surface.
+  const EGLint contextAttributes[] = {
+    EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+    EGL_CONTEXT_MINOR_VERSION, minorVersion,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if GLOOM_GL_DEBUG
+    EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+    EGL_NONE
+  };
+  EGLConfig config = EGL_NO_CONFIG_KHR;
+  if (std::string(displayExtensions).find("EGL_KHR_no_config_context") == std::string::npos)
+  {
+    // Older drivers still want a config, any one that can render desktop OpenGL will do
+    const EGLint configAttributes[] = {
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_NONE
+    };
+    EGLint configCount = 0;
+    if (!eglChooseConfig(sDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+      std::cout << "EGL could not find a config for desktop OpenGL" << std::endl;
+      DestroyHeadlessContext();
+      return false;
+    }
+  }
+
+  sContext = eglCreateContext(sDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+  if (sContext == EGL_NO_CONTEXT)
+  {
+    std::cout << "EGL context could not be created (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+    DestroyHeadlessContext();
+    return false;
+  }
+
+  if (!eglMakeCurrent(sDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, sContext))
+  {
+    std::cout << "EGL context could not be made current" << std::endl;
+    DestroyHeadlessContext();
+    return false;
+  }
+
+  return true;
+}
+
+void* GetHeadlessProcAddress(const char* name)
+{
+  return (void*)eglGetProcAddress(name);
+}
+
+bool MakeHeadlessContextCurrent(bool current)
+{
+  EGLContext context = current ? sContext : EGL_NO_CONTEXT;
+  return eglMakeCurrent(sDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+}
+
+void DestroyHeadlessContext()
+{
+  if (sDisplay == EGL_NO_DISPLAY)
+  {
+    return;
+  }
+
+  eglMakeCurrent(sDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (sContext != EGL_NO_CONTEXT)
+  {
+    eglDestroyContext(sDisplay, sContext);
+    sContext = EGL_NO_CONTEXT;
+  }
+  eglTerminate(sDisplay);
+  sDisplay = EGL_NO_DISPLAY;
+}
+
+bool CreateHeadlessFramebuffer(HeadlessFramebuffer& target, int width, int height)
+{
+  target.width = width;
+  target.height = height;
+
+  // Renderbuffers are the right choice here, since we never sample from these images
+  glGenRenderbuffers(1, &target.colorRenderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, target.colorRenderbuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenRenderbuffers(1, &target.depthRenderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, target.depthRenderbuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &target.framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorRenderbuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depthRenderbuffer);
+
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    std::cout << "Offscreen framebuffer is incomplete (status 0x" << std::hex << status << std::dec << ")" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+void DestroyHeadlessFramebuffer(HeadlessFramebuffer& target)
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &target.framebuffer);
+  glDeleteRenderbuffers(1, &target.colorRenderbuffer);
+  glDeleteRenderbuffers(1, &target.depthRenderbuffer);
+  target = HeadlessFramebuffer();
+}
@@ -0,0 +1,63 @@
+#include <gloom/instancing.hpp>
+#include <gloom/gl_state.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstddef>
+
+void CreateInstanceBuffer(InstanceBuffer& instances, GLuint vertexArray, GLsizei capacity)
+{
+  instances.capacity = capacity;
+  instances.count = 0;
+
+  // The attribute setup below is recorded in the vertex array, so it has to be bound first
+  glBindVertexArray(vertexArray);
+
+  glGenBuffers(1, &instances.buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, instances.buffer);
+  glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+
+  glEnableVertexAttribArray(kInstanceTranslationScaleLocation);
+  glVertexAttribPointer(kInstanceTranslationScaleLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			(GLvoid*)offsetof(InstanceData, translation));
+  // Advance once per instance instead of once per vertex
+  glVertexAttribDivisor(kInstanceTranslationScaleLocation, 1);
+
+  glEnableVertexAttribArray(kInstanceColorLocation);
+  glVertexAttribPointer(kInstanceColorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData),
+			(GLvoid*)offsetof(InstanceData, color));
+  glVertexAttribDivisor(kInstanceColorLocation, 1);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void UpdateInstanceBuffer(InstanceBuffer& instances, const InstanceData* data, GLsizei count)
+{
+  if (count > instances.capacity)
+  {
+    count = instances.capacity;
+  }
+  instances.count = count;
+
+  // May run every frame, so go through the state cache
+  GLStateBindBuffer(GL_ARRAY_BUFFER, instances.buffer);
+  // Orphan the old storage, the driver hands us fresh memory while draws still use the old one
+  glBufferData(GL_ARRAY_BUFFER, instances.capacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), data);
+}
+
+void SetConstantInstanceAttributes(const InstanceData& instance)
+{
+  glVertexAttrib4f(kInstanceTranslationScaleLocation, instance.translation[0], instance.translation[1],
+		   instance.translation[2], instance.scale);
+  glVertexAttrib4Nub(kInstanceColorLocation, instance.color[0], instance.color[1], instance.color[2],
+		     instance.color[3]);
+}
+
+void DestroyInstanceBuffer(InstanceBuffer& instances)
+{
+  // Unbind first, so the state cache does not remember a deleted name
+  GLStateBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDeleteBuffers(1, &instances.buffer);
+  instances = InstanceBuffer();
+}
@@ -0,0 +1,325 @@
+#include <gloom/job_system.hpp>
+#include <gloom/work_stealing_deque.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+// How often an idle thread looks for work before yielding, and yields before going to sleep
+static const int kSpinCount = 64;
+static const int kYieldCount = 256;
+
+static const size_t kCacheLineSize = 64;
+
+// Everything that belongs to one thread, on cache lines of its own
+struct alignas(kCacheLineSize) JobThread
+{
+  WorkStealingDeque<Job, kJobDequeCapacity> deque;
+  // Statistics, only written by the owning thread
+  std::atomic<unsigned long long> jobs{0};
+  std::atomic<unsigned long long> steals{0};
+  std::atomic<unsigned long long> overflows{0};
+  std::atomic<unsigned long long> sleeps{0};
+};
+
+// sThreads[0] is the main thread, the workers follow
+static std::vector<std::unique_ptr<JobThread>> sThreads;
+static std::vector<std::thread> sWorkers;
+static std::atomic<bool> sRunning{false};
+static std::atomic<bool> sStopRequested{false};
+
+// Sleeping workers are woken through this. 'sWorkGeneration' changes whenever jobs are
+// queued, a worker only goes to sleep if it did not change since it last looked for work.
+static std::mutex sSleepMutex;
+static std::condition_variable sWakeUp;
+static std::atomic<unsigned long long> sWorkGeneration{0};
+static std::atomic<int> sSleepingWorkers{0};
+
+// Index of the calling thread in sThreads, -1 for threads outside the job system
+static thread_local int tThreadIndex = -1;
+// Picks the first deque a thread tries to steal from
+static thread_local std::minstd_rand tRandom;
+
+// Adds a statistic without a read-modify-write, only the owning thread writes it
+static void Count(std::atomic<unsigned long long>& statistic)
+{
+  statistic.store(statistic.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+static void Execute(JobThread& thread, Job& job)
+{
+  job.function(job);
+  Count(thread.jobs);
+  if (job.counter != nullptr)
+  {
+    // Release: whatever the job wrote is visible to whoever sees the counter reach zero
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+static void WakeWorkers()
+{
+  sWorkGeneration.fetch_add(1, std::memory_order_seq_cst);
+  if (sSleepingWorkers.load(std::memory_order_seq_cst) > 0)
+  {
+    // Taking the lock makes sure a worker about to sleep either sees the new generation or gets the notification
+    std::lock_guard<std::mutex> lock(sSleepMutex);
+    sWakeUp.notify_all();
+  }
+}
+
+/*
+  Finds a job: the newest one of our own, else the oldest one of another thread
+  @return nullptr if there was none
+*/
+static Job* FindJob(int threadIndex)
+{
+  JobThread& thread = *sThreads[threadIndex];
+  Job* job = thread.deque.Pop();
+  if (job != nullptr)
+  {
+    return job;
+  }
+
+  // Start with a random victim, so thieves do not all line up at the same deque
+  int threadCount = (int)sThreads.size();
+  int first = (int)(tRandom() % threadCount);
+  for (int i = 0; i < threadCount; ++i)
+  {
+    int victim = (first + i) % threadCount;
+    if (victim == threadIndex)
+    {
+      continue;
+    }
+    job = sThreads[victim]->deque.Steal();
+    if (job != nullptr)
+    {
+      Count(thread.steals);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+static void Worker(int threadIndex)
+{
+  tThreadIndex = threadIndex;
+  JobThread& thread = *sThreads[threadIndex];
+  tRandom.seed(threadIndex + 1);
+
+  int attempts = 0;
+  while (!sStopRequested.load(std::memory_order_acquire))
+  {
+    unsigned long long generation = sWorkGeneration.load(std::memory_order_seq_cst);
+    Job* job = FindJob(threadIndex);
+    if (job != nullptr)
+    {
+      Execute(thread, *job);
+      attempts = 0;
+      continue;
+    }
+
+    // Spin briefly, then yield, then sleep, so idle workers do not burn whole cores
+    ++attempts;
+    if (attempts < kSpinCount)
+    {
+      continue;
+    }
+    if (attempts < kSpinCount + kYieldCount)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sSleepMutex);
+    sSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+    if (sWorkGeneration.load(std::memory_order_seq_cst) == generation && !sStopRequested.load())
+    {
+      Count(thread.sleeps);
+      sWakeUp.wait(lock, [generation] {
+	return sWorkGeneration.load(std::memory_order_seq_cst) != generation || sStopRequested.load();
+      });
+    }
+    sSleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+    attempts = 0;
+  }
+}
+
+void JobSystemStart(int workerCount)
+{
+  if (sRunning.load())
+  {
+    return;
+  }
+  if (workerCount < 0)
+  {
+    workerCount = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+  }
+
+  sThreads.clear();
+  for (int i = 0; i < workerCount + 1; ++i)
+  {
+    sThreads.push_back(std::make_unique<JobThread>());
+  }
+  tThreadIndex = 0;
+  sStopRequested.store(false);
+  sRunning.store(true);
+  for (int i = 1; i <= workerCount; ++i)
+  {
+    sWorkers.emplace_back(Worker, i);
+  }
+}
+
+void JobSystemStop()
+{
+  if (!sRunning.load())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sSleepMutex);
+    sStopRequested.store(true, std::memory_order_release);
+  }
+  sWakeUp.notify_all();
+  for (std::thread& worker : sWorkers)
+  {
+    worker.join();
+  }
+  sWorkers.clear();
+  sRunning.store(false);
+  tThreadIndex = -1;
+}
+
+int JobSystemThreadCount()
+{
+  return sRunning.load(std::memory_order_relaxed) ? (int)sThreads.size() : 1;
+}
+
+void JobRun(Job& job)
+{
+  if (job.counter != nullptr)
+  {
+    job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  int threadIndex = tThreadIndex;
+  if (!sRunning.load(std::memory_order_relaxed) || threadIndex < 0)
+  {
+    job.function(job);
+    if (job.counter != nullptr)
+    {
+      job.counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+    return;
+  }
+
+  JobThread& thread = *sThreads[threadIndex];
+  if (!thread.deque.Push(&job))
+  {
+    Count(thread.overflows);
+    Execute(thread, job);
+    return;
+  }
+  WakeWorkers();
+}
+
+void JobRun(Job* jobs, size_t count, JobCounter& counter)
+{
+  // Count the whole group first, so a waiter never sees zero while some jobs are not queued yet
+  counter.pending.fetch_add((int)count, std::memory_order_relaxed);
+
+  int threadIndex = tThreadIndex;
+  if (!sRunning.load(std::memory_order_relaxed) || threadIndex < 0)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      jobs[i].counter = &counter;
+      jobs[i].function(jobs[i]);
+      counter.pending.fetch_sub(1, std::memory_order_release);
+    }
+    return;
+  }
+
+  JobThread& thread = *sThreads[threadIndex];
+  for (size_t i = 0; i < count; ++i)
+  {
+    jobs[i].counter = &counter;
+    if (!thread.deque.Push(&jobs[i]))
+    {
+      Count(thread.overflows);
+      Execute(thread, jobs[i]);
+    }
+  }
+  WakeWorkers();
+}
+
+void JobWait(JobCounter& counter)
+{
+  int threadIndex = tThreadIndex;
+  if (!sRunning.load(std::memory_order_relaxed) || threadIndex < 0)
+  {
+    // Without the job system every job already ran in JobRun
+    while (counter.pending.load(std::memory_order_acquire) > 0)
+    {
+      std::this_thread::yield();
+    }
+    return;
+  }
+
+  // Help out instead of blocking. Jobs we run may be unrelated to the counter, that is fine,
+  // they had to run anyway.
+  JobThread& thread = *sThreads[threadIndex];
+  int attempts = 0;
+  while (counter.pending.load(std::memory_order_acquire) > 0)
+  {
+    Job* job = FindJob(threadIndex);
+    if (job != nullptr)
+    {
+      Execute(thread, *job);
+      attempts = 0;
+    }
+    else if (++attempts >= kSpinCount)
+    {
+      // The last jobs are running on other threads
+      std::this_thread::yield();
+    }
+  }
+}
+
+JobSystemStatistics GetJobSystemStatistics()
+{
+  JobSystemStatistics statistics;
+  for (const std::unique_ptr<JobThread>& thread : sThreads)
+  {
+    statistics.jobs += thread->jobs.load(std::memory_order_relaxed);
+    statistics.steals += thread->steals.load(std::memory_order_relaxed);
+    statistics.overflows += thread->overflows.load(std::memory_order_relaxed);
+    statistics.sleeps += thread->sleeps.load(std::memory_order_relaxed);
+  }
+  return statistics;
+}
+
+void JobSystemPrintStatistics()
+{
+  if (sThreads.empty())
+  {
+    return;
+  }
+
+  JobSystemStatistics statistics = GetJobSystemStatistics();
+  std::cout << "Job system: " << sThreads.size() << " threads ran " << statistics.jobs << " jobs, "
+	    << statistics.steals << " stolen, " << statistics.overflows << " ran on the spot (full deque), "
+	    << "workers slept " << statistics.sleeps << " times" << std::endl;
+  std::cout << "  Jobs per thread:";
+  for (const std::unique_ptr<JobThread>& thread : sThreads)
+  {
+    std::cout << " " << thread->jobs.load(std::memory_order_relaxed);
+  }
+  std::cout << std::endl;
+}
@@ -1,6 +1,43 @@
 /*
   Compilation on Linux
-  g++ -std=c++17 ./src/* -o prog -I ./include/ -I ./thirdparty/glm-master/ -lSDL2 -ldl
+  g++ -std=c++17 ./src/* -o prog -I ./include/ -I ./thirdparty/glm-master/ -lSDL2 -lEGL -ldl -pthread
+
+  Run without a display (renders offscreen and reports frames per second)
+  ./prog --headless --frames 1000
+
+  Render on a dedicated thread, while the main thread simulates the next frame
+  ./prog --render-thread --simulate-us 500
+
+  Reload the shaders in ./shaders whenever they are saved
+  ./prog --hot-reload
+
+  Spread the simulated game logic over 7 worker threads and the main thread
+  ./prog --simulate-us 4000 --jobs 7
+
+  Load the quad from another binary mesh file (convert OBJ files with tools/mesh_convert.cpp)
+  ./prog --mesh ./meshes/quad.mesh
+
+  Draw 10000 quads with a single instanced draw call
+  ./prog --instances 10000
+
+  Draw 100000 rotating 2D sprites over the scene with a sprite batch
+  ./prog --sprites 100000
+
+  Add a fountain of up to 100000 particles, simulated with SIMD on the job system and drawn instanced
+  ./prog --particles 100000 --jobs 3
+
+  Texture the quad with a TGA file, decoded and uploaded in the background
+  ./prog --texture ./textures/checker.tga
+
+  Show the frame's CPU and GPU times from the profiler in a text overlay
+  ./prog --overlay
+
+  Limit the frame rate to 120 FPS without vsync, or cap the frames queued on the GPU
+  ./prog --pacing limiter --fps 120
+  ./prog --pacing low-latency --max-queued 1
+
+  Write the frame profile as JSON and as a Chrome trace (open in chrome://tracing)
+  ./prog --profile profile.json --trace trace.json
 */
 
 // Third Party Libraries
@@ -8,11 +45,41 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+// GLoom
+#include <gloom/asset_io.hpp>
+#include <gloom/culling.hpp>
+#include <gloom/draw_bucket.hpp>
+#include <gloom/frame_pacing.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/gldebug.hpp>
+#include <gloom/headless.hpp>
+#include <gloom/instancing.hpp>
+#include <gloom/job_system.hpp>
+#include <gloom/mesh.hpp>
+#include <gloom/particle_system.hpp>
+#include <gloom/profiler.hpp>
+#include <gloom/program_cache.hpp>
+#include <gloom/render_commands.hpp>
+#include <gloom/render_thread.hpp>
+#include <gloom/shader_hot_reload.hpp>
+#include <gloom/shader_manager.hpp>
+#include <gloom/sprite_batch.hpp>
+#include <gloom/stream_buffer.hpp>
+#include <gloom/text_renderer.hpp>
+#include <gloom/texture_streaming.hpp>
+#include <gloom/transform.hpp>
+#include <gloom/uniform_buffer.hpp>
+
 // C++ Standard Template Library (STL)
 #include <iostream>
 #include <vector>
 #include <string>
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 
 // #################### vvv Globals vvv ####################
 // Globals are prefixed with 'g'
@@ -26,54 +93,111 @@ SDL_GLContext gOpenGLContext = nullptr;
 // Main loop flag
 bool gQuit = false; // If this is true then the program terminates
 
+// Headless mode
+// When set (with --headless) we do not open a window. Instead we render into an
+// offscreen framebuffer and report how many frames per second we achieved.
+bool gHeadless = false;
+// Number of frames to render before quitting, 0 means run until the user quits
+// Note: headless mode has no user to close the window, so it defaults to a fixed count
+int gFrameLimit = 0;
+HeadlessFramebuffer gHeadlessFramebuffer;
+
+// Frame pacing
+// When the next frame starts (with --pacing, see gloom/frame_pacing.hpp). A window waits for
+// vsync unless told otherwise, headless runs are benchmarks and render as fast as they can.
+FramePacingSettings gFramePacing;
+bool gFramePacingChosen = false;
+
+// Threading
+// If set (with --render-thread), a dedicated render thread owns the OpenGL context and executes
+// the commands recorded by the main thread, so simulation and rendering overlap
+bool gRenderThread = false;
+// Simulated game logic cost per frame in microseconds (with --simulate-us).
+// There is no real game logic yet, this lets us measure what the render thread buys us.
+int gSimulationMicroseconds = 0;
+// Worker threads of the job system (with --jobs), the frame's CPU work is spread over them
+// and the main thread. 0 keeps everything on the main thread.
+int gJobWorkers = 0;
+// The simulated game logic is split into this many equal jobs
+const int kSimulationJobs = 64;
+
+// Profiling
+// If set, the frame profile is written to these files when the program exits
+std::string gProfileJSONFilename = "";
+std::string gProfileTraceFilename = "";
+
 // shader
 // The following stores the unique id for the graphics pipeline
 // program object that will be used for our OpenGL draw calls.
-GLuint gGraphicsPipelineShaderProgram = 0;
+// Note: It is atomic because shader hot reloading may replace it on the render thread
+// while the main thread records commands that use it.
+std::atomic<GLuint> gGraphicsPipelineShaderProgram{0};
+// Linked programs are cached here as driver specific binaries, so we only compile them on the first launch
+std::string gShaderCacheDirectory = "./shadercache";
+// If set (with --hot-reload), editing a shader file recompiles it while the program is running
+bool gShaderHotReload = false;
 
 // OpenGL Objects
-// Vertex Array Object (VAO)
-// Vertex array objects encapsulate all of the items needed to render an object
-// For example, we may have multiple vertex buffer objects (VBO) related to rendering one object.
-// The VAO allows us to setup the OpenGL state to render that object using the correct
-// layout and correct buffers with one call after being setup
-GLuint gVertexArrayObject = 0;
-//Vertex Buffer Object (VBO)
-// Vertex Buffer Objects store information relating to vertices (e.g. positions, normals, textures)
-// VBOs are our mechanisim for arranging geometry on the GPU.
-GLuint gVertexBufferObject = 0;
-// Index Buffer Object (IBO)
-// This is used to store the array of indices that we want
-// to draw from, when we do indexed drawing.
-GLuint gIndexBufferObject = 0;
+// The quad we draw: its vertex array, vertex buffer and index buffer (see gloom/mesh.hpp)
+Mesh gQuadMesh;
+// Binary mesh file the quad is loaded from (with --mesh), convert OBJ files with tools/mesh_convert.cpp
+std::string gMeshFilename = "./meshes/quad.mesh";
+// Per instance Buffer
+// Holds the translation, scale and color of every copy of our quad,
+// so all of them are drawn with a single instanced draw call.
+InstanceBuffer gInstanceBuffer;
+// Number of quads to draw (with --instances), laid out in a grid
+int gInstanceCount = 1;
+
+// Draw calls of the current frame, sorted by state before they are issued
+DrawBucket gDrawBucket;
+// Everything in the scene: the draw each object needs, and (at the same index) its bounds.
+// Only the objects inside the view frustum are pushed into the draw bucket.
+std::vector<DrawPacket> gSceneObjects;
+CullingSet gSceneBounds;
+// Where each object is: its node in the transform hierarchy, and its bounds around the node's origin
+TransformHierarchy gSceneTransforms;
+std::vector<uint32_t> gSceneTransformNodes;
+std::vector<glm::vec3> gSceneHalfExtents;
+// Indices of the objects that survived culling this frame
+std::vector<uint32_t> gVisibleObjects;
+// Uniform Buffer
+// The shader constants of every frame (the view's and each draw's), written into one buffer
+// and selected per draw with glBindBufferRange, instead of glUniform* calls
+UniformRing gUniformRing;
+const size_t kUniformRingBytesPerFrame = 64 * 1024;
+// Textures
+// The quad's texture (with --texture) streams in over a few frames, see gloom/texture_streaming.hpp.
+// Until its first level arrives (or without one) the quad uses a 1x1 white texture.
+std::string gTextureFilename = "";
+TextureHandle gTexture = kInvalidTexture;
+GLuint gWhiteTexture = 0;
+// Sprites
+// 2D sprites (with --sprites N) drawn over the scene in a few batched draw calls, see gloom/sprite_batch.hpp.
+// Their program reads pixel positions, through an orthographic ViewBlock of their own.
+int gSpriteCount = 0;
+SpriteBatch gSpriteBatch;
+std::atomic<GLuint> gSpriteShaderProgram{0};
+// Overlay
+// Live statistics (with --overlay) drawn as text with the sprite program, see gloom/text_renderer.hpp
+bool gOverlay = false;
+TextRenderer gOverlayText;
+const size_t kOverlayMaxGlyphs = 4096;
+// Particles
+// A fountain of particles (with --particles N), simulated in Update and drawn as one instanced
+// draw of the scene's program, see gloom/particle_system.hpp
+int gParticleCount = 0;
+ParticleSystem gParticles;
+// Simulated seconds per frame, fixed so every run looks the same whatever the frame rate
+const float kParticleTimeStep = 1.0f / 60.0f;
 // #################### ^^^ Globals ^^^ ####################
 
 
 
 // #################### vvv Error handling routines vvv ####################
-static void GLClearAllErrors()
-{
-  while(glGetError() != GL_NO_ERROR)
-  {
-    
-  }
-}
-
-// Returns true if we have an error
-static bool GLCheckErrorStatus(const char* function, int line)
-{
-  while (GLenum error = glGetError())
-  {
-    std::cout << "OpenGL Error:" << error
-	      << "\tLine: " << line
-	      << "\tfunction: " << function << std::endl;
-    return true;
-  }
-
-  return false;
-}
-
-#define GLCheck(x) GLClearAllErrors(); x; GLCheckErrorStatus(#x, __LINE__);
+// Errors are reported by the driver through a debug callback (see gloom/gldebug.hpp).
+// GLCheck(x) only falls back to (sampled) glGetError polling when no callback is available,
+// and compiles down to plain x in release builds (-DNDEBUG).
 // #################### ^^^ Error handling routines ^^^ ####################
 
 /*
@@ -88,238 +212,225 @@ void GetOpenGLVersionInfo()
 }
 
 /*
-  LoadShaderAsString takes a filepath as an argument and will read line by line a file and return a string that is meant to be compiled at runtime for a vertex, fragment, geometry, tesselation, or compute shader.
-  e.g.
-    LoadShaderAsString("./shaders/filepath");
-  @param filename Path to the shader file
-  @return Entire file stored as a single string
+  Create the graphics pipeline
+
+  @return void
 */
-std::string LoadShaderAsString(const std::string& filename)
+void CreateGraphicsPipeline()
 {
-  // Resulting shader program loaded as a single string
-  std::string result = "";
+  ProgramCacheInitialize(gShaderCacheDirectory);
+  ShaderManagerInitialize();
+
+  // Submit every program first, so the driver can compile them all at the same time.
+  // Note: With more pipelines, each one would be submitted here before any of them is requested.
+  // The shader files are loaded without copying, and their contents go straight to glShaderSource
+  AssetFile vertexShaderSource = LoadAsset("./shaders/vert.glsl");
+  AssetFile fragmentShaderSource = LoadAsset("./shaders/frag.glsl");
+  ShaderProgramHandle graphicsPipeline = ShaderManagerSubmit("graphics pipeline", vertexShaderSource.View(), fragmentShaderSource.View());
+  ShaderProgramHandle spritePipeline = kInvalidShaderProgram;
+  if (gSpriteCount > 0 || gOverlay)
+  {
+    AssetFile spriteVertexShaderSource = LoadAsset("./shaders/sprite_vert.glsl");
+    AssetFile spriteFragmentShaderSource = LoadAsset("./shaders/sprite_frag.glsl");
+    spritePipeline = ShaderManagerSubmit("sprite pipeline", spriteVertexShaderSource.View(), spriteFragmentShaderSource.View());
+  }
 
-  std::string line = "";
-  std::ifstream myFile(filename.c_str());
+  // Only now do we wait for the compiler
+  gGraphicsPipelineShaderProgram = ShaderManagerGetProgram(graphicsPipeline);
+  if (spritePipeline != kInvalidShaderProgram)
+  {
+    gSpriteShaderProgram = ShaderManagerGetProgram(spritePipeline);
+  }
 
-  if(myFile.is_open())
+  if (gShaderHotReload)
   {
-    while(std::getline(myFile, line))
+    ShaderHotReloadWatch("graphics pipeline", "./shaders/vert.glsl", "./shaders/frag.glsl",
+			 graphicsPipeline, &gGraphicsPipelineShaderProgram);
+    if (spritePipeline != kInvalidShaderProgram)
     {
-      result += line + '\n';
+      ShaderHotReloadWatch("sprite pipeline", "./shaders/sprite_vert.glsl", "./shaders/sprite_frag.glsl",
+			   spritePipeline, &gSpriteShaderProgram);
     }
-    myFile.close();
+    ShaderHotReloadStart("./shaders");
   }
-  return result;
+
+  AssetIOPrintStatistics();
+  ProgramCachePrintStatistics();
+  ShaderManagerPrintStatistics();
 }
 
 /*
-  CompileShader will compile any valid vertex, fragment, geometry, tesselation or compute shader.
-  e.g.
-    Compile a vertex shader: CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    Compile a fragment shader: CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-  @param type We use the 'type' field to determine which shader we are going to compile
-  @param source : The shader source code.
-  @return id of the shaderObject
+  @return void
 */
-GLuint CompileShader(GLuint type, const std::string& source)
+void VertexSpecification()
 {
-  // Compile our shaders
-  GLuint shaderObject;
+  // Geometry Data
+  // The positions and colors of our vertices, and the indices of the triangles, come from a
+  // binary mesh file. Its vertex and index streams are already laid out the way the GPU
+  // reads them, so they are uploaded straight from the (memory mapped) file into
+  // a vertex buffer object and an index buffer object, and the vertex array object
+  // is set up from the attribute layout stored in the file.
+  if (!LoadMesh(gMeshFilename, gQuadMesh))
+  {
+    exit(1);
+  }
 
-  // Based on the type passed in, we create a shader object specifically for that
-  if (type == GL_VERTEX_SHADER)
+  // Per instance data
+  // A single quad covers the middle of the screen in its original colors. More quads are
+  // shrunk into a grid covering the whole screen, each tinted differently.
+  std::vector<InstanceData> instances(gInstanceCount);
+  int columns = 1;
+  while (columns * columns < gInstanceCount)
   {
-    shaderObject = glCreateShader(GL_VERTEX_SHADER);
-  
-  } 
-  else if (type == GL_FRAGMENT_SHADER)
+    ++columns;
+  }
+  for (int i = 0; i < gInstanceCount; ++i)
   {
-    shaderObject = glCreateShader(GL_FRAGMENT_SHADER);
+    InstanceData& instance = instances[i];
+    float cellSize = 2.0f / columns;
+    instance.translation[0] = gInstanceCount == 1 ? 0.0f : -1.0f + cellSize * (i % columns + 0.5f);
+    instance.translation[1] = gInstanceCount == 1 ? 0.0f : -1.0f + cellSize * (i / columns + 0.5f);
+    instance.translation[2] = 0.0f;
+    instance.scale = gInstanceCount == 1 ? 1.0f : cellSize;
+    instance.color[0] = gInstanceCount == 1 ? 255 : (GLubyte)(128 + (i * 37) % 128);
+    instance.color[1] = gInstanceCount == 1 ? 255 : (GLubyte)(128 + (i * 59) % 128);
+    instance.color[2] = gInstanceCount == 1 ? 255 : (GLubyte)(128 + (i * 83) % 128);
+    instance.color[3] = 255;
   }
 
-  const char* src = source.c_str();
-  // The source of our shader
-  glShaderSource(shaderObject, 1, &src, nullptr);
-  // Now compile our shader
-  glCompileShader(shaderObject);
-
-  // Retrieve the result of our compilation
-  int result;
-  // Our goal with glGetShaderiv is to retrieve the compilation status
-  glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &result);
-
-  if (result == GL_FALSE)
+  // The instance attributes are added to the quad's vertex array,
+  // with a divisor of 1 so they advance once per quad instead of once per vertex
+  CreateInstanceBuffer(gInstanceBuffer, gQuadMesh.vertexArray, gInstanceCount);
+  UpdateInstanceBuffer(gInstanceBuffer, instances.data(), gInstanceCount);
+
+  // Scene
+  // For now the scene is a single object, the quad with every copy of it in one instanced draw.
+  // Its bounds enclose all instances: the grid fills the screen, a single quad sits inside it.
+  DrawPacket quad;
+  quad.vertexArray = gQuadMesh.vertexArray;
+  quad.mode = GL_TRIANGLES;
+  quad.count = gQuadMesh.indexCount;
+  quad.indexType = gQuadMesh.indexType;
+  quad.indexOffset = 0;
+  quad.instanceCount = gInstanceBuffer.count;
+  gSceneObjects.push_back(quad);
+  gSceneTransformNodes.push_back(TransformAdd(gSceneTransforms, kTransformNoParent));
+  gSceneHalfExtents.push_back(glm::vec3(1.0f, 1.0f, 0.0f));
+  CullingSetAdd(gSceneBounds, glm::vec3(0.0f, 0.0f, 0.0f), gSceneHalfExtents.back());
+
+  // Texture Data
+  // The white texture is ready right away, a texture file is decoded and uploaded in the background
+  const GLubyte white[4] = { 255, 255, 255, 255 };
+  glGenTextures(1, &gWhiteTexture);
+  GLStateBindTexture(GL_TEXTURE_2D, gWhiteTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  if (!gTextureFilename.empty())
   {
-    int length;
-    glGetShaderiv(shaderObject, GL_INFO_LOG_LENGTH, &length);
-    char * errorMessages = new char[length]; // Could also use alloc here
-    glGetShaderInfoLog(shaderObject, length, &length, errorMessages);
-
-    if (type == GL_VERTEX_SHADER)
-    {
-      std::cout << "ERROR: GL_VERTEX_SHADER compilation failed!\n" << errorMessages << "\n";
-    }
-    else if (type == GL_FRAGMENT_SHADER)
+    if (!TextureStreamerStart(TextureStreamerSettings()))
     {
-      std::cout << "ERROR: GL_FRAGMENT_SHADER compilation failed!\n" << errorMessages << "\n";
+      std::cout << "Failed to start texture streaming" << std::endl;
+      exit(1);
     }
+    gTexture = TextureRequest(gTextureFilename);
+  }
 
-    // Reclaim our memory
-    delete[] errorMessages;
-
-    // Delete our broken shader
-    glDeleteShader(shaderObject);
-
-    return 0;
+  // Uniform Data
+  // Room for the view's uniforms and those of the draws, every frame in flight has its own region
+  if (!CreateUniformRing(gUniformRing, kUniformRingBytesPerFrame))
+  {
+    std::cout << "Failed to create the uniform buffer" << std::endl;
+    exit(1);
   }
 
-  return shaderObject;
-}
+  // Sprite Data
+  // Vertices for every sprite of a frame, written anew each frame
+  if (gSpriteCount > 0 && !CreateSpriteBatch(gSpriteBatch, (size_t)gSpriteCount))
+  {
+    std::cout << "Failed to create the sprite batch" << std::endl;
+    exit(1);
+  }
+  // The overlay's font is rasterized once, here
+  if (gOverlay && !CreateTextRenderer(gOverlayText, kOverlayMaxGlyphs))
+  {
+    std::cout << "Failed to create the overlay's text renderer" << std::endl;
+    exit(1);
+  }
 
-/*
-  Creates a graphics program object (i.e. graphics pipeline) with a Vertex Shader and a Fragment Shader
-  
-  @param vertexShaderSource Vertex source code as a string
-  @param fragmentShaderSource Fragment shader source code as a string
-  @return id of the program Object
-*/
-GLuint CreateShaderProgram(const std::string& vertexShaderSource,
-		           const std::string& fragmentShaderSource)
-{
-  // Create a new program object
-  GLuint programObject = glCreateProgram();
-
-  // Compile our shaders
-  GLuint myVertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-  GLuint myFragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-  // Link our two shader programs together
-  // Consider this the equivalent of taking two .cpp files, and linking them into one executable file
-  glAttachShader(programObject, myVertexShader);
-  glAttachShader(programObject, myFragmentShader);
-  glLinkProgram(programObject);
-
-  // Validate our program
-  glValidateProgram(programObject);
-
-  // Once our final program Object has been created, we can detach and then delete our individual shaders
-  glDetachShader(programObject,myVertexShader);
-  glDetachShader(programObject, myFragmentShader);
-  // Delete individual shaders once we are done
-  glDeleteShader(myVertexShader);
-  glDeleteShader(myFragmentShader);
-
-  return programObject;
+  // Particle Data
+  // Up to gParticleCount particles alive, rising from the bottom of the screen and falling back down
+  if (gParticleCount > 0)
+  {
+    if (!CreateParticleSystem(gParticles, (size_t)gParticleCount))
+    {
+      std::cout << "Failed to create the particle system" << std::endl;
+      exit(1);
+    }
+    ParticleEmitter fountain;
+    fountain.position = glm::vec3(0.0f, -0.9f, 0.0f);
+    fountain.velocity = glm::vec3(0.0f, 1.6f, 0.0f);
+    fountain.spread = glm::vec3(0.4f, 0.3f, 0.0f);
+    fountain.lifetime = 1.5f;
+    fountain.lifetimeSpread = 1.0f;
+    // As many particles as fit, on average
+    fountain.rate = gParticleCount / (fountain.lifetime + fountain.lifetimeSpread * 0.5f);
+    gParticles.gravity = glm::vec3(0.0f, -1.5f, 0.0f);
+    ParticleSystemAddEmitter(gParticles, fountain);
+  }
 }
 
 /*
-  Create the graphics pipeline
+  Moves every object's bounds to where its world matrix puts it
 
   @return void
 */
-void CreateGraphicsPipeline()
+void UpdateSceneBounds()
 {
-  std::string vertexShaderSource = LoadShaderAsString("./shaders/vert.glsl");
-  std::string fragmentShaderSource = LoadShaderAsString("./shaders/frag.glsl");
-  gGraphicsPipelineShaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+  for (size_t object = 0; object < gSceneObjects.size(); ++object)
+  {
+    const glm::mat4& world = gSceneTransforms.worlds[gSceneTransformNodes[object]];
+    // The box around the transformed box: each world axis gets the absolute
+    // contribution of every rotated and scaled local axis (Arvo)
+    glm::mat3 axes(world);
+    glm::vec3 halfExtents = glm::abs(axes[0]) * gSceneHalfExtents[object].x + glm::abs(axes[1]) * gSceneHalfExtents[object].y +
+			    glm::abs(axes[2]) * gSceneHalfExtents[object].z;
+    CullingSetUpdate(gSceneBounds, (uint32_t)object, glm::vec3(world[3]), halfExtents);
+  }
 }
 
 /*
+  Initialization of the graphics application without a window.
+  The OpenGL context comes from EGL instead of SDL, and we draw into an offscreen
+  framebuffer object that has the same size a window would have had.
+
   @return void
 */
-void VertexSpecification()
+void InitializeHeadlessProgram()
 {
-  // Geometry Data
-  // Here we are going to store x, y and z position attributes within vertexPositions for the data.
-  // For now, this information is just stored on the CPU, and we are going to store this data on the GPU shortly,
-  // in  a call to glBufferData which will store this information into a vertex buffer object.
-  // Note: The data has been segregated from the OpenGL calls which follow in this function
-  // It is not strictly necessary, but the code is cleaner if OpenGL (GPU) related functions
-  // are packed closer together versus CPU operations
-  const std::vector<GLfloat> vertexData{
-    // 0 - Vertex 
-    -0.5f, -0.5f, 0.0f,  // bottom left left vertex position
-     1.0f,  0.0f, 0.0f,  // color
-    // 1 - Vertex
-     0.5f, -0.5f, 0.0f,  // bottom right vertex position
-     0.0f,  1.0f, 0.0f,  // color 
-    // 2 - Vertex
-    -0.5f,  0.5f, 0.0f,  // top left vertex position
-     0.0f,  0.0f, 1.0f,   // color 
-    // 3 - Vertex
-     0.5f,  0.5f, 0.0f,  // top right
-     0.0f,  1.0f, 0.0f,  // color 
-  };
+  // Use OpenGL 4.1 core or greater, exactly like the windowed path
+  if (!CreateHeadlessContext(4, 1))
+  {
+    std::cout << "Headless OpenGL context could not be created" << std::endl;
+    exit(1);
+  }
 
-  // Vertex Arrays Object (VAO) Setup
-  // Note: We can think of the VAO as a 'wrapper around' all of the Vertex Buffer Objects
-  // in the sense that it encapsulates all VBO state that we are setting up. 
-  // Thus, it is also important that we glBindVertexArray (i.e. select the VAO we want to use)
-  // before our vertex buffer object operations.
-  glGenVertexArrays(1, &gVertexArrayObject);
-  // We bind (i.e. select) to the Vertex Array Object (VAO) that we want to work within.
-  glBindVertexArray(gVertexArrayObject);
-
-  // Start generating VBO
-  // Vertex Buffer Object (VBO) creation
-  // Create a new vertex buffer object
-  // Note; We'll see this pattern of code often in OpenGL of creating and binding to a buffer
-  glGenBuffers(1, &gVertexBufferObject);
-  // Next we'll do glBindBuffer.
-  // Bind is equivalent to 'selecting the active buffer object' that we want to work with
-  glBindBuffer(GL_ARRAY_BUFFER, gVertexBufferObject);
-  // Now in our currently binded buffer, we populate the data from our 'vertexPositions' which is on the CPU
-  // onto a buffer that will live on the GPU.
-
-  glBufferData(GL_ARRAY_BUFFER, // Kind of buffer we are working with e.g. GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER
-	       vertexData.size() * sizeof(GLfloat), // Size of data in bytes
-	       vertexData.data(), // Raw array of data
-	       GL_STATIC_DRAW // How we intend to use the data
-	       );
-
-  const std::vector<GLuint> indexBufferData {2, 0, 1, 3, 2, 1};
-
-  // Setup the Index Buffer Object (IBO i.e. EBO)
-  glGenBuffers(1, &gIndexBufferObject);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gIndexBufferObject);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-	       indexBufferData.size() * sizeof(GLuint),
-	       indexBufferData.data(),
-	       GL_STATIC_DRAW
-	       );
-
-  // For our Given Vertex Array Object, we need to tell OpenGL 'how' the information in our buffer will be used.
-  glEnableVertexAttribArray(0);
-  // For the specific attribute in our vertex specification, we use
-  // 'glVertexAttribPointer' to figure out how we are going to move through the data
-  glVertexAttribPointer(0, // Attribute 0 corresponds to the enabled glEnableVertexAttribArray.
-			   // In the future, we will also see that in our vertex shader this also correcpond to (layout=0) which selects these attributes
-			3, // The number of components (e.g. x, y, z = 3 components)
-			GL_FLOAT, // Type
-			GL_FALSE, // Is the data normalized
-			sizeof(GLfloat) * 6, // Stride
-			(void*)0 // Offset
-  );
-  
-  // VAO setup for color information
-  // We follow the same pattern except we use a stride for colors
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1,
-			3,
-			GL_FLOAT,
-			GL_FALSE,
-			sizeof(GLfloat) * 6,
-			(GLvoid*)(sizeof(GLfloat)*3)
-  );
-
-  // Unbind our currently bound Vertex Array Object
-  glBindVertexArray(0);
-  // Disable any attributes we opened in our Vertex Attribute Array,
-  // as we do not want to leave them open
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
+  // Initialize the Glad Library
+  if (!gladLoadGLLoader(GetHeadlessProcAddress))
+  {
+    std::cout << "glad was not initialized" << std::endl;
+    exit(1);
+  }
+
+  GetOpenGLVersionInfo();
+  GLDebugInitialize();
+
+  // The framebuffer stays bound for the rest of the program,
+  // so all of our draw calls end up in it rather than in a window.
+  if (!CreateHeadlessFramebuffer(gHeadlessFramebuffer, gScreenWidth, gScreenHeight))
+  {
+    exit(1);
+  }
 }
 
 /*
@@ -330,6 +441,12 @@ void VertexSpecification()
 */
 void InitializeProgram()
 {
+  if (gHeadless)
+  {
+    InitializeHeadlessProgram();
+    return;
+  }
+
   // Initialize SDL
   if (SDL_Init(SDL_INIT_VIDEO) < 0)
   {
@@ -341,6 +458,10 @@ void InitializeProgram()
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+#if GLOOM_GL_DEBUG
+  // A debug context makes the driver report everything it can through the debug callback
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
   
   // We want to request a double buffer for smooth updating
   SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -373,6 +494,7 @@ void InitializeProgram()
   }
 
   GetOpenGLVersionInfo();
+  GLDebugInitialize();
 }
 
 /*
@@ -407,21 +529,127 @@ void Input()
 */
 void PreDraw()
 {
+  // Note: We record commands (Render*) instead of calling OpenGL directly. They are executed
+  // either right away or on the render thread, and always go through the GL state cache,
+  // which skips the call to the driver if the state already has that value.
+
   // Disable depth test and face culling.
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
+  RenderDisable(GL_DEPTH_TEST);
+  RenderDisable(GL_CULL_FACE);
 
   // Initialize clear color
   // This is the background of the screen
-  glViewport(0, 0, gScreenWidth, gScreenHeight);
-  glClearColor(.03f, .05f, 0.27f, 1.f);
+  RenderViewport(0, 0, gScreenWidth, gScreenHeight);
+  RenderClearColor(.03f, .05f, 0.27f, 1.f);
 
   // Clear color buffer and depth buffer
-  glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-  
-  // Use our shader
-  glUseProgram(gGraphicsPipelineShaderProgram);
-  
+  RenderClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+
+  // Note: Programs, vertex arrays and textures are bound by the draw bucket in Draw()
+}
+
+/*
+  Records the sprites: a grid of them covering the screen, each one turning at its own speed.
+  The first half is white, the second half uses the streamed texture (if there is one), so
+  the frame needs two batches at most.
+
+  @param viewOffset Where the sprites' orthographic ViewUniforms are in the uniform ring
+  @return void
+*/
+void DrawSprites(GLintptr viewOffset)
+{
+  static int frame = 0;
+  ++frame;
+
+  GLuint texture = TextureUse(gTexture);
+  int columns = std::max(1, (int)std::ceil(std::sqrt((double)gSpriteCount * gScreenWidth / gScreenHeight)));
+  int rows = (gSpriteCount + columns - 1) / columns;
+  float cellWidth = (float)gScreenWidth / columns;
+  float cellHeight = (float)gScreenHeight / rows;
+
+  SpriteBatchBegin(gSpriteBatch);
+  for (int sprite = 0; sprite < gSpriteCount; ++sprite)
+  {
+    int column = sprite % columns;
+    int row = sprite / columns;
+    glm::vec4 rect(column * cellWidth + cellWidth * 0.1f, row * cellHeight + cellHeight * 0.1f, cellWidth * 0.8f,
+		   cellHeight * 0.8f);
+    glm::vec4 color((float)column / columns, (float)row / rows, 1.0f, 0.75f);
+    float rotation = frame * 0.01f * (1 + sprite % 7);
+    bool textured = sprite >= gSpriteCount / 2 && texture != 0;
+    SpriteBatchSubmit(gSpriteBatch, textured ? texture : gWhiteTexture, rect, color, rotation);
+  }
+
+  RenderUseProgram(gSpriteShaderProgram.load());
+  RenderBindBufferRange(GL_UNIFORM_BUFFER, kViewUniformBinding, gUniformRing.stream.buffer, viewOffset,
+			sizeof(ViewUniforms));
+  SpriteBatchEnd(gSpriteBatch);
+  // The scene is drawn without blending
+  RenderDisable(GL_BLEND);
+}
+
+/*
+  Records the overlay: a panel in the top left corner with the times of the newest frame the
+  profiler has GPU results for, a few frames old. Every line goes through one batch, so the
+  overlay is a single draw call.
+
+  @param viewOffset Where the orthographic ViewUniforms (in pixels) are in the uniform ring
+  @return void
+*/
+void DrawOverlay(GLintptr viewOffset)
+{
+  // Started first, so the overlay's own cost includes formatting the text
+  TextRendererBegin(gOverlayText);
+  ProfilerFrameTimes times;
+  bool measured = ProfilerLatestFrame(times);
+
+  // Formatted into a fixed buffer, nothing is allocated per frame
+  char text[2048];
+  int length = 0;
+  auto line = [&](const char* format, auto... values) {
+    if (length < (int)sizeof(text))
+    {
+      length += std::snprintf(text + length, sizeof(text) - length, format, values...);
+    }
+  };
+  if (!measured)
+  {
+    line("Waiting for the first GPU times\n");
+  }
+  else
+  {
+    line("Frame %lld  %.0f FPS\n", times.frame, times.cpuFrame > 0.0 ? 1000.0 / times.cpuFrame : 0.0);
+    line("          CPU ms   GPU ms\n");
+    line("Frame   %8.3f %8.3f\n", times.cpuFrame, times.gpuFrame);
+    for (int phase = 0; phase < static_cast<int>(FramePhase::Count); ++phase)
+    {
+      if (times.timed[phase])
+      {
+	line("%-7s %8.3f %8.3f\n", ProfilerPhaseName(static_cast<FramePhase>(phase)), times.cpuPhase[phase],
+	     times.gpuPhase[phase]);
+      }
+    }
+  }
+  line("Objects %zu of %zu visible\n", gVisibleObjects.size(), gSceneObjects.size());
+  if (gSpriteCount > 0)
+  {
+    line("Sprites %d\n", gSpriteCount);
+  }
+  line("Overlay %.3f ms CPU", gOverlayText.statistics.lastCpuMilliseconds);
+  length = std::min(length, (int)sizeof(text) - 1);
+
+  std::string_view string(text, length);
+  glm::vec2 size = TextRendererMeasure(gOverlayText, string);
+  float margin = 4.0f * gOverlayText.scale;
+  glm::vec4 panel(0.0f, gScreenHeight - size.y - 2.0f * margin, size.x + 2.0f * margin, size.y + 2.0f * margin);
+  TextRendererRect(gOverlayText, panel, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+  TextRendererPrint(gOverlayText, glm::vec2(margin, gScreenHeight - margin), string, glm::vec4(1.0f, 1.0f, 0.6f, 1.0f));
+
+  RenderUseProgram(gSpriteShaderProgram.load());
+  RenderBindBufferRange(GL_UNIFORM_BUFFER, kViewUniformBinding, gUniformRing.stream.buffer, viewOffset,
+			sizeof(ViewUniforms));
+  TextRendererEnd(gOverlayText);
+  RenderDisable(GL_BLEND);
 }
 
 /*
@@ -433,19 +661,279 @@ void PreDraw()
 */
 void Draw()
 {
-  // Enable our attributes
-  glBindVertexArray(gVertexArrayObject);
+  // Throw away the objects outside the view frustum. Our vertex shader has no camera,
+  // positions are already in clip space, so the view-projection matrix is the identity.
+  FrustumPlanes frustum = ExtractFrustumPlanes(glm::mat4(1.0f));
+  CullObjects(gSceneBounds, frustum, gVisibleObjects);
+
+  // Upload the next part of textures that are streaming in
+  TextureStreamerBeginFrame();
+  GLuint streamedTexture = TextureUse(gTexture);
+
+  // The view's uniforms are the same for every draw, so they are written and bound once
+  UniformRingBeginFrame(gUniformRing);
+  ViewUniforms view;
+  GLintptr viewOffset = UniformRingPush(gUniformRing, view);
+
+  // Collect this frame's draws. Each one names the program, vertex array (our attributes
+  // and index buffer) and texture it needs, and a sort key built from them.
+  // Its own uniforms (where the object is) go into the uniform ring next to the view's.
+  DrawBucketClear(gDrawBucket);
+  for (uint32_t object : gVisibleObjects)
+  {
+    DrawUniforms uniforms;
+    uniforms.model = gSceneTransforms.worlds[gSceneTransformNodes[object]];
+    GLintptr uniformOffset = UniformRingPush(gUniformRing, uniforms);
+    if (uniformOffset < 0)
+    {
+      // The frame's uniform region is full, see kUniformRingBytesPerFrame
+      continue;
+    }
+
+    DrawPacket packet = gSceneObjects[object];
+    packet.program = gGraphicsPipelineShaderProgram.load();
+    packet.texture = streamedTexture != 0 ? streamedTexture : gWhiteTexture;
+    packet.key = MakeDrawSortKey(0, packet.program, packet.texture, 0);
+    packet.uniformBuffer = gUniformRing.stream.buffer;
+    packet.uniformOffset = uniformOffset;
+    packet.uniformSize = sizeof(DrawUniforms);
+    DrawBucketPush(gDrawBucket, packet);
+  }
+
+  // The particles are already where they should be, so their model matrix is the identity.
+  // Their instances are copied into the stream buffer before the draws run. The upload is recorded
+  // every frame, even with nothing to draw, so the stream buffer moves through its regions with the updates.
+  if (gParticleCount > 0)
+  {
+    ParticleSystemUpload(gParticles);
+    GLintptr uniformOffset = gParticles.count > 0 ? UniformRingPush(gUniformRing, DrawUniforms()) : -1;
+    if (uniformOffset >= 0)
+    {
+      DrawPacket packet = ParticleSystemDrawPacket(gParticles);
+      packet.program = gGraphicsPipelineShaderProgram.load();
+      packet.texture = gWhiteTexture;
+      packet.key = MakeDrawSortKey(0, packet.program, packet.texture, 0);
+      packet.uniformBuffer = gUniformRing.stream.buffer;
+      packet.uniformOffset = uniformOffset;
+      packet.uniformSize = sizeof(DrawUniforms);
+      DrawBucketPush(gDrawBucket, packet);
+    }
+  }
 
-  // Select the vertex buffer object we want to enable
-  glBindBuffer(GL_ARRAY_BUFFER, gVertexBufferObject);
+  // The sprites and the overlay are placed in pixels, from the bottom left corner of the screen
+  GLintptr spriteViewOffset = -1;
+  if (gSpriteCount > 0 || gOverlay)
+  {
+    ViewUniforms spriteView;
+    spriteView.viewProjection = glm::mat4(1.0f);
+    spriteView.viewProjection[0][0] = 2.0f / gScreenWidth;
+    spriteView.viewProjection[1][1] = 2.0f / gScreenHeight;
+    spriteView.viewProjection[3] = glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+    spriteViewOffset = UniformRingPush(gUniformRing, spriteView);
+  }
 
-  // Render data
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  // Upload all uniforms of the frame at once, before the draws that read them
+  UniformRingFlush(gUniformRing);
+  RenderBindBufferRange(GL_UNIFORM_BUFFER, kViewUniformBinding, gUniformRing.stream.buffer, viewOffset,
+			sizeof(ViewUniforms));
 
-  // Stop using our current graphics pipeline
-  // Note: This is not necessary if we only have one graphics pipeline.
-  glUseProgram(0);
-  
+  // Order the draws so ones sharing state are next to each other,
+  // then render data, binding only what changes from one draw to the next
+  DrawBucketSort(gDrawBucket);
+  DrawBucketSubmit(gDrawBucket);
+  if (gParticleCount > 0)
+  {
+    ParticleSystemEndFrame(gParticles);
+  }
+  // Sprites go on top of the scene
+  if (gSpriteCount > 0)
+  {
+    DrawSprites(spriteViewOffset);
+  }
+  // And the overlay on top of everything
+  if (gOverlay)
+  {
+    DrawOverlay(spriteViewOffset);
+  }
+  // The GPU is done with this frame's uniforms once it gets past these draws
+  UniformRingEndFrame(gUniformRing);
+
+  // Note: We leave our graphics pipeline bound (no glUseProgram(0)).
+  // Unbinding it would only force the next frame to bind it again.
+}
+
+/*
+  Update
+  Game logic for the frame (simulation, animation, ...) goes here.
+  For now it only burns gSimulationMicroseconds of CPU time, standing in for real work.
+  The work is cut into kSimulationJobs pieces that the job system runs in parallel (with --jobs),
+  the way updates of independent objects would be.
+
+  @return void
+*/
+void Update()
+{
+  // Recompute the world matrices of objects that moved, and follow them with their bounds
+  if (TransformUpdate(gSceneTransforms) > 0)
+  {
+    UpdateSceneBounds();
+  }
+
+  // Moves the particles on and writes the frame's instances, with the job system's threads
+  if (gParticleCount > 0)
+  {
+    ParticleSystemUpdate(gParticles, kParticleTimeStep);
+  }
+
+  if (gSimulationMicroseconds <= 0)
+  {
+    return;
+  }
+
+  ParallelFor(kSimulationJobs, 1, [](size_t begin, size_t end) {
+    long long microseconds = (long long)gSimulationMicroseconds * (long long)(end - begin) / kSimulationJobs;
+    auto endTime = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+    while (std::chrono::steady_clock::now() < endTime)
+    {
+    }
+  });
+}
+
+/*
+  Work done on the thread that owns the OpenGL context before a frame's draw calls
+  @return void
+*/
+void BeginRenderFrame()
+{
+  // Swap in any shaders that were edited and have finished compiling.
+  // This happens between frames, so a frame never mixes old and new programs. Frames the render
+  // thread recorded before the swap still use the old program, which is deleted only once they ran.
+  ShaderHotReloadUpdate();
+
+  ProfilerBeginFrame();
+  GLStateBeginFrame();
+}
+
+/*
+  Work done on the thread that owns the OpenGL context after a frame's draw calls
+  @return void
+*/
+void PresentFrame()
+{
+  // One fence for the whole frame, which the sprite batches wait for before reusing their vertices
+  StreamBufferFenceFrame();
+  {
+    ProfileScope scope(FramePhase::Swap);
+    if (gHeadless)
+    {
+      // There is no window to swap, so just make sure the driver starts working on the frame
+      glFlush();
+    }
+    else
+    {
+      // Update screen of our specified window
+      SDL_GL_SwapWindow(gGraphicsApplicationWindow);
+    }
+  }
+  ProfilerEndFrame();
+
+  // Measures the frame's latency, in low latency mode this waits for the GPU to catch up
+  FramePacingFramePresented();
+
+  // Print any errors or warnings the driver reported during the frame
+  GLDebugFlush();
+}
+
+/*
+  Makes the OpenGL context current on the calling thread, or releases it (current = false)
+  so that another thread can take it.
+  @return void
+*/
+void MakeContextCurrent(bool current)
+{
+  if (gHeadless)
+  {
+    MakeHeadlessContextCurrent(current);
+  }
+  else
+  {
+    SDL_GL_MakeCurrent(gGraphicsApplicationWindow, current ? gOpenGLContext : nullptr);
+  }
+}
+
+/*
+  Runs one frame with everything on the main thread
+  @return void
+*/
+void SerialFrame()
+{
+  // Waits for the frame's time slot, so the wait is not part of the frame's profile
+  FramePacingBeginFrame();
+  BeginRenderFrame();
+  // Handle input 
+  // Note: without a window there are no events to handle
+  if (!gHeadless)
+  {
+    ProfileScope scope(FramePhase::Input);
+    Input();
+  }
+  // Game logic
+  {
+    ProfileScope scope(FramePhase::Update);
+    Update();
+  }
+  // Setup anything that needs to take place before draw calls 
+  {
+    ProfileScope scope(FramePhase::PreDraw);
+    PreDraw();
+  }
+  // Draw calls in OpenGL
+  {
+    ProfileScope scope(FramePhase::Draw);
+    Draw();
+  }
+  PresentFrame();
+}
+
+/*
+  Records one frame on the main thread, while the render thread executes an earlier one.
+  Note: The profiler belongs to the render thread here, so these phases are not timed.
+  @return void
+*/
+void ThreadedFrame()
+{
+  FramePacingBeginFrame();
+  if (!gHeadless)
+  {
+    Input();
+  }
+  Update();
+  PreDraw();
+  Draw();
+  RenderThreadEndFrame();
+}
+
+/*
+  Hands the OpenGL context over to a new render thread
+  @return void
+*/
+void StartRenderThread()
+{
+  MakeContextCurrent(false);
+
+  RenderThreadCallbacks callbacks;
+  callbacks.acquireContext = []() { MakeContextCurrent(true); };
+  callbacks.releaseContext = []() { MakeContextCurrent(false); };
+  // On the render thread, executing a frame's commands is the Draw phase
+  callbacks.beginFrame = []() {
+    BeginRenderFrame();
+    ProfilerBeginPhase(FramePhase::Draw);
+  };
+  callbacks.endFrame = []() {
+    ProfilerEndPhase(FramePhase::Draw);
+    PresentFrame();
+  };
+  RenderThreadStart(callbacks);
 }
 
 /*
@@ -456,32 +944,259 @@ void Draw()
 */
 void MainLoop()
 {
+  // Used to report the average frame rate when we are done
+  int frameCount = 0;
+  auto startTime = std::chrono::steady_clock::now();
+
+  // Every phase of the frame is timed on both the CPU and the GPU
+  ProfilerInitialize();
+
+  // The setup code changed state with plain gl* calls, which the state cache knows nothing about
+  GLStateInvalidate();
+
+  // Sets the swap interval, so it has to happen while the main thread still owns the context
+  FramePacingCallbacks pacingCallbacks;
+  if (!gHeadless)
+  {
+    pacingCallbacks.setSwapInterval = [](int interval) { return SDL_GL_SetSwapInterval(interval) == 0; };
+  }
+  gFramePacing.mode = FramePacingInitialize(gFramePacing, pacingCallbacks);
+
+  if (gRenderThread)
+  {
+    StartRenderThread();
+  }
+  if (gJobWorkers > 0)
+  {
+    JobSystemStart(gJobWorkers);
+  }
+
   // While application is running
   while (!gQuit)
   {
-    // Handle input 
-    Input();
-    // Setup anything that needs to take place before draw calls 
-    PreDraw();
-    // Draw calls in OpenGL
-    Draw();
-    // Update screen of our specified window
-    SDL_GL_SwapWindow(gGraphicsApplicationWindow);
+    if (gRenderThread)
+    {
+      ThreadedFrame();
+    }
+    else
+    {
+      SerialFrame();
+    }
+
+    ++frameCount;
+    if (gFrameLimit > 0 && frameCount >= gFrameLimit)
+    {
+      gQuit = true;
+    }
+  }
+
+  JobSystemStop();
+
+  // Let the render thread finish the frames in flight, then take the context back
+  if (gRenderThread)
+  {
+    RenderThreadStop();
+    MakeContextCurrent(true);
+  }
+  FramePacingShutdown();
+
+  // Wait for the GPU to finish all queued frames, otherwise we would only measure
+  // how fast we can submit work rather than how fast it gets rendered.
+  glFinish();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  if (elapsed.count() > 0.0)
+  {
+    std::cout << "Rendered " << frameCount << " frames in " << elapsed.count() << " s ("
+	      << frameCount / elapsed.count() << " FPS)" << std::endl;
+  }
+
+  // Report where the time went
+  ProfilerShutdown();
+  ProfilerPrintSummary();
+  GLStatePrintStatistics();
+  DrawBucketPrintStatistics(gDrawBucket);
+  UniformRingPrintStatistics(gUniformRing);
+  SpriteBatchPrintStatistics(gSpriteBatch);
+  TextRendererPrintStatistics(gOverlayText);
+  ParticleSystemPrintStatistics(gParticles);
+  TextureStreamerPrintStatistics();
+  FramePacingPrintStatistics();
+  CullingPrintStatistics();
+  TransformPrintStatistics();
+  JobSystemPrintStatistics();
+  if (gRenderThread)
+  {
+    RenderThreadPrintStatistics();
+  }
+  if (!gProfileJSONFilename.empty())
+  {
+    ProfilerWriteJSON(gProfileJSONFilename);
+  }
+  if (!gProfileTraceFilename.empty())
+  {
+    ProfilerWriteChromeTrace(gProfileTraceFilename);
   }
 }
 
 void CleanUp()
 {
+  ShaderHotReloadStop();
+  ShaderManagerShutdown();
+  DestroyUniformRing(gUniformRing);
+  if (gSpriteCount > 0)
+  {
+    DestroySpriteBatch(gSpriteBatch);
+  }
+  if (gOverlay)
+  {
+    DestroyTextRenderer(gOverlayText);
+  }
+  if (gParticleCount > 0)
+  {
+    DestroyParticleSystem(gParticles);
+  }
+  TextureStreamerStop();
+  GLStateBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures(1, &gWhiteTexture);
+  DestroyInstanceBuffer(gInstanceBuffer);
+  DestroyMesh(gQuadMesh);
+  GLDebugShutdown();
+
+  if (gHeadless)
+  {
+    DestroyHeadlessFramebuffer(gHeadlessFramebuffer);
+    DestroyHeadlessContext();
+    return;
+  }
+
   SDL_DestroyWindow(gGraphicsApplicationWindow);
   SDL_Quit();
 }
 
+/*
+  Reads the command line options
+  --headless        Render offscreen without a window (e.g. on CI machines)
+  --frames N        Quit after N frames
+  --render-thread   Render on a dedicated thread
+  --simulate-us N   Spend N microseconds per frame on (simulated) game logic
+  --jobs N          Spread the frame's CPU work over N worker threads besides the main thread
+  --hot-reload      Recompile shaders when their files change
+  --profile F       Write frame time statistics (p50/p99/max) as JSON to file F on exit
+  --trace F         Write the recent frames in Chrome trace format to file F on exit
+  --texture F       Stream the TGA file F in as the quad's texture
+  --sprites N       Draw N 2D sprites over the scene with a sprite batch
+  --overlay         Show the profiler's frame times in a text overlay
+  --particles N     Simulate and draw a fountain of up to N particles
+  --pacing MODE     unlimited, vsync, adaptive, limiter or low-latency (default: vsync, unlimited headless)
+  --fps N           Frames per second of the limiter (and of vsync when it is not available)
+  --max-queued N    Frames the GPU may have queued in low-latency mode (0 to 3)
+
+  @return void
+*/
+void ParseCommandLine(int argc, char* args[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--headless")
+    {
+      gHeadless = true;
+    }
+    else if (option == "--frames" && i + 1 < argc)
+    {
+      gFrameLimit = std::atoi(args[++i]);
+    }
+    else if (option == "--render-thread")
+    {
+      gRenderThread = true;
+    }
+    else if (option == "--simulate-us" && i + 1 < argc)
+    {
+      gSimulationMicroseconds = std::atoi(args[++i]);
+    }
+    else if (option == "--jobs" && i + 1 < argc)
+    {
+      gJobWorkers = std::max(0, std::atoi(args[++i]));
+    }
+    else if (option == "--mesh" && i + 1 < argc)
+    {
+      gMeshFilename = args[++i];
+    }
+    else if (option == "--texture" && i + 1 < argc)
+    {
+      gTextureFilename = args[++i];
+    }
+    else if (option == "--pacing" && i + 1 < argc)
+    {
+      if (!FramePacingParseMode(args[++i], gFramePacing.mode))
+      {
+	std::cout << "Unknown pacing mode: " << args[i] << std::endl;
+	exit(1);
+      }
+      gFramePacingChosen = true;
+    }
+    else if (option == "--fps" && i + 1 < argc)
+    {
+      gFramePacing.targetFramesPerSecond = std::max(1.0, std::atof(args[++i]));
+    }
+    else if (option == "--max-queued" && i + 1 < argc)
+    {
+      gFramePacing.maxQueuedFrames = std::atoi(args[++i]);
+    }
+    else if (option == "--sprites" && i + 1 < argc)
+    {
+      gSpriteCount = std::max(0, std::atoi(args[++i]));
+    }
+    else if (option == "--overlay")
+    {
+      gOverlay = true;
+    }
+    else if (option == "--particles" && i + 1 < argc)
+    {
+      gParticleCount = std::max(0, std::atoi(args[++i]));
+    }
+    else if (option == "--instances" && i + 1 < argc)
+    {
+      gInstanceCount = std::max(1, std::atoi(args[++i]));
+    }
+    else if (option == "--hot-reload")
+    {
+      gShaderHotReload = true;
+    }
+    else if (option == "--profile" && i + 1 < argc)
+    {
+      gProfileJSONFilename = args[++i];
+    }
+    else if (option == "--trace" && i + 1 < argc)
+    {
+      gProfileTraceFilename = args[++i];
+    }
+    else
+    {
+      std::cout << "Unknown option: " << option << std::endl;
+      exit(1);
+    }
+  }
+
+  // Nobody can close a window that does not exist
+  if (gHeadless && gFrameLimit <= 0)
+  {
+    gFrameLimit = 1000;
+  }
+  if (!gFramePacingChosen)
+  {
+    gFramePacing.mode = gHeadless ? FramePacingMode::Unlimited : FramePacingMode::VSync;
+  }
+}
+
 /*
   The entry point into a program
   @return program status
 */
 int main( int argc, char* args[] )
 {
+  // 0. Read the command line options
+  ParseCommandLine(argc, args);
 
   // 1. Setup the graphics program
   InitializeProgram();
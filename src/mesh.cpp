@@ -0,0 +1,237 @@
+#include <gloom/mesh.hpp>
+#include <gloom/asset_io.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Rounds up to the next multiple of kMeshStreamAlignment
+static uint64_t AlignStream(uint64_t offset)
+{
+  return (offset + kMeshStreamAlignment - 1) / kMeshStreamAlignment * kMeshStreamAlignment;
+}
+
+// Bytes of one component of an attribute, 0 for types we do not support
+static uint32_t ComponentSize(uint32_t type)
+{
+  switch (type)
+  {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+      return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+      return 2;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+      return 4;
+    case GL_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+      // Packed, all 4 components share 4 bytes
+      return 1;
+  }
+  return 0;
+}
+
+// Bytes of a whole attribute
+static uint32_t AttributeSize(const MeshAttribute& attribute)
+{
+  return ComponentSize(attribute.type) * attribute.components;
+}
+
+/*
+  Checks everything we rely on before touching the streams, a damaged or truncated file
+  must not make us read past the end of the mapping
+*/
+static bool ValidateMeshHeader(const MeshFileHeader& header, size_t fileSize, const std::string& filename)
+{
+  // One past the last byte of each stream. The offsets are checked against the file size
+  // before the ends, so a huge offset can not wrap an end around into the file.
+  uint64_t vertexEnd = header.vertexOffset + (uint64_t)header.vertexCount * header.vertexStride;
+  uint64_t indexEnd = header.indexOffset + (uint64_t)header.indexCount * header.indexSize;
+
+  const char* problem = nullptr;
+  if (std::memcmp(header.magic, kMeshMagic, sizeof(kMeshMagic)) != 0)
+  {
+    problem = "not a mesh file";
+  }
+  else if (header.version != kMeshVersion || header.headerSize != sizeof(MeshFileHeader))
+  {
+    problem = "unsupported version, convert it again";
+  }
+  else if (header.attributeCount == 0 || header.attributeCount > (uint32_t)kMeshMaxAttributes ||
+	   header.vertexStride == 0)
+  {
+    problem = "invalid vertex layout";
+  }
+  else if (header.indexSize != 2 && header.indexSize != 4)
+  {
+    problem = "invalid index size";
+  }
+  else if (header.vertexOffset % kMeshStreamAlignment != 0 || header.indexOffset % kMeshStreamAlignment != 0 ||
+	   header.vertexOffset > fileSize || header.indexOffset > fileSize || vertexEnd > fileSize ||
+	   indexEnd > fileSize)
+  {
+    problem = "streams out of bounds (truncated file?)";
+  }
+  else if (header.vertexOffset < sizeof(MeshFileHeader) || header.indexOffset < sizeof(MeshFileHeader) ||
+	   (header.indexOffset < vertexEnd && header.vertexOffset < indexEnd))
+  {
+    problem = "streams overlap each other or the header";
+  }
+  for (uint32_t i = 0; problem == nullptr && i < header.attributeCount; ++i)
+  {
+    const MeshAttribute& attribute = header.attributes[i];
+    uint32_t size = AttributeSize(attribute);
+    if (attribute.components < 1 || attribute.components > 4 || size == 0 ||
+	attribute.offset + size > header.vertexStride)
+    {
+      problem = "invalid vertex attribute";
+    }
+  }
+
+  if (problem != nullptr)
+  {
+    std::cout << "Mesh " << filename << ": " << problem << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool WriteMeshFile(const std::string& filename, const MeshData& mesh)
+{
+  if (mesh.attributes.empty() || mesh.attributes.size() > (size_t)kMeshMaxAttributes || mesh.vertexStride == 0)
+  {
+    std::cout << "Mesh " << filename << ": invalid vertex layout" << std::endl;
+    return false;
+  }
+
+  uint32_t vertexCount = mesh.VertexCount();
+  // Half the index memory (and bandwidth) whenever the mesh is small enough
+  bool shortIndices = vertexCount <= 0xFFFF;
+
+  MeshFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMeshMagic, sizeof(kMeshMagic));
+  header.version = kMeshVersion;
+  header.headerSize = sizeof(MeshFileHeader);
+  header.vertexCount = vertexCount;
+  header.vertexStride = mesh.vertexStride;
+  header.indexCount = (uint32_t)mesh.indices.size();
+  header.indexSize = shortIndices ? 2 : 4;
+  header.attributeCount = (uint32_t)mesh.attributes.size();
+  header.vertexOffset = sizeof(MeshFileHeader);
+  header.indexOffset = AlignStream(header.vertexOffset + (uint64_t)vertexCount * mesh.vertexStride);
+  for (size_t i = 0; i < mesh.attributes.size(); ++i)
+  {
+    header.attributes[i] = mesh.attributes[i];
+  }
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    std::cout << "Could not write " << filename << std::endl;
+    return false;
+  }
+
+  const char padding[kMeshStreamAlignment] = {};
+  file.write((const char*)&header, sizeof(header));
+  file.write((const char*)mesh.vertices.data(), (std::streamsize)vertexCount * mesh.vertexStride);
+  file.write(padding, (std::streamsize)(header.indexOffset - header.vertexOffset - (uint64_t)vertexCount * mesh.vertexStride));
+  if (shortIndices)
+  {
+    std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+    file.write((const char*)indices.data(), (std::streamsize)(indices.size() * sizeof(uint16_t)));
+  }
+  else
+  {
+    file.write((const char*)mesh.indices.data(), (std::streamsize)(mesh.indices.size() * sizeof(uint32_t)));
+  }
+  return file.good();
+}
+
+bool LoadMesh(const std::string& filename, Mesh& mesh)
+{
+  // Large meshes are memory mapped, so the upload below reads straight from the page cache
+  AssetFile file = LoadAsset(filename);
+  if (!file.IsOpen())
+  {
+    std::cout << "Could not load mesh " << filename << std::endl;
+    return false;
+  }
+  std::string_view contents = file.View();
+
+  MeshFileHeader header;
+  if (contents.size() < sizeof(header))
+  {
+    std::cout << "Mesh " << filename << ": truncated header" << std::endl;
+    return false;
+  }
+  // Copy the header out, the mapping itself makes no alignment promises to the compiler
+  std::memcpy(&header, contents.data(), sizeof(header));
+  if (!ValidateMeshHeader(header, contents.size(), filename))
+  {
+    return false;
+  }
+
+  mesh.vertexCount = (GLsizei)header.vertexCount;
+  mesh.indexCount = (GLsizei)header.indexCount;
+  mesh.indexType = header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+  // Vertex Arrays Object (VAO) Setup
+  // Note: We can think of the VAO as a 'wrapper around' all of the Vertex Buffer Objects
+  // in the sense that it encapsulates all VBO state that we are setting up.
+  // Thus, it is also important that we glBindVertexArray (i.e. select the VAO we want to use)
+  // before our vertex buffer object operations.
+  glGenVertexArrays(1, &mesh.vertexArray);
+  glBindVertexArray(mesh.vertexArray);
+
+  // Vertex Buffer Object (VBO)
+  // The vertex stream is already laid out the way the GPU reads it, so it goes
+  // from the file to the buffer without passing through any copy of our own
+  glGenBuffers(1, &mesh.vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER,
+	       (GLsizeiptr)header.vertexCount * header.vertexStride,
+	       contents.data() + header.vertexOffset,
+	       GL_STATIC_DRAW);
+
+  // Index Buffer Object (IBO i.e. EBO)
+  // Its binding is part of the VAO state
+  glGenBuffers(1, &mesh.indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+	       (GLsizeiptr)header.indexCount * header.indexSize,
+	       contents.data() + header.indexOffset,
+	       GL_STATIC_DRAW);
+
+  // For our Vertex Array Object, we tell OpenGL 'how' the information in our buffer will be used,
+  // one glVertexAttribPointer per attribute described in the file
+  for (uint32_t i = 0; i < header.attributeCount; ++i)
+  {
+    const MeshAttribute& attribute = header.attributes[i];
+    glEnableVertexAttribArray(attribute.location);
+    glVertexAttribPointer(attribute.location,
+			  (GLint)attribute.components,
+			  (GLenum)attribute.type,
+			  attribute.normalized ? GL_TRUE : GL_FALSE,
+			  (GLsizei)header.vertexStride,
+			  (GLvoid*)(uintptr_t)attribute.offset);
+  }
+
+  // Unbind our currently bound Vertex Array Object
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
+}
+
+void DestroyMesh(Mesh& mesh)
+{
+  glDeleteVertexArrays(1, &mesh.vertexArray);
+  glDeleteBuffers(1, &mesh.vertexBuffer);
+  glDeleteBuffers(1, &mesh.indexBuffer);
+  mesh = Mesh();
+}
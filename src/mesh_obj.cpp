@@ -0,0 +1,130 @@
+#include <gloom/mesh.hpp>
+
+// C++ Standard Template Library (STL)
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+// Floats per vertex of the layout we produce: position and color
+static const int kObjFloatsPerVertex = 6;
+
+static bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Moves 'cursor' past spaces, not past the end of the line
+static void SkipSpaces(const char*& cursor, const char* end)
+{
+  while (cursor < end && IsSpace(*cursor))
+  {
+    ++cursor;
+  }
+}
+
+// Reads the next number on the line, returns false if there is none
+template <typename T>
+static bool ReadNumber(const char*& cursor, const char* end, T& value)
+{
+  SkipSpaces(cursor, end);
+  std::from_chars_result result = std::from_chars(cursor, end, value);
+  if (result.ec != std::errc())
+  {
+    return false;
+  }
+  cursor = result.ptr;
+  return true;
+}
+
+bool ParseObjMesh(std::string_view text, MeshData& mesh)
+{
+  mesh = MeshData();
+  mesh.vertexStride = kObjFloatsPerVertex * sizeof(GLfloat);
+  mesh.attributes.push_back({ 0, 3, GL_FLOAT, 0, 0 });
+  mesh.attributes.push_back({ 1, 3, GL_FLOAT, 0, 3 * sizeof(GLfloat) });
+
+  std::vector<GLfloat> vertices;
+  std::vector<int> polygon;
+  int lineNumber = 0;
+
+  const char* cursor = text.data();
+  const char* textEnd = text.data() + text.size();
+  while (cursor < textEnd)
+  {
+    const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', textEnd - cursor));
+    if (lineEnd == nullptr)
+    {
+      lineEnd = textEnd;
+    }
+    ++lineNumber;
+
+    SkipSpaces(cursor, lineEnd);
+    if (lineEnd - cursor >= 2 && cursor[0] == 'v' && IsSpace(cursor[1]))
+    {
+      // v x y z [r g b]
+      cursor += 2;
+      GLfloat values[kObjFloatsPerVertex] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+      int count = 0;
+      while (count < kObjFloatsPerVertex && ReadNumber(cursor, lineEnd, values[count]))
+      {
+        ++count;
+      }
+      if (count != 3 && count != 6)
+      {
+        std::cout << "OBJ line " << lineNumber << ": expected 3 or 6 numbers after 'v'" << std::endl;
+        return false;
+      }
+      vertices.insert(vertices.end(), values, values + kObjFloatsPerVertex);
+    }
+    else if (lineEnd - cursor >= 2 && cursor[0] == 'f' && IsSpace(cursor[1]))
+    {
+      // f v1[/vt1[/vn1]] v2... , we only need the position index
+      cursor += 2;
+      polygon.clear();
+      int index = 0;
+      while (ReadNumber(cursor, lineEnd, index))
+      {
+        // Negative indices count back from the most recent vertex
+        int vertexCount = (int)(vertices.size() / kObjFloatsPerVertex);
+        int resolved = index < 0 ? vertexCount + index : index - 1;
+        if (index == 0 || resolved < 0 || resolved >= vertexCount)
+        {
+          std::cout << "OBJ line " << lineNumber << ": vertex index out of range" << std::endl;
+          return false;
+        }
+        polygon.push_back(resolved);
+
+        // Skip "/vt/vn"
+        while (cursor < lineEnd && !IsSpace(*cursor))
+        {
+          ++cursor;
+        }
+      }
+      if (polygon.size() < 3)
+      {
+        std::cout << "OBJ line " << lineNumber << ": a face needs at least 3 vertices" << std::endl;
+        return false;
+      }
+      // Triangle fan around the first vertex
+      for (size_t i = 1; i + 1 < polygon.size(); ++i)
+      {
+        mesh.indices.push_back((uint32_t)polygon[0]);
+        mesh.indices.push_back((uint32_t)polygon[i]);
+        mesh.indices.push_back((uint32_t)polygon[i + 1]);
+      }
+    }
+    // Anything else (comments, vt, vn, groups, materials) is ignored
+
+    cursor = lineEnd + 1;
+  }
+
+  if (vertices.empty() || mesh.indices.empty())
+  {
+    std::cout << "OBJ: no vertices or no faces" << std::endl;
+    return false;
+  }
+
+  mesh.vertices.resize(vertices.size() * sizeof(GLfloat));
+  std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+  return true;
+}
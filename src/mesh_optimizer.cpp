@@ -0,0 +1,361 @@
+#include <gloom/mesh_optimizer.hpp>
+
+// Third Party Libraries
+#include <glm/glm.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Scoring constants from Forsyth's article
+static const float kCacheDecayPower = 1.5f;
+static const float kLastTriangleScore = 0.75f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+
+VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, int cacheSize)
+{
+  VertexCacheStatistics statistics;
+
+  // A FIFO cache: a vertex is in the cache if it entered less than cacheSize misses ago
+  std::vector<uint32_t> enteredAt(vertexCount, 0);
+  std::vector<bool> referenced(vertexCount, false);
+  uint32_t referencedCount = 0;
+  uint32_t time = 0;
+  for (uint32_t index : indices)
+  {
+    if (!referenced[index])
+    {
+      referenced[index] = true;
+      ++referencedCount;
+    }
+    bool cached = enteredAt[index] != 0 && time - enteredAt[index] < (uint32_t)cacheSize;
+    if (!cached)
+    {
+      ++time;
+      enteredAt[index] = time;
+      ++statistics.misses;
+    }
+  }
+
+  size_t triangleCount = indices.size() / 3;
+  statistics.acmr = triangleCount == 0 ? 0.0f : (float)statistics.misses / triangleCount;
+  statistics.atvr = referencedCount == 0 ? 0.0f : (float)statistics.misses / referencedCount;
+  return statistics;
+}
+
+// How much we want to use a vertex next, see Forsyth's article
+static float VertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+  if (remainingTriangles == 0)
+  {
+    // No triangle needs this vertex anymore
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cachePosition >= 0)
+  {
+    if (cachePosition < 3)
+    {
+      // Used by the last triangle. A fixed score, so we do not simply strip along it.
+      score = kLastTriangleScore;
+    }
+    else
+    {
+      float scaler = 1.0f / (kVertexCacheOptimizeSize - 3);
+      score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+    }
+  }
+
+  // Prefer vertices with few triangles left, so we finish them off rather than leave lone triangles behind
+  score += kValenceBoostScale * std::pow((float)remainingTriangles, -kValenceBoostPower);
+  return score;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  // The triangles using each vertex, stored back to back (vertex v owns
+  // adjacency[adjacencyOffset[v] ... adjacencyOffset[v] + remaining[v]])
+  std::vector<uint32_t> remaining(vertexCount, 0);
+  for (uint32_t index : indices)
+  {
+    ++remaining[index];
+  }
+  std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+  for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+  {
+    adjacencyOffset[vertex + 1] = adjacencyOffset[vertex] + remaining[vertex];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  std::vector<uint32_t> filled(vertexCount, 0);
+  for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+  {
+    for (int corner = 0; corner < 3; ++corner)
+    {
+      uint32_t vertex = indices[triangle * 3 + corner];
+      adjacency[adjacencyOffset[vertex] + filled[vertex]++] = (uint32_t)triangle;
+    }
+  }
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScore(vertexCount);
+  for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+  {
+    vertexScore[vertex] = VertexScore(-1, remaining[vertex]);
+  }
+
+  std::vector<float> triangleScore(triangleCount);
+  std::vector<bool> emitted(triangleCount, false);
+  int bestTriangle = 0;
+  for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+  {
+    triangleScore[triangle] = vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] +
+			      vertexScore[indices[triangle * 3 + 2]];
+    if (triangleScore[triangle] > triangleScore[bestTriangle])
+    {
+      bestTriangle = (int)triangle;
+    }
+  }
+
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> newCache;
+  cache.reserve(kVertexCacheOptimizeSize + 3);
+  newCache.reserve(kVertexCacheOptimizeSize + 3);
+  // Where to continue looking when no triangle in the cache is left
+  size_t scanPosition = 0;
+
+  for (size_t step = 0; step < triangleCount; ++step)
+  {
+    if (bestTriangle < 0)
+    {
+      while (emitted[scanPosition])
+      {
+        ++scanPosition;
+      }
+      bestTriangle = (int)scanPosition;
+    }
+
+    const uint32_t* triangleVertices = &indices[bestTriangle * 3];
+    output.insert(output.end(), triangleVertices, triangleVertices + 3);
+    emitted[bestTriangle] = true;
+
+    // The triangle no longer counts towards its vertices
+    for (int corner = 0; corner < 3; ++corner)
+    {
+      uint32_t vertex = triangleVertices[corner];
+      uint32_t* begin = &adjacency[adjacencyOffset[vertex]];
+      uint32_t* end = begin + remaining[vertex];
+      uint32_t* found = std::find(begin, end, (uint32_t)bestTriangle);
+      if (found != end)
+      {
+        *found = *(end - 1);
+        --remaining[vertex];
+      }
+    }
+
+    // The triangle's vertices move to the front of the cache, everything else moves back
+    newCache.assign(triangleVertices, triangleVertices + 3);
+    for (uint32_t vertex : cache)
+    {
+      if (vertex != triangleVertices[0] && vertex != triangleVertices[1] && vertex != triangleVertices[2])
+      {
+        newCache.push_back(vertex);
+      }
+    }
+    for (size_t i = kVertexCacheOptimizeSize; i < newCache.size(); ++i)
+    {
+      // Fell out of the cache. Their scores still need updating below,
+      // so they are only dropped from newCache afterwards.
+      cachePosition[newCache[i]] = -1;
+    }
+
+    // Update the scores of every vertex whose position changed, and of their triangles
+    bestTriangle = -1;
+    float bestScore = -1.0f;
+    for (size_t i = 0; i < newCache.size(); ++i)
+    {
+      uint32_t vertex = newCache[i];
+      if (i < (size_t)kVertexCacheOptimizeSize)
+      {
+        cachePosition[vertex] = (int)i;
+      }
+      float score = VertexScore(cachePosition[vertex], remaining[vertex]);
+      float delta = score - vertexScore[vertex];
+      vertexScore[vertex] = score;
+
+      for (uint32_t a = 0; a < remaining[vertex]; ++a)
+      {
+        uint32_t triangle = adjacency[adjacencyOffset[vertex] + a];
+        triangleScore[triangle] += delta;
+        // The next triangle is one touching the cache, that is where the gains are
+        if (i < (size_t)kVertexCacheOptimizeSize && triangleScore[triangle] > bestScore)
+        {
+          bestScore = triangleScore[triangle];
+          bestTriangle = (int)triangle;
+        }
+      }
+    }
+
+    if (newCache.size() > (size_t)kVertexCacheOptimizeSize)
+    {
+      newCache.resize(kVertexCacheOptimizeSize);
+    }
+    cache.swap(newCache);
+  }
+
+  indices.swap(output);
+}
+
+// Finds the float position attribute, nullptr if there is none
+static const MeshAttribute* FindPositionAttribute(const MeshData& mesh)
+{
+  for (const MeshAttribute& attribute : mesh.attributes)
+  {
+    if (attribute.location == 0 && attribute.type == GL_FLOAT && attribute.components >= 3)
+    {
+      return &attribute;
+    }
+  }
+  return nullptr;
+}
+
+static glm::vec3 ReadPosition(const MeshData& mesh, const MeshAttribute& attribute, uint32_t vertex)
+{
+  glm::vec3 position;
+  std::memcpy(&position[0], mesh.vertices.data() + (size_t)vertex * mesh.vertexStride + attribute.offset, sizeof(position));
+  return position;
+}
+
+bool OptimizeOverdraw(MeshData& mesh)
+{
+  const MeshAttribute* positionAttribute = FindPositionAttribute(mesh);
+  if (positionAttribute == nullptr)
+  {
+    return false;
+  }
+
+  const std::vector<uint32_t>& indices = mesh.indices;
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return true;
+  }
+
+  // Cut into clusters wherever a triangle missed the (simulated) cache with all three vertices.
+  // The cache was cold there anyway, so reordering the clusters costs (almost) nothing.
+  std::vector<size_t> clusterStarts;
+  {
+    std::vector<uint32_t> enteredAt(mesh.VertexCount(), 0);
+    uint32_t time = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+      int misses = 0;
+      for (int corner = 0; corner < 3; ++corner)
+      {
+        uint32_t index = indices[triangle * 3 + corner];
+        if (enteredAt[index] == 0 || time - enteredAt[index] >= (uint32_t)kVertexCacheAnalyzeSize)
+        {
+          ++time;
+          enteredAt[index] = time;
+          ++misses;
+        }
+      }
+      if (misses == 3 || triangle == 0)
+      {
+        clusterStarts.push_back(triangle);
+      }
+    }
+  }
+  clusterStarts.push_back(triangleCount);
+
+  // The center of the whole mesh
+  glm::vec3 meshCenter(0.0f);
+  for (uint32_t vertex = 0; vertex < mesh.VertexCount(); ++vertex)
+  {
+    meshCenter += ReadPosition(mesh, *positionAttribute, vertex);
+  }
+  meshCenter /= (float)std::max(1u, mesh.VertexCount());
+
+  // How far each cluster faces away from the center: clusters on the outside of the mesh,
+  // facing out, are the ones most likely to hide others, so they go first
+  struct Cluster
+  {
+    size_t start, end;
+    float sortKey;
+  };
+  std::vector<Cluster> clusters;
+  for (size_t i = 0; i + 1 < clusterStarts.size(); ++i)
+  {
+    glm::vec3 centroid(0.0f);
+    glm::vec3 normal(0.0f);
+    float area = 0.0f;
+    for (size_t triangle = clusterStarts[i]; triangle < clusterStarts[i + 1]; ++triangle)
+    {
+      glm::vec3 p0 = ReadPosition(mesh, *positionAttribute, indices[triangle * 3]);
+      glm::vec3 p1 = ReadPosition(mesh, *positionAttribute, indices[triangle * 3 + 1]);
+      glm::vec3 p2 = ReadPosition(mesh, *positionAttribute, indices[triangle * 3 + 2]);
+      // Its length is twice the area, so larger triangles weigh more
+      glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+      float triangleArea = glm::length(triangleNormal);
+      centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+      normal += triangleNormal;
+      area += triangleArea;
+    }
+    centroid = area > 0.0f ? centroid / area : meshCenter;
+    float normalLength = glm::length(normal);
+    float sortKey = normalLength > 0.0f ? glm::dot(centroid - meshCenter, normal / normalLength) : 0.0f;
+    clusters.push_back({ clusterStarts[i], clusterStarts[i + 1], sortKey });
+  }
+
+  std::stable_sort(clusters.begin(), clusters.end(),
+		   [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  for (const Cluster& cluster : clusters)
+  {
+    output.insert(output.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+  }
+  mesh.indices.swap(output);
+  return true;
+}
+
+void OptimizeVertexFetch(MeshData& mesh)
+{
+  const uint32_t kUnused = 0xFFFFFFFF;
+  std::vector<uint32_t> remap(mesh.VertexCount(), kUnused);
+  std::vector<uint8_t> vertices;
+  vertices.reserve(mesh.vertices.size());
+
+  uint32_t nextVertex = 0;
+  for (uint32_t& index : mesh.indices)
+  {
+    if (remap[index] == kUnused)
+    {
+      remap[index] = nextVertex++;
+      const uint8_t* vertex = mesh.vertices.data() + (size_t)index * mesh.vertexStride;
+      vertices.insert(vertices.end(), vertex, vertex + mesh.vertexStride);
+    }
+    index = remap[index];
+  }
+  mesh.vertices.swap(vertices);
+}
+
+bool OptimizeMesh(MeshData& mesh)
+{
+  OptimizeVertexCache(mesh.indices, mesh.VertexCount());
+  bool overdraw = OptimizeOverdraw(mesh);
+  // Last, it only renames vertices and does not change the triangle order
+  OptimizeVertexFetch(mesh);
+  return overdraw;
+}
@@ -0,0 +1,623 @@
+// Enables GLM's SIMD layer (glm_vec4 and the glm_vec4_* functions) and its aligned types in this file,
+// see culling.cpp. It has to come before the first GLM include, also the ones of our own headers.
+#define GLM_FORCE_INTRINSICS
+
+#include <gloom/particle_system.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/job_system.hpp>
+#include <gloom/render_commands.hpp>
+
+// Third Party Libraries
+#include <glm/gtc/type_aligned.hpp>
+#include <glm/simd/common.h>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+#include <immintrin.h>
+#endif
+
+const int kParticleArrayCount = 13;
+
+/*
+  Every value of a particle in an array of its own, four particles per glm::aligned_vec4.
+  Particle i is lane i % 4 of group i / 4, or simply lanes[array][i].
+
+  The arrays share one allocation, each a cache line further from a 4 KB boundary than the one
+  before, so the same particle of different arrays does not always fall into the same cache set.
+*/
+struct ParticleBuffer
+{
+  std::vector<glm::aligned_vec4> storage;
+  glm::aligned_vec4 *positionX, *positionY, *positionZ;
+  glm::aligned_vec4 *velocityX, *velocityY, *velocityZ;
+  glm::aligned_vec4 *colorR, *colorG, *colorB, *colorA;
+  // Seconds left, and one over the seconds the particle started with
+  glm::aligned_vec4 *life, *inverseLifetime;
+  glm::aligned_vec4* size;
+  // The first particle of every array above, for moving whole particles
+  float* lanes[kParticleArrayCount] = {};
+};
+
+/*
+  An update integrates the current buffer in place, then copies the particles that are still
+  alive into the other one, which becomes the current one
+*/
+struct ParticleArrays
+{
+  ParticleBuffer buffers[2];
+  int current = 0;
+  // Bit i of group g is set if particle g * 4 + i lives on, written by the integration
+  std::vector<uint8_t> alive;
+};
+
+// Particles alive in a group, by its mask
+static const int kAliveCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// Copies all values of 'count' particles from one buffer to the other
+static void CopyParticles(const ParticleBuffer& from, size_t source, ParticleBuffer& to, size_t destination,
+			  size_t count)
+{
+  for (int array = 0; array < kParticleArrayCount; ++array)
+  {
+    std::memcpy(to.lanes[array] + destination, from.lanes[array] + source, count * sizeof(float));
+  }
+}
+
+#if (GLM_ARCH & GLM_ARCH_AVX_BIT) || !(GLM_ARCH & GLM_ARCH_SSE2_BIT)
+// One group of 4 particles, one lane at a time. @return bit i set if particle i of the group is still alive
+static int IntegrateGroupScalar(ParticleBuffer& p, size_t group, const glm::vec3& gravity, float deltaTime)
+{
+  int alive = 0;
+  for (int lane = 0; lane < 4; ++lane)
+  {
+    glm::aligned_vec4* velocities[3] = { &p.velocityX[group], &p.velocityY[group], &p.velocityZ[group] };
+    glm::aligned_vec4* positions[3] = { &p.positionX[group], &p.positionY[group], &p.positionZ[group] };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      (*velocities[axis])[lane] += gravity[axis] * deltaTime;
+      (*positions[axis])[lane] += (*velocities[axis])[lane] * deltaTime;
+    }
+    p.life[group][lane] -= deltaTime;
+    alive |= p.life[group][lane] > 0.0f ? 1 << lane : 0;
+  }
+  return alive;
+}
+#endif
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+
+// Two groups (8 particles) per iteration, a group left over goes through IntegrateGroupScalar
+static void IntegrateGroups(ParticleBuffer& p, size_t firstGroup, size_t endGroup, const glm::vec3& gravity,
+			    float deltaTime, uint8_t* alive)
+{
+  const __m256 step = _mm256_set1_ps(deltaTime);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 velocityStep[3] = { _mm256_set1_ps(gravity.x * deltaTime), _mm256_set1_ps(gravity.y * deltaTime),
+				   _mm256_set1_ps(gravity.z * deltaTime) };
+  glm::aligned_vec4* velocities[3] = { p.velocityX, p.velocityY, p.velocityZ };
+  glm::aligned_vec4* positions[3] = { p.positionX, p.positionY, p.positionZ };
+
+  size_t group = firstGroup;
+  for (; group + 2 <= endGroup; group += 2)
+  {
+    // Two neighbouring aligned_vec4 are 8 floats in a row, but only 16 byte aligned
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      float* velocity = &velocities[axis][group].x;
+      float* position = &positions[axis][group].x;
+      __m256 v = _mm256_add_ps(_mm256_loadu_ps(velocity), velocityStep[axis]);
+      _mm256_storeu_ps(velocity, v);
+      _mm256_storeu_ps(position, _mm256_add_ps(_mm256_loadu_ps(position), _mm256_mul_ps(v, step)));
+    }
+    __m256 life = _mm256_sub_ps(_mm256_loadu_ps(&p.life[group].x), step);
+    _mm256_storeu_ps(&p.life[group].x, life);
+    int mask = _mm256_movemask_ps(_mm256_cmp_ps(life, zero, _CMP_GT_OQ));
+    alive[group - firstGroup] = (uint8_t)(mask & 0xF);
+    alive[group + 1 - firstGroup] = (uint8_t)(mask >> 4);
+  }
+  if (group < endGroup)
+  {
+    alive[group - firstGroup] = (uint8_t)IntegrateGroupScalar(p, group, gravity, deltaTime);
+  }
+}
+
+const char* ParticleInstructionSet()
+{
+  return "AVX (8 particles)";
+}
+
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+// One group (4 particles) per iteration with GLM's SIMD layer
+static void IntegrateGroups(ParticleBuffer& p, size_t firstGroup, size_t endGroup, const glm::vec3& gravity,
+			    float deltaTime, uint8_t* alive)
+{
+  const glm_vec4 step = _mm_set1_ps(deltaTime);
+  const glm_vec4 zero = _mm_setzero_ps();
+  const glm_vec4 velocityStep[3] = { _mm_set1_ps(gravity.x * deltaTime), _mm_set1_ps(gravity.y * deltaTime),
+				     _mm_set1_ps(gravity.z * deltaTime) };
+  glm::aligned_vec4* velocities[3] = { p.velocityX, p.velocityY, p.velocityZ };
+  glm::aligned_vec4* positions[3] = { p.positionX, p.positionY, p.positionZ };
+
+  for (size_t group = firstGroup; group < endGroup; ++group)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      glm::aligned_vec4& velocity = velocities[axis][group];
+      glm::aligned_vec4& position = positions[axis][group];
+      velocity.data = glm_vec4_add(velocity.data, velocityStep[axis]);
+      position.data = glm_vec4_fma(velocity.data, step, position.data);
+    }
+    glm::aligned_vec4& life = p.life[group];
+    life.data = glm_vec4_sub(life.data, step);
+    alive[group - firstGroup] = (uint8_t)_mm_movemask_ps(_mm_cmpgt_ps(life.data, zero));
+  }
+}
+
+const char* ParticleInstructionSet()
+{
+  return "SSE (4 particles)";
+}
+
+#else
+
+static void IntegrateGroups(ParticleBuffer& p, size_t firstGroup, size_t endGroup, const glm::vec3& gravity,
+			    float deltaTime, uint8_t* alive)
+{
+  for (size_t group = firstGroup; group < endGroup; ++group)
+  {
+    alive[group - firstGroup] = (uint8_t)IntegrateGroupScalar(p, group, gravity, deltaTime);
+  }
+}
+
+const char* ParticleInstructionSet()
+{
+  return "scalar";
+}
+
+#endif
+
+/*
+  Integrates the particles of a chunk and notes which of them live on
+
+  @return the particles alive in the chunk
+*/
+static size_t IntegrateChunk(ParticleSystem& system, size_t chunk, float deltaTime)
+{
+  ParticleArrays& particles = *system.particles;
+  size_t begin = chunk * kParticleChunkSize;
+  size_t end = std::min(begin + kParticleChunkSize, system.count);
+  size_t firstGroup = begin / 4;
+  size_t endGroup = (end + 3) / 4;
+
+  uint8_t* alive = particles.alive.data() + firstGroup;
+  IntegrateGroups(particles.buffers[particles.current], firstGroup, endGroup, system.gravity, deltaTime, alive);
+  // The lanes after the last particle hold old particles, which are not alive
+  if (end % 4 != 0)
+  {
+    alive[endGroup - 1 - firstGroup] &= (uint8_t)((1 << (end % 4)) - 1);
+  }
+
+  size_t count = 0;
+  for (size_t group = 0; group < endGroup - firstGroup; ++group)
+  {
+    count += kAliveCount[alive[group]];
+  }
+  return count;
+}
+
+// Writes particle i of a buffer as an instance
+static void WriteInstance(const ParticleBuffer& buffer, size_t i, InstanceData& instance)
+{
+  const float* const* lanes = buffer.lanes;
+  instance.translation[0] = lanes[0][i];
+  instance.translation[1] = lanes[1][i];
+  instance.translation[2] = lanes[2][i];
+  // Shrinks linearly to nothing over the particle's lifetime
+  instance.scale = lanes[12][i] * lanes[10][i] * lanes[11][i];
+  // Packed in a register, four byte stores read back as one word would stall
+  uint32_t packed = 0;
+  for (int channel = 0; channel < 4; ++channel)
+  {
+    packed |= (uint32_t)(lanes[6 + channel][i] * 255.0f + 0.5f) << (channel * 8);
+  }
+  std::memcpy(instance.color, &packed, sizeof(packed));
+}
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+static_assert(offsetof(InstanceData, scale) == 3 * sizeof(GLfloat), "translation and scale are stored together");
+
+// Writes the 4 particles of a group as instances: x, y, z and scale of the group transposed into
+// one row per particle, and the 4 colors converted to bytes and packed together
+static void WriteInstanceGroup(const ParticleBuffer& buffer, size_t group, InstanceData* instances)
+{
+  glm_vec4 scale = glm_vec4_mul(glm_vec4_mul(buffer.size[group].data, buffer.life[group].data),
+				buffer.inverseLifetime[group].data);
+  glm_vec4 row0 = buffer.positionX[group].data;
+  glm_vec4 row1 = buffer.positionY[group].data;
+  glm_vec4 row2 = buffer.positionZ[group].data;
+  glm_vec4 row3 = scale;
+  _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+  const glm_vec4 toByte = _mm_set1_ps(255.0f);
+  const glm_vec4 half = _mm_set1_ps(0.5f);
+  const glm::aligned_vec4* channels[4] = { buffer.colorR, buffer.colorG, buffer.colorB, buffer.colorA };
+  __m128i colors = _mm_setzero_si128();
+  for (int channel = 0; channel < 4; ++channel)
+  {
+    __m128i bytes = _mm_cvttps_epi32(glm_vec4_fma(channels[channel][group].data, toByte, half));
+    colors = _mm_or_si128(colors, _mm_slli_epi32(bytes, channel * 8));
+  }
+  alignas(16) uint32_t packed[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(packed), colors);
+
+  const glm_vec4 rows[4] = { row0, row1, row2, row3 };
+  for (int lane = 0; lane < 4; ++lane)
+  {
+    InstanceData& instance = instances[group * 4 + lane];
+    _mm_storeu_ps(instance.translation, rows[lane]);
+    std::memcpy(instance.color, &packed[lane], sizeof(uint32_t));
+  }
+}
+
+#endif
+
+// Writes particles [begin, end) of a buffer as instances into the staging memory of the frame
+static void WriteInstances(ParticleSystem& system, const ParticleBuffer& buffer, size_t begin, size_t end)
+{
+  InstanceData* instances = system.staging[system.region].data();
+  size_t i = begin;
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+  // One at a time up to the first whole group, then a group at a time
+  for (; i < end && i % 4 != 0; ++i)
+  {
+    WriteInstance(buffer, i, instances[i]);
+  }
+  for (; i + 4 <= end; i += 4)
+  {
+    WriteInstanceGroup(buffer, i / 4, instances);
+  }
+#endif
+  for (; i < end; ++i)
+  {
+    WriteInstance(buffer, i, instances[i]);
+  }
+}
+
+/*
+  Copies the particles of a chunk that live on into the other buffer, in the order they were in,
+  and writes their instances while they are still in the cache
+
+  @param destination Index of the chunk's first particle in the other buffer
+*/
+static void CompactChunk(ParticleSystem& system, size_t chunk, size_t destination)
+{
+  ParticleArrays& particles = *system.particles;
+  const ParticleBuffer& from = particles.buffers[particles.current];
+  ParticleBuffer& to = particles.buffers[1 - particles.current];
+  size_t begin = chunk * kParticleChunkSize;
+  size_t end = std::min(begin + kParticleChunkSize, system.count);
+
+  // Most particles live on, so they are copied in runs: from one dead particle to the next
+  size_t write = destination;
+  size_t run = begin;
+  for (size_t group = begin / 4; group < (end + 3) / 4; ++group)
+  {
+    int mask = particles.alive[group];
+    if (mask == 0xF)
+    {
+      continue;
+    }
+    for (int lane = 0; lane < 4 && group * 4 + lane < end; ++lane)
+    {
+      if (mask & (1 << lane))
+      {
+        continue;
+      }
+      size_t dead = group * 4 + lane;
+      if (dead > run)
+      {
+        CopyParticles(from, run, to, write, dead - run);
+        write += dead - run;
+      }
+      run = dead + 1;
+    }
+  }
+  if (end > run)
+  {
+    CopyParticles(from, run, to, write, end - run);
+    write += end - run;
+  }
+  WriteInstances(system, to, destination, write);
+}
+
+// @return a random number between -1 and 1
+static float RandomSigned(uint32_t& random)
+{
+  random = random * 1664525u + 1013904223u;
+  return (float)(random >> 8) / (float)(1 << 23) - 1.0f;
+}
+
+// Adds the emitters' particles for this update at the end of the arrays
+static void Spawn(ParticleSystem& system, float deltaTime)
+{
+  float* const* lanes = system.particles->buffers[system.particles->current].lanes;
+  for (ParticleEmitter& emitter : system.emitters)
+  {
+    emitter.accumulator += emitter.rate * deltaTime;
+    size_t spawn = (size_t)emitter.accumulator;
+    emitter.accumulator -= (float)spawn;
+
+    size_t room = system.maxParticles - system.count;
+    system.statistics.dropped += spawn > room ? spawn - room : 0;
+    spawn = std::min(spawn, room);
+    system.statistics.spawned += spawn;
+
+    for (size_t i = system.count; i < system.count + spawn; ++i)
+    {
+      float lifetime = emitter.lifetime + emitter.lifetimeSpread * (RandomSigned(system.random) * 0.5f + 0.5f);
+      lifetime = std::max(lifetime, 1e-3f);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        lanes[axis][i] = emitter.position[axis];
+        lanes[3 + axis][i] = emitter.velocity[axis] + emitter.spread[axis] * RandomSigned(system.random);
+      }
+      for (int channel = 0; channel < 4; ++channel)
+      {
+        float variation = channel < 3 ? emitter.colorSpread * RandomSigned(system.random) : 0.0f;
+        lanes[6 + channel][i] = glm::clamp(emitter.color[channel] + variation, 0.0f, 1.0f);
+      }
+      lanes[10][i] = lifetime;
+      lanes[11][i] = 1.0f / lifetime;
+      lanes[12][i] = emitter.size;
+    }
+    system.count += spawn;
+  }
+}
+
+bool CreateParticleSystem(ParticleSystem& system, size_t maxParticles, bool createBuffers)
+{
+  system = ParticleSystem();
+  size_t chunks = (std::max<size_t>(1, maxParticles) + kParticleChunkSize - 1) / kParticleChunkSize;
+  system.maxParticles = chunks * kParticleChunkSize;
+  system.chunkOffsets.resize(chunks);
+
+  system.particles = new ParticleArrays();
+  system.particles->alive.resize(system.maxParticles / 4);
+  for (ParticleBuffer& buffer : system.particles->buffers)
+  {
+    glm::aligned_vec4** arrays[kParticleArrayCount] = {
+      &buffer.positionX, &buffer.positionY, &buffer.positionZ, &buffer.velocityX, &buffer.velocityY,
+      &buffer.velocityZ, &buffer.colorR, &buffer.colorG, &buffer.colorB, &buffer.colorA,
+      &buffer.life, &buffer.inverseLifetime, &buffer.size
+    };
+    // A chunk is a multiple of 4 KB in every array, plus a cache line (4 groups) between the arrays
+    size_t stride = system.maxParticles / 4 + 4;
+    buffer.storage.assign(stride * kParticleArrayCount, glm::aligned_vec4(0.0f));
+    for (int array = 0; array < kParticleArrayCount; ++array)
+    {
+      *arrays[array] = buffer.storage.data() + stride * array;
+      buffer.lanes[array] = &(*arrays[array])->x;
+    }
+  }
+  for (int region = 0; region < kStreamBufferRegions; ++region)
+  {
+    system.staging[region].resize(system.maxParticles);
+    system.uploads[region].system = &system;
+    system.uploads[region].region = region;
+  }
+  if (!createBuffers)
+  {
+    return true;
+  }
+
+  // Every region starts at a whole instance, the vertex arrays point at the regions' starts
+  if (!CreateStreamBuffer(system.stream, system.maxParticles * sizeof(InstanceData)))
+  {
+    return false;
+  }
+
+  // The quad of vert.glsl, from -0.5 to 0.5, with white vertex colors so the instance color shows
+  const GLfloat quad[4][6] = {
+    { -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f },
+    { 0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f },
+    { -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f },
+    { 0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f },
+  };
+  const GLushort indices[6] = { 2, 0, 1, 3, 2, 1 };
+  glGenBuffers(1, &system.quadBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, system.quadBuffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+  // The stream buffer was checked by CreateStreamBuffer. Like there, ask the buffers themselves
+  // rather than glGetError, which may still hold an error from any earlier call.
+  GLint64 quadBufferSize = 0;
+  GLint64 indexBufferSize = 0;
+  glGetBufferParameteri64v(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &quadBufferSize);
+
+  // OpenGL 4.1 has no base instance for glDrawElementsInstanced, so every region gets a vertex
+  // array of its own with the instance attributes starting at that region
+  glGenVertexArrays(kStreamBufferRegions, system.vertexArrays);
+  for (int region = 0; region < kStreamBufferRegions; ++region)
+  {
+    glBindVertexArray(system.vertexArrays[region]);
+    if (region == 0)
+    {
+      glGenBuffers(1, &system.indexBuffer);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, system.indexBuffer);
+    if (region == 0)
+    {
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+      glGetBufferParameteri64v(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &indexBufferSize);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, system.quadBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+
+    size_t regionStart = region * system.stream.regionSize;
+    glBindBuffer(GL_ARRAY_BUFFER, system.stream.buffer);
+    glEnableVertexAttribArray(kInstanceTranslationScaleLocation);
+    glVertexAttribPointer(kInstanceTranslationScaleLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			  (GLvoid*)(regionStart + offsetof(InstanceData, translation)));
+    glVertexAttribDivisor(kInstanceTranslationScaleLocation, 1);
+    glEnableVertexAttribArray(kInstanceColorLocation);
+    glVertexAttribPointer(kInstanceColorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData),
+			  (GLvoid*)(regionStart + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(kInstanceColorLocation, 1);
+  }
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  // The cache did not see any of the bindings above
+  GLStateInvalidate();
+  return quadBufferSize == (GLint64)sizeof(quad) && indexBufferSize == (GLint64)sizeof(indices);
+}
+
+size_t ParticleSystemAddEmitter(ParticleSystem& system, const ParticleEmitter& emitter)
+{
+  system.emitters.push_back(emitter);
+  return system.emitters.size() - 1;
+}
+
+void ParticleSystemUpdate(ParticleSystem& system, float deltaTime)
+{
+  auto start = std::chrono::steady_clock::now();
+  system.region = (system.region + 1) % kStreamBufferRegions;
+  size_t simulated = system.count;
+
+  // Integrate every chunk, in parallel, and count the particles that live on
+  size_t chunks = (system.count + kParticleChunkSize - 1) / kParticleChunkSize;
+  ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+    for (size_t chunk = begin; chunk < end; ++chunk)
+    {
+      system.chunkOffsets[chunk] = IntegrateChunk(system, chunk, deltaTime);
+    }
+  });
+
+  // A chunk's particles go right after those of all chunks before it
+  size_t count = 0;
+  for (size_t chunk = 0; chunk < chunks; ++chunk)
+  {
+    size_t alive = system.chunkOffsets[chunk];
+    system.chunkOffsets[chunk] = count;
+    count += alive;
+  }
+
+  // Which lets every chunk copy its particles into the other buffer, and write their instances, in parallel
+  ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+    for (size_t chunk = begin; chunk < end; ++chunk)
+    {
+      CompactChunk(system, chunk, system.chunkOffsets[chunk]);
+    }
+  });
+  system.particles->current = 1 - system.particles->current;
+  system.statistics.died += system.count - count;
+  system.count = count;
+
+  Spawn(system, deltaTime);
+  WriteInstances(system, system.particles->buffers[system.particles->current], count, system.count);
+
+  ++system.statistics.updates;
+  system.statistics.simulated += simulated;
+  system.statistics.simulateMilliseconds +=
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs on the thread that owns the context: copies a frame's instances into its region of the buffer
+static void UploadParticles(void* data)
+{
+  ParticleUpload& upload = *static_cast<ParticleUpload*>(data);
+  ParticleSystem& system = *upload.system;
+
+  // Moves through the regions in the same order as the updates did, and waits here
+  // if the GPU still reads the region from kStreamBufferRegions frames ago
+  StreamBufferBeginFrame(system.stream);
+  if (upload.count == 0)
+  {
+    return;
+  }
+
+  // The first allocation of the frame, so it is at the start of the region where the vertex array points
+  size_t size = upload.count * sizeof(InstanceData);
+  StreamAllocation allocation = StreamBufferMap(system.stream, size);
+  if (allocation.data != nullptr)
+  {
+    std::memcpy(allocation.data, system.staging[upload.region].data(), size);
+  }
+  StreamBufferUnmap(system.stream);
+}
+
+static void FenceParticles(void* data)
+{
+  ParticleSystem& system = *static_cast<ParticleSystem*>(data);
+  StreamBufferEndFrame(system.stream);
+}
+
+void ParticleSystemUpload(ParticleSystem& system)
+{
+  // The render thread may be kStreamBufferRegions - 1 frames behind at most (see render_thread.hpp),
+  // so it is done with this region's staging memory before an update writes into it again
+  system.uploads[system.region].count = system.count;
+  RenderCall(UploadParticles, &system.uploads[system.region]);
+}
+
+DrawPacket ParticleSystemDrawPacket(const ParticleSystem& system)
+{
+  DrawPacket packet;
+  packet.vertexArray = system.vertexArrays[system.region];
+  packet.mode = GL_TRIANGLES;
+  packet.count = 6;
+  packet.indexType = GL_UNSIGNED_SHORT;
+  packet.instanceCount = (GLsizei)system.count;
+  return packet;
+}
+
+void ParticleSystemEndFrame(ParticleSystem& system)
+{
+  // The GPU is done with this frame's instances once it gets past the draw
+  RenderCall(FenceParticles, &system);
+}
+
+void DestroyParticleSystem(ParticleSystem& system)
+{
+  if (system.stream.buffer != 0)
+  {
+    DestroyStreamBuffer(system.stream);
+    glDeleteBuffers(1, &system.quadBuffer);
+    glDeleteBuffers(1, &system.indexBuffer);
+    glDeleteVertexArrays(kStreamBufferRegions, system.vertexArrays);
+    // The cache may still have a deleted vertex array bound, a new one may get the same name
+    GLStateInvalidate();
+  }
+  delete system.particles;
+  system = ParticleSystem();
+}
+
+void ParticleSystemPrintStatistics(const ParticleSystem& system)
+{
+  const ParticleStatistics& statistics = system.statistics;
+  if (statistics.updates == 0)
+  {
+    return;
+  }
+  double updates = (double)statistics.updates;
+  std::cout << "Particles (" << ParticleInstructionSet() << "): " << system.count << " alive, "
+	    << statistics.spawned / updates << " spawned and " << statistics.died / updates << " died per update, "
+	    << statistics.dropped << " dropped, " << statistics.simulateMilliseconds / updates << " ms per update";
+  if (statistics.simulated > 0)
+  {
+    std::cout << " (" << statistics.simulateMilliseconds * 1e6 / statistics.simulated << " ns per particle)";
+  }
+  std::cout << std::endl;
+}
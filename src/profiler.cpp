@@ -0,0 +1,445 @@
+#include <gloom/profiler.hpp>
+
+// Third Party Libraries
+#include <glad/glad.h>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Number of recent frames kept for the statistics and the trace
+static const int kHistorySize = 4096;
+static const int kPhaseCount = static_cast<int>(FramePhase::Count);
+static const char* kPhaseNames[kPhaseCount] = { "Input", "Update", "PreDraw", "Draw", "Swap" };
+
+// Everything we know about a single frame
+// Times are in microseconds, relative to when the profiler was initialized
+struct FrameRecord
+{
+  double cpuBegin[kPhaseCount] = {};
+  double cpuDuration[kPhaseCount] = {};
+  double gpuBegin[kPhaseCount] = {};
+  double gpuDuration[kPhaseCount] = {};
+  // Phases can be skipped (e.g. there is no input to handle when headless)
+  bool timed[kPhaseCount] = {};
+  double cpuFrameBegin = 0.0;
+  double cpuFrameTime = 0.0;
+  double gpuFrameTime = 0.0;
+  bool hasGpuTimes = false;
+};
+
+// Timestamp queries for one frame: one at the beginning and one at the end
+// of every phase, plus one each for the beginning and end of the frame
+struct FrameQueries
+{
+  GLuint phaseBegin[kPhaseCount] = {};
+  GLuint phaseEnd[kPhaseCount] = {};
+  GLuint frameBegin = 0;
+  GLuint frameEnd = 0;
+  // Which frame these queries were last issued for, -1 if none are pending
+  long long frame = -1;
+  bool phaseIssued[kPhaseCount] = {};
+};
+
+static std::chrono::steady_clock::time_point sStartTime;
+// GPU timestamp (in ns) taken at the same moment as sStartTime
+// Used to put GPU events on the same timeline as CPU events
+static GLint64 sGpuStartTime = 0;
+static bool sInitialized = false;
+
+static std::vector<FrameRecord> sHistory(kHistorySize);
+static FrameQueries sQueries[kProfilerFramesInFlight];
+static long long sFrameIndex = 0;
+// Number of GPU results we had to throw away because they were not ready in time
+static long long sDroppedGpuFrames = 0;
+// A copy of the newest frame with GPU times, other threads read it while we write the history
+static std::mutex sLatestMutex;
+static ProfilerFrameTimes sLatest;
+
+static double MicrosecondsSinceStart()
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sStartTime).count();
+}
+
+static FrameRecord& CurrentRecord()
+{
+  return sHistory[sFrameIndex % kHistorySize];
+}
+
+static FrameQueries& CurrentQueries()
+{
+  return sQueries[sFrameIndex % kProfilerFramesInFlight];
+}
+
+static void CollectGpuTimes(FrameQueries& queries);
+
+void ProfilerInitialize()
+{
+  for (FrameQueries& queries : sQueries)
+  {
+    glGenQueries(kPhaseCount, queries.phaseBegin);
+    glGenQueries(kPhaseCount, queries.phaseEnd);
+    glGenQueries(1, &queries.frameBegin);
+    glGenQueries(1, &queries.frameEnd);
+  }
+
+  sStartTime = std::chrono::steady_clock::now();
+  glGetInteger64v(GL_TIMESTAMP, &sGpuStartTime);
+  sInitialized = true;
+}
+
+void ProfilerShutdown()
+{
+  if (!sInitialized)
+  {
+    return;
+  }
+
+  for (FrameQueries& queries : sQueries)
+  {
+    // Pick up the last few frames before the queries are gone
+    CollectGpuTimes(queries);
+    glDeleteQueries(kPhaseCount, queries.phaseBegin);
+    glDeleteQueries(kPhaseCount, queries.phaseEnd);
+    glDeleteQueries(1, &queries.frameBegin);
+    glDeleteQueries(1, &queries.frameEnd);
+    queries = FrameQueries();
+  }
+  sInitialized = false;
+}
+
+/*
+  Reads back the queries of an older frame, if the GPU is done with them.
+  Queries are completed in order, so if the last one of the frame is available all of them are.
+*/
+static void CollectGpuTimes(FrameQueries& queries)
+{
+  if (queries.frame < 0)
+  {
+    return;
+  }
+
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(queries.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (available == GL_FALSE)
+  {
+    // Reading it now would stall, so we give up on this frame's GPU times
+    ++sDroppedGpuFrames;
+    queries.frame = -1;
+    return;
+  }
+
+  // The frame may already have dropped out of our history
+  if (sFrameIndex - queries.frame >= kHistorySize)
+  {
+    queries.frame = -1;
+    return;
+  }
+
+  FrameRecord& record = sHistory[queries.frame % kHistorySize];
+  for (int phase = 0; phase < kPhaseCount; ++phase)
+  {
+    if (!queries.phaseIssued[phase])
+    {
+      continue;
+    }
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(queries.phaseBegin[phase], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries.phaseEnd[phase], GL_QUERY_RESULT, &end);
+    record.gpuBegin[phase] = (static_cast<GLint64>(begin) - sGpuStartTime) / 1000.0;
+    record.gpuDuration[phase] = (end - begin) / 1000.0;
+  }
+
+  GLuint64 frameBegin = 0;
+  GLuint64 frameEnd = 0;
+  glGetQueryObjectui64v(queries.frameBegin, GL_QUERY_RESULT, &frameBegin);
+  glGetQueryObjectui64v(queries.frameEnd, GL_QUERY_RESULT, &frameEnd);
+  record.gpuFrameTime = (frameEnd - frameBegin) / 1000.0;
+  record.hasGpuTimes = true;
+
+  std::lock_guard<std::mutex> lock(sLatestMutex);
+  if (queries.frame > sLatest.frame)
+  {
+    sLatest.frame = queries.frame;
+    sLatest.cpuFrame = record.cpuFrameTime / 1000.0;
+    sLatest.gpuFrame = record.gpuFrameTime / 1000.0;
+    for (int phase = 0; phase < kPhaseCount; ++phase)
+    {
+      sLatest.cpuPhase[phase] = record.cpuDuration[phase] / 1000.0;
+      sLatest.gpuPhase[phase] = record.gpuDuration[phase] / 1000.0;
+      sLatest.timed[phase] = record.timed[phase];
+    }
+  }
+
+  queries.frame = -1;
+}
+
+void ProfilerBeginFrame()
+{
+  FrameRecord& record = CurrentRecord();
+  record = FrameRecord();
+  record.cpuFrameBegin = MicrosecondsSinceStart();
+
+  if (!sInitialized)
+  {
+    return;
+  }
+
+  // These queries were issued kProfilerFramesInFlight frames ago, so the GPU has most likely finished them
+  FrameQueries& queries = CurrentQueries();
+  CollectGpuTimes(queries);
+
+  queries.frame = sFrameIndex;
+  std::fill(std::begin(queries.phaseIssued), std::end(queries.phaseIssued), false);
+  glQueryCounter(queries.frameBegin, GL_TIMESTAMP);
+}
+
+void ProfilerEndFrame()
+{
+  FrameRecord& record = CurrentRecord();
+  record.cpuFrameTime = MicrosecondsSinceStart() - record.cpuFrameBegin;
+
+  if (sInitialized)
+  {
+    glQueryCounter(CurrentQueries().frameEnd, GL_TIMESTAMP);
+  }
+
+  ++sFrameIndex;
+}
+
+void ProfilerBeginPhase(FramePhase phase)
+{
+  int index = static_cast<int>(phase);
+  FrameRecord& record = CurrentRecord();
+  record.cpuBegin[index] = MicrosecondsSinceStart();
+  record.timed[index] = true;
+
+  if (sInitialized)
+  {
+    FrameQueries& queries = CurrentQueries();
+    glQueryCounter(queries.phaseBegin[index], GL_TIMESTAMP);
+    queries.phaseIssued[index] = true;
+  }
+}
+
+void ProfilerEndPhase(FramePhase phase)
+{
+  int index = static_cast<int>(phase);
+  FrameRecord& record = CurrentRecord();
+  record.cpuDuration[index] = MicrosecondsSinceStart() - record.cpuBegin[index];
+
+  if (sInitialized)
+  {
+    glQueryCounter(CurrentQueries().phaseEnd[index], GL_TIMESTAMP);
+  }
+}
+
+bool ProfilerLatestFrame(ProfilerFrameTimes& times)
+{
+  std::lock_guard<std::mutex> lock(sLatestMutex);
+  times = sLatest;
+  return sLatest.frame >= 0;
+}
+
+const char* ProfilerPhaseName(FramePhase phase)
+{
+  return kPhaseNames[static_cast<int>(phase)];
+}
+
+// p50, p99 and max of a set of samples, in milliseconds
+struct Percentiles
+{
+  double p50 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+  int count = 0;
+};
+
+static Percentiles ComputePercentiles(std::vector<double> samples)
+{
+  Percentiles result;
+  result.count = static_cast<int>(samples.size());
+  if (samples.empty())
+  {
+    return result;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  auto at = [&samples](double fraction) {
+    size_t index = static_cast<size_t>(fraction * (samples.size() - 1) + 0.5);
+    return samples[index] / 1000.0;
+  };
+  result.p50 = at(0.50);
+  result.p99 = at(0.99);
+  result.max = samples.back() / 1000.0;
+  return result;
+}
+
+// Visits the recorded frames that are still in our history, oldest first
+template <typename Function>
+static void ForEachRecordedFrame(Function function)
+{
+  long long first = std::max(0LL, sFrameIndex - kHistorySize);
+  for (long long frame = first; frame < sFrameIndex; ++frame)
+  {
+    function(sHistory[frame % kHistorySize]);
+  }
+}
+
+// Gathers the statistics shared by the summary and the JSON report
+struct ProfilerStatistics
+{
+  Percentiles cpuFrame;
+  Percentiles gpuFrame;
+  Percentiles cpuPhase[kPhaseCount];
+  Percentiles gpuPhase[kPhaseCount];
+};
+
+static ProfilerStatistics ComputeStatistics()
+{
+  std::vector<double> cpuFrame;
+  std::vector<double> gpuFrame;
+  std::vector<double> cpuPhase[kPhaseCount];
+  std::vector<double> gpuPhase[kPhaseCount];
+
+  ForEachRecordedFrame([&](const FrameRecord& record) {
+    cpuFrame.push_back(record.cpuFrameTime);
+    if (record.hasGpuTimes)
+    {
+      gpuFrame.push_back(record.gpuFrameTime);
+    }
+    for (int phase = 0; phase < kPhaseCount; ++phase)
+    {
+      if (!record.timed[phase])
+      {
+        continue;
+      }
+      cpuPhase[phase].push_back(record.cpuDuration[phase]);
+      if (record.hasGpuTimes)
+      {
+        gpuPhase[phase].push_back(record.gpuDuration[phase]);
+      }
+    }
+  });
+
+  ProfilerStatistics statistics;
+  statistics.cpuFrame = ComputePercentiles(cpuFrame);
+  statistics.gpuFrame = ComputePercentiles(gpuFrame);
+  for (int phase = 0; phase < kPhaseCount; ++phase)
+  {
+    statistics.cpuPhase[phase] = ComputePercentiles(cpuPhase[phase]);
+    statistics.gpuPhase[phase] = ComputePercentiles(gpuPhase[phase]);
+  }
+  return statistics;
+}
+
+void ProfilerPrintSummary()
+{
+  ProfilerStatistics statistics = ComputeStatistics();
+
+  auto print = [](const char* name, const Percentiles& cpu, const Percentiles& gpu) {
+    std::cout << "  " << name
+	      << "\tCPU p50 " << cpu.p50 << " p99 " << cpu.p99 << " max " << cpu.max
+	      << "\tGPU p50 " << gpu.p50 << " p99 " << gpu.p99 << " max " << gpu.max << std::endl;
+  };
+
+  std::cout << "Frame profile (ms) over the last " << statistics.cpuFrame.count << " frames" << std::endl;
+  print("Frame", statistics.cpuFrame, statistics.gpuFrame);
+  for (int phase = 0; phase < kPhaseCount; ++phase)
+  {
+    print(kPhaseNames[phase], statistics.cpuPhase[phase], statistics.gpuPhase[phase]);
+  }
+  if (sDroppedGpuFrames > 0)
+  {
+    std::cout << "  GPU results not ready in time for " << sDroppedGpuFrames << " frames" << std::endl;
+  }
+}
+
+static void WritePercentiles(std::ofstream& out, const Percentiles& percentiles)
+{
+  out << "{\"p50\": " << percentiles.p50
+      << ", \"p99\": " << percentiles.p99
+      << ", \"max\": " << percentiles.max
+      << ", \"samples\": " << percentiles.count << "}";
+}
+
+bool ProfilerWriteJSON(const std::string& filename)
+{
+  std::ofstream out(filename);
+  if (!out.is_open())
+  {
+    std::cout << "Could not write profile to " << filename << std::endl;
+    return false;
+  }
+
+  ProfilerStatistics statistics = ComputeStatistics();
+  out << "{\n";
+  out << "  \"frames\": " << sFrameIndex << ",\n";
+  out << "  \"droppedGpuFrames\": " << sDroppedGpuFrames << ",\n";
+  out << "  \"unit\": \"ms\",\n";
+  out << "  \"frame\": {\"cpu\": ";
+  WritePercentiles(out, statistics.cpuFrame);
+  out << ", \"gpu\": ";
+  WritePercentiles(out, statistics.gpuFrame);
+  out << "},\n";
+  out << "  \"phases\": {\n";
+  for (int phase = 0; phase < kPhaseCount; ++phase)
+  {
+    out << "    \"" << kPhaseNames[phase] << "\": {\"cpu\": ";
+    WritePercentiles(out, statistics.cpuPhase[phase]);
+    out << ", \"gpu\": ";
+    WritePercentiles(out, statistics.gpuPhase[phase]);
+    out << "}" << (phase + 1 < kPhaseCount ? "," : "") << "\n";
+  }
+  out << "  }\n";
+  out << "}\n";
+  return true;
+}
+
+bool ProfilerWriteChromeTrace(const std::string& filename)
+{
+  std::ofstream out(filename);
+  if (!out.is_open())
+  {
+    std::cout << "Could not write trace to " << filename << std::endl;
+    return false;
+  }
+
+  // Complete events ("ph": "X") with timestamps and durations in microseconds
+  // tid 1 is the CPU timeline and tid 2 the GPU timeline
+  bool first = true;
+  auto writeEvent = [&](const char* name, int tid, double begin, double duration) {
+    out << (first ? "\n" : ",\n")
+	<< "{\"name\": \"" << name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << tid
+	<< ", \"ts\": " << begin << ", \"dur\": " << duration << "}";
+    first = false;
+  };
+
+  out << std::fixed;
+  out << "{\"traceEvents\": [";
+  out << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}}";
+  out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+  first = false;
+  ForEachRecordedFrame([&](const FrameRecord& record) {
+    writeEvent("Frame", 1, record.cpuFrameBegin, record.cpuFrameTime);
+    for (int phase = 0; phase < kPhaseCount; ++phase)
+    {
+      if (!record.timed[phase])
+      {
+        continue;
+      }
+      writeEvent(kPhaseNames[phase], 1, record.cpuBegin[phase], record.cpuDuration[phase]);
+      if (record.hasGpuTimes)
+      {
+        writeEvent(kPhaseNames[phase], 2, record.gpuBegin[phase], record.gpuDuration[phase]);
+      }
+    }
+  });
+  out << "\n],\n\"displayTimeUnit\": \"ms\"}\n";
+  return true;
+}
@@ -0,0 +1,219 @@
+#include <gloom/program_cache.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Every cache file starts with this header, followed by binaryLength bytes of program binary
+struct ProgramCacheHeader
+{
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t key = 0;
+  uint32_t binaryFormat = 0;
+  uint32_t binaryLength = 0;
+  double compileMilliseconds = 0.0;
+};
+
+// 'GLPB' (GL Program Binary)
+static const uint32_t kProgramCacheMagic = 0x42504C47;
+// Bump this if the file layout changes
+static const uint32_t kProgramCacheVersion = 1;
+
+static bool sEnabled = false;
+static std::string sDirectory = "";
+// GL_RENDERER and GL_VERSION, mixed into every key
+static std::string sDriverIdentity = "";
+
+// Statistics
+static int sHits = 0;
+static int sMisses = 0;
+static int sRejected = 0;
+static double sMillisecondsSaved = 0.0;
+
+// FNV-1a, continuing from 'hash'
+static uint64_t HashBytes(uint64_t hash, const char* data, size_t length)
+{
+  for (size_t i = 0; i < length; ++i)
+  {
+    hash ^= (unsigned char)data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static std::string CacheFilename(uint64_t key)
+{
+  std::ostringstream filename;
+  filename << sDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+  return filename.str();
+}
+
+void ProgramCacheInitialize(const std::string& directory)
+{
+  GLint formatCount = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+  if (formatCount <= 0)
+  {
+    std::cout << "Program cache disabled: the driver supports no program binary formats" << std::endl;
+    sEnabled = false;
+    return;
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error)
+  {
+    std::cout << "Program cache disabled: could not create " << directory << std::endl;
+    sEnabled = false;
+    return;
+  }
+
+  sDirectory = directory;
+  sDriverIdentity = std::string((const char*)glGetString(GL_RENDERER)) + "\n" +
+		    std::string((const char*)glGetString(GL_VERSION));
+  sEnabled = true;
+}
+
+bool ProgramCacheEnabled()
+{
+  return sEnabled;
+}
+
+uint64_t ProgramCacheKey(std::initializer_list<std::string_view> sources)
+{
+  uint64_t hash = 14695981039346656037ull;
+  hash = HashBytes(hash, sDriverIdentity.data(), sDriverIdentity.size());
+  for (std::string_view source : sources)
+  {
+    // Mix in the length too, so moving text from one stage to the next changes the key
+    uint64_t length = source.size();
+    hash = HashBytes(hash, (const char*)&length, sizeof(length));
+    hash = HashBytes(hash, source.data(), source.size());
+  }
+  return hash;
+}
+
+GLuint ProgramCacheLoad(uint64_t key)
+{
+  if (!sEnabled)
+  {
+    return 0;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+
+  std::ifstream file(CacheFilename(key), std::ios::binary);
+  if (!file.is_open())
+  {
+    ++sMisses;
+    return 0;
+  }
+
+  ProgramCacheHeader header;
+  file.read((char*)&header, sizeof(header));
+  if (!file || header.magic != kProgramCacheMagic || header.version != kProgramCacheVersion || header.key != key)
+  {
+    ++sMisses;
+    return 0;
+  }
+
+  std::vector<char> binary(header.binaryLength);
+  file.read(binary.data(), binary.size());
+  if (!file)
+  {
+    ++sMisses;
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+  // The driver is free to reject binaries, e.g. after a driver update
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked == GL_FALSE)
+  {
+    glDeleteProgram(program);
+    ++sRejected;
+    ++sMisses;
+    return 0;
+  }
+
+  std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - startTime;
+  ++sHits;
+  sMillisecondsSaved += header.compileMilliseconds - loadTime.count();
+  return program;
+}
+
+void ProgramCacheStore(uint64_t key, GLuint program, double compileMilliseconds)
+{
+  if (!sEnabled)
+  {
+    return;
+  }
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+  {
+    return;
+  }
+
+  ProgramCacheHeader header;
+  std::vector<char> binary(length);
+  GLenum binaryFormat = 0;
+  GLsizei writtenLength = 0;
+  glGetProgramBinary(program, length, &writtenLength, &binaryFormat, binary.data());
+  if (writtenLength <= 0)
+  {
+    return;
+  }
+
+  header.magic = kProgramCacheMagic;
+  header.version = kProgramCacheVersion;
+  header.key = key;
+  header.binaryFormat = binaryFormat;
+  header.binaryLength = (uint32_t)writtenLength;
+  header.compileMilliseconds = compileMilliseconds;
+
+  // Write to a temporary file first, so a crash can never leave a half written entry behind
+  std::string filename = CacheFilename(key);
+  std::string temporaryFilename = filename + ".tmp";
+  {
+    std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+      return;
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write(binary.data(), writtenLength);
+    if (!file)
+    {
+      return;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporaryFilename, filename, error);
+}
+
+void ProgramCachePrintStatistics()
+{
+  if (!sEnabled)
+  {
+    return;
+  }
+
+  std::cout << "Program cache: " << sHits << " hits, " << sMisses << " misses";
+  if (sRejected > 0)
+  {
+    std::cout << " (" << sRejected << " binaries rejected by the driver)";
+  }
+  std::cout << ", " << sMillisecondsSaved << " ms of compile time saved" << std::endl;
+}
@@ -0,0 +1,209 @@
+#include <gloom/render_commands.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/gldebug.hpp>
+
+void ExecuteRenderCommand(const RenderCommand& command)
+{
+  switch (command.type)
+  {
+    case RenderCommandType::Enable:
+      GLStateEnable(command.enumValue);
+      break;
+    case RenderCommandType::Disable:
+      GLStateDisable(command.enumValue);
+      break;
+    case RenderCommandType::Viewport:
+      GLStateViewport(command.integers[0], command.integers[1], command.integers[2], command.integers[3]);
+      break;
+    case RenderCommandType::ClearColor:
+      GLStateClearColor(command.floats[0], command.floats[1], command.floats[2], command.floats[3]);
+      break;
+    case RenderCommandType::Clear:
+      glClear(command.enumValue);
+      break;
+    case RenderCommandType::BlendFunc:
+      GLStateBlendFunc(command.enumValue, (GLenum)command.integers[0]);
+      break;
+    case RenderCommandType::UseProgram:
+      GLStateUseProgram(command.name);
+      break;
+    case RenderCommandType::BindVertexArray:
+      GLStateBindVertexArray(command.name);
+      break;
+    case RenderCommandType::BindBuffer:
+      GLStateBindBuffer(command.enumValue, command.name);
+      break;
+    case RenderCommandType::BindBufferRange:
+      GLStateBindBufferRange(command.enumValue, (GLuint)command.integers[0], command.name, command.offset,
+			     command.size);
+      break;
+    case RenderCommandType::BindTexture:
+      GLStateActiveTexture(GL_TEXTURE0 + command.integers[0]);
+      GLStateBindTexture(command.enumValue, command.name);
+      break;
+    case RenderCommandType::DrawElements:
+      GLCheck(glDrawElements(command.enumValue, command.integers[0], (GLenum)command.integers[1],
+			     (const void*)command.offset));
+      break;
+    case RenderCommandType::DrawElementsInstanced:
+      GLCheck(glDrawElementsInstanced(command.enumValue, command.integers[0], (GLenum)command.integers[1],
+				      (const void*)command.offset, command.integers[2]));
+      break;
+    case RenderCommandType::DrawElementsBaseVertex:
+      GLCheck(glDrawElementsBaseVertex(command.enumValue, command.integers[0], (GLenum)command.integers[1],
+				       (void*)command.offset, command.integers[2]));
+      break;
+    case RenderCommandType::Call:
+      command.function(command.data);
+      break;
+    case RenderCommandType::EndFrame:
+      // Handled by whoever presents the frame
+      break;
+  }
+}
+
+void RenderEnable(GLenum capability)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::Enable;
+  command.enumValue = capability;
+  RenderSubmit(command);
+}
+
+void RenderDisable(GLenum capability)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::Disable;
+  command.enumValue = capability;
+  RenderSubmit(command);
+}
+
+void RenderViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::Viewport;
+  command.integers[0] = x;
+  command.integers[1] = y;
+  command.integers[2] = width;
+  command.integers[3] = height;
+  RenderSubmit(command);
+}
+
+void RenderClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::ClearColor;
+  command.floats[0] = red;
+  command.floats[1] = green;
+  command.floats[2] = blue;
+  command.floats[3] = alpha;
+  RenderSubmit(command);
+}
+
+void RenderClear(GLbitfield mask)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::Clear;
+  command.enumValue = mask;
+  RenderSubmit(command);
+}
+
+void RenderBlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::BlendFunc;
+  command.enumValue = sourceFactor;
+  command.integers[0] = (GLint)destinationFactor;
+  RenderSubmit(command);
+}
+
+void RenderUseProgram(GLuint program)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::UseProgram;
+  command.name = program;
+  RenderSubmit(command);
+}
+
+void RenderBindVertexArray(GLuint vertexArray)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::BindVertexArray;
+  command.name = vertexArray;
+  RenderSubmit(command);
+}
+
+void RenderBindBuffer(GLenum target, GLuint buffer)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::BindBuffer;
+  command.enumValue = target;
+  command.name = buffer;
+  RenderSubmit(command);
+}
+
+void RenderBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::BindBufferRange;
+  command.enumValue = target;
+  command.name = buffer;
+  command.integers[0] = (GLint)index;
+  command.offset = offset;
+  command.size = size;
+  RenderSubmit(command);
+}
+
+void RenderBindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::BindTexture;
+  command.enumValue = target;
+  command.name = texture;
+  command.integers[0] = (GLint)unit;
+  RenderSubmit(command);
+}
+
+void RenderDrawElements(GLenum mode, GLsizei count, GLenum type, GLintptr offset)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::DrawElements;
+  command.enumValue = mode;
+  command.integers[0] = count;
+  command.integers[1] = (GLint)type;
+  command.offset = offset;
+  RenderSubmit(command);
+}
+
+void RenderDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instanceCount)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::DrawElementsInstanced;
+  command.enumValue = mode;
+  command.integers[0] = count;
+  command.integers[1] = (GLint)type;
+  command.offset = offset;
+  command.integers[2] = instanceCount;
+  RenderSubmit(command);
+}
+
+void RenderDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLint baseVertex)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::DrawElementsBaseVertex;
+  command.enumValue = mode;
+  command.integers[0] = count;
+  command.integers[1] = (GLint)type;
+  command.offset = offset;
+  command.integers[2] = baseVertex;
+  RenderSubmit(command);
+}
+
+void RenderCall(void (*function)(void* data), void* data)
+{
+  RenderCommand command;
+  command.type = RenderCommandType::Call;
+  command.function = function;
+  command.data = data;
+  RenderSubmit(command);
+}
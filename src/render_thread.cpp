@@ -0,0 +1,161 @@
+#include <gloom/render_thread.hpp>
+#include <gloom/spsc_ring.hpp>
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// Enough commands for a few frames of our scene
+static const size_t kCommandRingCapacity = 16384;
+// How often to check for work before giving the core to another thread
+static const int kSpinCount = 64;
+
+static SpscRing<RenderCommand, kCommandRingCapacity> sCommands;
+static RenderThreadCallbacks sCallbacks;
+static std::thread sRenderThread;
+static std::atomic<bool> sRunning{false};
+static std::atomic<bool> sStopRequested{false};
+
+// Frames recorded by the main thread and frames presented by the render thread
+static std::atomic<unsigned long long> sFramesSubmitted{0};
+static std::atomic<unsigned long long> sFramesRendered{0};
+
+// Statistics, only touched by the main thread
+static unsigned long long sRingFullStalls = 0;
+static unsigned long long sFrameWaits = 0;
+static double sMillisecondsWaited = 0.0;
+
+// Spin briefly, then yield, so an idle thread does not burn a whole core
+static void Backoff(int& attempts)
+{
+  if (++attempts < kSpinCount)
+  {
+    return;
+  }
+  std::this_thread::yield();
+}
+
+static void RenderThread()
+{
+  sCallbacks.acquireContext();
+
+  bool inFrame = false;
+  RenderCommand command;
+  int attempts = 0;
+  for (;;)
+  {
+    if (!sCommands.TryPop(command))
+    {
+      // Only exit once every recorded command has been executed
+      if (sStopRequested.load(std::memory_order_acquire) && sCommands.Empty())
+      {
+        break;
+      }
+      Backoff(attempts);
+      continue;
+    }
+    attempts = 0;
+
+    if (!inFrame)
+    {
+      sCallbacks.beginFrame();
+      inFrame = true;
+    }
+
+    if (command.type == RenderCommandType::EndFrame)
+    {
+      sCallbacks.endFrame();
+      inFrame = false;
+      sFramesRendered.fetch_add(1, std::memory_order_release);
+    }
+    else
+    {
+      ExecuteRenderCommand(command);
+    }
+  }
+
+  sCallbacks.releaseContext();
+}
+
+void RenderSubmit(const RenderCommand& command)
+{
+  if (!sRunning.load(std::memory_order_relaxed))
+  {
+    ExecuteRenderCommand(command);
+    return;
+  }
+
+  if (sCommands.TryPush(command))
+  {
+    return;
+  }
+
+  // The render thread is behind by a whole ring of commands, wait for it
+  ++sRingFullStalls;
+  auto startTime = std::chrono::steady_clock::now();
+  int attempts = 0;
+  while (!sCommands.TryPush(command))
+  {
+    Backoff(attempts);
+  }
+  sMillisecondsWaited += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void RenderThreadStart(const RenderThreadCallbacks& callbacks)
+{
+  sCallbacks = callbacks;
+  sStopRequested.store(false);
+  sFramesSubmitted.store(0);
+  sFramesRendered.store(0);
+  sRunning.store(true);
+  sRenderThread = std::thread(RenderThread);
+}
+
+void RenderThreadEndFrame()
+{
+  RenderCommand command;
+  command.type = RenderCommandType::EndFrame;
+  RenderSubmit(command);
+  unsigned long long submitted = sFramesSubmitted.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  // Do not let the simulation run too far ahead of what is on screen
+  if (submitted - sFramesRendered.load(std::memory_order_acquire) <= (unsigned long long)kRenderThreadMaxFramesInFlight)
+  {
+    return;
+  }
+
+  ++sFrameWaits;
+  auto startTime = std::chrono::steady_clock::now();
+  int attempts = 0;
+  while (submitted - sFramesRendered.load(std::memory_order_acquire) > (unsigned long long)kRenderThreadMaxFramesInFlight)
+  {
+    Backoff(attempts);
+  }
+  sMillisecondsWaited += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void RenderThreadStop()
+{
+  if (!sRunning.load())
+  {
+    return;
+  }
+
+  sStopRequested.store(true, std::memory_order_release);
+  sRenderThread.join();
+  sRunning.store(false);
+}
+
+bool RenderThreadRunning()
+{
+  return sRunning.load(std::memory_order_relaxed);
+}
+
+void RenderThreadPrintStatistics()
+{
+  std::cout << "Render thread: " << sFramesRendered.load() << " frames rendered, main thread waited "
+	    << sFrameWaits << " times for frames in flight and " << sRingFullStalls
+	    << " times for a full command ring (" << sMillisecondsWaited << " ms total)" << std::endl;
+}
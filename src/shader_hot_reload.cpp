@@ -0,0 +1,304 @@
+#include <gloom/shader_hot_reload.hpp>
+#include <gloom/asset_io.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/render_thread.hpp>
+
+// POSIX / Linux
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// C++ Standard Template Library (STL)
+#include <atomic>
+#include <climits>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A program we reload when its files change
+struct WatchedProgram
+{
+  std::string name = "";
+  std::string vertexFilename = "";
+  std::string fragmentFilename = "";
+  // Only the watcher thread touches this, to skip saves that did not change anything
+  size_t sourceHash = 0;
+
+  // Only the render thread touches these
+  ShaderProgramHandle currentHandle = kInvalidShaderProgram;
+  ShaderProgramHandle pendingHandle = kInvalidShaderProgram;
+  std::atomic<GLuint>* program = nullptr;
+};
+
+// New sources loaded by the watcher thread, waiting for the render thread
+struct ReloadedSources
+{
+  size_t programIndex = 0;
+  std::string vertexSource = "";
+  std::string fragmentSource = "";
+};
+
+// A replaced program, kept alive until no recorded frame can still use it
+struct RetiredProgram
+{
+  ShaderProgramHandle handle = kInvalidShaderProgram;
+  int framesLeft = 0;
+};
+
+// With the render thread, up to kRenderThreadMaxFramesInFlight frames were recorded before the
+// swap and still name the old program, and the main thread may be recording one more right now
+static const int kRetiredProgramFrames = kRenderThreadMaxFramesInFlight + 1;
+
+// Editors tend to write a file several times in a row, so we wait this long for
+// things to settle before loading anything
+static const std::chrono::milliseconds kDebounceTime(50);
+
+static std::vector<WatchedProgram> sWatchedPrograms;
+static std::thread sWatcherThread;
+static std::atomic<bool> sRunning{false};
+static int sInotify = -1;
+// Writing to this pipe wakes the watcher thread up so it can exit
+static int sWakePipe[2] = { -1, -1 };
+
+// Hand over from the watcher thread to the render thread
+static std::mutex sReloadMutex;
+static std::vector<ReloadedSources> sReloadedSources;
+
+// Only the render thread touches these
+static std::vector<RetiredProgram> sRetiredPrograms;
+
+void ShaderHotReloadWatch(const std::string& name, const std::string& vertexFilename,
+			  const std::string& fragmentFilename, ShaderProgramHandle handle,
+			  std::atomic<GLuint>* program)
+{
+  WatchedProgram watched;
+  watched.name = name;
+  watched.vertexFilename = vertexFilename;
+  watched.fragmentFilename = fragmentFilename;
+  watched.currentHandle = handle;
+  watched.program = program;
+  sWatchedPrograms.push_back(watched);
+}
+
+static bool UsesFile(const WatchedProgram& watched, const std::string& filename)
+{
+  namespace fs = std::filesystem;
+  return fs::path(watched.vertexFilename).filename() == filename ||
+	 fs::path(watched.fragmentFilename).filename() == filename;
+}
+
+/*
+  Runs on the watcher thread: loads the sources of a program and queues them for the
+  render thread if they differ from what we loaded last time
+*/
+static void LoadChangedProgram(size_t programIndex)
+{
+  WatchedProgram& watched = sWatchedPrograms[programIndex];
+  AssetFile vertexFile = LoadAsset(watched.vertexFilename);
+  AssetFile fragmentFile = LoadAsset(watched.fragmentFilename);
+  if (!vertexFile.IsOpen() || !fragmentFile.IsOpen())
+  {
+    // Probably caught in the middle of a save, the next event will try again
+    return;
+  }
+
+  std::hash<std::string_view> hasher;
+  size_t hash = hasher(vertexFile.View()) ^ (hasher(fragmentFile.View()) * 31);
+  if (hash == watched.sourceHash)
+  {
+    return;
+  }
+  watched.sourceHash = hash;
+
+  // The render thread gets its own copy, the asset files are released right after this
+  ReloadedSources reloaded;
+  reloaded.programIndex = programIndex;
+  reloaded.vertexSource = std::string(vertexFile.View());
+  reloaded.fragmentSource = std::string(fragmentFile.View());
+
+  std::lock_guard<std::mutex> lock(sReloadMutex);
+  // A newer version replaces one the render thread has not picked up yet
+  for (ReloadedSources& queued : sReloadedSources)
+  {
+    if (queued.programIndex == programIndex)
+    {
+      queued = std::move(reloaded);
+      return;
+    }
+  }
+  sReloadedSources.push_back(std::move(reloaded));
+}
+
+static void WatcherThread()
+{
+  std::vector<char> events(64 * (sizeof(inotify_event) + NAME_MAX + 1));
+  std::vector<bool> changed(sWatchedPrograms.size());
+
+  while (sRunning.load())
+  {
+    pollfd descriptors[2] = {
+      { sInotify, POLLIN, 0 },
+      { sWakePipe[0], POLLIN, 0 }
+    };
+    if (poll(descriptors, 2, -1) <= 0 || (descriptors[1].revents & POLLIN))
+    {
+      continue;
+    }
+
+    // Let the editor finish saving, then take every event that arrived in the meantime
+    std::this_thread::sleep_for(kDebounceTime);
+    std::fill(changed.begin(), changed.end(), false);
+    ssize_t length;
+    while ((length = read(sInotify, events.data(), events.size())) > 0)
+    {
+      for (char* position = events.data(); position < events.data() + length;)
+      {
+        const inotify_event* event = (const inotify_event*)position;
+        position += sizeof(inotify_event) + event->len;
+        if (event->len == 0)
+        {
+          continue;
+        }
+        for (size_t i = 0; i < sWatchedPrograms.size(); ++i)
+        {
+          if (UsesFile(sWatchedPrograms[i], event->name))
+          {
+            changed[i] = true;
+          }
+        }
+      }
+    }
+
+    for (size_t i = 0; i < sWatchedPrograms.size(); ++i)
+    {
+      if (changed[i])
+      {
+        LoadChangedProgram(i);
+      }
+    }
+  }
+}
+
+bool ShaderHotReloadStart(const std::string& directory)
+{
+  // Remember what is loaded right now, so saving an unchanged file does not trigger a reload
+  for (size_t i = 0; i < sWatchedPrograms.size(); ++i)
+  {
+    AssetFile vertexFile = LoadAsset(sWatchedPrograms[i].vertexFilename);
+    AssetFile fragmentFile = LoadAsset(sWatchedPrograms[i].fragmentFilename);
+    std::hash<std::string_view> hasher;
+    sWatchedPrograms[i].sourceHash = hasher(vertexFile.View()) ^ (hasher(fragmentFile.View()) * 31);
+  }
+
+  sInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (sInotify < 0)
+  {
+    std::cout << "Shader hot reload: inotify is not available" << std::endl;
+    return false;
+  }
+
+  // IN_CLOSE_WRITE covers editors that write in place,
+  // IN_MOVED_TO covers editors that write a temporary file and rename it
+  if (inotify_add_watch(sInotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+      pipe(sWakePipe) != 0)
+  {
+    std::cout << "Shader hot reload: could not watch " << directory << std::endl;
+    close(sInotify);
+    sInotify = -1;
+    return false;
+  }
+
+  sRunning.store(true);
+  sWatcherThread = std::thread(WatcherThread);
+  std::cout << "Shader hot reload: watching " << directory << std::endl;
+  return true;
+}
+
+void ShaderHotReloadUpdate()
+{
+  // Delete the replaced programs that every frame recorded with them has finished with
+  for (size_t i = 0; i < sRetiredPrograms.size();)
+  {
+    if (--sRetiredPrograms[i].framesLeft > 0)
+    {
+      ++i;
+      continue;
+    }
+    // Unbind first, so the state cache does not remember a deleted name
+    GLStateUseProgram(0);
+    ShaderManagerRelease(sRetiredPrograms[i].handle);
+    sRetiredPrograms.erase(sRetiredPrograms.begin() + i);
+  }
+
+  // Start compiling whatever the watcher thread loaded since the last frame
+  std::vector<ReloadedSources> reloadedSources;
+  {
+    std::lock_guard<std::mutex> lock(sReloadMutex);
+    reloadedSources.swap(sReloadedSources);
+  }
+  for (const ReloadedSources& reloaded : reloadedSources)
+  {
+    WatchedProgram& watched = sWatchedPrograms[reloaded.programIndex];
+    if (watched.pendingHandle != kInvalidShaderProgram)
+    {
+      // An even newer version arrived before the last one finished compiling
+      ShaderManagerRelease(watched.pendingHandle);
+    }
+    watched.pendingHandle = ShaderManagerSubmit(watched.name, reloaded.vertexSource, reloaded.fragmentSource);
+  }
+
+  // Swap in programs that finished compiling
+  for (WatchedProgram& watched : sWatchedPrograms)
+  {
+    if (watched.pendingHandle == kInvalidShaderProgram || !ShaderManagerIsReady(watched.pendingHandle))
+    {
+      continue;
+    }
+
+    GLuint program = ShaderManagerGetProgram(watched.pendingHandle);
+    if (program == 0)
+    {
+      std::cout << "Shader hot reload: '" << watched.name << "' failed, keeping the previous version" << std::endl;
+      ShaderManagerRelease(watched.pendingHandle);
+    }
+    else
+    {
+      std::cout << "Shader hot reload: '" << watched.name << "' reloaded" << std::endl;
+      RetiredProgram retired;
+      retired.handle = watched.currentHandle;
+      retired.framesLeft = kRetiredProgramFrames;
+      sRetiredPrograms.push_back(retired);
+      watched.currentHandle = watched.pendingHandle;
+      watched.program->store(program);
+    }
+    watched.pendingHandle = kInvalidShaderProgram;
+  }
+}
+
+void ShaderHotReloadStop()
+{
+  // ShaderManagerShutdown deletes the retired programs with all the others
+  sRetiredPrograms.clear();
+  if (!sRunning.load())
+  {
+    return;
+  }
+
+  sRunning.store(false);
+  char wake = 0;
+  if (write(sWakePipe[1], &wake, 1) != 1)
+  {
+    std::cout << "Shader hot reload: could not wake the watcher thread" << std::endl;
+  }
+  sWatcherThread.join();
+
+  close(sInotify);
+  close(sWakePipe[0]);
+  close(sWakePipe[1]);
+  sInotify = -1;
+  sWakePipe[0] = sWakePipe[1] = -1;
+}
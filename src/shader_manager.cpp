@@ -0,0 +1,233 @@
+#include <gloom/shader_manager.hpp>
+#include <gloom/program_cache.hpp>
+#include <gloom/uniform_buffer.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Everything we need to remember about a submitted program
+struct ShaderProgramEntry
+{
+  std::string name = "";
+  GLuint vertexShader = 0;
+  GLuint fragmentShader = 0;
+  GLuint program = 0;
+  uint64_t cacheKey = 0;
+  std::chrono::steady_clock::time_point submitTime;
+  // Set once we have checked the status (or the program came from the cache)
+  bool finished = false;
+  bool failed = false;
+};
+
+static std::vector<ShaderProgramEntry> sPrograms;
+static bool sParallelCompile = false;
+
+// Statistics
+static int sCacheHits = 0;
+static double sMillisecondsWaited = 0.0;
+
+void ShaderManagerInitialize()
+{
+  // 0xFFFFFFFF lets the driver pick the number of compiler threads
+  if (GLAD_GL_KHR_parallel_shader_compile)
+  {
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    sParallelCompile = true;
+  }
+  else if (GLAD_GL_ARB_parallel_shader_compile)
+  {
+    glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    sParallelCompile = true;
+  }
+
+  std::cout << "Parallel shader compile: " << (sParallelCompile ? "enabled" : "not supported") << std::endl;
+}
+
+/*
+  Creates a shader object and starts compiling it.
+  Note: we deliberately do not ask for GL_COMPILE_STATUS here, that would wait for the compiler.
+*/
+static GLuint StartCompile(GLenum type, std::string_view source)
+{
+  GLuint shaderObject = glCreateShader(type);
+  const char* src = source.data();
+  GLint length = (GLint)source.size();
+  glShaderSource(shaderObject, 1, &src, &length);
+  glCompileShader(shaderObject);
+  return shaderObject;
+}
+
+ShaderProgramHandle ShaderManagerSubmit(const std::string& name, std::string_view vertexSource,
+					std::string_view fragmentSource)
+{
+  ShaderProgramEntry entry;
+  entry.name = name;
+  entry.submitTime = std::chrono::steady_clock::now();
+  entry.cacheKey = ProgramCacheKey({ vertexSource, fragmentSource });
+
+  // A cached binary is ready to use straight away
+  entry.program = ProgramCacheLoad(entry.cacheKey);
+  if (entry.program != 0)
+  {
+    // Block bindings are not part of the binary, loading it resets them like linking does
+    BindUniformBlocks(entry.program);
+    entry.finished = true;
+    ++sCacheHits;
+  }
+  else
+  {
+    entry.vertexShader = StartCompile(GL_VERTEX_SHADER, vertexSource);
+    entry.fragmentShader = StartCompile(GL_FRAGMENT_SHADER, fragmentSource);
+
+    entry.program = glCreateProgram();
+    // Tell the driver we will ask for the binary of this program, so it keeps it around
+    glProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(entry.program, entry.vertexShader);
+    glAttachShader(entry.program, entry.fragmentShader);
+    // Linking is queued behind the compiles, again without waiting for the result
+    glLinkProgram(entry.program);
+  }
+
+  sPrograms.push_back(entry);
+  return (ShaderProgramHandle)sPrograms.size() - 1;
+}
+
+bool ShaderManagerIsReady(ShaderProgramHandle handle)
+{
+  const ShaderProgramEntry& entry = sPrograms[handle];
+  if (entry.finished || !sParallelCompile)
+  {
+    return true;
+  }
+
+  GLint completed = GL_FALSE;
+  glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &completed);
+  return completed == GL_TRUE;
+}
+
+// Prints the info log of a shader that failed to compile
+static void PrintShaderErrors(const std::string& name, const char* stage, GLuint shaderObject)
+{
+  GLint result = GL_FALSE;
+  glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &result);
+  if (result == GL_TRUE)
+  {
+    return;
+  }
+
+  GLint length = 0;
+  glGetShaderiv(shaderObject, GL_INFO_LOG_LENGTH, &length);
+  std::vector<char> errorMessages(length + 1);
+  glGetShaderInfoLog(shaderObject, length, &length, errorMessages.data());
+  std::cout << "ERROR: " << stage << " compilation failed in '" << name << "'!\n" << errorMessages.data() << "\n";
+}
+
+/*
+  Checks the result of compiling and linking, then releases the shader objects.
+  This is the point where we actually wait for the compiler.
+*/
+static void FinishProgram(ShaderProgramEntry& entry)
+{
+  auto waitStartTime = std::chrono::steady_clock::now();
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(entry.program, GL_LINK_STATUS, &linked);
+
+  auto now = std::chrono::steady_clock::now();
+  sMillisecondsWaited += std::chrono::duration<double, std::milli>(now - waitStartTime).count();
+
+  if (linked == GL_FALSE)
+  {
+    // Find out which stage is to blame
+    PrintShaderErrors(entry.name, "GL_VERTEX_SHADER", entry.vertexShader);
+    PrintShaderErrors(entry.name, "GL_FRAGMENT_SHADER", entry.fragmentShader);
+
+    GLint length = 0;
+    glGetProgramiv(entry.program, GL_INFO_LOG_LENGTH, &length);
+    std::vector<char> errorMessages(length + 1);
+    glGetProgramInfoLog(entry.program, length, &length, errorMessages.data());
+    std::cout << "ERROR: Program linking failed in '" << entry.name << "'!\n" << errorMessages.data() << "\n";
+
+    glDeleteProgram(entry.program);
+    entry.program = 0;
+    entry.failed = true;
+  }
+  else
+  {
+    // Validate our program
+    glValidateProgram(entry.program);
+    BindUniformBlocks(entry.program);
+
+    // The time from submitting to linking is an upper bound of what the compile cost us
+    std::chrono::duration<double, std::milli> compileTime = now - entry.submitTime;
+    ProgramCacheStore(entry.cacheKey, entry.program, compileTime.count());
+
+    // Once our final program Object has been created, we can detach and then delete our individual shaders
+    glDetachShader(entry.program, entry.vertexShader);
+    glDetachShader(entry.program, entry.fragmentShader);
+  }
+
+  // Delete individual shaders once we are done
+  glDeleteShader(entry.vertexShader);
+  glDeleteShader(entry.fragmentShader);
+  entry.vertexShader = 0;
+  entry.fragmentShader = 0;
+  entry.finished = true;
+}
+
+GLuint ShaderManagerGetProgram(ShaderProgramHandle handle)
+{
+  if (handle < 0 || handle >= (ShaderProgramHandle)sPrograms.size())
+  {
+    return 0;
+  }
+
+  ShaderProgramEntry& entry = sPrograms[handle];
+  if (!entry.finished)
+  {
+    FinishProgram(entry);
+  }
+  return entry.program;
+}
+
+void ShaderManagerRelease(ShaderProgramHandle handle)
+{
+  if (handle < 0 || handle >= (ShaderProgramHandle)sPrograms.size())
+  {
+    return;
+  }
+
+  ShaderProgramEntry& entry = sPrograms[handle];
+  if (!entry.finished)
+  {
+    glDeleteShader(entry.vertexShader);
+    glDeleteShader(entry.fragmentShader);
+  }
+  glDeleteProgram(entry.program);
+  // Keep the slot so other handles stay valid, it just no longer owns anything
+  entry = ShaderProgramEntry();
+  entry.finished = true;
+}
+
+void ShaderManagerShutdown()
+{
+  for (ShaderProgramEntry& entry : sPrograms)
+  {
+    if (!entry.finished)
+    {
+      glDeleteShader(entry.vertexShader);
+      glDeleteShader(entry.fragmentShader);
+    }
+    glDeleteProgram(entry.program);
+  }
+  sPrograms.clear();
+}
+
+void ShaderManagerPrintStatistics()
+{
+  std::cout << "Shader manager: " << sPrograms.size() << " programs submitted, "
+	    << sCacheHits << " from the program cache, "
+	    << sMillisecondsWaited << " ms spent waiting on the compiler" << std::endl;
+}
@@ -0,0 +1,240 @@
+#include <gloom/sprite_batch.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/render_commands.hpp>
+
+#include <glm/gtc/packing.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+bool CreateSpriteBatch(SpriteBatch& batch, size_t maxSprites)
+{
+  batch = SpriteBatch();
+  batch.maxSprites = maxSprites;
+  for (int region = 0; region < kStreamBufferRegions; ++region)
+  {
+    batch.staging[region].resize(maxSprites * 4);
+    batch.uploads[region].batch = &batch;
+    batch.uploads[region].region = region;
+  }
+  // Every region starts at a whole vertex, so draws can address it with a base vertex
+  if (!CreateStreamBuffer(batch.stream, std::max<size_t>(1, maxSprites) * 4 * sizeof(SpriteVertex)))
+  {
+    return false;
+  }
+  // A fence of our own costs more than the sprites themselves for small batches like the overlay's
+  batch.stream.frameFence = true;
+
+  // The same six indices for every quad, 4 vertices further each time
+  std::vector<GLushort> indices(kSpriteBatchMaxQuadsPerDraw * 6);
+  const GLushort quad[6] = { 2, 0, 1, 3, 2, 1 };
+  for (uint32_t sprite = 0; sprite < kSpriteBatchMaxQuadsPerDraw; ++sprite)
+  {
+    for (int i = 0; i < 6; ++i)
+    {
+      indices[sprite * 6 + i] = (GLushort)(sprite * 4 + quad[i]);
+    }
+  }
+
+  // The attribute setup and the index buffer are recorded in the vertex array, so it has to be bound first
+  glGenVertexArrays(1, &batch.vertexArray);
+  glBindVertexArray(batch.vertexArray);
+
+  glGenBuffers(1, &batch.indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+  // The stream buffer was checked by CreateStreamBuffer. Like there, ask the buffer itself
+  // rather than glGetError, which may still hold an error from any earlier call.
+  GLint64 indexBufferSize = 0;
+  glGetBufferParameteri64v(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &indexBufferSize);
+
+  // Offsets are from the start of the buffer, draws pick the region and sprite with their base vertex
+  glBindBuffer(GL_ARRAY_BUFFER, batch.stream.buffer);
+  glEnableVertexAttribArray(kSpritePositionLocation);
+  glVertexAttribPointer(kSpritePositionLocation, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+			(GLvoid*)offsetof(SpriteVertex, position));
+  glEnableVertexAttribArray(kSpriteTextureCoordinatesLocation);
+  glVertexAttribPointer(kSpriteTextureCoordinatesLocation, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(SpriteVertex),
+			(GLvoid*)offsetof(SpriteVertex, textureCoordinates));
+  glEnableVertexAttribArray(kSpriteColorLocation);
+  glVertexAttribPointer(kSpriteColorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex),
+			(GLvoid*)offsetof(SpriteVertex, color));
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  // The cache did not see any of the bindings above
+  GLStateInvalidate();
+  return indexBufferSize == (GLint64)(indices.size() * sizeof(GLushort));
+}
+
+void SpriteBatchBegin(SpriteBatch& batch)
+{
+  batch.region = (batch.region + 1) % kStreamBufferRegions;
+  batch.spriteCount = 0;
+  batch.draws.clear();
+  ++batch.statistics.frames;
+}
+
+bool SpriteBatchSubmit(SpriteBatch& batch, GLuint texture, const glm::vec4& rect, const glm::vec4& color,
+		       float rotation, const glm::vec4& textureRect, SpriteBlend blend)
+{
+  if (batch.spriteCount >= batch.maxSprites)
+  {
+    ++batch.statistics.overflows;
+    return false;
+  }
+
+  // Continue the current batch if we can, otherwise note why we could not
+  if (batch.draws.empty() || batch.draws.back().texture != texture || batch.draws.back().blend != blend)
+  {
+    if (!batch.draws.empty())
+    {
+      batch.statistics.textureBreaks += batch.draws.back().texture != texture ? 1 : 0;
+      batch.statistics.blendBreaks += batch.draws.back().blend != blend ? 1 : 0;
+    }
+    SpriteDraw draw;
+    draw.texture = texture;
+    draw.blend = blend;
+    draw.firstSprite = (uint32_t)batch.spriteCount;
+    batch.draws.push_back(draw);
+  }
+  ++batch.draws.back().spriteCount;
+
+  // The corners are the center plus or minus the two half axes of the (rotated) rectangle
+  glm::vec2 halfSize(rect.z * 0.5f, rect.w * 0.5f);
+  glm::vec2 center(rect.x + halfSize.x, rect.y + halfSize.y);
+  glm::vec2 axisX(halfSize.x, 0.0f);
+  glm::vec2 axisY(0.0f, halfSize.y);
+  if (rotation != 0.0f)
+  {
+    float cosine = std::cos(rotation);
+    float sine = std::sin(rotation);
+    axisX = glm::vec2(cosine, sine) * halfSize.x;
+    axisY = glm::vec2(-sine, cosine) * halfSize.y;
+  }
+
+  uint32_t packedColor = glm::packUnorm4x8(color);
+  SpriteVertex* vertices = batch.staging[batch.region].data() + batch.spriteCount * 4;
+  vertices[0].position = center - axisX - axisY;
+  vertices[1].position = center + axisX - axisY;
+  vertices[2].position = center - axisX + axisY;
+  vertices[3].position = center + axisX + axisY;
+  vertices[0].textureCoordinates = glm::packUnorm2x16(glm::vec2(textureRect.x, textureRect.y));
+  vertices[1].textureCoordinates = glm::packUnorm2x16(glm::vec2(textureRect.x + textureRect.z, textureRect.y));
+  vertices[2].textureCoordinates = glm::packUnorm2x16(glm::vec2(textureRect.x, textureRect.y + textureRect.w));
+  vertices[3].textureCoordinates =
+    glm::packUnorm2x16(glm::vec2(textureRect.x + textureRect.z, textureRect.y + textureRect.w));
+  for (int corner = 0; corner < 4; ++corner)
+  {
+    vertices[corner].color = packedColor;
+  }
+  ++batch.spriteCount;
+  return true;
+}
+
+// Runs on the thread that owns the context: copies a recorded frame into its region of the buffer
+static void UploadSprites(void* data)
+{
+  SpriteUpload& upload = *static_cast<SpriteUpload*>(data);
+  SpriteBatch& batch = *upload.batch;
+
+  // Moves through the regions in the same order as the recording did, and waits here
+  // if the GPU still reads the region from kStreamBufferRegions frames ago
+  StreamBufferBeginFrame(batch.stream);
+  if (upload.spriteCount == 0)
+  {
+    return;
+  }
+
+  size_t size = upload.spriteCount * 4 * sizeof(SpriteVertex);
+  StreamAllocation allocation = StreamBufferMap(batch.stream, size, sizeof(SpriteVertex));
+  if (allocation.data != nullptr)
+  {
+    std::memcpy(allocation.data, batch.staging[upload.region].data(), size);
+  }
+  StreamBufferUnmap(batch.stream);
+}
+
+static void FenceSprites(void* data)
+{
+  SpriteBatch& batch = *static_cast<SpriteBatch*>(data);
+  StreamBufferEndFrame(batch.stream);
+}
+
+static void RecordBlend(SpriteBlend blend)
+{
+  switch (blend)
+  {
+    case SpriteBlend::Opaque:
+      RenderDisable(GL_BLEND);
+      break;
+    case SpriteBlend::Alpha:
+      RenderEnable(GL_BLEND);
+      RenderBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      break;
+    case SpriteBlend::Additive:
+      RenderEnable(GL_BLEND);
+      RenderBlendFunc(GL_SRC_ALPHA, GL_ONE);
+      break;
+  }
+}
+
+void SpriteBatchEnd(SpriteBatch& batch)
+{
+  // The render thread may be kStreamBufferRegions - 1 frames behind at most (see render_thread.hpp),
+  // so it is done with this frame's staging memory before we record into it again
+  batch.uploads[batch.region].spriteCount = batch.spriteCount;
+  RenderCall(UploadSprites, &batch.uploads[batch.region]);
+
+  // Where this frame's region starts, counted in vertices
+  GLint regionVertex = (GLint)(batch.region * batch.stream.regionSize / sizeof(SpriteVertex));
+  RenderBindVertexArray(batch.vertexArray);
+  for (size_t i = 0; i < batch.draws.size(); ++i)
+  {
+    const SpriteDraw& draw = batch.draws[i];
+    if (i == 0 || draw.blend != batch.draws[i - 1].blend)
+    {
+      RecordBlend(draw.blend);
+    }
+    RenderBindTexture(0, GL_TEXTURE_2D, draw.texture);
+    for (uint32_t first = 0; first < draw.spriteCount; first += kSpriteBatchMaxQuadsPerDraw)
+    {
+      uint32_t count = std::min(kSpriteBatchMaxQuadsPerDraw, draw.spriteCount - first);
+      RenderDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(count * 6), GL_UNSIGNED_SHORT, 0,
+				   regionVertex + (GLint)((draw.firstSprite + first) * 4));
+      ++batch.statistics.drawCalls;
+    }
+  }
+  batch.statistics.sprites += batch.spriteCount;
+  batch.statistics.batches += batch.draws.size();
+
+  // The GPU is done with this frame's vertices once it gets past these draws, which the frame fence marks
+  RenderCall(FenceSprites, &batch);
+}
+
+void DestroySpriteBatch(SpriteBatch& batch)
+{
+  DestroyStreamBuffer(batch.stream);
+  glDeleteBuffers(1, &batch.indexBuffer);
+  glDeleteVertexArrays(1, &batch.vertexArray);
+  // The cache may still have the deleted vertex array bound, a new one may get the same name
+  GLStateInvalidate();
+  batch = SpriteBatch();
+}
+
+void SpriteBatchPrintStatistics(const SpriteBatch& batch)
+{
+  const SpriteBatchStatistics& statistics = batch.statistics;
+  if (statistics.frames == 0)
+  {
+    return;
+  }
+  std::cout << "Sprite batch: " << (double)statistics.sprites / statistics.frames << " sprites in "
+	    << (double)statistics.batches / statistics.frames << " batches and " << (double)statistics.drawCalls / statistics.frames
+	    << " draw calls per frame (" << statistics.textureBreaks << " texture and " << statistics.blendBreaks
+	    << " blend changes), " << statistics.overflows << " overflows" << std::endl;
+  StreamBufferPrintStatistics(batch.stream, "sprites");
+}
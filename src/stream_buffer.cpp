@@ -0,0 +1,218 @@
+#include <gloom/stream_buffer.hpp>
+#include <gloom/gl_state.hpp>
+
+// C++ Standard Template Library (STL)
+#include <chrono>
+#include <iostream>
+
+// How long a single glClientWaitSync may block before we check again
+static const GLuint64 kFenceTimeoutNanoseconds = 1000000000;
+
+// The frame fences of the last kStreamBufferRegions frames, by frame number modulo kStreamBufferRegions.
+// A region is reused kStreamBufferRegions frames later, so the fence it needs is still here, or one
+// of a later frame that signals after it.
+static GLsync sFrameFences[kStreamBufferRegions] = {};
+// The frame being recorded, frames before it are fenced. Starts at 1, 0 means no frame.
+static unsigned long long sFrame = 1;
+
+bool CreateStreamBuffer(StreamBuffer& stream, size_t regionSize, bool allowPersistent)
+{
+  stream = StreamBuffer();
+  stream.regionSize = regionSize;
+  size_t totalSize = regionSize * kStreamBufferRegions;
+
+  glGenBuffers(1, &stream.buffer);
+  // GL_COPY_WRITE_BUFFER does not affect vertex arrays or any drawing state,
+  // so binding our buffer there never disturbs what the renderer has bound
+  GLStateBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+
+  if (allowPersistent && GLAD_GL_ARB_buffer_storage)
+  {
+    // Immutable storage that stays mapped. Coherent means our writes become visible to the
+    // GPU without glFlushMappedBufferRange or a barrier.
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+    stream.persistentMapping = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags);
+    stream.persistent = stream.persistentMapping != nullptr;
+    if (!stream.persistent)
+    {
+      // Immutable storage can not be respecified, start over with a new buffer
+      // (unbound first, so the state cache does not remember a deleted name)
+      GLStateBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+      glDeleteBuffers(1, &stream.buffer);
+      glGenBuffers(1, &stream.buffer);
+      GLStateBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+    }
+  }
+
+  if (!stream.persistent)
+  {
+    // Allocated once, never orphaned
+    glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+  }
+
+  // The first StreamBufferBeginFrame advances to region 0
+  stream.region = kStreamBufferRegions - 1;
+
+  // Ask the buffer itself rather than glGetError, which may still hold an error from any earlier call.
+  // A failed glBufferData leaves the buffer empty.
+  GLint64 allocatedSize = 0;
+  glGetBufferParameteri64v(GL_COPY_WRITE_BUFFER, GL_BUFFER_SIZE, &allocatedSize);
+  return allocatedSize == (GLint64)totalSize;
+}
+
+// Waits until the GPU passed 'fence', counting the wait if it had not yet
+static void WaitForFence(StreamBuffer& stream, GLsync fence)
+{
+  // Usually the GPU finished this region frames ago, and a zero timeout poll says so
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  if (result != GL_TIMEOUT_EXPIRED)
+  {
+    return;
+  }
+
+  ++stream.statistics.fenceWaits;
+  auto startTime = std::chrono::steady_clock::now();
+  do
+  {
+    // Flush so the fence is guaranteed to reach the GPU, or we could wait forever
+    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNanoseconds);
+  } while (result == GL_TIMEOUT_EXPIRED);
+  stream.statistics.fenceWaitMilliseconds +=
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void StreamBufferBeginFrame(StreamBuffer& stream)
+{
+  stream.region = (stream.region + 1) % kStreamBufferRegions;
+  stream.regionUsed = 0;
+
+  if (stream.frameFence)
+  {
+    unsigned long long& frame = stream.regionFrames[stream.region];
+    if (frame == 0)
+    {
+      return;
+    }
+    if (frame < sFrame)
+    {
+      WaitForFence(stream, sFrameFences[frame % kStreamBufferRegions]);
+    }
+    else
+    {
+      // No frame fence covers the region yet, so everything issued so far has to finish
+      GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      WaitForFence(stream, fence);
+      glDeleteSync(fence);
+    }
+    frame = 0;
+    return;
+  }
+
+  GLsync& fence = stream.fences[stream.region];
+  if (fence == nullptr)
+  {
+    return;
+  }
+  WaitForFence(stream, fence);
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+StreamAllocation StreamBufferMap(StreamBuffer& stream, size_t size, size_t alignment)
+{
+  StreamAllocation allocation;
+
+  size_t start = (stream.regionUsed + alignment - 1) / alignment * alignment;
+  if (start + size > stream.regionSize)
+  {
+    ++stream.statistics.overflows;
+    return allocation;
+  }
+
+  allocation.offset = (GLintptr)(stream.region * stream.regionSize + start);
+  stream.regionUsed = start + size;
+  ++stream.statistics.allocations;
+  stream.statistics.bytesStreamed += size;
+
+  if (stream.persistent)
+  {
+    allocation.data = static_cast<char*>(stream.persistentMapping) + allocation.offset;
+    return allocation;
+  }
+
+  // The fence in StreamBufferBeginFrame already guarantees that the GPU is done with this
+  // region, so the driver does not need to synchronize (or copy) anything
+  GLStateBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+  allocation.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, allocation.offset, size,
+				     GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+  stream.mapped = allocation.data != nullptr;
+  return allocation;
+}
+
+void StreamBufferUnmap(StreamBuffer& stream)
+{
+  if (!stream.mapped)
+  {
+    return;
+  }
+  GLStateBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+  glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  stream.mapped = false;
+}
+
+void StreamBufferEndFrame(StreamBuffer& stream)
+{
+  StreamBufferUnmap(stream);
+  if (stream.frameFence)
+  {
+    stream.regionFrames[stream.region] = sFrame;
+    return;
+  }
+  if (stream.fences[stream.region] != nullptr)
+  {
+    glDeleteSync(stream.fences[stream.region]);
+  }
+  stream.fences[stream.region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamBufferFenceFrame()
+{
+  GLsync& fence = sFrameFences[sFrame % kStreamBufferRegions];
+  if (fence != nullptr)
+  {
+    glDeleteSync(fence);
+  }
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  ++sFrame;
+}
+
+void DestroyStreamBuffer(StreamBuffer& stream)
+{
+  for (GLsync& fence : stream.fences)
+  {
+    if (fence != nullptr)
+    {
+      glDeleteSync(fence);
+    }
+  }
+  if (stream.persistent)
+  {
+    GLStateBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
+  StreamBufferUnmap(stream);
+  GLStateBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glDeleteBuffers(1, &stream.buffer);
+  stream = StreamBuffer();
+}
+
+void StreamBufferPrintStatistics(const StreamBuffer& stream, const std::string& name)
+{
+  const StreamBufferStatistics& statistics = stream.statistics;
+  std::cout << "Stream buffer " << name << " (" << (stream.persistent ? "persistent" : "map unsynchronized")
+	    << ", " << kStreamBufferRegions << " x " << stream.regionSize / 1024 << " KiB): "
+	    << statistics.bytesStreamed / (1024.0 * 1024.0) << " MiB streamed in " << statistics.allocations
+	    << " allocations, " << statistics.overflows << " overflows, " << statistics.fenceWaits
+	    << " fence waits (" << statistics.fenceWaitMilliseconds << " ms)" << std::endl;
+}
@@ -0,0 +1,259 @@
+#include <gloom/text_renderer.hpp>
+#include <gloom/gl_state.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// The font, one row of 5 pixels per byte from top to bottom, the leftmost pixel in bit 4.
+// The last row is below the baseline, only descenders (g, j, p, q, y) use it.
+static const uint8_t kFont[kGlyphCount - 1][kGlyphHeight] =
+{
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+  { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00 }, // !
+  { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+  { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00 }, // #
+  { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04, 0x00 }, // $
+  { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00 }, // %
+  { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D, 0x00 }, // &
+  { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+  { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00 }, // (
+  { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00 }, // )
+  { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00, 0x00 }, // *
+  { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x00 }, // +
+  { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08, 0x00 }, // ,
+  { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00 }, // -
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // .
+  { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00 }, // /
+  { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E, 0x00 }, // 0
+  { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // 1
+  { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F, 0x00 }, // 2
+  { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E, 0x00 }, // 3
+  { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02, 0x00 }, // 4
+  { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E, 0x00 }, // 5
+  { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E, 0x00 }, // 6
+  { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00 }, // 7
+  { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00 }, // 8
+  { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C, 0x00 }, // 9
+  { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00, 0x00 }, // :
+  { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08, 0x00 }, // ;
+  { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00 }, // <
+  { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // =
+  { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00 }, // >
+  { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00 }, // ?
+  { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E, 0x00 }, // @
+  { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x00 }, // A
+  { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E, 0x00 }, // B
+  { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E, 0x00 }, // C
+  { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C, 0x00 }, // D
+  { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F, 0x00 }, // E
+  { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10, 0x00 }, // F
+  { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F, 0x00 }, // G
+  { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00 }, // H
+  { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // I
+  { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C, 0x00 }, // J
+  { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00 }, // K
+  { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F, 0x00 }, // L
+  { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00 }, // M
+  { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00 }, // N
+  { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // O
+  { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10, 0x00 }, // P
+  { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D, 0x00 }, // Q
+  { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11, 0x00 }, // R
+  { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E, 0x00 }, // S
+  { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, // T
+  { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // U
+  { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00 }, // V
+  { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00 }, // W
+  { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00 }, // X
+  { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x00 }, // Y
+  { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F, 0x00 }, // Z
+  { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E, 0x00 }, // [
+  { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00 }, // backslash
+  { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E, 0x00 }, // ]
+  { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ^
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00 }, // _
+  { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 }, // `
+  { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, // a
+  { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E, 0x00 }, // b
+  { 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x00 }, // c
+  { 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F, 0x00 }, // d
+  { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 }, // e
+  { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08, 0x00 }, // f
+  { 0x00, 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // g
+  { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00 }, // h
+  { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // i
+  { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x12, 0x0C }, // j
+  { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00 }, // k
+  { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // l
+  { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11, 0x00 }, // m
+  { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00 }, // n
+  { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // o
+  { 0x00, 0x00, 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10 }, // p
+  { 0x00, 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x01 }, // q
+  { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00 }, // r
+  { 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E, 0x00 }, // s
+  { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06, 0x00 }, // t
+  { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00 }, // u
+  { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00 }, // v
+  { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00 }, // w
+  { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00 }, // x
+  { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // y
+  { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F, 0x00 }, // z
+  { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00 }, // {
+  { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, // |
+  { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00 }, // }
+  { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00 }, // ~
+};
+
+// Index of the solid glyph, right after '~'
+static const int kSolidGlyph = kGlyphCount - 1;
+
+bool CreateTextRenderer(TextRenderer& text, size_t maxGlyphs, int scale)
+{
+  text.scale = std::max(1, scale);
+  text.statistics = TextRendererStatistics();
+
+  // Glyphs never shrink, so the page needs no mipmaps, and a texel of border keeps neighbors apart
+  TextureAtlasSettings settings;
+  settings.pageSize = 128;
+  settings.maxPages = 1;
+  settings.border = 1;
+  settings.mipLevels = 0;
+  CreateTextureAtlas(text.glyphs, settings);
+
+  // White pixels, the font only decides the alpha, and the color is the text's
+  uint8_t pixels[kGlyphWidth * kGlyphHeight * 4];
+  for (int glyph = 0; glyph < kGlyphCount; ++glyph)
+  {
+    for (int row = 0; row < kGlyphHeight; ++row)
+    {
+      // The atlas expects the rows from bottom to top
+      uint8_t bits = glyph == kSolidGlyph ? 0x1F : kFont[glyph][kGlyphHeight - 1 - row];
+      for (int column = 0; column < kGlyphWidth; ++column)
+      {
+	uint8_t* pixel = pixels + (row * kGlyphWidth + column) * 4;
+	pixel[0] = 255;
+	pixel[1] = 255;
+	pixel[2] = 255;
+	pixel[3] = (bits >> (kGlyphWidth - 1 - column)) & 1 ? 255 : 0;
+      }
+    }
+    if (!TextureAtlasInsert(text.glyphs, (AtlasAssetId)glyph, pixels, kGlyphWidth, kGlyphHeight))
+    {
+      std::cout << "Could not fit the font into its glyph atlas" << std::endl;
+      return false;
+    }
+    text.glyphRects[glyph] = TextureAtlasFind(text.glyphs, (AtlasAssetId)glyph)->textureRect;
+  }
+  text.texture = text.glyphs.pages[0].texture;
+
+  // Whole screen pixels per font pixel, so nearest filtering hits every texel exactly
+  GLStateBindTexture(GL_TEXTURE_2D, text.texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  return CreateSpriteBatch(text.batch, maxGlyphs);
+}
+
+void TextRendererBegin(TextRenderer& text)
+{
+  text.frameBegin = std::chrono::steady_clock::now();
+  SpriteBatchBegin(text.batch);
+}
+
+glm::vec2 TextRendererPrint(TextRenderer& text, glm::vec2 position, std::string_view string, const glm::vec4& color)
+{
+  // Snapped to whole pixels, so the glyphs' texels line up with the screen's
+  float scale = (float)text.scale;
+  float left = std::floor(position.x);
+  glm::vec2 pen(left, std::floor(position.y));
+  for (char character : string)
+  {
+    if (character == '\n')
+    {
+      pen.x = left;
+      pen.y -= kLineAdvance * scale;
+      continue;
+    }
+    int glyph = (unsigned char)character - kFirstGlyph;
+    if (glyph < 0 || glyph >= kSolidGlyph)
+    {
+      glyph = '?' - kFirstGlyph;
+    }
+    if (glyph != 0)
+    {
+      glm::vec4 rect(pen.x, pen.y - kGlyphHeight * scale, kGlyphWidth * scale, kGlyphHeight * scale);
+      SpriteBatchSubmit(text.batch, text.texture, rect, color, 0.0f, text.glyphRects[glyph]);
+    }
+    pen.x += kGlyphAdvance * scale;
+  }
+  return pen;
+}
+
+void TextRendererRect(TextRenderer& text, const glm::vec4& rect, const glm::vec4& color)
+{
+  // The middle of the solid glyph, away from its border
+  glm::vec4 solid = text.glyphRects[kSolidGlyph];
+  glm::vec4 middle(solid.x + solid.z * 0.5f, solid.y + solid.w * 0.5f, 0.0f, 0.0f);
+  SpriteBatchSubmit(text.batch, text.texture, rect, color, 0.0f, middle);
+}
+
+glm::vec2 TextRendererMeasure(const TextRenderer& text, std::string_view string)
+{
+  int columns = 0;
+  int longest = 0;
+  int lines = string.empty() ? 0 : 1;
+  for (char character : string)
+  {
+    if (character == '\n')
+    {
+      columns = 0;
+      ++lines;
+      continue;
+    }
+    longest = std::max(longest, ++columns);
+  }
+  // The last character and line end at their glyph, not at the advance
+  float width = longest > 0 ? ((longest - 1) * kGlyphAdvance + kGlyphWidth) * text.scale : 0.0f;
+  float height = lines > 0 ? ((lines - 1) * kLineAdvance + kGlyphHeight) * text.scale : 0.0f;
+  return glm::vec2(width, height);
+}
+
+void TextRendererEnd(TextRenderer& text)
+{
+  // Recording the upload and the draws is part of the text's cost. Without a render thread they also
+  // run right away, and the batch's fence may make the driver flush (e.g. llvmpipe).
+  SpriteBatchEnd(text.batch);
+  TextRendererStatistics& statistics = text.statistics;
+  statistics.lastCpuMilliseconds =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - text.frameBegin).count();
+
+  statistics.cpuMilliseconds += statistics.lastCpuMilliseconds;
+  statistics.maxCpuMilliseconds = std::max(statistics.maxCpuMilliseconds, statistics.lastCpuMilliseconds);
+  statistics.glyphs += text.batch.spriteCount;
+  ++statistics.frames;
+}
+
+void DestroyTextRenderer(TextRenderer& text)
+{
+  DestroySpriteBatch(text.batch);
+  DestroyTextureAtlas(text.glyphs);
+  text.texture = 0;
+}
+
+void TextRendererPrintStatistics(const TextRenderer& text)
+{
+  const TextRendererStatistics& statistics = text.statistics;
+  if (statistics.frames == 0)
+  {
+    return;
+  }
+  std::cout << "Text: " << (double)statistics.glyphs / statistics.frames << " glyphs per frame in "
+	    << (double)text.batch.statistics.drawCalls / statistics.frames << " draw calls, laid out and submitted in "
+	    << statistics.cpuMilliseconds / statistics.frames << " ms (max " << statistics.maxCpuMilliseconds << " ms)"
+	    << std::endl;
+}
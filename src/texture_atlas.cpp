@@ -0,0 +1,250 @@
+#include <gloom/texture_atlas.hpp>
+#include <gloom/asset_io.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/tga.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+void CreateTextureAtlas(TextureAtlas& atlas, const TextureAtlasSettings& settings)
+{
+  atlas = TextureAtlas();
+  atlas.settings = settings;
+  atlas.settings.mipLevels = std::min(std::max(settings.mipLevels, 0), 8);
+  atlas.settings.border = std::max(settings.border, 1 << atlas.settings.mipLevels);
+  atlas.settings.maxPages = std::max(settings.maxPages, 1);
+}
+
+// Adds an empty page, its texture has every level down to mipLevels
+static TextureAtlasPage& AddPage(TextureAtlas& atlas)
+{
+  const TextureAtlasSettings& settings = atlas.settings;
+  TextureAtlasPage page;
+  AtlasPackerReset(page.packer, settings.pageSize, settings.pageSize, settings.method);
+
+  glGenTextures(1, &page.texture);
+  GLStateActiveTexture(GL_TEXTURE0);
+  GLStateBindTexture(GL_TEXTURE_2D, page.texture);
+  for (int level = 0; level <= settings.mipLevels; ++level)
+  {
+    int size = std::max(1, settings.pageSize >> level);
+    glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, settings.mipLevels);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, settings.mipLevels > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  atlas.pages.push_back(page);
+  return atlas.pages.back();
+}
+
+// Fills in the lookup table entry of an image placed in a slot
+static AtlasEntry MakeEntry(const TextureAtlas& atlas, int page, const AtlasRect& slot, int width, int height)
+{
+  float scale = 1.0f / atlas.settings.pageSize;
+  AtlasEntry entry;
+  entry.page = page;
+  entry.texture = atlas.pages[page].texture;
+  entry.slot = slot;
+  entry.width = width;
+  entry.height = height;
+  entry.textureRect = glm::vec4((slot.x + atlas.settings.border) * scale, (slot.y + atlas.settings.border) * scale,
+				width * scale, height * scale);
+  return entry;
+}
+
+bool TextureAtlasInsert(TextureAtlas& atlas, AtlasAssetId id, const uint8_t* pixels, int width, int height)
+{
+  if (atlas.entries.count(id) != 0)
+  {
+    return true;
+  }
+
+  const TextureAtlasSettings& settings = atlas.settings;
+  int alignment = 1 << settings.mipLevels;
+  AtlasRect slot;
+  slot.width = AtlasSlotSize(width, settings.border, alignment);
+  slot.height = AtlasSlotSize(height, settings.border, alignment);
+
+  // The first page with room, or a new one
+  int page = -1;
+  for (size_t i = 0; i < atlas.pages.size() && page < 0; ++i)
+  {
+    if (AtlasPackerInsert(atlas.pages[i].packer, slot.width, slot.height, slot))
+    {
+      page = (int)i;
+    }
+  }
+  if (page < 0 && (int)atlas.pages.size() < settings.maxPages && slot.width <= settings.pageSize &&
+      slot.height <= settings.pageSize)
+  {
+    if (AtlasPackerInsert(AddPage(atlas).packer, slot.width, slot.height, slot))
+    {
+      page = (int)atlas.pages.size() - 1;
+    }
+  }
+  if (page < 0)
+  {
+    ++atlas.statistics.failedInserts;
+    return false;
+  }
+
+  // Client memory, not a pixel buffer object the texture streamer may have left bound
+  atlas.slotPixels.resize((size_t)slot.width * slot.height * 4);
+  AtlasRect local = slot;
+  local.x = 0;
+  local.y = 0;
+  AtlasBlit(atlas.slotPixels.data(), slot.width, local, settings.border, pixels, width, height);
+  GLStateBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  GLStateActiveTexture(GL_TEXTURE0);
+  GLStateBindTexture(GL_TEXTURE_2D, atlas.pages[page].texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, slot.x, slot.y, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE,
+		  atlas.slotPixels.data());
+  atlas.pages[page].mipmapsDirty = true;
+
+  atlas.entries[id] = MakeEntry(atlas, page, slot, width, height);
+  ++atlas.statistics.inserts;
+  atlas.statistics.imageArea += (size_t)width * height;
+  return true;
+}
+
+bool TextureAtlasEvict(TextureAtlas& atlas, AtlasAssetId id)
+{
+  auto found = atlas.entries.find(id);
+  if (found == atlas.entries.end())
+  {
+    return false;
+  }
+  // The pixels stay until another image is uploaded over them, nothing samples them anymore
+  const AtlasEntry& entry = found->second;
+  AtlasPackerRelease(atlas.pages[entry.page].packer, entry.slot);
+  atlas.statistics.imageArea -= (size_t)entry.width * entry.height;
+  ++atlas.statistics.evictions;
+  atlas.entries.erase(found);
+  return true;
+}
+
+const AtlasEntry* TextureAtlasFind(const TextureAtlas& atlas, AtlasAssetId id)
+{
+  auto found = atlas.entries.find(id);
+  return found != atlas.entries.end() ? &found->second : nullptr;
+}
+
+void TextureAtlasUpdateMipmaps(TextureAtlas& atlas)
+{
+  if (atlas.settings.mipLevels == 0)
+  {
+    return;
+  }
+  for (TextureAtlasPage& page : atlas.pages)
+  {
+    if (page.mipmapsDirty)
+    {
+      GLStateActiveTexture(GL_TEXTURE0);
+      GLStateBindTexture(GL_TEXTURE_2D, page.texture);
+      glGenerateMipmap(GL_TEXTURE_2D);
+      page.mipmapsDirty = false;
+    }
+  }
+}
+
+bool LoadTextureAtlas(TextureAtlas& atlas, const std::string& manifestFilename)
+{
+  AtlasManifest manifest;
+  if (!ReadAtlasManifest(manifestFilename, manifest))
+  {
+    std::cout << "Could not read the atlas manifest " << manifestFilename << std::endl;
+    return false;
+  }
+  TextureAtlasSettings settings;
+  settings.pageSize = manifest.pageSize;
+  settings.maxPages = (int)manifest.pageFilenames.size();
+  settings.border = manifest.border;
+  settings.mipLevels = manifest.mipLevels;
+  CreateTextureAtlas(atlas, settings);
+
+  std::filesystem::path directory = std::filesystem::path(manifestFilename).parent_path();
+  for (const std::string& pageFilename : manifest.pageFilenames)
+  {
+    AssetFile file = LoadAsset((directory / pageFilename).string());
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    if (!file.IsOpen() || !DecodeTGA(file.View(), pixels, width, height) || width != manifest.pageSize ||
+	height != manifest.pageSize)
+    {
+      std::cout << "Could not load the atlas page " << pageFilename << std::endl;
+      DestroyTextureAtlas(atlas);
+      return false;
+    }
+    TextureAtlasPage& page = AddPage(atlas);
+    GLStateBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    page.mipmapsDirty = true;
+    // The packer does not know the baked layout, so the page takes no new images.
+    // Evicted images still give their room back (with MaxRects).
+    page.packer.freeRects.clear();
+    page.packer.skyline.assign(1, SkylineSegment{ 0, manifest.pageSize, manifest.pageSize });
+  }
+
+  int alignment = 1 << atlas.settings.mipLevels;
+  for (const AtlasManifestEntry& image : manifest.entries)
+  {
+    AtlasRect slot;
+    slot.x = image.rect.x - manifest.border;
+    slot.y = image.rect.y - manifest.border;
+    slot.width = AtlasSlotSize(image.rect.width, manifest.border, alignment);
+    slot.height = AtlasSlotSize(image.rect.height, manifest.border, alignment);
+    TextureAtlasPage& page = atlas.pages[image.page];
+    page.packer.usedArea += (size_t)slot.width * slot.height;
+    ++page.packer.rectCount;
+    atlas.entries[AtlasAssetIdFromName(image.name)] = MakeEntry(atlas, image.page, slot, image.rect.width, image.rect.height);
+    atlas.statistics.imageArea += (size_t)image.rect.width * image.rect.height;
+  }
+  TextureAtlasUpdateMipmaps(atlas);
+  return true;
+}
+
+void DestroyTextureAtlas(TextureAtlas& atlas)
+{
+  // Unbound first, so the state cache does not remember a deleted name
+  GLStateActiveTexture(GL_TEXTURE0);
+  GLStateBindTexture(GL_TEXTURE_2D, 0);
+  for (TextureAtlasPage& page : atlas.pages)
+  {
+    glDeleteTextures(1, &page.texture);
+  }
+  atlas = TextureAtlas();
+}
+
+double TextureAtlasEfficiency(const TextureAtlas& atlas)
+{
+  if (atlas.pages.empty())
+  {
+    return 0.0;
+  }
+  return (double)atlas.statistics.imageArea / ((double)atlas.pages.size() * atlas.settings.pageSize * atlas.settings.pageSize);
+}
+
+void TextureAtlasPrintStatistics(const TextureAtlas& atlas)
+{
+  if (atlas.pages.empty())
+  {
+    return;
+  }
+  size_t slotArea = 0;
+  for (const TextureAtlasPage& page : atlas.pages)
+  {
+    slotArea += page.packer.usedArea;
+  }
+  double pageArea = (double)atlas.pages.size() * atlas.settings.pageSize * atlas.settings.pageSize;
+  std::cout << "Texture atlas (" << AtlasPackMethodName(atlas.settings.method) << "): " << atlas.entries.size()
+	    << " images on " << atlas.pages.size() << " pages of " << atlas.settings.pageSize << "x" << atlas.settings.pageSize
+	    << ", images cover " << TextureAtlasEfficiency(atlas) * 100.0 << "% (" << slotArea / pageArea * 100.0
+	    << "% with borders), " << atlas.statistics.inserts << " inserts, " << atlas.statistics.evictions
+	    << " evictions, " << atlas.statistics.failedInserts << " failed" << std::endl;
+}
@@ -0,0 +1,676 @@
+#include <gloom/texture_streaming.hpp>
+#include <gloom/asset_io.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/render_commands.hpp>
+#include <gloom/stream_buffer.hpp>
+#include <gloom/tga.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Linux
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Largest width or height we accept (DecodeTGA rejects larger images), and its mip levels
+static const int kMaxTextureSize = kMaxTGASize;
+static const int kMaxMipLevels = 15;
+// Staging buffers kept in the pool for reuse, more are freed
+static const size_t kStagingPoolSize = 8;
+// Nice value of the decode threads: when cores are scarce, the threads rendering and
+// simulating the frame go first, and decoding uses the time they leave
+static const int kDecodeThreadNice = 10;
+
+// Where a texture is on its way from the file to the GPU
+enum TextureState : int
+{
+  kTextureQueued,     // Waiting for (or being worked on by) a decode thread
+  kTextureDecoded,    // Mip chain ready in staging memory, waiting for a texture object
+  kTextureStreaming,  // Levels being uploaded, smallest first
+  kTextureResident,   // Every level uploaded
+  kTextureEvicted,    // Deleted to stay under the memory budget, requested again on its next use
+  kTextureFailed
+};
+
+struct StreamedTexture
+{
+  std::string filename;
+  std::chrono::steady_clock::time_point requestTime;
+
+  // Shared between the recording thread, the decode threads and the thread that owns the context
+  std::atomic<int> state{kTextureQueued};
+  // The texture object once its smallest level is uploaded, 0 before that (and after eviction)
+  std::atomic<GLuint> visibleTexture{0};
+  std::atomic<unsigned long long> lastUsedFrame{0};
+
+  // Written by a decode thread, then only used by the context's thread once it took the texture from sDecoded
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+  int levels = 0;
+  size_t levelOffsets[kMaxMipLevels] = {};
+
+  // Only used by the thread that owns the context
+  GLuint texture = 0;
+  size_t bytes = 0;
+  // The level being uploaded (counting down to 0) and its next row
+  int uploadLevel = 0;
+  int uploadRow = 0;
+};
+
+static TextureStreamerSettings sSettings;
+static std::atomic<bool> sRunning{false};
+
+// Textures never move, handles index this array
+static std::unique_ptr<StreamedTexture[]> sTextures;
+static std::atomic<int> sTextureCount{0};
+static std::mutex sRequestMutex;
+static std::unordered_map<std::string, TextureHandle> sHandles;
+
+// Work for the decode threads, and what they finished
+static std::vector<std::thread> sDecodeThreads;
+static std::mutex sDecodeMutex;
+static std::condition_variable sDecodeWakeUp;
+static std::deque<TextureHandle> sDecodeQueue;
+static bool sDecodeStop = false;
+static std::mutex sDecodedMutex;
+static std::vector<TextureHandle> sDecoded;
+
+// Pooled staging memory for the mip chains
+static std::mutex sStagingMutex;
+static std::vector<std::vector<uint8_t>> sStagingPool;
+
+// The frame being recorded, and the frame whose uploads run on the context's thread (never ahead of it)
+static std::atomic<unsigned long long> sRecordedFrame{0};
+static unsigned long long sExecutedFrame = 0;
+
+// Context's thread only: the pixel buffer object, textures still uploading (oldest request first)
+static StreamBuffer sUploadBuffer;
+static std::vector<TextureHandle> sStreaming;
+static std::vector<TextureHandle> sReady;
+
+static std::mutex sStatisticsMutex;
+static TextureStreamerStatistics sStatistics;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point startTime)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+static int LevelSize(int size, int level)
+{
+  return std::max(1, size >> level);
+}
+
+static std::vector<uint8_t> AcquireStaging(size_t size)
+{
+  std::lock_guard<std::mutex> lock(sStagingMutex);
+  // The smallest buffer that is large enough, so large ones stay around for large textures
+  int best = -1;
+  for (size_t i = 0; i < sStagingPool.size(); ++i)
+  {
+    if (sStagingPool[i].capacity() >= size && (best < 0 || sStagingPool[i].capacity() < sStagingPool[best].capacity()))
+    {
+      best = (int)i;
+    }
+  }
+
+  std::vector<uint8_t> buffer;
+  if (best >= 0)
+  {
+    buffer = std::move(sStagingPool[best]);
+    sStagingPool[best] = std::move(sStagingPool.back());
+    sStagingPool.pop_back();
+  }
+  else
+  {
+    std::lock_guard<std::mutex> statisticsLock(sStatisticsMutex);
+    ++sStatistics.stagingAllocations;
+  }
+  buffer.resize(size);
+  return buffer;
+}
+
+static void ReleaseStaging(std::vector<uint8_t>&& buffer)
+{
+  if (buffer.capacity() == 0)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(sStagingMutex);
+  if (sStagingPool.size() < kStagingPoolSize)
+  {
+    sStagingPool.push_back(std::move(buffer));
+  }
+  buffer = std::vector<uint8_t>();
+}
+
+/*
+  Averages 2x2 blocks of the source level into the next level. Odd sizes repeat the last row or column.
+*/
+static void DownsampleLevel(const uint8_t* source, int sourceWidth, int sourceHeight, uint8_t* destination, int width,
+			    int height)
+{
+  for (int y = 0; y < height; ++y)
+  {
+    const uint8_t* row0 = source + (size_t)std::min(2 * y, sourceHeight - 1) * sourceWidth * 4;
+    const uint8_t* row1 = source + (size_t)std::min(2 * y + 1, sourceHeight - 1) * sourceWidth * 4;
+    for (int x = 0; x < width; ++x)
+    {
+      int x0 = std::min(2 * x, sourceWidth - 1) * 4;
+      int x1 = std::min(2 * x + 1, sourceWidth - 1) * 4;
+      for (int channel = 0; channel < 4; ++channel)
+      {
+	destination[channel] = (uint8_t)((row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] +
+					  row1[x1 + channel] + 2) / 4);
+      }
+      destination += 4;
+    }
+  }
+}
+
+/*
+  Runs on a decode thread: loads and decodes the file, then builds the mip chain in staging memory
+*/
+static bool DecodeTexture(StreamedTexture& texture)
+{
+  AssetFile file = LoadAsset(texture.filename);
+  if (!file.IsOpen())
+  {
+    return false;
+  }
+
+  // The first level is decoded into memory of the thread, and copied into the front of the chain
+  thread_local std::vector<uint8_t> tImage;
+  int width = 0;
+  int height = 0;
+  if (!DecodeTGA(file.View(), tImage, width, height))
+  {
+    return false;
+  }
+
+  int levels = 1;
+  while ((std::max(width, height) >> levels) > 0)
+  {
+    ++levels;
+  }
+  size_t size = 0;
+  for (int level = 0; level < levels; ++level)
+  {
+    texture.levelOffsets[level] = size;
+    size += (size_t)LevelSize(width, level) * LevelSize(height, level) * 4;
+  }
+
+  texture.pixels = AcquireStaging(size);
+  std::memcpy(texture.pixels.data(), tImage.data(), (size_t)width * height * 4);
+  for (int level = 1; level < levels; ++level)
+  {
+    DownsampleLevel(texture.pixels.data() + texture.levelOffsets[level - 1], LevelSize(width, level - 1),
+		    LevelSize(height, level - 1), texture.pixels.data() + texture.levelOffsets[level],
+		    LevelSize(width, level), LevelSize(height, level));
+  }
+  texture.width = width;
+  texture.height = height;
+  texture.levels = levels;
+  return true;
+}
+
+static void DecodeThread()
+{
+  // On Linux the nice value belongs to the thread, not the whole process
+  setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), kDecodeThreadNice);
+
+  while (true)
+  {
+    TextureHandle handle = kInvalidTexture;
+    {
+      std::unique_lock<std::mutex> lock(sDecodeMutex);
+      sDecodeWakeUp.wait(lock, [] { return sDecodeStop || !sDecodeQueue.empty(); });
+      if (sDecodeStop)
+      {
+	return;
+      }
+      handle = sDecodeQueue.front();
+      sDecodeQueue.pop_front();
+    }
+
+    StreamedTexture& texture = sTextures[handle];
+    auto startTime = std::chrono::steady_clock::now();
+    bool decoded = DecodeTexture(texture);
+    double milliseconds = MillisecondsSince(startTime);
+    {
+      std::lock_guard<std::mutex> lock(sStatisticsMutex);
+      ++(decoded ? sStatistics.decoded : sStatistics.failed);
+      sStatistics.decodeMilliseconds += decoded ? milliseconds : 0.0;
+    }
+
+    if (!decoded)
+    {
+      std::cout << "ERROR: Could not load the texture '" << texture.filename << "'" << std::endl;
+      texture.state.store(kTextureFailed);
+      continue;
+    }
+    texture.state.store(kTextureDecoded);
+    std::lock_guard<std::mutex> lock(sDecodedMutex);
+    sDecoded.push_back(handle);
+  }
+}
+
+static void QueueDecode(TextureHandle handle)
+{
+  sTextures[handle].requestTime = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(sDecodeMutex);
+    sDecodeQueue.push_back(handle);
+  }
+  sDecodeWakeUp.notify_one();
+}
+
+bool TextureStreamerStart(const TextureStreamerSettings& settings)
+{
+  sSettings = settings;
+  // A row of the widest texture always has to fit into the pixel buffer
+  size_t regionSize = std::max(settings.uploadBudgetBytes, (size_t)kMaxTextureSize * 4);
+  if (!CreateStreamBuffer(sUploadBuffer, regionSize))
+  {
+    return false;
+  }
+
+  sTextures.reset(new StreamedTexture[kMaxStreamedTextures]);
+  sTextureCount = 0;
+  sHandles.clear();
+  sRecordedFrame = 0;
+  sExecutedFrame = 0;
+  sStatistics = TextureStreamerStatistics();
+  sDecodeStop = false;
+  for (int i = 0; i < std::max(1, settings.decodeThreads); ++i)
+  {
+    sDecodeThreads.emplace_back(DecodeThread);
+  }
+  sRunning = true;
+  return true;
+}
+
+/*
+  Deletes a texture object. Uploads and draws only use texture unit 0, so unbinding it there
+  keeps the GL state cache from thinking a later texture with the same name is still bound.
+*/
+static void DeleteTextureObject(StreamedTexture& texture)
+{
+  GLStateActiveTexture(GL_TEXTURE0);
+  GLStateBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures(1, &texture.texture);
+  texture.texture = 0;
+
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  --sStatistics.residentTextures;
+  sStatistics.residentBytes -= texture.bytes;
+}
+
+void TextureStreamerStop()
+{
+  if (!sRunning)
+  {
+    return;
+  }
+  sRunning = false;
+  {
+    std::lock_guard<std::mutex> lock(sDecodeMutex);
+    sDecodeStop = true;
+    sDecodeQueue.clear();
+  }
+  sDecodeWakeUp.notify_all();
+  for (std::thread& thread : sDecodeThreads)
+  {
+    thread.join();
+  }
+  sDecodeThreads.clear();
+
+  for (int handle = 0; handle < sTextureCount; ++handle)
+  {
+    if (sTextures[handle].texture != 0)
+    {
+      DeleteTextureObject(sTextures[handle]);
+    }
+  }
+  sTextures.reset();
+  sDecoded.clear();
+  sStreaming.clear();
+  sStagingPool.clear();
+  DestroyStreamBuffer(sUploadBuffer);
+}
+
+TextureHandle TextureRequest(const std::string& filename)
+{
+  TextureHandle handle = kInvalidTexture;
+  {
+    std::lock_guard<std::mutex> lock(sRequestMutex);
+    auto existing = sHandles.find(filename);
+    if (existing != sHandles.end())
+    {
+      return existing->second;
+    }
+    if (sTextureCount == kMaxStreamedTextures)
+    {
+      return kInvalidTexture;
+    }
+    handle = sTextureCount;
+    sTextures[handle].filename = filename;
+    sHandles[filename] = handle;
+    // Publishes the filename to the context's thread, which only looks at handles below the count
+    sTextureCount.store(handle + 1, std::memory_order_release);
+  }
+  {
+    std::lock_guard<std::mutex> lock(sStatisticsMutex);
+    ++sStatistics.requests;
+  }
+  QueueDecode(handle);
+  return handle;
+}
+
+GLuint TextureUse(TextureHandle handle)
+{
+  if (handle < 0 || handle >= sTextureCount.load(std::memory_order_acquire))
+  {
+    return 0;
+  }
+  StreamedTexture& texture = sTextures[handle];
+
+  // Marking the texture first and reading its name second (both sequentially consistent), while an
+  // eviction clears the name first and checks the mark second, means that either the eviction sees
+  // that the texture is used by this frame, or we see that it is gone. See EvictTextures.
+  texture.lastUsedFrame.store(sRecordedFrame.load(std::memory_order_relaxed));
+  GLuint name = texture.visibleTexture.load();
+
+  int evicted = kTextureEvicted;
+  if (name == 0 && texture.state.compare_exchange_strong(evicted, kTextureQueued))
+  {
+    QueueDecode(handle);
+  }
+  return name;
+}
+
+bool TextureIsResident(TextureHandle handle)
+{
+  return handle >= 0 && handle < sTextureCount.load(std::memory_order_acquire) &&
+	 sTextures[handle].state.load() == kTextureResident;
+}
+
+bool TextureFailed(TextureHandle handle)
+{
+  return handle >= 0 && handle < sTextureCount.load(std::memory_order_acquire) &&
+	 sTextures[handle].state.load() == kTextureFailed;
+}
+
+/*
+  Creates the texture object with room for every level. Levels are filled in by UploadTextures.
+*/
+static void CreateTextureObject(StreamedTexture& texture)
+{
+  glGenTextures(1, &texture.texture);
+  GLStateBindTexture(GL_TEXTURE_2D, texture.texture);
+  texture.bytes = 0;
+  for (int level = 0; level < texture.levels; ++level)
+  {
+    int width = LevelSize(texture.width, level);
+    int height = LevelSize(texture.height, level);
+    glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    texture.bytes += (size_t)width * height * 4;
+  }
+  // Sampling is limited to the levels that are uploaded, starting with just the smallest one
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.levels - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.levels - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+  texture.uploadLevel = texture.levels - 1;
+  texture.uploadRow = 0;
+  texture.state.store(kTextureStreaming);
+
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  ++sStatistics.residentTextures;
+  sStatistics.residentBytes += texture.bytes;
+}
+
+/*
+  Uploads rows of the texture's current level through the pixel buffer object, at most 'budget' bytes
+  (but at least one row if 'budget' allows nothing else to happen this frame)
+
+  @return the bytes uploaded
+*/
+static size_t UploadRows(StreamedTexture& texture, size_t budget, bool firstUpload)
+{
+  int level = texture.uploadLevel;
+  int width = LevelSize(texture.width, level);
+  int height = LevelSize(texture.height, level);
+  size_t rowBytes = (size_t)width * 4;
+  int rows = std::min((size_t)(height - texture.uploadRow), budget / rowBytes);
+  if (rows == 0)
+  {
+    if (!firstUpload)
+    {
+      return 0;
+    }
+    rows = 1;
+  }
+
+  size_t bytes = rows * rowBytes;
+  StreamAllocation allocation = StreamBufferMap(sUploadBuffer, bytes, 4);
+  if (allocation.data == nullptr)
+  {
+    return 0;
+  }
+  const uint8_t* source = texture.pixels.data() + texture.levelOffsets[level] + texture.uploadRow * rowBytes;
+  std::memcpy(allocation.data, source, bytes);
+  StreamBufferUnmap(sUploadBuffer);
+
+  // With a buffer bound to GL_PIXEL_UNPACK_BUFFER, the pointer argument is an offset into it
+  GLStateBindBuffer(GL_PIXEL_UNPACK_BUFFER, sUploadBuffer.buffer);
+  GLStateBindTexture(GL_TEXTURE_2D, texture.texture);
+  glTexSubImage2D(GL_TEXTURE_2D, level, 0, texture.uploadRow, width, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+		  (const void*)allocation.offset);
+  texture.uploadRow += rows;
+  if (texture.uploadRow < height)
+  {
+    return bytes;
+  }
+
+  // The level is complete, let the sampler use it
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+  double milliseconds = MillisecondsSince(texture.requestTime);
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  if (level == texture.levels - 1)
+  {
+    texture.visibleTexture.store(texture.texture);
+    ++sStatistics.firstLevelCount;
+    sStatistics.firstLevelMilliseconds += milliseconds;
+    sStatistics.firstLevelMaxMilliseconds = std::max(sStatistics.firstLevelMaxMilliseconds, milliseconds);
+  }
+  if (level == 0)
+  {
+    texture.state.store(kTextureResident);
+    ++sStatistics.fullyResidentCount;
+    sStatistics.fullyResidentMilliseconds += milliseconds;
+    sStatistics.fullyResidentMaxMilliseconds = std::max(sStatistics.fullyResidentMaxMilliseconds, milliseconds);
+  }
+  --texture.uploadLevel;
+  texture.uploadRow = 0;
+  return bytes;
+}
+
+/*
+  Spends this frame's upload budget on the textures that are streaming, oldest request first
+*/
+static void UploadTextures()
+{
+  size_t uploaded = 0;
+  size_t stillStreaming = 0;
+  for (TextureHandle handle : sStreaming)
+  {
+    StreamedTexture& texture = sTextures[handle];
+    while (texture.uploadLevel >= 0 && uploaded < sSettings.uploadBudgetBytes)
+    {
+      size_t bytes = UploadRows(texture, sSettings.uploadBudgetBytes - uploaded, uploaded == 0);
+      if (bytes == 0)
+      {
+	break;
+      }
+      uploaded += bytes;
+    }
+
+    if (texture.uploadLevel < 0)
+    {
+      ReleaseStaging(std::move(texture.pixels));
+    }
+    else
+    {
+      sStreaming[stillStreaming++] = handle;
+    }
+  }
+  sStreaming.resize(stillStreaming);
+  GLStateBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  if (uploaded > 0)
+  {
+    std::lock_guard<std::mutex> lock(sStatisticsMutex);
+    sStatistics.bytesUploaded += uploaded;
+    ++sStatistics.uploadFrames;
+    sStatistics.budgetLimitedFrames += !sStreaming.empty() ? 1 : 0;
+  }
+}
+
+/*
+  Deletes the least recently used resident textures until we are under the memory budget.
+  Textures used by a frame that is not drawn yet are never evicted.
+*/
+static void EvictTextures()
+{
+  int textureCount = sTextureCount.load(std::memory_order_acquire);
+  while (true)
+  {
+    {
+      std::lock_guard<std::mutex> lock(sStatisticsMutex);
+      if (sStatistics.residentBytes <= sSettings.memoryBudgetBytes)
+      {
+	return;
+      }
+    }
+
+    // A linear search, evictions are rare and there are few textures compared to their pixels
+    int oldest = -1;
+    unsigned long long oldestFrame = sExecutedFrame;
+    for (int handle = 0; handle < textureCount; ++handle)
+    {
+      StreamedTexture& texture = sTextures[handle];
+      unsigned long long lastUsed = texture.lastUsedFrame.load(std::memory_order_relaxed);
+      if (texture.state.load(std::memory_order_relaxed) == kTextureResident && lastUsed < oldestFrame)
+      {
+	oldest = handle;
+	oldestFrame = lastUsed;
+      }
+    }
+    if (oldest < 0)
+    {
+      return;
+    }
+
+    // The counterpart of TextureUse: hide the texture, then check again that no frame still to be drawn uses it
+    StreamedTexture& texture = sTextures[oldest];
+    texture.visibleTexture.store(0);
+    if (texture.lastUsedFrame.load() >= sExecutedFrame)
+    {
+      texture.visibleTexture.store(texture.texture);
+      return;
+    }
+    DeleteTextureObject(texture);
+    texture.state.store(kTextureEvicted);
+    std::lock_guard<std::mutex> lock(sStatisticsMutex);
+    ++sStatistics.evictions;
+  }
+}
+
+// Runs on the thread that owns the context, once per frame
+static void UpdateTextures(void*)
+{
+  ++sExecutedFrame;
+  StreamBufferBeginFrame(sUploadBuffer);
+
+  // Give the textures the decode threads finished a texture object. This comes before the
+  // pixel buffer is bound: glTexImage2D would read from it instead of allocating empty levels.
+  {
+    std::lock_guard<std::mutex> lock(sDecodedMutex);
+    sReady.swap(sDecoded);
+  }
+  GLStateActiveTexture(GL_TEXTURE0);
+  for (TextureHandle handle : sReady)
+  {
+    CreateTextureObject(sTextures[handle]);
+    sStreaming.push_back(handle);
+  }
+  sReady.clear();
+
+  UploadTextures();
+  StreamBufferEndFrame(sUploadBuffer);
+  EvictTextures();
+}
+
+void TextureStreamerBeginFrame()
+{
+  if (!sRunning)
+  {
+    return;
+  }
+  sRecordedFrame.fetch_add(1, std::memory_order_relaxed);
+  RenderCall(UpdateTextures, nullptr);
+}
+
+TextureStreamerStatistics TextureStreamerGetStatistics()
+{
+  std::lock_guard<std::mutex> lock(sStatisticsMutex);
+  return sStatistics;
+}
+
+void TextureStreamerPrintStatistics()
+{
+  TextureStreamerStatistics statistics = TextureStreamerGetStatistics();
+  if (statistics.requests == 0)
+  {
+    return;
+  }
+  const double kMiB = 1024.0 * 1024.0;
+  std::cout << "Texture streaming: " << statistics.requests << " requested, " << statistics.decoded << " decoded ("
+	    << (statistics.decoded > 0 ? statistics.decodeMilliseconds / statistics.decoded : 0.0) << " ms each), "
+	    << statistics.failed << " failed, " << statistics.stagingAllocations << " staging allocations" << std::endl;
+  std::cout << "  Uploads: " << statistics.bytesUploaded / kMiB << " MiB in " << statistics.uploadFrames << " frames ("
+	    << (statistics.uploadFrames > 0 ? statistics.bytesUploaded / 1024.0 / statistics.uploadFrames : 0.0)
+	    << " KiB per frame, " << statistics.budgetLimitedFrames << " frames at the budget of "
+	    << sSettings.uploadBudgetBytes / 1024 << " KiB)" << std::endl;
+  std::cout << "  Memory: " << statistics.residentTextures << " textures in " << statistics.residentBytes / kMiB
+	    << " MiB (budget " << sSettings.memoryBudgetBytes / kMiB << " MiB), " << statistics.evictions << " evictions"
+	    << std::endl;
+  if (statistics.firstLevelCount > 0)
+  {
+    std::cout << "  Latency: first level after " << statistics.firstLevelMilliseconds / statistics.firstLevelCount
+	      << " ms (max " << statistics.firstLevelMaxMilliseconds << " ms)";
+    if (statistics.fullyResidentCount > 0)
+    {
+      std::cout << ", fully resident after " << statistics.fullyResidentMilliseconds / statistics.fullyResidentCount
+		<< " ms (max " << statistics.fullyResidentMaxMilliseconds << " ms)";
+    }
+    std::cout << std::endl;
+  }
+  StreamBufferPrintStatistics(sUploadBuffer, "texture uploads");
+}
@@ -0,0 +1,103 @@
+#include <gloom/tga.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+
+bool DecodeTGA(std::string_view file, std::vector<uint8_t>& pixels, int& width, int& height)
+{
+  const size_t kHeaderSize = 18;
+  if (file.size() < kHeaderSize)
+  {
+    return false;
+  }
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(file.data());
+  uint8_t idLength = data[0];
+  uint8_t colorMapType = data[1];
+  uint8_t imageType = data[2];
+  size_t colorMapLength = data[5] | (data[6] << 8);
+  size_t colorMapEntryBits = data[7];
+  width = data[12] | (data[13] << 8);
+  height = data[14] | (data[15] << 8);
+  int bitsPerPixel = data[16];
+  uint8_t descriptor = data[17];
+
+  // True color (2), or true color with run length encoding (10), stored left to right
+  bool compressed = imageType == 10;
+  if ((imageType != 2 && !compressed) || (bitsPerPixel != 24 && bitsPerPixel != 32) ||
+      colorMapType > 1 || (descriptor & 0x10) != 0 || width == 0 || height == 0 || width > kMaxTGASize ||
+      height > kMaxTGASize)
+  {
+    return false;
+  }
+  // Rows are stored bottom to top unless bit 5 says otherwise
+  bool topToBottom = (descriptor & 0x20) != 0;
+  int bytesPerPixel = bitsPerPixel / 8;
+
+  // The image data follows the id and an (unused) color map
+  size_t position = kHeaderSize + idLength + (colorMapType == 1 ? colorMapLength * ((colorMapEntryBits + 7) / 8) : 0);
+  const size_t pixelCount = (size_t)width * height;
+  // The header's size is not trusted before the file is known to hold that many pixels: all of them
+  // uncompressed, or at most 128 for every packet (a header byte and one pixel) left in the file
+  if (position > file.size())
+  {
+    return false;
+  }
+  size_t left = file.size() - position;
+  if (compressed ? pixelCount > left / (1 + bytesPerPixel) * 128 : pixelCount * bytesPerPixel > left)
+  {
+    return false;
+  }
+  pixels.resize(pixelCount * 4);
+
+  size_t x = 0;
+  size_t y = 0;
+  uint8_t* row = pixels.data() + (topToBottom ? height - 1 : 0) * (size_t)width * 4;
+  // Writes the next pixel, BGR(A) in the file, RGBA for OpenGL
+  auto emit = [&](const uint8_t* source)
+  {
+    uint8_t* destination = row + x * 4;
+    destination[0] = source[2];
+    destination[1] = source[1];
+    destination[2] = source[0];
+    destination[3] = bytesPerPixel == 4 ? source[3] : 255;
+    if (++x == (size_t)width)
+    {
+      x = 0;
+      y = std::min(y + 1, (size_t)height - 1);
+      row = pixels.data() + (topToBottom ? height - 1 - y : y) * (size_t)width * 4;
+    }
+  };
+
+  size_t written = 0;
+  while (written < pixelCount)
+  {
+    // Uncompressed files are one long packet of raw pixels
+    size_t count = pixelCount;
+    bool run = false;
+    if (compressed)
+    {
+      // A packet header: 1 to 128 copies of one pixel (bit 7 set), or 1 to 128 pixels as they are
+      if (position >= file.size())
+      {
+        return false;
+      }
+      uint8_t header = data[position++];
+      count = (header & 0x7F) + 1;
+      run = (header & 0x80) != 0;
+    }
+    count = std::min(count, pixelCount - written);
+
+    size_t bytes = run ? bytesPerPixel : count * bytesPerPixel;
+    if (position + bytes > file.size())
+    {
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+      emit(data + position + (run ? 0 : i * bytesPerPixel));
+    }
+    position += bytes;
+    written += count;
+  }
+  return true;
+}
@@ -0,0 +1,250 @@
+// Enables GLM's SIMD layer (glm_vec4 and glm_mat4_mul) in this file, see culling.cpp
+#define GLM_FORCE_INTRINSICS
+
+#include <gloom/transform.hpp>
+#include <gloom/gl_state.hpp>
+
+// Third Party Libraries
+#include <glm/simd/matrix.h>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+static TransformStatistics sStatistics;
+
+// Marks a node dirty and remembers it, so the next update can go straight to it
+static void MarkDirty(TransformHierarchy& hierarchy, uint32_t node)
+{
+  if (!hierarchy.dirty[node])
+  {
+    hierarchy.dirty[node] = 1;
+    hierarchy.dirtyNodes.push_back(node);
+  }
+}
+
+uint32_t TransformAdd(TransformHierarchy& hierarchy, uint32_t parent, const glm::vec3& translation,
+		      const glm::quat& rotation, const glm::vec3& scale)
+{
+  uint32_t node = (uint32_t)hierarchy.Size();
+  if (parent != kTransformNoParent && parent >= node)
+  {
+    std::cout << "TransformAdd: parent " << parent << " does not exist" << std::endl;
+    parent = kTransformNoParent;
+  }
+
+  hierarchy.parents.push_back(parent);
+  hierarchy.translations.push_back(translation);
+  hierarchy.rotations.push_back(rotation);
+  hierarchy.scales.push_back(scale);
+  hierarchy.lastDescendants.push_back(node);
+  hierarchy.dirty.push_back(0);
+  hierarchy.worlds.push_back(glm::mat4(1.0f));
+  // The new node is the highest index there is, so it ends the subtree of all its ancestors
+  for (uint32_t ancestor = parent; ancestor != kTransformNoParent; ancestor = hierarchy.parents[ancestor])
+  {
+    hierarchy.lastDescendants[ancestor] = node;
+  }
+  MarkDirty(hierarchy, node);
+  return node;
+}
+
+void TransformSetTranslation(TransformHierarchy& hierarchy, uint32_t node, const glm::vec3& translation)
+{
+  hierarchy.translations[node] = translation;
+  MarkDirty(hierarchy, node);
+}
+
+void TransformSetRotation(TransformHierarchy& hierarchy, uint32_t node, const glm::quat& rotation)
+{
+  hierarchy.rotations[node] = rotation;
+  MarkDirty(hierarchy, node);
+}
+
+void TransformSetScale(TransformHierarchy& hierarchy, uint32_t node, const glm::vec3& scale)
+{
+  hierarchy.scales[node] = scale;
+  MarkDirty(hierarchy, node);
+}
+
+void TransformClear(TransformHierarchy& hierarchy)
+{
+  hierarchy.parents.clear();
+  hierarchy.translations.clear();
+  hierarchy.rotations.clear();
+  hierarchy.scales.clear();
+  hierarchy.lastDescendants.clear();
+  hierarchy.dirty.clear();
+  hierarchy.worlds.clear();
+  hierarchy.dirtyNodes.clear();
+  hierarchy.uploadBegin = 0;
+  hierarchy.uploadEnd = 0;
+}
+
+// translate(t) * rotate(r) * scale(s), without multiplying three matrices
+static glm::mat4 ComposeLocal(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+  glm::mat3 rotationMatrix = glm::mat3_cast(rotation);
+  return glm::mat4(glm::vec4(rotationMatrix[0] * scale.x, 0.0f), glm::vec4(rotationMatrix[1] * scale.y, 0.0f),
+		   glm::vec4(rotationMatrix[2] * scale.z, 0.0f), glm::vec4(translation, 1.0f));
+}
+
+// result = parent * local with SSE. Our matrices are not 16 byte aligned, so the columns are loaded unaligned.
+static void MultiplyWorld(const glm::mat4& parent, const glm::mat4& local, glm::mat4& result)
+{
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+  glm_vec4 a[4], b[4], product[4];
+  for (int column = 0; column < 4; ++column)
+  {
+    a[column] = _mm_loadu_ps(&parent[column][0]);
+    b[column] = _mm_loadu_ps(&local[column][0]);
+  }
+  glm_mat4_mul(a, b, product);
+  for (int column = 0; column < 4; ++column)
+  {
+    _mm_storeu_ps(&result[column][0], product[column]);
+  }
+#else
+  result = parent * local;
+#endif
+}
+
+size_t TransformUpdate(TransformHierarchy& hierarchy)
+{
+  std::vector<uint32_t>& dirtyNodes = hierarchy.dirtyNodes;
+  if (dirtyNodes.empty())
+  {
+    return 0;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+  // Often marked front to back already (e.g. everything after loading)
+  if (!std::is_sorted(dirtyNodes.begin(), dirtyNodes.end()))
+  {
+    std::sort(dirtyNodes.begin(), dirtyNodes.end());
+  }
+
+  // During the pass 'dirty' means "world matrix changed", so children of recomputed nodes are
+  // recomputed too. The pass covers spans from a dirty node to the end of the subtrees of the dirty
+  // nodes seen so far. Nodes outside the spans can not depend on a change, their flags are all 0.
+  size_t updated = 0;
+  uint32_t begin = dirtyNodes[0];
+  uint32_t last = begin;
+  uint32_t spanBegin = begin;
+  uint32_t spanEnd = begin;
+  size_t nextDirty = 0;
+  const uint32_t* parents = hierarchy.parents.data();
+  const uint32_t* lastDescendants = hierarchy.lastDescendants.data();
+  uint8_t* dirty = hierarchy.dirty.data();
+  for (uint32_t node = begin;; ++node)
+  {
+    if (node >= spanEnd)
+    {
+      // Past every changed subtree, continue at the next dirty node
+      std::fill(dirty + spanBegin, dirty + spanEnd, 0);
+      if (nextDirty == dirtyNodes.size())
+      {
+        break;
+      }
+      node = spanBegin = dirtyNodes[nextDirty];
+    }
+    for (; nextDirty < dirtyNodes.size() && dirtyNodes[nextDirty] <= node; ++nextDirty)
+    {
+      spanEnd = std::max(spanEnd, lastDescendants[dirtyNodes[nextDirty]] + 1);
+    }
+
+    uint32_t parent = parents[node];
+    if (!dirty[node])
+    {
+      if (parent == kTransformNoParent || !dirty[parent])
+      {
+        continue;
+      }
+      dirty[node] = 1;
+    }
+
+    glm::mat4 local = ComposeLocal(hierarchy.translations[node], hierarchy.rotations[node], hierarchy.scales[node]);
+    if (parent == kTransformNoParent)
+    {
+      hierarchy.worlds[node] = local;
+    }
+    else
+    {
+      MultiplyWorld(hierarchy.worlds[parent], local, hierarchy.worlds[node]);
+    }
+    ++updated;
+    last = node;
+  }
+  dirtyNodes.clear();
+
+  // Grow the range the next upload has to copy
+  if (hierarchy.uploadEnd == hierarchy.uploadBegin)
+  {
+    hierarchy.uploadBegin = begin;
+    hierarchy.uploadEnd = last + 1;
+  }
+  else
+  {
+    hierarchy.uploadBegin = std::min(hierarchy.uploadBegin, begin);
+    hierarchy.uploadEnd = std::max(hierarchy.uploadEnd, last + 1);
+  }
+
+  ++sStatistics.updates;
+  sStatistics.nodesUpdated += updated;
+  sStatistics.nanoseconds += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+  return updated;
+}
+
+void UploadWorldMatrices(TransformHierarchy& hierarchy, TransformBuffer& transformBuffer)
+{
+  if (transformBuffer.buffer == 0)
+  {
+    glGenBuffers(1, &transformBuffer.buffer);
+  }
+  GLStateBindBuffer(GL_COPY_WRITE_BUFFER, transformBuffer.buffer);
+
+  if (transformBuffer.capacity < hierarchy.Size())
+  {
+    // Grow with some headroom, and upload everything
+    transformBuffer.capacity = std::max(hierarchy.Size(), transformBuffer.capacity * 2);
+    glBufferData(GL_COPY_WRITE_BUFFER, transformBuffer.capacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+    hierarchy.uploadBegin = 0;
+    hierarchy.uploadEnd = (uint32_t)hierarchy.Size();
+  }
+
+  if (hierarchy.uploadEnd > hierarchy.uploadBegin)
+  {
+    glBufferSubData(GL_COPY_WRITE_BUFFER, hierarchy.uploadBegin * sizeof(glm::mat4),
+		    (hierarchy.uploadEnd - hierarchy.uploadBegin) * sizeof(glm::mat4), &hierarchy.worlds[hierarchy.uploadBegin]);
+  }
+  hierarchy.uploadBegin = 0;
+  hierarchy.uploadEnd = 0;
+}
+
+void DestroyTransformBuffer(TransformBuffer& transformBuffer)
+{
+  if (transformBuffer.buffer != 0)
+  {
+    // Also forget it in the state cache, a new buffer may get the same name
+    GLStateBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &transformBuffer.buffer);
+  }
+  transformBuffer.buffer = 0;
+  transformBuffer.capacity = 0;
+}
+
+TransformStatistics GetTransformStatistics()
+{
+  return sStatistics;
+}
+
+void TransformPrintStatistics()
+{
+  if (sStatistics.updates == 0)
+  {
+    return;
+  }
+  std::cout << "Transforms: " << (double)sStatistics.nodesUpdated / sStatistics.updates << " nodes updated per update, "
+	    << sStatistics.nodesUpdated / (sStatistics.nanoseconds / 1e6) << " nodes per ms" << std::endl;
+}
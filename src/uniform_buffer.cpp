@@ -0,0 +1,126 @@
+#include <gloom/uniform_buffer.hpp>
+#include <gloom/gl_state.hpp>
+#include <gloom/render_commands.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstring>
+#include <iostream>
+
+void BindUniformBlocks(GLuint program)
+{
+  const char* names[] = { kViewUniformBlockName, kDrawUniformBlockName };
+  const GLuint bindings[] = { kViewUniformBinding, kDrawUniformBinding };
+  for (int i = 0; i < 2; ++i)
+  {
+    GLuint blockIndex = glGetUniformBlockIndex(program, names[i]);
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+      glUniformBlockBinding(program, blockIndex, bindings[i]);
+    }
+  }
+}
+
+bool CreateUniformRing(UniformRing& ring, size_t bytesPerFrame)
+{
+  ring = UniformRing();
+
+  GLint alignment = 256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  ring.alignment = alignment > 0 ? (size_t)alignment : 256;
+
+  // Regions start aligned too, since the stream buffer places them back to back
+  size_t regionSize = (bytesPerFrame + ring.alignment - 1) / ring.alignment * ring.alignment;
+  for (int region = 0; region < kStreamBufferRegions; ++region)
+  {
+    ring.staging[region].resize(regionSize);
+    ring.uploads[region].ring = &ring;
+    ring.uploads[region].region = region;
+  }
+  return CreateStreamBuffer(ring.stream, regionSize);
+}
+
+void UniformRingBeginFrame(UniformRing& ring)
+{
+  ring.region = (ring.region + 1) % kStreamBufferRegions;
+  ring.used = 0;
+  ++ring.statistics.frames;
+}
+
+GLintptr UniformRingAllocate(UniformRing& ring, const void* data, size_t size)
+{
+  size_t start = (ring.used + ring.alignment - 1) / ring.alignment * ring.alignment;
+  if (start + size > ring.stream.regionSize)
+  {
+    ++ring.statistics.overflows;
+    return -1;
+  }
+
+  std::memcpy(ring.staging[ring.region].data() + start, data, size);
+  ring.used = start + size;
+  ++ring.statistics.allocations;
+  ring.statistics.bytes += size;
+  return (GLintptr)(ring.region * ring.stream.regionSize + start);
+}
+
+// Runs on the thread that owns the context: copies a recorded frame into its region of the buffer
+static void UploadFrame(void* data)
+{
+  UniformUpload& upload = *static_cast<UniformUpload*>(data);
+  UniformRing& ring = *upload.ring;
+
+  // The stream buffer moves through its regions in the same order as the recording did, and
+  // waits here if the GPU still reads the region from kStreamBufferRegions frames ago
+  StreamBufferBeginFrame(ring.stream);
+  if (upload.size == 0)
+  {
+    return;
+  }
+
+  StreamAllocation allocation = StreamBufferMap(ring.stream, upload.size, ring.alignment);
+  if (allocation.data != nullptr)
+  {
+    std::memcpy(allocation.data, ring.staging[upload.region].data(), upload.size);
+  }
+  StreamBufferUnmap(ring.stream);
+}
+
+static void FenceFrame(void* data)
+{
+  UniformRing& ring = *static_cast<UniformRing*>(data);
+  StreamBufferEndFrame(ring.stream);
+}
+
+void UniformRingFlush(UniformRing& ring)
+{
+  // The render thread may be kStreamBufferRegions - 1 frames behind at most (see render_thread.hpp),
+  // so it is done with this frame's staging memory before we record into it again
+  ring.uploads[ring.region].size = ring.used;
+  RenderCall(UploadFrame, &ring.uploads[ring.region]);
+}
+
+void UniformRingEndFrame(UniformRing& ring)
+{
+  RenderCall(FenceFrame, &ring);
+}
+
+void DestroyUniformRing(UniformRing& ring)
+{
+  DestroyStreamBuffer(ring.stream);
+  // The cache still has ranges of the deleted buffer bound to the uniform block bindings,
+  // a new buffer may get the same name
+  GLStateInvalidate();
+  ring = UniformRing();
+}
+
+void UniformRingPrintStatistics(const UniformRing& ring)
+{
+  const UniformRingStatistics& statistics = ring.statistics;
+  if (statistics.frames == 0)
+  {
+    return;
+  }
+  std::cout << "Uniform ring (" << ring.alignment << " byte alignment): " << (double)statistics.allocations / statistics.frames
+	    << " blocks and " << (double)statistics.bytes / statistics.frames << " bytes per frame, "
+	    << statistics.overflows << " overflows" << std::endl;
+  StreamBufferPrintStatistics(ring.stream, "uniforms");
+}
@@ -0,0 +1,151 @@
+#include <gloom/vertex_format.hpp>
+
+// Third Party Libraries
+#include <glm/glm.hpp>
+#include <glm/packing.hpp>
+#include <glm/gtc/packing.hpp>
+
+// C++ Standard Template Library (STL)
+#include <cstring>
+#include <iostream>
+
+const char* VertexFormatName(VertexFormat format)
+{
+  switch (format)
+  {
+    case VertexFormat::Float:
+      return "float";
+    case VertexFormat::Compact:
+      return "compact";
+  }
+  return "unknown";
+}
+
+bool ParseVertexFormat(const std::string& name, VertexFormat& format)
+{
+  for (VertexFormat candidate : { VertexFormat::Float, VertexFormat::Compact })
+  {
+    if (name == VertexFormatName(candidate))
+    {
+      format = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Describes how one attribute is stored in the destination format
+static MeshAttribute DestinationAttribute(const MeshAttribute& source, VertexFormat format)
+{
+  MeshAttribute attribute = source;
+  if (format == VertexFormat::Compact)
+  {
+    if (source.location == kVertexPositionLocation)
+    {
+      // 4 halves rather than 3 keeps every attribute 4 byte aligned
+      attribute.components = 4;
+      attribute.type = GL_HALF_FLOAT;
+      attribute.normalized = 0;
+    }
+    else if (source.location == kVertexColorLocation)
+    {
+      attribute.components = 4;
+      attribute.type = GL_UNSIGNED_BYTE;
+      attribute.normalized = 1;
+    }
+    else if (source.location == kVertexNormalLocation)
+    {
+      attribute.components = 4;
+      attribute.type = GL_INT_2_10_10_10_REV;
+      attribute.normalized = 1;
+    }
+  }
+  return attribute;
+}
+
+// Bytes an attribute occupies in the destination format
+static uint32_t DestinationSize(const MeshAttribute& attribute)
+{
+  switch (attribute.type)
+  {
+    case GL_HALF_FLOAT:
+      return 2 * attribute.components;
+    case GL_UNSIGNED_BYTE:
+      return attribute.components;
+    case GL_INT_2_10_10_10_REV:
+      return 4;
+  }
+  return 4 * attribute.components;
+}
+
+bool ConvertVertexFormat(const MeshData& source, VertexFormat format, MeshData& destination)
+{
+  for (const MeshAttribute& attribute : source.attributes)
+  {
+    if (attribute.type != GL_FLOAT)
+    {
+      std::cout << "ConvertVertexFormat: attribute " << attribute.location << " is not stored as floats" << std::endl;
+      return false;
+    }
+  }
+
+  destination = MeshData();
+  destination.indices = source.indices;
+
+  // Lay out the destination attributes one after another
+  uint32_t offset = 0;
+  for (const MeshAttribute& sourceAttribute : source.attributes)
+  {
+    MeshAttribute attribute = DestinationAttribute(sourceAttribute, format);
+    attribute.offset = offset;
+    offset += DestinationSize(attribute);
+    destination.attributes.push_back(attribute);
+  }
+  destination.vertexStride = offset;
+
+  uint32_t vertexCount = source.VertexCount();
+  destination.vertices.resize((size_t)vertexCount * destination.vertexStride);
+
+  for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+  {
+    const uint8_t* input = source.vertices.data() + (size_t)vertex * source.vertexStride;
+    uint8_t* output = destination.vertices.data() + (size_t)vertex * destination.vertexStride;
+
+    for (size_t i = 0; i < source.attributes.size(); ++i)
+    {
+      const MeshAttribute& from = source.attributes[i];
+      const MeshAttribute& to = destination.attributes[i];
+
+      // Missing components read as (0, 0, 0, 1), like OpenGL does
+      glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+      std::memcpy(&value[0], input + from.offset, from.components * sizeof(float));
+
+      switch (to.type)
+      {
+        case GL_HALF_FLOAT:
+        {
+          glm::uint64 packed = glm::packHalf4x16(value);
+          std::memcpy(output + to.offset, &packed, sizeof(packed));
+          break;
+        }
+        case GL_UNSIGNED_BYTE:
+        {
+          glm::uint32 packed = glm::packUnorm4x8(value);
+          std::memcpy(output + to.offset, &packed, sizeof(packed));
+          break;
+        }
+        case GL_INT_2_10_10_10_REV:
+        {
+          // Normals have no meaningful w, store 0
+          glm::uint32 packed = glm::packSnorm3x10_1x2(glm::vec4(glm::vec3(value), 0.0f));
+          std::memcpy(output + to.offset, &packed, sizeof(packed));
+          break;
+        }
+        default:
+          std::memcpy(output + to.offset, &value[0], to.components * sizeof(float));
+          break;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,193 @@
+/*
+  Atlas packer
+
+  Bakes TGA images into texture atlas pages offline (see gloom/atlas_packer.hpp), so the
+  program loads a few large textures instead of many small ones and sprites using different
+  images can share a batch. Writes the pages as <output>_<page>.tga and a manifest <output>.atlas
+  that says where every image is. Load the result with LoadTextureAtlas (gloom/texture_atlas.hpp),
+  images are looked up by the id of their file name without the extension (AtlasAssetIdFromName).
+
+  All images are known up front, so they are packed largest first, which packs tighter than
+  the runtime atlas can when images arrive one at a time.
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./tools/atlas_pack.cpp ./src/atlas_packer.cpp ./src/tga.cpp ./src/asset_io.cpp -o atlas_pack -I ./include/
+
+  Usage
+  ./atlas_pack [--size N] [--border N] [--mips N] [--method maxrects|skyline] output input.tga...
+*/
+
+// GLoom
+#include <gloom/asset_io.hpp>
+#include <gloom/atlas_packer.hpp>
+#include <gloom/tga.hpp>
+
+// C++ Standard Template Library (STL)
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct SourceImage
+{
+  std::string name;
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+};
+
+/*
+  Writes an uncompressed 32 bit TGA, rows from bottom to top
+
+  @return false if the file could not be written
+*/
+bool WriteTGA(const std::string& filename, const std::vector<uint8_t>& pixels, int width, int height)
+{
+  const uint8_t header[18] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, (uint8_t)(width & 0xFF), (uint8_t)(width >> 8),
+			       (uint8_t)(height & 0xFF), (uint8_t)(height >> 8), 32, 8 };
+  std::vector<uint8_t> bgra(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i += 4)
+  {
+    bgra[i + 0] = pixels[i + 2];
+    bgra[i + 1] = pixels[i + 1];
+    bgra[i + 2] = pixels[i + 0];
+    bgra[i + 3] = pixels[i + 3];
+  }
+  std::ofstream file(filename, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(bgra.data()), bgra.size());
+  return file.good();
+}
+
+int main(int argc, char* args[])
+{
+  AtlasManifest manifest;
+  manifest.pageSize = 2048;
+  manifest.border = 2;
+  manifest.mipLevels = 2;
+  AtlasPackMethod method = AtlasPackMethod::MaxRects;
+  std::vector<std::string> filenames;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--size" && i + 1 < argc)
+    {
+      manifest.pageSize = std::atoi(args[++i]);
+    }
+    else if (option == "--border" && i + 1 < argc)
+    {
+      manifest.border = std::atoi(args[++i]);
+    }
+    else if (option == "--mips" && i + 1 < argc)
+    {
+      manifest.mipLevels = std::atoi(args[++i]);
+    }
+    else if (option == "--method" && i + 1 < argc && ParseAtlasPackMethod(args[i + 1], method))
+    {
+      ++i;
+    }
+    else if (option.rfind("--", 0) == 0)
+    {
+      filenames.clear();
+      break;
+    }
+    else
+    {
+      filenames.push_back(option);
+    }
+  }
+  if (filenames.size() < 2 || manifest.pageSize <= 0 || manifest.pageSize > 16384 || manifest.mipLevels < 0 ||
+      manifest.mipLevels > 8)
+  {
+    std::cout << "Usage: " << args[0] << " [--size N] [--border N] [--mips N] [--method maxrects|skyline] output input.tga..."
+	      << std::endl;
+    return 1;
+  }
+  // Like the runtime atlas, every mip level keeps a texel of border
+  manifest.border = std::max(manifest.border, 1 << manifest.mipLevels);
+  int alignment = 1 << manifest.mipLevels;
+  std::string output = filenames[0];
+
+  std::vector<SourceImage> images;
+  size_t imageArea = 0;
+  for (size_t i = 1; i < filenames.size(); ++i)
+  {
+    SourceImage image;
+    image.name = std::filesystem::path(filenames[i]).stem().string();
+    AssetFile file = LoadAsset(filenames[i]);
+    if (!file.IsOpen() || !DecodeTGA(file.View(), image.pixels, image.width, image.height))
+    {
+      std::cout << "Could not decode " << filenames[i] << std::endl;
+      return 1;
+    }
+    imageArea += (size_t)image.width * image.height;
+    images.push_back(std::move(image));
+  }
+
+  // Largest first, by the longer side, then by area
+  std::sort(images.begin(), images.end(), [](const SourceImage& a, const SourceImage& b) {
+    int longA = std::max(a.width, a.height);
+    int longB = std::max(b.width, b.height);
+    return longA != longB ? longA > longB : a.width * a.height > b.width * b.height;
+  });
+
+  std::vector<AtlasPacker> packers;
+  std::vector<std::vector<uint8_t>> pages;
+  for (const SourceImage& image : images)
+  {
+    AtlasRect slot;
+    int slotWidth = AtlasSlotSize(image.width, manifest.border, alignment);
+    int slotHeight = AtlasSlotSize(image.height, manifest.border, alignment);
+    if (slotWidth > manifest.pageSize || slotHeight > manifest.pageSize)
+    {
+      std::cout << image.name << " (" << image.width << "x" << image.height << ") does not fit on a page" << std::endl;
+      return 1;
+    }
+    size_t page = 0;
+    while (page < packers.size() && !AtlasPackerInsert(packers[page], slotWidth, slotHeight, slot))
+    {
+      ++page;
+    }
+    if (page == packers.size())
+    {
+      packers.emplace_back();
+      AtlasPackerReset(packers.back(), manifest.pageSize, manifest.pageSize, method);
+      pages.emplace_back((size_t)manifest.pageSize * manifest.pageSize * 4, 0);
+      AtlasPackerInsert(packers.back(), slotWidth, slotHeight, slot);
+    }
+    AtlasBlit(pages[page].data(), manifest.pageSize, slot, manifest.border, image.pixels.data(), image.width, image.height);
+
+    AtlasManifestEntry entry;
+    entry.name = image.name;
+    entry.page = (int)page;
+    entry.rect = { slot.x + manifest.border, slot.y + manifest.border, image.width, image.height };
+    manifest.entries.push_back(entry);
+  }
+
+  std::string stem = std::filesystem::path(output).filename().string();
+  for (size_t page = 0; page < pages.size(); ++page)
+  {
+    std::string pageFilename = stem + "_" + std::to_string(page) + ".tga";
+    manifest.pageFilenames.push_back(pageFilename);
+    std::string path = (std::filesystem::path(output).parent_path() / pageFilename).string();
+    if (!WriteTGA(path, pages[page], manifest.pageSize, manifest.pageSize))
+    {
+      std::cout << "Could not write " << path << std::endl;
+      return 1;
+    }
+  }
+  if (!WriteAtlasManifest(output + ".atlas", manifest))
+  {
+    std::cout << "Could not write " << output << ".atlas" << std::endl;
+    return 1;
+  }
+
+  double pageArea = (double)pages.size() * manifest.pageSize * manifest.pageSize;
+  std::cout << images.size() << " images packed (" << AtlasPackMethodName(method) << ") into " << pages.size()
+	    << " pages of " << manifest.pageSize << "x" << manifest.pageSize << ", the images cover "
+	    << imageArea / pageArea * 100.0 << "% of them" << std::endl;
+  return 0;
+}
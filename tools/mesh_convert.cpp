@@ -0,0 +1,99 @@
+/*
+  Mesh converter
+
+  Converts a Wavefront OBJ file into our binary mesh format (see gloom/mesh.hpp), so the
+  program never has to parse text at load time. Vertices are stored in the compact format
+  (half float positions, 8 bit colors, see gloom/vertex_format.hpp) unless told otherwise.
+  With --optimize, triangles and vertices are reordered for the vertex cache, overdraw and
+  vertex fetch first (see gloom/mesh_optimizer.hpp).
+
+  Compilation on Linux (from the repository root)
+  g++ -std=c++17 -O2 ./tools/mesh_convert.cpp ./src/mesh.cpp ./src/mesh_obj.cpp ./src/mesh_optimizer.cpp ./src/vertex_format.cpp ./src/asset_io.cpp ./src/glad.c -o mesh_convert -I ./include/ -I ./thirdparty/glm-master/ -ldl
+
+  Usage
+  ./mesh_convert [--format float|compact] [--optimize] input.obj output.mesh
+*/
+
+// GLoom
+#include <gloom/asset_io.hpp>
+#include <gloom/mesh.hpp>
+#include <gloom/mesh_optimizer.hpp>
+#include <gloom/vertex_format.hpp>
+
+// C++ Standard Template Library (STL)
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Prints the vertex cache statistics of a mesh
+void PrintVertexCacheStatistics(const char* label, const MeshData& mesh)
+{
+  VertexCacheStatistics statistics = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+  std::cout << label << ": ACMR " << statistics.acmr << ", ATVR " << statistics.atvr << std::endl;
+}
+
+int main(int argc, char* args[])
+{
+  VertexFormat format = VertexFormat::Compact;
+  bool optimize = false;
+  std::vector<std::string> filenames;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string option = args[i];
+    if (option == "--format" && i + 1 < argc)
+    {
+      if (!ParseVertexFormat(args[++i], format))
+      {
+        std::cout << "Unknown vertex format: " << args[i] << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--optimize")
+    {
+      optimize = true;
+    }
+    else
+    {
+      filenames.push_back(option);
+    }
+  }
+  if (filenames.size() != 2)
+  {
+    std::cout << "Usage: " << args[0] << " [--format float|compact] [--optimize] input.obj output.mesh" << std::endl;
+    return 1;
+  }
+  const char* inputFilename = filenames[0].c_str();
+  const char* outputFilename = filenames[1].c_str();
+
+  AssetFile input = LoadAsset(inputFilename);
+  if (!input.IsOpen())
+  {
+    std::cout << "Could not read " << inputFilename << std::endl;
+    return 1;
+  }
+
+  MeshData parsed;
+  if (!ParseObjMesh(input.View(), parsed))
+  {
+    return 1;
+  }
+
+  if (optimize)
+  {
+    // Positions are still floats here, which the overdraw pass needs
+    PrintVertexCacheStatistics("Before optimizing", parsed);
+    OptimizeMesh(parsed);
+    PrintVertexCacheStatistics("After optimizing", parsed);
+  }
+
+  MeshData mesh;
+  if (!ConvertVertexFormat(parsed, format, mesh) || !WriteMeshFile(outputFilename, mesh))
+  {
+    return 1;
+  }
+
+  std::cout << outputFilename << ": " << mesh.VertexCount() << " vertices (" << VertexFormatName(format)
+	    << ", " << mesh.vertexStride << " bytes each), " << mesh.indices.size() / 3 << " triangles, "
+	    << (mesh.VertexCount() <= 0xFFFF ? 16 : 32) << " bit indices" << std::endl;
+  return 0;
+}